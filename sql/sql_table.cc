@@ -8337,7 +8337,7 @@ mysql_prepare_alter_table(THD *thd, TABLE *table,
           //key_type= KEYTYPE_FULLTEXT;
           my_error(ER_TIANMU_NOT_SUPPORTED_FULLTEXT_INDEX, MYF(0));
           goto err; 
-        } else {
+        } else if (table->file->ha_table_flags() & HA_NON_SECONDARY_KEY) {
           //key_type= KEYTYPE_MULTIPLE;
           my_error(ER_TIANMU_NOT_SUPPORTED_SECONDARY_INDEX, MYF(0));
           goto err; 
@@ -259,7 +259,7 @@ enum class ColOperation {
 enum class ExtraOperation { EX_DO_NOTHING, EX_COND_PUSH, EX_UNKNOWN };
 
 // pack data format, stored on disk so only append new ones at the end.
-enum class PackFmt : char { DEFAULT, PPM1, PPM2, RANGECODE, LZ4, LOOKUP, NOCOMPRESS, TRIE, ZLIB };
+enum class PackFmt : char { DEFAULT, PPM1, PPM2, RANGECODE, LZ4, LOOKUP, NOCOMPRESS, TRIE, ZLIB, BITPACK };
 
 // data source
 enum class LoadSource {
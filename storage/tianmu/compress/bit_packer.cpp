@@ -0,0 +1,276 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "compress/bit_packer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/simd_filter.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define TIANMU_SIMD_X86 1
+#include <immintrin.h>
+#define TIANMU_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace Tianmu {
+namespace compress {
+
+namespace {
+
+// bits needed for values up to v
+int BitWidth(uint64_t v) { return v == 0 ? 0 : 64 - __builtin_clzll(v); }
+
+// bytes of n packed values of width bits
+size_t PackedSize(uint n, int width) { return (uint64_t(n) * width + 7) / 8; }
+
+template <typename V>
+void Store(char *&p, V v) {
+  std::memcpy(p, &v, sizeof(V));
+  p += sizeof(V);
+}
+
+template <typename V>
+V Load(const char *&p) {
+  V v;
+  std::memcpy(&v, p, sizeof(V));
+  p += sizeof(V);
+  return v;
+}
+
+// n codes of width bits, code(i) for i in [0, n), lowest bits first; returns
+// the end of the written bytes
+template <typename F>
+char *PackBits(char *dest, uint n, int width, F code) {
+  if (width == 0)
+    return dest;
+  uint64_t acc = 0;
+  int bits = 0;
+  for (uint i = 0; i < n; i++) {
+    uint64_t v = code(i);
+    acc |= v << bits;
+    if (bits + width >= 64) {
+      std::memcpy(dest, &acc, sizeof(acc));
+      dest += sizeof(acc);
+      acc = bits == 0 ? 0 : v >> (64 - bits);
+      bits = bits + width - 64;
+    } else
+      bits += width;
+  }
+  std::memcpy(dest, &acc, (bits + 7) / 8);
+  return dest + (bits + 7) / 8;
+}
+
+template <class T>
+void UnpackBitsScalar(const char *src, uint begin, uint n, int width, T base, T *out) {
+  uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+  for (uint i = begin; i < n; i++) {
+    uint64_t off = uint64_t(i) * width;
+    const char *p = src + (off >> 3);
+    int shift = off & 7;
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    uint64_t v = w >> shift;
+    if (shift + width > 64)
+      v |= uint64_t(static_cast<uchar>(p[8])) << (64 - shift);
+    out[i] = T(base + (v & mask));
+  }
+}
+
+#ifdef TIANMU_SIMD_X86
+// 8 codes per step with one 4 byte gather each, so for widths up to 25
+// (shift + width <= 32)
+template <class T>
+TIANMU_TARGET_AVX2 uint UnpackBitsAvx2(const char *src, uint n, int width, T base, T *out) {
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i mask = _mm256_set1_epi32(int((1u << width) - 1));
+  const __m256i seven = _mm256_set1_epi32(7);
+  alignas(32) uint32_t codes[8];
+  uint i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i off = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(int(i)), lane), _mm256_set1_epi32(width));
+    __m256i word = _mm256_i32gather_epi32(reinterpret_cast<const int *>(src), _mm256_srli_epi32(off, 3), 1);
+    __m256i v = _mm256_and_si256(_mm256_srlv_epi32(word, _mm256_and_si256(off, seven)), mask);
+    if constexpr (sizeof(T) == 4) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi32(v, _mm256_set1_epi32(int(base))));
+    } else {
+      _mm256_store_si256(reinterpret_cast<__m256i *>(codes), v);
+      for (int j = 0; j < 8; j++) out[i + j] = T(base + codes[j]);
+    }
+  }
+  return i;
+}
+#endif
+
+template <class T>
+void UnpackBits(const char *src, uint n, int width, T base, T *out) {
+  if (width == 0) {
+    std::fill(out, out + n, base);
+    return;
+  }
+  uint done = 0;
+#ifdef TIANMU_SIMD_X86
+  // i * width stays in 32 bits for a pack of 64K rows
+  if (width <= 25 && utils::simd::ActiveLevel() >= utils::simd::Level::AVX2)
+    done = UnpackBitsAvx2(src, n, width, base, out);
+#endif
+  UnpackBitsScalar(src, done, n, width, base, out);
+}
+
+}  // namespace
+
+template <class T>
+CprsErr BitPacker<T>::Compress(char *dest, uint &len, const T *src, uint nrec, [[maybe_unused]] T maxval) {
+  if (nrec == 0 || len < MaxSize(nrec))
+    return CprsErr::CPRS_ERR_BUF;
+
+  T min = src[0], max = src[0];
+  T dmin = 0, dmax = 0;
+  uint nruns = 1, max_run = 1, run = 1;
+  for (uint i = 1; i < nrec; i++) {
+    min = std::min(min, src[i]);
+    max = std::max(max, src[i]);
+    T d = T(src[i] - src[i - 1]);
+    dmin = i == 1 ? d : std::min(dmin, d);
+    dmax = i == 1 ? d : std::max(dmax, d);
+    if (src[i] == src[i - 1])
+      run++;
+    else {
+      max_run = std::max(max_run, run);
+      nruns++;
+      run = 1;
+    }
+  }
+  max_run = std::max(max_run, run);
+
+  int for_width = BitWidth(T(max - min));
+  int delta_width = BitWidth(T(dmax - dmin));
+  int length_width = BitWidth(max_run - 1);
+  size_t for_size = 2 + sizeof(T) + PackedSize(nrec, for_width);
+  size_t delta_size = nrec > 1 ? 2 + 2 * sizeof(T) + PackedSize(nrec - 1, delta_width) : for_size;
+  size_t rle_size = 3 + sizeof(uint) + sizeof(T) + PackedSize(nruns, for_width) + PackedSize(nruns, length_width);
+
+  char *p = dest;
+  if (for_size <= delta_size && for_size <= rle_size) {
+    Store(p, Scheme::FOR);
+    Store(p, uchar(for_width));
+    Store(p, min);
+    p = PackBits(p, nrec, for_width, [src, min](uint i) { return uint64_t(T(src[i] - min)); });
+  } else if (delta_size <= rle_size) {
+    Store(p, Scheme::DELTA);
+    Store(p, uchar(delta_width));
+    Store(p, src[0]);
+    Store(p, dmin);
+    p = PackBits(p, nrec - 1, delta_width,
+                 [src, dmin](uint i) { return uint64_t(T(T(src[i + 1] - src[i]) - dmin)); });
+  } else {
+    std::vector<T> values;
+    std::vector<uint> lengths;
+    values.reserve(nruns);
+    lengths.reserve(nruns);
+    for (uint i = 0; i < nrec; i++) {
+      if (i > 0 && src[i] == src[i - 1]) {
+        lengths.back()++;
+      } else {
+        values.push_back(src[i]);
+        lengths.push_back(1);
+      }
+    }
+    Store(p, Scheme::RLE);
+    Store(p, uchar(for_width));
+    Store(p, uchar(length_width));
+    Store(p, nruns);
+    Store(p, min);
+    p = PackBits(p, nruns, for_width, [&values, min](uint i) { return uint64_t(T(values[i] - min)); });
+    p = PackBits(p, nruns, length_width, [&lengths](uint i) { return uint64_t(lengths[i] - 1); });
+  }
+  std::memset(p, 0, SLACK);
+  len = uint(p + SLACK - dest);
+  return CprsErr::CPRS_SUCCESS;
+}
+
+template <class T>
+bool BitPacker<T>::Runs(const char *src, uint len, std::vector<T> &values, std::vector<uint> &lengths) {
+  if (len < 3 + sizeof(uint) + sizeof(T) + SLACK || GetScheme(src) != Scheme::RLE)
+    return false;
+  const char *p = src + 1;
+  int value_width = Load<uchar>(p);
+  int length_width = Load<uchar>(p);
+  uint nruns = Load<uint>(p);
+  T base = Load<T>(p);
+  if (value_width > int(sizeof(T) * 8) || length_width > 32 ||
+      PackedSize(nruns, value_width) + PackedSize(nruns, length_width) + SLACK > len - size_t(p - src))
+    return false;
+  values.resize(nruns);
+  lengths.resize(nruns);
+  UnpackBits(p, nruns, value_width, base, values.data());
+  UnpackBits(p + PackedSize(nruns, value_width), nruns, length_width, 1u, lengths.data());
+  return true;
+}
+
+template <class T>
+CprsErr BitPacker<T>::Decompress(T *dest, char *src, uint len, uint nrec, [[maybe_unused]] T maxval) {
+  if (nrec == 0 || len < 2 + sizeof(T) + SLACK)
+    return CprsErr::CPRS_ERR_PAR;
+
+  const char *p = src + 1;
+  int width = Load<uchar>(p);
+  switch (GetScheme(src)) {
+    case Scheme::FOR: {
+      T base = Load<T>(p);
+      if (width > int(sizeof(T) * 8) || PackedSize(nrec, width) + SLACK > len - size_t(p - src))
+        return CprsErr::CPRS_ERR_COR;
+      UnpackBits(p, nrec, width, base, dest);
+      return CprsErr::CPRS_SUCCESS;
+    }
+    case Scheme::DELTA: {
+      if (len < 2 + 2 * sizeof(T) + SLACK)
+        return CprsErr::CPRS_ERR_COR;
+      dest[0] = Load<T>(p);
+      T dmin = Load<T>(p);
+      if (width > int(sizeof(T) * 8) || PackedSize(nrec - 1, width) + SLACK > len - size_t(p - src))
+        return CprsErr::CPRS_ERR_COR;
+      UnpackBits(p, nrec - 1, width, dmin, dest + 1);
+      for (uint i = 1; i < nrec; i++) dest[i] = T(dest[i - 1] + dest[i]);
+      return CprsErr::CPRS_SUCCESS;
+    }
+    case Scheme::RLE: {
+      std::vector<T> values;
+      std::vector<uint> lengths;
+      if (!Runs(src, len, values, lengths))
+        return CprsErr::CPRS_ERR_COR;
+      uint row = 0;
+      for (size_t r = 0; r < values.size(); r++) {
+        if (lengths[r] > nrec - row)
+          return CprsErr::CPRS_ERR_COR;
+        std::fill(dest + row, dest + row + lengths[r], values[r]);
+        row += lengths[r];
+      }
+      return row == nrec ? CprsErr::CPRS_SUCCESS : CprsErr::CPRS_ERR_COR;
+    }
+  }
+  return CprsErr::CPRS_ERR_VER;
+}
+
+template class BitPacker<uchar>;
+template class BitPacker<ushort>;
+template class BitPacker<uint>;
+template class BitPacker<uint64_t>;
+
+}  // namespace compress
+}  // namespace Tianmu
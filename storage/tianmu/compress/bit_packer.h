@@ -0,0 +1,64 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_COMPRESS_BIT_PACKER_H_
+#define TIANMU_COMPRESS_BIT_PACKER_H_
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/common_definitions.h"
+#include "compress/defs.h"
+
+namespace Tianmu {
+namespace compress {
+
+// Lightweight codec of the integer packs of BITPACK columns. A block is stored
+// in whichever of these is the smallest:
+//   FOR   - frame of reference: value - min, bit packed
+//   DELTA - differences of neighbours minus their minimum, bit packed
+//   RLE   - runs of equal values: run values - min and run lengths - 1, both bit packed
+// Decoding is a shift and a mask per value (8 values per step with AVX2), much
+// cheaper than the filter chain and range coder of NumCompressor.
+//
+// Layout: scheme byte, bit width(s), scheme header, packed streams, 8 bytes of
+// slack so that the decoder can always load a whole word.
+template <class T>
+class BitPacker final {
+ public:
+  enum class Scheme : uchar { FOR = 0, DELTA = 1, RLE = 2 };
+
+  // room Compress() needs for nrec values
+  static uint MaxSize(uint nrec) { return nrec * sizeof(T) + MAX_HEADER + SLACK; }
+
+  // same interface as NumCompressor; maxval is not needed by the codec
+  CprsErr Compress(char *dest, uint &len, const T *src, uint nrec, T maxval);
+  CprsErr Decompress(T *dest, char *src, uint len, uint nrec, T maxval);
+
+  static Scheme GetScheme(const char *src) { return static_cast<Scheme>(*src); }
+  // the runs of an RLE block, as run values and run lengths; false for other schemes
+  static bool Runs(const char *src, uint len, std::vector<T> &values, std::vector<uint> &lengths);
+
+ private:
+  static constexpr uint MAX_HEADER = 3 + sizeof(uint) + 2 * sizeof(T);
+  static constexpr uint SLACK = 8;
+};
+
+}  // namespace compress
+}  // namespace Tianmu
+
+#endif  // TIANMU_COMPRESS_BIT_PACKER_H_
@@ -22,7 +22,6 @@ low-level mechanisms
 
 #include "aggregation_algorithm.h"
 
-#include "core/ctask.h"
 #include "core/engine.h"
 #include "core/mi_iterator.h"
 #include "core/pack_guardian.h"
@@ -259,8 +258,11 @@ void AggregationAlgorithm::MultiDimensionalGroupByScan(GroupByWrapper &gbw, int6
 
   AggregationWorkerEnt ag_worker(gbw, mind, thd_cnt, this);
 
-  if (!gbw.IsOnePass())
+  if (!gbw.IsOnePass()) {
     gbw.InitTupleLeft(mit.NumOfTuples());
+    if (1 == thd_cnt && tianmu_sysvar_groupby_spill)
+      gbw.InitSpill();  // no more passes, new groups not fitting in memory are partitioned on disk
+  }
   bool rewind_needed = false;
   try {
     do {
@@ -295,7 +297,7 @@ void AggregationAlgorithm::MultiDimensionalGroupByScan(GroupByWrapper &gbw, int6
 #endif
 
       if (ag_worker.ThreadsUsed() > 1) {
-        ag_worker.DistributeAggreTaskAverage(mit);
+        ag_worker.DistributeAggreTask(mit);
       } else {
         thread_type = "sin";
         while (mit.IsValid()) {  // need muti thread
@@ -336,11 +338,18 @@ void AggregationAlgorithm::MultiDimensionalGroupByScan(GroupByWrapper &gbw, int6
       MultiDimensionalDistinctScan(gbw, mit);  // if not needed, no effect
       ag_worker.Commit();
 
+      // groups may be spread over hash partitions after a parallel merge
+      std::vector<GroupByWrapper *> results = ag_worker.Results();
+      int64_t no_groups = 0;
+      for (auto *res : results) no_groups += res->NumOfGroups();
+
       // Now it is time to prepare output values
       if (first_pass) {
         first_pass = false;
-        int64_t upper_groups = gbw.NumOfGroups() + gbw.TuplesNoOnes();  // upper approximation: the current size +
-                                                                        // all other possible rows (if any)
+        int64_t upper_groups = no_groups + gbw.TuplesNoOnes();  // upper approximation: the current size +
+                                                                // all other possible rows (if any)
+        if (gbw.IsSpilling())
+          upper_groups += gbw.Spill()->NumOfTuples();
         t->CalculatePageSize(upper_groups);
         if (upper_groups > gbw.UpperApproxOfGroups())
           upper_groups = gbw.UpperApproxOfGroups();  // another upper limitation: not more
@@ -359,51 +368,38 @@ void AggregationAlgorithm::MultiDimensionalGroupByScan(GroupByWrapper &gbw, int6
         }
       }
       tianmu_control_.lock(m_conn->GetThreadID()) << "Group/Aggregate end. Begin generating output." << system::unlock;
-      tianmu_control_.lock(m_conn->GetThreadID()) << "Output rows: " << gbw.NumOfGroups() + gbw.TuplesNoOnes()
+      tianmu_control_.lock(m_conn->GetThreadID()) << "Output rows: " << no_groups + gbw.TuplesNoOnes()
                                                   << ", output table row limit: " << t->GetPageSize() << system::unlock;
-      int64_t output_size = (gbw.NumOfGroups() + gbw.TuplesNoOnes()) * t->GetOneOutputRecordSize();
-      gbw.RewindRows();
-      if (t->GetPageSize() >= (gbw.NumOfGroups() + gbw.TuplesNoOnes()) && output_size > (1L << 29) &&
+      int64_t output_size = (no_groups + gbw.TuplesNoOnes()) * t->GetOneOutputRecordSize();
+      for (auto *res : results) res->RewindRows();
+      if (t->GetPageSize() >= (no_groups + gbw.TuplesNoOnes()) && output_size > (1L << 29) &&
           !t->HasHavingConditions() && tianmu_sysvar_parallel_filloutput) {
         // Turn on parallel output when:
         // 1. output page is large enough to hold all output rows
         // 2. output result is larger than 512MB
         // 3. no have condition
         tianmu_control_.lock(m_conn->GetThreadID()) << "Start parallel output" << system::unlock;
-        ParallelFillOutputWrapper(gbw, offset, limit, mit);
+        for (auto *res : results) ParallelFillOutputWrapper(*res, offset, limit, mit);
       } else {
-        while (gbw.RowValid()) {
-          // copy GroupTable into TempTable, row by row
+        for (auto *res : results) {
+          FillOutputRows(*res, limit, offset, sender, displayed_no_groups);
           if (t->NumOfObj() >= limit)
             break;
-          AggregateFillOutput(gbw, gbw.GetCurrentRow(),
-                              offset);  // offset is decremented for each row, if positive
-          if (sender && t->NumOfObj() > (1 << mind->ValueOfPower()) - 1) {
-            TempTable::RecordIterator iter = t->begin();
-            for (int64_t i = 0; i < t->NumOfObj(); i++) {
-              sender->Send(iter);
-              ++iter;
-            }
-            displayed_no_groups += t->NumOfObj();
-            limit -= t->NumOfObj();
-            t->SetNumOfObj(0);
-          }
-          gbw.NextRow();
         }
       }
-      if (sender) {
-        TempTable::RecordIterator iter = t->begin();
-        for (int64_t i = 0; i < t->NumOfObj(); i++) {
-          sender->Send(iter);
-          ++iter;
-        }
-        displayed_no_groups += t->NumOfObj();
-        limit -= t->NumOfObj();
-        t->SetNumOfObj(0);
-      } else
-        displayed_no_groups = t->NumOfObj();
+      SendOutputRows(sender, limit, displayed_no_groups);
       if (t->NumOfObj() >= limit)
         break;
+      if (gbw.IsSpilling() && gbw.Spill()->NumOfTuples() > 0) {
+        tianmu_control_.lock(m_conn->GetThreadID())
+            << "Aggregating " << gbw.Spill()->NumOfTuples() << " spilled tuples ("
+            << gbw.Spill()->ByteSize() / 1_MB << " MB)" << system::unlock;
+        tuples_spilled += gbw.Spill()->NumOfTuples();
+        bytes_spilled += gbw.Spill()->ByteSize();
+        AggregateSpilled(gbw, *gbw.Spill(), limit, offset, sender, displayed_no_groups);
+        if (t->NumOfObj() >= limit)
+          break;
+      }
       if (gbw.AnyTuplesLeft())
         gbw.ClearUsed();                              // prepare for the next pass, if needed
     } while (gbw.AnyTuplesLeft() && (1 == thd_cnt));  // do the next pass, if anything left
@@ -416,6 +412,79 @@ void AggregationAlgorithm::MultiDimensionalGroupByScan(GroupByWrapper &gbw, int6
         << "Generating output end. "
         << "Aggregated (" << displayed_no_groups << " group). Omitted packrows: " << gbw.packrows_omitted << " + "
         << gbw.packrows_part_omitted << " partially, out of " << packrows_found << " total." << system::unlock;
+  if (tuples_spilled > 0)
+    tianmu_control_.lock(m_conn->GetThreadID())
+        << "Aggregation spilled " << tuples_spilled << " tuples (" << bytes_spilled / 1_MB << " MB) to disk."
+        << system::unlock;
+}
+
+void AggregationAlgorithm::FillOutputRows(GroupByWrapper &gbw, int64_t &limit, int64_t &offset,
+                                          ResultSender *sender, int64_t &displayed_no_groups) {
+  while (gbw.RowValid()) {
+    // copy GroupTable into TempTable, row by row
+    if (t->NumOfObj() >= limit)
+      break;
+    AggregateFillOutput(gbw, gbw.GetCurrentRow(),
+                        offset);  // offset is decremented for each row, if positive
+    if (sender && t->NumOfObj() > (1 << mind->ValueOfPower()) - 1)
+      SendOutputRows(sender, limit, displayed_no_groups);
+    gbw.NextRow();
+  }
+}
+
+void AggregationAlgorithm::SendOutputRows(ResultSender *sender, int64_t &limit, int64_t &displayed_no_groups) {
+  if (sender) {
+    TempTable::RecordIterator iter = t->begin();
+    for (int64_t i = 0; i < t->NumOfObj(); i++) {
+      sender->Send(iter);
+      ++iter;
+    }
+    displayed_no_groups += t->NumOfObj();
+    limit -= t->NumOfObj();
+    t->SetNumOfObj(0);
+  } else
+    displayed_no_groups = t->NumOfObj();
+}
+
+// Every partition holds all remaining tuples of its groups, so it is aggregated
+// and output on its own. Tuples which still do not fit are split into the
+// partitions of the next level.
+void AggregationAlgorithm::AggregateSpilled(GroupByWrapper &gbw, GroupSpill &spill, int64_t &limit, int64_t &offset,
+                                            ResultSender *sender, int64_t &displayed_no_groups) {
+  MEASURE_FET("AggregationAlgorithm::AggregateSpilled(...)");
+  for (int part = 0; part < GroupSpill::kPartitions; part++) {
+    if (spill.NumOfTuples(part) == 0)
+      continue;
+    if (t->NumOfObj() >= limit)
+      return;
+    gbw.ClearUsed();
+    gbw.ClearNoGroups();
+    std::unique_ptr<GroupSpill> overflow;
+    const unsigned char *rec;
+    uint32_t len;
+    spill.Rewind(part);
+    while (spill.Next(rec, len)) {
+      if (m_conn->Killed())
+        throw common::KilledException();
+      if (!gbw.AggregateSpilled(rec, len, factor)) {
+        if (!overflow)
+          overflow = std::make_unique<GroupSpill>(spill.Level() + 1);
+        overflow->Put(gbw.CurrentKeyHash(), rec, len);
+      }
+    }
+    spill.ReleasePartition(part);
+    gbw.RewindRows();
+    FillOutputRows(gbw, limit, offset, sender, displayed_no_groups);
+    SendOutputRows(sender, limit, displayed_no_groups);
+    if (overflow) {
+      tianmu_control_.lock(m_conn->GetThreadID())
+          << "Spilled partition " << part << " (level " << spill.Level() << ") split again: "
+          << overflow->NumOfTuples() << " tuples" << system::unlock;
+      tuples_spilled += overflow->NumOfTuples();
+      bytes_spilled += overflow->ByteSize();
+      AggregateSpilled(gbw, *overflow, limit, offset, sender, displayed_no_groups);
+    }
+  }
 }
 
 void AggregationAlgorithm::MultiDimensionalDistinctScan(GroupByWrapper &gbw, MIIterator &mit) {
@@ -561,6 +630,8 @@ AggregaGroupingResult AggregationAlgorithm::AggregatePackrow(GroupByWrapper &gbw
       return AggregaGroupingResult::AGR_FINISH;       // aggregation finished
     }
   }
+  if (skip_packrow && !packrow_done && gbw.IsSpilling())
+    skip_packrow = false;  // left for the next pass otherwise; the rows of new groups are spilled below
   if (skip_packrow)
     gbw.packrows_omitted++;
   else if (part_omitted)
@@ -579,8 +650,10 @@ AggregaGroupingResult AggregationAlgorithm::AggregatePackrow(GroupByWrapper &gbw
   // common::NULL_VALUE_64);	// do not lock if the grouping row is uniform
 
   while (mit->IsValid()) {  // becomes invalid on pack end
-    if (m_conn->Killed())
+    if (m_conn->Killed()) {
+      gbw.FlushBatches(factor);
       return AggregaGroupingResult::AGR_KILLED;  // killed
+    }
     if (gbw.TuplesGet(cur_tuple)) {
       if (require_locking_gr) {
         for (int gr_a = 0; gr_a < gbw.NumOfGroupingAttrs(); gr_a++)
@@ -627,12 +700,19 @@ AggregaGroupingResult AggregationAlgorithm::AggregatePackrow(GroupByWrapper &gbw
           // Prepare packs for aggregated columns
           for (int gr_a = gbw.NumOfGroupingAttrs(); gr_a < gbw.NumOfAttrs(); gr_a++)
             if (gbw.ColumnNotOmitted(gr_a)) {
+              if (gbw.BatchAggregated(gr_a)) {
+                gbw.PutBatchValue(gr_a, pos, *mit);  // aggregated at the end of the packrow
+                continue;
+              }
               bool value_successfully_aggregated = gbw.PutAggregatedValue(gr_a, pos, *mit, factor);
               if (!value_successfully_aggregated) {
                 gbw.DistinctlyOmitted(gr_a, cur_tuple);
               }
             }
         }
+      } else if (gbw.IsSpilling()) {
+        gbw.SpillCurrentTuple(*mit);
+        gbw.TuplesReset(cur_tuple);
       }
     }
     cur_tuple++;
@@ -640,6 +720,7 @@ AggregaGroupingResult AggregationAlgorithm::AggregatePackrow(GroupByWrapper &gbw
     if (mit->PackrowStarted())
       break;
   }
+  gbw.FlushBatches(factor);
   gbw.CommitResets();
   return AggregaGroupingResult::AGR_OK;  // success
 }
@@ -871,43 +952,46 @@ void AggregationAlgorithm::TaskFillOutput(GroupByWrapper *gbw, Transaction *ci,
   }
 }
 
-void AggregationWorkerEnt::TaskAggrePacks(MIIterator *taskIterator, DimensionVector *dims [[maybe_unused]],
-                                          MIIterator *mit [[maybe_unused]], CTask *task [[maybe_unused]],
-                                          GroupByWrapper *gbw, Transaction *ci [[maybe_unused]]) {
-  TIANMU_LOG(LogCtl_Level::DEBUG, "TaskAggrePacks task_id: %d start pack_start: %d pack_end: %d", task->dwTaskId,
-             task->dwStartPackno, task->dwEndPackno);
+// Aggregate packrows taken from the shared queue into the worker's own table.
+// The iterator only moves forward, unless a stolen packrow lies behind it.
+void AggregationWorkerEnt::TaskAggrePacks(int worker, MIIterator *taskIterator, MorselQueue *queue,
+                                          GroupByWrapper *gbw, Transaction *ci) {
+  common::SetMySQLTHD(ci->Thd());
+  current_txn_ = ci;
 #ifdef DEBUG_AGGREGA_COST
   std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 #endif
 
   taskIterator->Rewind();
-  int task_pack_num = 0;
-  while (taskIterator->IsValid()) {
-    if ((task_pack_num >= task->dwStartPackno) && (task_pack_num <= task->dwEndPackno)) {
-      int cur_tuple = (*task->dwPack2cur)[task_pack_num];
-      MIInpackIterator mii(*taskIterator);
-      AggregaGroupingResult grouping_result = aa->AggregatePackrow(*gbw, &mii, cur_tuple);
-      if (grouping_result == AggregaGroupingResult::AGR_FINISH)
-        break;
-      if (grouping_result == AggregaGroupingResult::AGR_KILLED)
-        throw common::KilledException();
-      if (grouping_result == AggregaGroupingResult::AGR_OVERFLOW ||
-          grouping_result == AggregaGroupingResult::AGR_OTHER_ERROR)
-        throw common::NotImplementedException("Aggregation overflow.");
+  int it_pack = 0;  // the packrow taskIterator is standing on
+  int pack = 0;
+  int packs_done = 0;
+  while (!finished && queue->Next(worker, pack)) {
+    if (pack < it_pack) {
+      taskIterator->Rewind();
+      it_pack = 0;
     }
-
-    taskIterator->NextPackrow();
-    ++task_pack_num;
+    for (; it_pack < pack; ++it_pack) taskIterator->NextPackrow();
+    MIInpackIterator mii(*taskIterator);
+    AggregaGroupingResult grouping_result = aa->AggregatePackrow(*gbw, &mii, pack_start[pack]);
+    packs_done++;
+    if (grouping_result == AggregaGroupingResult::AGR_FINISH)
+      finished = true;  // e.g. all distinct values found - the rest is not needed by anybody
+    if (grouping_result == AggregaGroupingResult::AGR_KILLED)
+      throw common::KilledException();
+    if (grouping_result == AggregaGroupingResult::AGR_OVERFLOW ||
+        grouping_result == AggregaGroupingResult::AGR_OTHER_ERROR)
+      throw common::NotImplementedException("Aggregation overflow.");
   }
 
 #ifdef DEBUG_AGGREGA_COST
   auto diff =
       std::chrono::duration_cast<std::chrono::duration<float>>(std::chrono::high_resolution_clock::now() - start);
   if (diff.count() > tianmu_sysvar_slow_query_record_interval) {
-    TIANMU_LOG(LogCtl_Level::INFO, "TaskAggrePacks task_id: %d spend: %f pack_start: %d pack_end: %d", task->dwTaskId,
-               diff.count(), task->dwStartPackno, task->dwEndPackno);
+    TIANMU_LOG(LogCtl_Level::INFO, "TaskAggrePacks worker: %d spend: %f packs: %d", worker, diff.count(), packs_done);
   }
 #endif
+  TIANMU_LOG(LogCtl_Level::DEBUG, "TaskAggrePacks worker: %d packs: %d", worker, packs_done);
 }
 
 void AggregationWorkerEnt::PrepShardingCopy(MIIterator *mit, GroupByWrapper *gb_sharding,
@@ -923,110 +1007,90 @@ void AggregationWorkerEnt::PrepShardingCopy(MIIterator *mit, GroupByWrapper *gb_
   vGBW->emplace_back(std::move(gbw_ptr));
 }
 
-/*Average allocation task*/
-void AggregationWorkerEnt::DistributeAggreTaskAverage(MIIterator &mit) {
+// Merge one hash partition of all thread-local tables. The local tables are
+// only read, so all partitions are merged at once.
+void AggregationWorkerEnt::TaskMergePartition(int part, int no_parts, GroupByWrapper *target, Transaction *ci) {
+  common::SetMySQLTHD(ci->Thd());
+  current_txn_ = ci;
+  for (auto &gbw : vGBW) target->Merge(*gbw, part, no_parts);
+}
+
+/*Morsel-driven parallel aggregation*/
+void AggregationWorkerEnt::DistributeAggreTask(MIIterator &mit) {
   Transaction *conn = current_txn_;
-  DimensionVector dims(mind->NumOfDimensions());
-  std::vector<CTask> vTask;
-  std::vector<std::unique_ptr<GroupByWrapper>> vGBW;
-  vGBW.reserve(m_threads);
-  vTask.reserve(m_threads);
   if (tianmu_control_.isOn())
     tianmu_control_.lock(conn->GetThreadID()) << "Prepare data for parallel aggreation" << system::unlock;
 
-  int packnum = 0;
-  int curtuple_index = 0;
-  std::unordered_map<int, int> pack2cur;
+  pack_start.clear();
+  int64_t cur_tuple = 0;
   while (mit.IsValid()) {
-    pack2cur.emplace(std::pair<int, int>(packnum, curtuple_index));
-
-    int64_t packrow_length = mit.GetPackSizeLeft();
-    curtuple_index += packrow_length;
-    packnum++;
+    pack_start.push_back(cur_tuple);
+    cur_tuple += mit.GetPackSizeLeft();
     mit.NextPackrow();
   }
-
-  pack2cur.emplace(std::pair<int, int>(packnum, curtuple_index));
-
-  int loopcnt = 0;
-  int mod = 0;
-  int num = 0;
-
-  int threads_num = m_threads + 1;
-
-  do {
-    loopcnt = (packnum < threads_num) ? packnum : threads_num;
-    mod = packnum % loopcnt;
-    num = packnum / loopcnt;
-
-    --threads_num;
-  } while ((num <= 1) && (threads_num >= 1));
-
-  TIANMU_LOG(LogCtl_Level::DEBUG,
-             "DistributeAggreTaskAverage packnum: %d threads_num: %d loopcnt: %d num: %d mod: %d NumOfTuples: %d",
-             packnum, threads_num, loopcnt, num, mod, mit.NumOfTuples());
-
+  mit.Rewind();
+  int packnum = int(pack_start.size());
+  int workers = std::max(1, std::min(m_threads, packnum));
+
+  // gb_main is kept empty for the merge, all workers use their own copies
+  vGBW.clear();
+  vGBW.reserve(workers);
+  parts.clear();
+  finished = false;
   utils::result_set<void> res;
-  for (int i = 0; i < loopcnt; ++i) {
+  for (int i = 0; i < workers; ++i)
     res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&AggregationWorkerEnt::PrepShardingCopy, this, &mit,
                                                              gb_main, &vGBW));
-
-    int pack_start = i * num;
-    int pack_end = 0;
-    int dwPackNum = 0;
-    if (i == (loopcnt - 1)) {
-      pack_end = packnum;
-      dwPackNum = packnum;
-    } else {
-      pack_end = (i + 1) * num - 1;
-      dwPackNum = pack_end + 1;
-    }
-
-    int cur_start = pack2cur[pack_start];
-    int cur_end = pack2cur[pack_end] - 1;
-
-    CTask tmp;
-    tmp.dwTaskId = i;
-    tmp.dwPackNum = dwPackNum;
-    tmp.dwStartPackno = pack_start;
-    tmp.dwEndPackno = pack_end;
-    tmp.dwStartTuple = cur_start;
-    tmp.dwEndTuple = cur_end;
-    tmp.dwTuple = cur_start;
-    tmp.dwPack2cur = &pack2cur;
-
-    vTask.push_back(tmp);
-  }
   res.get_all_with_except();
 
-  mit.Rewind();
-
+  MorselQueue queue(packnum, workers);
   std::vector<MIIterator> taskIterator;
-  taskIterator.reserve(vTask.size());
-
-  utils::result_set<void> res1;
-  for (uint i = 0; i < vTask.size(); ++i) {
-    if (dims.NoDimsUsed() == 0)
-      dims.SetAll();
+  taskIterator.reserve(workers);
+  for (int i = 0; i < workers; ++i) {
     auto &mii = taskIterator.emplace_back(mit, true);
-    mii.SetTaskNum(vTask.size());
+    mii.SetTaskNum(workers);
     mii.SetTaskId(i);
   }
 
-  for (size_t i = 0; i < vTask.size(); ++i) {
-    GroupByWrapper *gbw = i == 0 ? gb_main : vGBW[i].get();
-    res1.insert(ha_tianmu_engine_->query_thread_pool.add_task(&AggregationWorkerEnt::TaskAggrePacks, this,
-                                                              &taskIterator[i], &dims, &mit, &vTask[i], gbw, conn));
-  }
+  utils::result_set<void> res1;
+  for (int i = 0; i < workers; ++i)
+    res1.insert(ha_tianmu_engine_->query_thread_pool.add_task(&AggregationWorkerEnt::TaskAggrePacks, this, i,
+                                                              &taskIterator[i], &queue, vGBW[i].get(), conn));
   res1.get_all_with_except();
+  TIANMU_LOG(LogCtl_Level::DEBUG, "DistributeAggreTask packnum: %d workers: %d steals: %ld NumOfTuples: %ld", packnum,
+             workers, queue.NumOfSteals(), mit.NumOfTuples());
 
-  for (size_t i = 0; i < vTask.size(); ++i) {
-    // Merge aggreation data together
-    if (i != 0) {
-      aa->MultiDimensionalDistinctScan(*(vGBW[i]), mit);
-      gb_main->Merge(*(vGBW[i]));
-    }
+  for (auto &gbw : vGBW) {
+    aa->MultiDimensionalDistinctScan(*gbw, mit);
+    gb_main->MergeStatus(*gbw);
+  }
+  // every partition but the first is a full copy of gb_main, so there are only
+  // as many as the aggregation buffer limit allows
+  int no_parts = 1;
+  if (workers > 1 && gb_main->MayBeParallel()) {
+    int64_t copy_size = std::max<int64_t>(1, gb_main->ByteSize());
+    no_parts = 1 + int(mm::TraceableObject::MaxBufferSizeForAggr(copy_size * (workers - 1)) / copy_size);
   }
+  if (no_parts > 1) {
+    // every group belongs to exactly one partition, so the partitions need no
+    // further merging and are output one after another
+    for (int i = 1; i < no_parts; ++i) parts.emplace_back(new GroupByWrapper(*gb_main));
+    utils::result_set<void> res2;
+    for (int i = 0; i < no_parts; ++i)
+      res2.insert(ha_tianmu_engine_->query_thread_pool.add_task(&AggregationWorkerEnt::TaskMergePartition, this, i,
+                                                                no_parts, i == 0 ? gb_main : parts[i - 1].get(),
+                                                                conn));
+    res2.get_all_with_except();
+  } else {
+    for (auto &gbw : vGBW) gb_main->Merge(*gbw);
+  }
+  vGBW.clear();
+}
+
+std::vector<GroupByWrapper *> AggregationWorkerEnt::Results() {
+  std::vector<GroupByWrapper *> res{gb_main};
+  for (auto &gbw : parts) res.push_back(gbw.get());
+  return res;
 }
 }  // namespace core
 }  // namespace Tianmu
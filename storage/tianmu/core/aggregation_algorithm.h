@@ -18,10 +18,12 @@
 #define TIANMU_CORE_AGGREGATION_ALGORITHM_H_
 #pragma once
 
+#include <atomic>
 #include <mutex>
-#include "core/ctask.h"
+
 #include "core/groupby_wrapper.h"
 #include "core/mi_iterator.h"
+#include "core/morsel_queue.h"
 #include "core/query.h"
 #include "core/temp_table.h"
 
@@ -39,7 +41,13 @@ enum class AggregaGroupingResult {
 class AggregationAlgorithm {
  public:
   AggregationAlgorithm(TempTable *tt)
-      : t(tt), m_conn(tt->m_conn), mind(tt->GetMultiIndexP()), factor(1), packrows_found(0) {}
+      : t(tt),
+        m_conn(tt->m_conn),
+        mind(tt->GetMultiIndexP()),
+        factor(1),
+        packrows_found(0),
+        tuples_spilled(0),
+        bytes_spilled(0) {}
 
   void Aggregate(bool just_distinct, int64_t &limit, int64_t &offset, ResultSender *sender);
 
@@ -50,6 +58,11 @@ class AggregationAlgorithm {
                                    [[maybe_unused]] bool limit_less_than_no_groups);
   void MultiDimensionalDistinctScan(GroupByWrapper &gbw, MIIterator &mit);
   void AggregateFillOutput(GroupByWrapper &gbw, int64_t gt_pos, int64_t &omit_by_offset);
+  void FillOutputRows(GroupByWrapper &gbw, int64_t &limit, int64_t &offset, ResultSender *sender,
+                      int64_t &displayed_no_groups);
+  void SendOutputRows(ResultSender *sender, int64_t &limit, int64_t &displayed_no_groups);
+  void AggregateSpilled(GroupByWrapper &gbw, GroupSpill &spill, int64_t &limit, int64_t &offset, ResultSender *sender,
+                        int64_t &displayed_no_groups);
 
   // Return code for AggregatePackrow: 0 - success, 1 - stop aggregation
   // (finished), 5 - pack already aggregated (skip)
@@ -76,6 +89,8 @@ class AggregationAlgorithm {
   // Some statistics for display:
   int64_t packrows_found;  // all packrows, except these completely omitted (as
                            // aggregated before)
+  int64_t tuples_spilled;  // tuples of groups not fitting in memory, see GroupSpill
+  int64_t bytes_spilled;
   std::mutex mtx;
 };
 
@@ -98,11 +113,15 @@ class AggregationWorkerEnt {
   void ReevaluateNumberOfThreads([[maybe_unused]] MIIterator &mit) {}
   int ThreadsUsed() { return m_threads; }
   void Barrier() {}
-  void TaskAggrePacks(MIIterator *taskIterator, DimensionVector *dims, MIIterator *mit, CTask *task,
-                      GroupByWrapper *gbw, Transaction *ci);
-  void DistributeAggreTaskAverage(MIIterator &mit);
+  void TaskAggrePacks(int worker, MIIterator *taskIterator, MorselQueue *queue, GroupByWrapper *gbw,
+                      Transaction *ci);
+  void TaskMergePartition(int part, int no_parts, GroupByWrapper *target, Transaction *ci);
+  void DistributeAggreTask(MIIterator &mit);
   void PrepShardingCopy(MIIterator *mit, GroupByWrapper *gb_sharding,
                         std::vector<std::unique_ptr<GroupByWrapper>> *vGBW);
+  // The groups found: after a parallel scan each hash partition is in its own
+  // wrapper (gb_main holds the first one), otherwise just gb_main.
+  std::vector<GroupByWrapper *> Results();
 
  protected:
   GroupByWrapper *gb_main;
@@ -110,6 +129,11 @@ class AggregationWorkerEnt {
   int m_threads;
   AggregationAlgorithm *aa;
   std::mutex mtx;
+
+  std::vector<std::unique_ptr<GroupByWrapper>> vGBW;   // thread-local tables of the scan
+  std::vector<std::unique_ptr<GroupByWrapper>> parts;  // merged partitions, except the first one
+  std::vector<int64_t> pack_start;                     // the first tuple of each packrow
+  std::atomic<bool> finished{false};                   // no more packrows needed by anybody
 };
 }  // namespace core
 }  // namespace Tianmu
@@ -82,6 +82,22 @@ class TIANMUAggregator {
                                   [[maybe_unused]] int64_t factor) {
     DEBUG_ASSERT(0);
   }
+  /*!
+   * \brief Add a batch of numerical values to one counter, e.g. for a query
+   * without grouping columns. Nulls are already removed by the caller.
+   * Subclasses keep the running value in a local variable instead of updating
+   * the counter row by row.
+   */
+  virtual void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+    for (int i = 0; i < no_values; i++) PutAggregatedValue(buf, v[i], factor);
+  }
+  /*!
+   * \brief Add a batch of numerical values, v[i] to the counter bufs[i].
+   * Nulls are already removed by the caller; counters may repeat.
+   */
+  virtual void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) {
+    for (int i = 0; i < no_values; i++) PutAggregatedValue(bufs[i], v[i], factor);
+  }
   /*!
    * \brief Add the counters value represented in src_buf into buf.
    * Common encoding is assumed.
@@ -247,6 +263,15 @@ class AggregatorCount64 : public TIANMUAggregator {
   void PutAggregatedValue(unsigned char *buf, [[maybe_unused]] const types::BString &v, int64_t factor) override {
     PutAggregatedValue(buf, factor);
   }
+  void PutAggregatedBatch(unsigned char *buf, [[maybe_unused]] const int64_t *v, int no_values,
+                          int64_t factor) override {
+    PutAggregatedValue(buf, no_values * factor);
+  }
+  void PutAggregatedBatch(unsigned char *const *bufs, [[maybe_unused]] const int64_t *v, int no_values,
+                          int64_t factor) override {
+    stats_updated = false;
+    for (int i = 0; i < no_values; i++) *((int64_t *)bufs[i]) += factor;
+  }
 
   void Reset(unsigned char *buf) override { *((int64_t *)buf) = 0; }
   // Optimization part
@@ -315,6 +340,15 @@ class AggregatorCount32 : public TIANMUAggregator {
   void PutAggregatedValue(unsigned char *buf, [[maybe_unused]] const types::BString &v, int64_t factor) override {
     PutAggregatedValue(buf, factor);
   }
+  void PutAggregatedBatch(unsigned char *buf, [[maybe_unused]] const int64_t *v, int no_values,
+                          int64_t factor) override {
+    PutAggregatedValue(buf, no_values * factor);
+  }
+  void PutAggregatedBatch(unsigned char *const *bufs, [[maybe_unused]] const int64_t *v, int no_values,
+                          int64_t factor) override {
+    stats_updated = false;
+    for (int i = 0; i < no_values; i++) *((int *)bufs[i]) += (int)factor;
+  }
 
   void Reset(unsigned char *buf) override { *((int *)buf) = 0; }
   ///////////// Optimization part /////////////////
@@ -36,6 +36,20 @@ void AggregatorSum64::PutAggregatedValue(unsigned char *buf, int64_t v, int64_t
   *p += v * factor;
 }
 
+void AggregatorSum64::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  // a batch of int64_t values cannot overflow a 128-bit sum, so the loop needs no checks
+  __int128 sum = 0;
+  for (int i = 0; i < no_values; i++) sum += v[i];
+  if (sum > std::numeric_limits<int64_t>::max() || sum < std::numeric_limits<int64_t>::min())
+    throw common::NotImplementedException("Aggregation overflow.");
+  PutAggregatedValue(buf, int64_t(sum), factor);
+}
+
+void AggregatorSum64::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values,
+                                         int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorSum64::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorSum64::Merge(unsigned char *buf, unsigned char *src_buf) {
   int64_t *p = (int64_t *)buf;
   int64_t *ps = (int64_t *)src_buf;
@@ -75,6 +89,20 @@ void AggregatorSumD::PutAggregatedValue(unsigned char *buf, int64_t v, int64_t f
   (*p).d += *((double *)(&v)) * factor;
 }
 
+void AggregatorSumD::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  if (no_values == 0)
+    return;
+  stats_updated = false;
+  common::double_int_t *p = (common::double_int_t *)buf;
+  double sum = ((*p).i == common::NULL_VALUE_64 ? 0 : (*p).d);
+  for (int i = 0; i < no_values; i++) sum += *((double *)(v + i)) * factor;  // same order as row by row
+  (*p).d = sum;
+}
+
+void AggregatorSumD::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorSumD::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorSumD::Merge(unsigned char *buf, unsigned char *src_buf) {
   common::double_int_t *p = (common::double_int_t *)buf;
   common::double_int_t *ps = (common::double_int_t *)src_buf;
@@ -118,6 +146,24 @@ void AggregatorAvg64::PutAggregatedValue(unsigned char *buf, int64_t v, int64_t
   *((int64_t *)(buf + sizeof(int64_t))) += factor;
 }
 
+void AggregatorAvg64::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  stats_updated = false;
+  double sum = *((double *)buf);
+  for (int i = 0; i < no_values; i++) sum += double(v[i]) * factor;
+  *((double *)buf) = sum;
+  if (!warning_issued && (sum > std::numeric_limits<std::streamsize>::max() ||
+                          sum < std::numeric_limits<std::streamsize>::min())) {
+    common::PushWarning(current_txn_->Thd(), Sql_condition::SL_NOTE, ER_UNKNOWN_ERROR, "Values rounded in average()");
+    warning_issued = true;
+  }
+  *((int64_t *)(buf + sizeof(int64_t))) += no_values * factor;
+}
+
+void AggregatorAvg64::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values,
+                                         int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorAvg64::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorAvg64::Merge(unsigned char *buf, unsigned char *src_buf) {
   if (*((int64_t *)(src_buf + sizeof(int64_t))) == 0)
     return;
@@ -150,6 +196,18 @@ void AggregatorAvgD::PutAggregatedValue(unsigned char *buf, int64_t v, int64_t f
   *((int64_t *)(buf + sizeof(int64_t))) += factor;
 }
 
+void AggregatorAvgD::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  stats_updated = false;
+  double sum = *((double *)buf);
+  for (int i = 0; i < no_values; i++) sum += *((double *)(v + i)) * factor;
+  *((double *)buf) = sum;
+  *((int64_t *)(buf + sizeof(int64_t))) += no_values * factor;
+}
+
+void AggregatorAvgD::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorAvgD::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorAvgD::PutAggregatedValue(unsigned char *buf, const types::BString &v, int64_t factor) {
   stats_updated = false;
   types::TianmuNum val(common::ColumnType::REAL);
@@ -235,6 +293,19 @@ void AggregatorMin64::PutAggregatedValue(unsigned char *buf, int64_t v, [[maybe_
   }
 }
 
+void AggregatorMin64::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  if (no_values == 0)
+    return;
+  int64_t min = v[0];
+  for (int i = 1; i < no_values; i++) min = (v[i] < min ? v[i] : min);
+  PutAggregatedValue(buf, min, factor);
+}
+
+void AggregatorMin64::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values,
+                                         int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorMin64::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorMin64::Merge(unsigned char *buf, unsigned char *src_buf) {
   if (*((int64_t *)src_buf) == common::NULL_VALUE_64)
     return;
@@ -412,6 +483,19 @@ void AggregatorMax64::PutAggregatedValue(unsigned char *buf, int64_t v, [[maybe_
   }
 }
 
+void AggregatorMax64::PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) {
+  if (no_values == 0)
+    return;
+  int64_t max = v[0];
+  for (int i = 1; i < no_values; i++) max = (v[i] > max ? v[i] : max);
+  PutAggregatedValue(buf, max, factor);
+}
+
+void AggregatorMax64::PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values,
+                                         int64_t factor) {
+  for (int i = 0; i < no_values; i++) AggregatorMax64::PutAggregatedValue(bufs[i], v[i], factor);
+}
+
 void AggregatorMax64::Merge(unsigned char *buf, unsigned char *src_buf) {
   if (*((int64_t *)src_buf) == common::NULL_VALUE_64)
     return;
@@ -59,6 +59,8 @@ class AggregatorSum64 : public TIANMUAggregator {
   TIANMUAggregator *Copy() override { return new AggregatorSum64(*this); }
   int BufferByteSize() override { return 8; }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   int64_t GetValue64(unsigned char *buf) override { return *((int64_t *)buf); }
   void Reset(unsigned char *buf) override { *((int64_t *)buf) = common::NULL_VALUE_64; }
@@ -112,6 +114,8 @@ class AggregatorSumD : public TIANMUAggregator {
   int BufferByteSize() override { return 8; }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
   void PutAggregatedValue(unsigned char *buf, const types::BString &v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   int64_t GetValue64(unsigned char *buf) override { return *((int64_t *)buf); }  // double passed as 64-bit code
   double GetValueD(unsigned char *buf) override { return *((double *)buf); }
@@ -154,6 +158,8 @@ class AggregatorAvg64 : public TIANMUAggregator {
   TIANMUAggregator *Copy() override { return new AggregatorAvg64(*this); }
   int BufferByteSize() override { return 16; }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   double GetValueD(unsigned char *buf) override;
   int64_t GetValue64(unsigned char *buf) override {  // double passed as 64-bit code
@@ -203,6 +209,8 @@ class AggregatorAvgD : public TIANMUAggregator {
   int BufferByteSize() override { return 16; }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
   void PutAggregatedValue(unsigned char *buf, const types::BString &v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   double GetValueD(unsigned char *buf) override;
   int64_t GetValue64(unsigned char *buf) override {  // double passed as 64-bit code
@@ -344,6 +352,8 @@ class AggregatorMin64 : public AggregatorMin {
       *((int64_t *)buf) = (int64_t)factor;
   }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   int64_t GetValue64(unsigned char *buf) override { return *((int64_t *)buf); }
   void SetAggregatePackMin(int64_t par1) override { pack_min = par1; }
@@ -573,6 +583,8 @@ class AggregatorMax64 : public AggregatorMax {
       *((int64_t *)buf) = (int64_t)factor;
   }
   void PutAggregatedValue(unsigned char *buf, int64_t v, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *buf, const int64_t *v, int no_values, int64_t factor) override;
+  void PutAggregatedBatch(unsigned char *const *bufs, const int64_t *v, int no_values, int64_t factor) override;
   void Merge(unsigned char *buf, unsigned char *src_buf) override;
   int64_t GetValue64(unsigned char *buf) override { return *((int64_t *)buf); }
   void SetAggregatePackMax(int64_t par1) override { pack_max = par1; }
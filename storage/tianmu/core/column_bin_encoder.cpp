@@ -317,10 +317,11 @@ bool ColumnBinEncoder::EncoderInt::SecondColumn(vcolumn::VirtualColumn *vc) {
 
 void ColumnBinEncoder::EncoderInt::Encode(uchar *buf, uchar *buf_sec, vcolumn::VirtualColumn *vc, MIIterator &mit,
                                           bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
+  int64_t v = reader.GetValueInt64(vc, mit);
+  if (null_status > 0 && v == common::NULL_VALUE_64)
     SetNull(buf, buf_sec);
   else
-    EncodeInt64(buf, buf_sec, vc->GetNotNullValueInt64(mit), false, update_stats);
+    EncodeInt64(buf, buf_sec, v, false, update_stats);
 }
 
 bool ColumnBinEncoder::EncoderInt::EncodeInt64(uchar *buf, uchar *buf_sec, int64_t v, [[maybe_unused]] bool sec_column,
@@ -353,9 +354,7 @@ bool ColumnBinEncoder::EncoderInt::EncodeInt64(uchar *buf, uchar *buf_sec, int64
 }
 
 int64_t ColumnBinEncoder::EncoderInt::ValEncode(vcolumn::VirtualColumn *vc, MIIterator &mit, bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
-    return ValEncodeInt64(common::NULL_VALUE_64, update_stats);
-  return ValEncodeInt64(vc->GetNotNullValueInt64(mit), update_stats);
+  return ValEncodeInt64(reader.GetValueInt64(vc, mit), update_stats);
 }
 
 int64_t ColumnBinEncoder::EncoderInt::ValEncodeInt64(int64_t v, bool update_stats) {
@@ -587,11 +586,11 @@ bool ColumnBinEncoder::EncoderDate::SecondColumn(vcolumn::VirtualColumn *vc) {
 
 void ColumnBinEncoder::EncoderDate::Encode(uchar *buf, uchar *buf_sec, vcolumn::VirtualColumn *vc, MIIterator &mit,
                                            bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
+  int64_t v = reader.GetValueInt64(vc, mit);
+  if (null_status > 0 && v == common::NULL_VALUE_64)
     SetNull(buf, buf_sec);
   else
-    EncoderInt::EncodeInt64(buf, buf_sec, types::DT::DateSortEncoding(vc->GetNotNullValueInt64(mit)), false,
-                            update_stats);
+    EncoderInt::EncodeInt64(buf, buf_sec, types::DT::DateSortEncoding(v), false, update_stats);
 }
 
 bool ColumnBinEncoder::EncoderDate::EncodeInt64(uchar *buf, uchar *buf_sec, int64_t v, [[maybe_unused]] bool sec_column,
@@ -604,9 +603,10 @@ bool ColumnBinEncoder::EncoderDate::EncodeInt64(uchar *buf, uchar *buf_sec, int6
 }
 
 int64_t ColumnBinEncoder::EncoderDate::ValEncode(vcolumn::VirtualColumn *vc, MIIterator &mit, bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
+  int64_t v = reader.GetValueInt64(vc, mit);
+  if (null_status > 0 && v == common::NULL_VALUE_64)
     return EncoderInt::ValEncodeInt64(common::NULL_VALUE_64, update_stats);
-  return EncoderInt::ValEncodeInt64(types::DT::DateSortEncoding(vc->GetNotNullValueInt64(mit)), update_stats);
+  return EncoderInt::ValEncodeInt64(types::DT::DateSortEncoding(v), update_stats);
 }
 
 int64_t ColumnBinEncoder::EncoderDate::ValEncodeInt64(int64_t v, bool update_stats) {
@@ -681,11 +681,11 @@ bool ColumnBinEncoder::EncoderYear::SecondColumn(vcolumn::VirtualColumn *vc) {
 
 void ColumnBinEncoder::EncoderYear::Encode(uchar *buf, uchar *buf_sec, vcolumn::VirtualColumn *vc, MIIterator &mit,
                                            bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
+  int64_t v = reader.GetValueInt64(vc, mit);
+  if (null_status > 0 && v == common::NULL_VALUE_64)
     SetNull(buf, buf_sec);
   else
-    EncoderInt::EncodeInt64(buf, buf_sec, types::DT::YearSortEncoding(vc->GetNotNullValueInt64(mit)), false,
-                            update_stats);
+    EncoderInt::EncodeInt64(buf, buf_sec, types::DT::YearSortEncoding(v), false, update_stats);
 }
 
 bool ColumnBinEncoder::EncoderYear::EncodeInt64(uchar *buf, uchar *buf_sec, int64_t v, [[maybe_unused]] bool sec_column,
@@ -698,9 +698,10 @@ bool ColumnBinEncoder::EncoderYear::EncodeInt64(uchar *buf, uchar *buf_sec, int6
 }
 
 int64_t ColumnBinEncoder::EncoderYear::ValEncode(vcolumn::VirtualColumn *vc, MIIterator &mit, bool update_stats) {
-  if (null_status > 0 && vc->IsNull(mit))
+  int64_t v = reader.GetValueInt64(vc, mit);
+  if (null_status > 0 && v == common::NULL_VALUE_64)
     return EncoderInt::ValEncodeInt64(common::NULL_VALUE_64, update_stats);
-  return EncoderInt::ValEncodeInt64(types::DT::YearSortEncoding(vc->GetNotNullValueInt64(mit)), update_stats);
+  return EncoderInt::ValEncodeInt64(types::DT::YearSortEncoding(v), update_stats);
 }
 
 int64_t ColumnBinEncoder::EncoderYear::ValEncodeInt64(int64_t v, bool update_stats) {
@@ -20,6 +20,7 @@
 
 #include "core/rsi_cmap.h"
 #include "types/text_stat.h"
+#include "vc/pack_value_reader.h"
 #include "vc/virtual_column.h"
 
 namespace Tianmu {
@@ -273,6 +274,8 @@ class ColumnBinEncoder::EncoderInt : public ColumnBinEncoder::ColumnValueEncoder
 
   int64_t min_found;  // local statistics, for rough evaluations
   int64_t max_found;
+
+  vcolumn::PackValueReader reader;  // whole-pack decoding of the source column
 };
 
 class ColumnBinEncoder::EncoderDecimal : public ColumnBinEncoder::EncoderInt {
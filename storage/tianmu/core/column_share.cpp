@@ -22,6 +22,10 @@
 #include "common/exception.h"
 #include "core/column_share.h"
 #include "core/engine.h"
+#include "core/pack_int.h"
+#include "core/pack_str.h"
+#include "system/io_engine.h"
+#include "system/memory_stream.h"
 #include "system/tianmu_file.h"
 #include "system/tianmu_system.h"
 
@@ -68,7 +72,10 @@ void ColumnShare::Init(common::TX_ID xid) {
 
   read_meta();
 
-  scan_dpn(xid);
+  read_version(xid);
+
+  if (!tianmu_sysvar_lazy_column_init)
+    scan_dpn();
 }
 
 void ColumnShare::map_dpn() {
@@ -133,7 +140,7 @@ void ColumnShare::read_meta() {
   }
 }
 
-void ColumnShare::scan_dpn(common::TX_ID xid) {
+void ColumnShare::read_version(common::TX_ID xid) {
   COL_VER_HDR hdr{};
   system::TianmuFile fv;
   fv.OpenReadOnly(m_path / common::COL_VERSION_DIR / xid.ToString());
@@ -144,20 +151,25 @@ void ColumnShare::scan_dpn(common::TX_ID xid) {
   // get column saved auto inc
   auto_inc_.store(hdr.auto_inc);
 
-  if (hdr.numOfPacks == 0) {
-    for (uint32_t i = 0; i < capacity; i++) {
-      start[i].reset();
-    }
+  committed_packs_.resize(hdr.numOfPacks);
+  fv.ReadExact(committed_packs_.data(), hdr.numOfPacks * sizeof(common::PACK_INDEX));
+}
+
+void ColumnShare::scan_dpn() {
+  std::scoped_lock guard(dpn_scan_mtx_);
+  if (dpn_scanned_.load(std::memory_order_relaxed))
     return;
-  }
 
-  auto arr = std::make_unique<common::PACK_INDEX[]>(hdr.numOfPacks);
-  fv.ReadExact(arr.get(), hdr.numOfPacks * sizeof(common::PACK_INDEX));
-  auto end = arr.get() + hdr.numOfPacks;
+  // one pass over the committed pack indexes and one over the DPNs
+  std::vector<bool> committed(capacity, false);
+  for (auto i : committed_packs_) {
+    ASSERT(i < capacity, "bad dpn index: " + std::to_string(i));
+    committed[i] = true;
+  }
 
+  segs.clear();
   for (uint32_t i = 0; i < capacity; i++) {
-    auto found = std::find(arr.get(), end, i);
-    if (found == end) {
+    if (!committed[i]) {
       start[i].reset();
     } else {
       start[i].SetPackPtr(0);
@@ -171,7 +183,6 @@ void ColumnShare::scan_dpn(common::TX_ID xid) {
       }
       if (start[i].dataAddress != DPN_INVALID_ADDR) {
         segs.push_back({start[i].dataAddress, start[i].dataLength, i});
-      } else {
       }
     }
   }
@@ -179,17 +190,22 @@ void ColumnShare::scan_dpn(common::TX_ID xid) {
   segs.sort([](const auto &a, const auto &b) { return a.offset < b.offset; });
 
   // make sure the data is good
-  auto second = segs.cbegin();
-  for (auto first = second++; second != segs.cend(); ++first, ++second) {
-    if (second->offset < first->offset + first->len) {
-      TIANMU_LOG(LogCtl_Level::ERROR, "sorted beg: -------------------");
-      for (auto &it : segs) {
-        TIANMU_LOG(LogCtl_Level::ERROR, "     %u  [%ld, %ld]", it.idx, it.offset, it.len);
+  if (!segs.empty()) {
+    auto second = segs.cbegin();
+    for (auto first = second++; second != segs.cend(); ++first, ++second) {
+      if (second->offset < first->offset + first->len) {
+        TIANMU_LOG(LogCtl_Level::ERROR, "sorted beg: -------------------");
+        for (auto &it : segs) {
+          TIANMU_LOG(LogCtl_Level::ERROR, "     %u  [%ld, %ld]", it.idx, it.offset, it.len);
+        }
+        TIANMU_LOG(LogCtl_Level::ERROR, "sorted end: -------------------");
+        throw common::DatabaseException("bad DPN index file: " + m_path.string());
       }
-      TIANMU_LOG(LogCtl_Level::ERROR, "sorted end: -------------------");
-      throw common::DatabaseException("bad DPN index file: " + m_path.string());
     }
   }
+
+  std::vector<common::PACK_INDEX>().swap(committed_packs_);
+  dpn_scanned_.store(true, std::memory_order_release);
 }
 
 void ColumnShare::init_dpn(DPN &dpn, const common::TX_ID xid, const DPN *from) {
@@ -219,6 +235,7 @@ void ColumnShare::init_dpn(DPN &dpn, const common::TX_ID xid, const DPN *from) {
 }
 
 int ColumnShare::alloc_dpn(common::TX_ID xid, const DPN *from) {
+  EnsureDPNScanned();
   for (uint32_t i = 0; i < capacity; i++) {
     if (start[i].used == 1) {
       if (!(start[i].xmax < ha_tianmu_engine_->MinXID()))
@@ -259,6 +276,75 @@ void ColumnShare::alloc_seg(DPN *dpn) {
   dpn->dataAddress = prev;
 }
 
+system::TianmuFile &ColumnShare::DataFileForRead() {
+  if (!data_file_open_.load(std::memory_order_acquire)) {
+    std::scoped_lock guard(data_file_mtx_);
+    if (!data_file_open_.load(std::memory_order_relaxed)) {
+      data_file_.OpenReadOnly(DataFile());
+      data_file_open_.store(true, std::memory_order_release);
+    }
+  }
+  return data_file_;
+}
+
+std::shared_ptr<Pack> ColumnShare::Fetch(const PackCoordinate &pc, const char *image) {
+  auto dpn = get_dpn_ptr(pc_dp(pc));
+
+  // with the sync backend the pack reads itself from a freshly opened file,
+  // otherwise its whole image is read with one pread() on the shared handle
+  std::unique_ptr<char[]> buf;
+  auto io = ha_tianmu_engine_->GetIOEngine();
+  if (image == nullptr && dpn->dataLength > 0 && io && io->GetBackend() != system::IOEngine::Backend::SYNC) {
+    buf.reset(new char[dpn->dataLength]);
+    DataFileForRead().ReadExactAt(buf.get(), dpn->dataLength, dpn->dataAddress);
+    image = buf.get();
+  }
+
+  std::unique_ptr<system::MemoryStream> src;
+  if (image)
+    src = std::make_unique<system::MemoryStream>(image, dpn->dataLength, DataFile());
+
+  if (pt == common::PackType::STR)
+    return std::make_shared<PackStr>(dpn, pc, this, src.get());
+  return std::make_shared<PackInt>(dpn, pc, this, src.get());
+}
+
+void ColumnShare::ReadPackImages(const std::vector<PackCoordinate> &pcs,
+                                 std::vector<std::unique_ptr<char[]>> &images) {
+  images.clear();
+  images.resize(pcs.size());
+  auto io = ha_tianmu_engine_->GetIOEngine();
+  if (pcs.empty() || !io || io->GetBackend() == system::IOEngine::Backend::SYNC)
+    return;
+
+  std::vector<system::ReadRequest> reqs;
+  std::vector<size_t> idx;
+  reqs.reserve(pcs.size());
+  try {
+    int fd = DataFileForRead().Handle();
+    for (size_t i = 0; i < pcs.size(); i++) {
+      auto dpn = get_dpn_ptr(pc_dp(pcs[i]));
+      if (dpn->dataLength == 0)
+        continue;
+      images[i].reset(new char[dpn->dataLength]);
+      reqs.push_back({fd, off_t(dpn->dataAddress), images[i].get(), dpn->dataLength});
+      idx.push_back(i);
+    }
+    io->ReadBatch(reqs.data(), reqs.size());
+  } catch (std::exception &e) {
+    TIANMU_LOG(LogCtl_Level::WARN, "Batch read of %s failed: %s", DataFile().c_str(), e.what());
+    images.clear();
+    images.resize(pcs.size());
+    return;
+  }
+  // every other read fails, for the tests of the fallback to Fetch() below
+  DBUG_EXECUTE_IF("tianmu_io_batch_fail", for (size_t r = 0; r < reqs.size(); r += 2) reqs[r].error = EIO;);
+
+  for (size_t r = 0; r < reqs.size(); r++)
+    if (reqs[r].error != 0 || reqs[r].done != reqs[r].len)
+      images[idx[r]].reset();
+}
+
 void ColumnShare::sync_dpns() {
   int ret = ::msync(start, common::COL_DN_FILE_SIZE, MS_SYNC);
   if (ret != 0)
@@ -18,13 +18,19 @@
 #define TIANMU_CORE_COLUMN_SHARE_H_
 #pragma once
 
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/common_definitions.h"
 #include "common/mysql_gate.h"
 #include "core/column_type.h"
 #include "core/dpn.h"
+#include "core/tools.h"
+#include "system/tianmu_file.h"
 #include "util/fs.h"
 
 namespace Tianmu {
@@ -60,6 +66,8 @@ struct alignas(128) COL_VER_HDR_V3 {
 
 using COL_VER_HDR = COL_VER_HDR_V3;
 
+class Pack;
+
 class ColumnShare final {
   friend class TianmuAttr;
 
@@ -78,10 +86,12 @@ class ColumnShare final {
 
   DPN *get_dpn_ptr(common::PACK_INDEX i) {
     ASSERT(i < common::COL_DN_FILE_SIZE / sizeof(DPN), "bad dpn index: " + std::to_string(i));
+    EnsureDPNScanned();
     return &start[i];
   }
   const DPN *get_dpn_ptr(common::PACK_INDEX i) const {
     ASSERT(i < common::COL_DN_FILE_SIZE / sizeof(DPN), "bad dpn index: " + std::to_string(i));
+    EnsureDPNScanned();
     return &start[i];
   }
 
@@ -102,16 +112,37 @@ class ColumnShare final {
 
   void Truncate() { auto_inc_.store(0); }
 
+  // Read and decompress a committed pack of this column. image is the on-disk
+  // data of the pack if it has been read already (see ReadPackImages()).
+  std::shared_ptr<Pack> Fetch(const PackCoordinate &pc, const char *image = nullptr);
+  // Read the on-disk data of packs pcs in one batch of the engine's I/O
+  // backend. The images of packs which failed to read are left empty, their
+  // Fetch() will read them again and report the error.
+  void ReadPackImages(const std::vector<PackCoordinate> &pcs, std::vector<std::unique_ptr<char[]>> &images);
+
  private:
   void Init(common::TX_ID xid);
   void map_dpn();
   void read_meta();
-  void scan_dpn(common::TX_ID xid);
+  void read_version(common::TX_ID xid);
+  void scan_dpn();
+  // The DPNs are scanned on open, or on first use if tianmu_lazy_column_init
+  // is set, so columns never used by queries are not scanned at all.
+  void EnsureDPNScanned() const {
+    if (!dpn_scanned_.load(std::memory_order_acquire))
+      const_cast<ColumnShare *>(this)->scan_dpn();
+  }
+  system::TianmuFile &DataFileForRead();
 
   TableShare *owner;
   const fs::path m_path;
   ColumnType ct;
   int dn_fd{-1};
+  // read-only handle of the DATA file shared by all pack reads, opened on
+  // first use
+  system::TianmuFile data_file_;
+  std::atomic<bool> data_file_open_{false};
+  std::mutex data_file_mtx_;
   DPN *start;
   size_t capacity{0};  // current capacity of the dn array
   common::PackType pt;
@@ -125,6 +156,10 @@ class ColumnShare final {
   };
   std::list<seg> segs;  // only used by write session so no mutex is needed
 
+  std::vector<common::PACK_INDEX> committed_packs_;  // from the version file, until scan_dpn()
+  std::atomic<bool> dpn_scanned_{false};
+  std::mutex dpn_scan_mtx_;
+
   bool has_filter_cmap = false;
   bool has_filter_hist = false;
   bool has_filter_bloom = false;
@@ -22,8 +22,11 @@
 namespace Tianmu {
 namespace core {
 void DataCache::ReleaseAll() {
-  _packs.clear();
-  _ftrees.clear();
+  for (auto &s : shards_) {
+    std::scoped_lock lock(s.mutex);
+    s.packs.clear();
+    s.ftrees.clear();
+  }
 }
 
 // release all data for table id
@@ -34,21 +37,25 @@ void DataCache::ReleaseTable(int id) {
 
 void DataCache::ReleasePacks(int table) {
   std::vector<TraceableObjectPtr> packs_removed;
+  ++m_packGeneration;
   {
     std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
-    std::scoped_lock lock(m_cache_mutex);
-    auto it = _packs.begin();
-    while (it != _packs.end()) {
-      if (pc_table(it->first) == table) {
-        auto tmp = it++;
-        std::shared_ptr<Pack> pack = std::static_pointer_cast<Pack>(tmp->second);
-        pack->Lock();
-        pack->SetOwner(0);
-        _packs.erase(tmp);
-        packs_removed.push_back(pack);
-        m_objectsReleased++;
-      } else
-        it++;
+    for (auto &s : shards_) {
+      std::scoped_lock lock(s.mutex);
+      auto it = s.packs.begin();
+      while (it != s.packs.end()) {
+        if (pc_table(it->first) == table) {
+          auto tmp = it++;
+          std::shared_ptr<Pack> pack = std::static_pointer_cast<Pack>(tmp->second);
+          ConsumePrefetched(pack.get(), false);
+          pack->Lock();
+          pack->SetOwner(0);
+          s.packs.erase(tmp);
+          packs_removed.push_back(pack);
+          s.objects_released++;
+        } else
+          it++;
+      }
     }
   }
 }
@@ -57,61 +64,23 @@ void DataCache::ReleaseFTrees(int table) {
   std::vector<TraceableObjectPtr> to_remove;
   {
     std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
-    std::scoped_lock lock(m_cache_mutex);
-    auto it = _ftrees.begin();
-    while (it != _ftrees.end()) {
-      if (it->first[0] == table) {
-        auto tmp = it++;
-        auto sp = tmp->second;
-        sp->Lock();
-        sp->SetOwner(0);
-        _ftrees.erase(tmp);
-        to_remove.push_back(sp);
-        m_objectsReleased++;
-      } else
-        it++;
+    for (auto &s : shards_) {
+      std::scoped_lock lock(s.mutex);
+      auto it = s.ftrees.begin();
+      while (it != s.ftrees.end()) {
+        if (it->first[0] == table) {
+          auto tmp = it++;
+          auto sp = tmp->second;
+          sp->Lock();
+          sp->SetOwner(0);
+          s.ftrees.erase(tmp);
+          to_remove.push_back(sp);
+          s.objects_released++;
+        } else
+          it++;
+      }
     }
   }
 }
-
-template <>
-DataCache::PackContainer &DataCache::cache() {
-  return (_packs);
-}
-
-template <>
-DataCache::PackContainer const &DataCache::cache() const {
-  return (_packs);
-}
-
-template <>
-DataCache::FTreeContainer &DataCache::cache() {
-  return (_ftrees);
-}
-
-template <>
-DataCache::FTreeContainer const &DataCache::cache() const {
-  return (_ftrees);
-}
-
-template <>
-DataCache::IOPackReqSet &DataCache::waitIO() {
-  return (_packPendingIO);
-}
-
-template <>
-DataCache::IOFTreeReqSet &DataCache::waitIO() {
-  return (_ftreePendingIO);
-}
-
-template <>
-std::condition_variable_any &DataCache::condition<PackCoordinate>() {
-  return (_packWaitIO);
-}
-
-template <>
-std::condition_variable_any &DataCache::condition<FTreeCoordinate>() {
-  return (_ftreeWaitIO);
-}
 }  // namespace core
 }  // namespace Tianmu
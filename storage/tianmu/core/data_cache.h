@@ -18,6 +18,8 @@
 #define TIANMU_CORE_DATA_CACHE_H_
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_map>
@@ -25,11 +27,18 @@
 #include <utility>
 
 #include "core/pack.h"
+#include "util/parking_lot.h"
 
 namespace Tianmu {
 namespace core {
 using TraceableObjectPtr = std::shared_ptr<mm::TraceableObject>;
 
+// The cache is partitioned into shards by the hash of the object coordinate.
+// Every shard has its own mutex, pending-IO sets and wait conditions, so
+// lookups of different packs do not serialize on one lock. The global
+// memory manager mutex is only taken to pin a pack that was found in the
+// cache (Lock() + TrackAccess()); the lock order is always
+// TraceableObject::GetLockingMutex() -> Shard::mutex.
 class DataCache final {
  private:
   using PackContainer = std::unordered_map<PackCoordinate, TraceableObjectPtr, PackCoordinate>;
@@ -38,40 +47,171 @@ class DataCache final {
   using FTreeContainer = std::unordered_map<FTreeCoordinate, TraceableObjectPtr, FTreeCoordinate>;
   using IOFTreeReqSet = std::unordered_set<FTreeCoordinate, FTreeCoordinate>;
 
-  PackContainer _packs;
-  FTreeContainer _ftrees;
+  static constexpr size_t kShardBits = 6;
+  static constexpr size_t kShards = 1 << kShardBits;
+
+  struct alignas(64) Shard {
+    PackContainer packs;
+    FTreeContainer ftrees;
+
+    IOPackReqSet pack_pending_io;
+    IOFTreeReqSet ftree_pending_io;
+
+    std::condition_variable pack_wait_io;
+    std::condition_variable ftree_wait_io;
+
+    std::mutex mutex;
+
+    // status counters, protected by mutex
+    int64_t cache_hits = 0;
+    int64_t cache_misses = 0;
+    int64_t objects_released = 0;
+    int64_t read_wait = 0;
+    int64_t false_wakeup = 0;
+    int64_t read_wait_in_progress = 0;
+    int64_t pack_loads = 0;
+    int64_t pack_load_in_progress = 0;
+    int64_t load_errors = 0;
+
+    template <typename T>
+    auto &cache() {
+      if constexpr (T::ID == COORD_TYPE::PACK)
+        return packs;
+      else
+        return ftrees;
+    }
 
-  int64_t m_cacheHits = 0;
-  int64_t m_cacheMisses = 0;
-  int64_t m_objectsReleased = 0;
+    template <typename T>
+    auto &waitIO() {
+      if constexpr (T::ID == COORD_TYPE::PACK)
+        return pack_pending_io;
+      else
+        return ftree_pending_io;
+    }
 
-  IOPackReqSet _packPendingIO;
-  IOFTreeReqSet _ftreePendingIO;
+    template <typename T>
+    std::condition_variable &condition() {
+      if constexpr (T::ID == COORD_TYPE::PACK)
+        return pack_wait_io;
+      else
+        return ftree_wait_io;
+    }
+  };
 
-  std::condition_variable_any _packWaitIO;
-  std::condition_variable_any _ftreeWaitIO;
+  std::array<Shard, kShards> shards_;
 
-  int64_t m_readWait = 0;
-  int64_t m_falseWakeup = 0;
-  int64_t m_readWaitInProgress = 0;
-  int64_t m_packLoads = 0;
-  int64_t m_packLoadInProgress = 0;
-  int64_t m_loadErrors = 0;
   int64_t m_reDecompress = 0;
+  std::atomic<int64_t> m_packLockWaits{0};
+
+  // read-ahead statistics; m_prefetchBytes is the size of the packs which
+  // were read ahead and not used (nor released) yet
+  std::atomic<int64_t> m_prefetchIssued{0};
+  std::atomic<int64_t> m_prefetchHits{0};
+  std::atomic<int64_t> m_prefetchWasted{0};
+  std::atomic<int64_t> m_prefetchBytes{0};
+  // bumped by ReleasePacks() before any pack is purged; a read-ahead started
+  // under an older generation may have read packs of a dropped table, so its
+  // result is thrown away
+  std::atomic<uint64_t> m_packGeneration{0};
+
+  // pack hits and misses by the segment of the release policy the pack was
+  // found in (for a miss: admitted to), see mm::CacheSegment
+  std::atomic<int64_t> m_probationHits{0};
+  std::atomic<int64_t> m_protectedHits{0};
+  std::atomic<int64_t> m_probationMisses{0};
+  std::atomic<int64_t> m_protectedMisses{0};
+
+  // threads waiting for another thread to finish loading a pack park here,
+  // keyed by the DPN address
+  utils::ParkingLot dpn_parking_;
+
+  template <typename T>
+  Shard &shard(T const &coord_) {
+    // spread neighbouring coordinates (e.g. consecutive packs of a column)
+    // over different shards
+    uint64_t h = static_cast<uint64_t>(coord_.hash()) * 0x9E3779B97F4A7C15ULL;
+    return shards_[h >> (64 - kShardBits)];
+  }
 
-  std::recursive_mutex m_cache_mutex;
+  int64_t Sum(int64_t Shard::*counter) const {
+    int64_t sum = 0;
+    for (auto &s : shards_) sum += s.*counter;
+    return sum;
+  }
+
+  // Account for the first use (or the removal) of a pack which was read
+  // ahead. Must be called with TraceableObject::GetLockingMutex() held and
+  // before the object is locked, as Lock() clears the flag.
+  void ConsumePrefetched(mm::TraceableObject *o, bool used) {
+    if (!o->IsPrefetchUnused())
+      return;
+    o->clearPrefetchUnused();
+    m_prefetchBytes -= o->SizeAllocated();
+    if (used)
+      ++m_prefetchHits;
+    else
+      ++m_prefetchWasted;
+  }
+
+  void CountSegmentAccess(mm::CacheSegment segment, bool hit) {
+    if (segment == mm::CacheSegment::PROBATION)
+      ++(hit ? m_probationHits : m_probationMisses);
+    else if (segment == mm::CacheSegment::PROTECTED)
+      ++(hit ? m_protectedHits : m_protectedMisses);
+  }
+
+  // Pin a pack found in the cache. Returns false if the memory manager has
+  // dropped the object in the meantime; the caller must look it up again.
+  bool PinObject(TraceableObjectPtr const &sp, bool count_hit = false) {
+    std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
+    if (sp->GetOwner() != this)
+      return false;
+    mm::PackAccess access =
+        sp->IsPrefetchUnused() ? mm::PackAccess::FIRST_USE_OF_PREFETCHED : mm::PackAccess::USE;
+    ConsumePrefetched(sp.get(), true);
+    sp->Lock();
+    mm::CacheSegment segment = sp->TrackAccess(access);
+    if (count_hit)
+      CountSegmentAccess(segment, true);
+    return true;
+  }
+
+  template <typename T>
+  void EraseObject(Shard &s, T const &coord_, TraceableObjectPtr &removed, bool lock) {
+    auto &c(s.cache<T>());
+    auto it = c.find(coord_);
+    if (it != c.end()) {
+      removed = it->second;
+      ConsumePrefetched(removed.get(), false);
+      if (lock)
+        removed->Lock();
+      removed->SetOwner(nullptr);
+      c.erase(it);
+      ++s.objects_released;
+    }
+  }
 
  public:
-  int64_t getReadWait() { return m_readWait; }
-  int64_t getReadWaitInProgress() { return m_readWaitInProgress; }
-  int64_t getFalseWakeup() { return m_falseWakeup; }
-  int64_t getPackLoads() { return m_packLoads; }
-  int64_t getPackLoadInProgress() { return m_packLoadInProgress; }
-  int64_t getLoadErrors() { return m_loadErrors; }
-  int64_t getReDecompress() { return m_reDecompress; }
-  int64_t getCacheHits() { return m_cacheHits; }
-  int64_t getCacheMisses() { return m_cacheMisses; }
-  int64_t getReleased() { return m_objectsReleased; }
+  int64_t getReadWait() const { return Sum(&Shard::read_wait); }
+  int64_t getReadWaitInProgress() const { return Sum(&Shard::read_wait_in_progress); }
+  int64_t getFalseWakeup() const { return Sum(&Shard::false_wakeup); }
+  int64_t getPackLoads() const { return Sum(&Shard::pack_loads); }
+  int64_t getPackLoadInProgress() const { return Sum(&Shard::pack_load_in_progress); }
+  int64_t getLoadErrors() const { return Sum(&Shard::load_errors); }
+  int64_t getReDecompress() const { return m_reDecompress; }
+  int64_t getCacheHits() const { return Sum(&Shard::cache_hits); }
+  int64_t getCacheMisses() const { return Sum(&Shard::cache_misses); }
+  int64_t getReleased() const { return Sum(&Shard::objects_released); }
+  int64_t getPackLockWaits() const { return m_packLockWaits; }
+  int64_t getPrefetchIssued() const { return m_prefetchIssued; }
+  int64_t getPrefetchHits() const { return m_prefetchHits; }
+  int64_t getPrefetchWasted() const { return m_prefetchWasted; }
+  int64_t getPrefetchBytes() const { return m_prefetchBytes; }
+  uint64_t getPackGeneration() const { return m_packGeneration; }
+  int64_t getProbationHits() const { return m_probationHits; }
+  int64_t getProtectedHits() const { return m_protectedHits; }
+  int64_t getProbationMisses() const { return m_probationMisses; }
+  int64_t getProtectedMisses() const { return m_protectedMisses; }
   DataCache() = default;
   ~DataCache() = default;
 
@@ -79,30 +219,33 @@ class DataCache final {
 
   template <typename T>
   void PutObject(T const &coord_, TraceableObjectPtr p) {
-    TraceableObjectPtr old;
+    TraceableObjectPtr old;  // old object must be physically deleted after mutex unlock
     {
+      Shard &s(shard(coord_));
       std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
-      std::scoped_lock lock(m_cache_mutex);
+      std::scoped_lock lock(s.mutex);
 
       p->SetOwner(this);
-      auto &c(cache<T>());
+      auto &c(s.cache<T>());
       auto result = c.insert(std::make_pair(coord_, p));
       if (!result.second && result.first->second != p) {
-        old = result.first->second;  // old object must be physically deleted
-                                     // after mutex unlock
-        DropObject(coord_);
+        EraseObject(s, coord_, old, T::ID == COORD_TYPE::PACK);
         result = c.insert(std::make_pair(coord_, p));
       }
       if constexpr (T::ID == COORD_TYPE::PACK) {
         p->TrackAccess();
-        // int objnum = c.size();
-        // TIANMU_LOG(LogCtl_Level::DEBUG, "PutObject packs objnum %d
-        // (table:%d,pack:%d,clounm:%d)", objnum,pc_table(coord_),
-        // pc_dp(coord_), pc_column(coord_));
       }
     }
   }
 
+  // Block until the thread which set loading_flag in dpn has published the
+  // pack (or given up on loading it).
+  void WaitForPackLoad(const DPN *dpn) {
+    if (dpn_parking_.Wait(dpn, [dpn] { return dpn->GetPackPtr() != loading_flag; }))
+      ++m_packLockWaits;
+  }
+  void NotifyPackLoaded(const DPN *dpn) { dpn_parking_.NotifyAll(dpn); }
+
   void ReleaseTable(int id);
   void ReleasePacks(int table);
   void ReleaseFTrees(int table);
@@ -111,166 +254,222 @@ class DataCache final {
   void DropObject(T const &coord_) {
     TraceableObjectPtr removed;
     {
+      Shard &s(shard(coord_));
       std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
-      std::scoped_lock lock(m_cache_mutex);
-      auto &c(cache<T>());
-      auto it = c.find(coord_);
-      if (it != c.end()) {
-        // if (T::ID == COORD_TYPE::PACK) {
-        // int objnum = c.size();
-        // TIANMU_LOG(LogCtl_Level::DEBUG, "DropObject packs objnum %d
-        // (table:%d,pack:%d,clounm:%d)", objnum,pc_table(coord_),
-        // pc_dp(coord_), pc_column(coord_));
-        //}
-        removed = it->second;
-        if constexpr (T::ID == COORD_TYPE::PACK) {
-          removed->Lock();
-        }
-        removed->SetOwner(nullptr);
-        c.erase(it);
-        ++m_objectsReleased;
-      }
+      std::scoped_lock lock(s.mutex);
+      EraseObject(s, coord_, removed, T::ID == COORD_TYPE::PACK);
     }
   }
 
+  // called by the memory manager with TraceableObject::GetLockingMutex() held
   template <typename T>
   void DropObjectByMM(T const &coord_) {
     TraceableObjectPtr removed;
     {
-      std::scoped_lock lock(m_cache_mutex);
-      auto &c(cache<T>());
-
-      auto it = c.find(coord_);
-      if (it != c.end()) {
-        removed = it->second;
-        removed->SetOwner(nullptr);
-        c.erase(it);
-        ++m_objectsReleased;
-      }
+      Shard &s(shard(coord_));
+      std::scoped_lock lock(s.mutex);
+      EraseObject(s, coord_, removed, false);
     }
   }
 
   template <typename T, typename U>
   std::shared_ptr<T> GetLockedObject(U const &coord_) {
-    std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
-    std::scoped_lock lock(m_cache_mutex);
-
-    auto &c(cache<U>());
-    auto it = c.find(coord_);
-    if (it == c.end())
-      //++ m_cacheMisses;
-      return nullptr;
-
-    //++ m_cacheHits;
-    auto sp = std::static_pointer_cast<T>(it->second);
-    sp->Lock();
-    if constexpr (U::ID == COORD_TYPE::PACK)
-      sp->TrackAccess();
-    return sp;
+    Shard &s(shard(coord_));
+    auto &c(s.cache<U>());
+    for (;;) {
+      TraceableObjectPtr sp;
+      {
+        std::scoped_lock lock(s.mutex);
+        auto it = c.find(coord_);
+        if (it == c.end())
+          return nullptr;
+        sp = it->second;
+      }
+      if constexpr (U::ID == COORD_TYPE::PACK) {
+        if (!PinObject(sp))
+          continue;
+      } else {
+        sp->Lock();
+      }
+      return std::static_pointer_cast<T>(sp);
+    }
   }
 
   template <typename T, typename U, typename V>
   std::shared_ptr<T> GetOrFetchObject(U const &coord_, V *fetcher_) {
-    auto &c(cache<U>());
-    auto &w(waitIO<U>());
-    auto &cond(condition<U>());
-    bool waited = false;
-    /* a scope for mutex lock */
-    {
-      /* Lock is acquired inside */
-      std::unique_lock<std::recursive_mutex> m_obj_guard(mm::TraceableObject::GetLockingMutex());
-
-      std::scoped_lock lock(m_cache_mutex);
+    Shard &s(shard(coord_));
+    auto &c(s.cache<U>());
+    auto &w(s.waitIO<U>());
+    auto &cond(s.condition<U>());
+
+    for (;;) {
+      TraceableObjectPtr sp;
+      /* a scope for mutex lock */
+      {
+        std::unique_lock<std::mutex> lock(s.mutex);
 
-      auto it = c.find(coord_);
+        auto it = c.find(coord_);
+        if (it != c.end()) {
+          if constexpr (U::ID == COORD_TYPE::PACK)
+            ++s.cache_hits;
+        } else {
+          if constexpr (U::ID == COORD_TYPE::PACK)
+            ++s.cache_misses;
+          bool waited = false;
+          while (w.find(coord_) != w.end()) {
+            s.read_wait_in_progress++;
+            if (waited)
+              s.false_wakeup++;
+            else
+              s.read_wait++;
+
+            cond.wait(lock);
+
+            waited = true;
+            s.read_wait_in_progress--;
+          }
+          // if the object is still missing it has been loaded, used, unlocked
+          // and pushed out of memory before we got to it after waiting
+          it = c.find(coord_);
+        }
 
-      if (it != c.end()) {
-        if constexpr (U::ID == COORD_TYPE::PACK) {
-          it->second->Lock();
-          ++m_cacheHits;
-          it->second->TrackAccess();
+        if (it == c.end()) {
+          w.insert(coord_);
+          s.pack_load_in_progress++;
+          break;
         }
-        return std::static_pointer_cast<T>(it->second);
+        sp = it->second;
       }
 
-      {
-        if constexpr (U::ID == COORD_TYPE::PACK)
-          m_cacheMisses++;
-        auto rit = w.find(coord_);
-        while (rit != w.end()) {
-          m_readWaitInProgress++;
-          if (waited)
-            m_falseWakeup++;
-          else
-            m_readWait++;
-
-          m_cache_mutex.unlock();
-          cond.wait(m_obj_guard);
-          m_cache_mutex.lock();
-
-          waited = true;
-          m_readWaitInProgress--;
-          rit = w.find(coord_);
-        }
-        it = c.find(coord_);
-        if (it != c.end()) {
-          if constexpr (U::ID == COORD_TYPE::PACK) {
-            it->second->Lock();
-            it->second->TrackAccess();
-          }
-          return std::static_pointer_cast<T>(it->second);
-        }
-        // mm::TraceableObject::GetLockingMutex().Unlock();
-        // if we get here the obj has been loaded, used, unlocked
-        // and pushed out of memory before we should get to it after
-        // waiting
+      if constexpr (U::ID == COORD_TYPE::PACK) {
+        if (!PinObject(sp, true))
+          continue;  // dropped by the memory manager meanwhile, look it up again
       }
-      w.insert(coord_);
-      m_packLoadInProgress++;
+      return std::static_pointer_cast<T>(sp);
     }
 
     std::shared_ptr<T> obj;
     try {
       obj = fetcher_->Fetch(coord_);
     } catch (...) {
-      std::scoped_lock m_obj_guard(mm::TraceableObject::GetLockingMutex());
-      std::scoped_lock lock(m_cache_mutex);
-      m_loadErrors++;
-      m_packLoadInProgress--;
-      w.erase(coord_);
+      {
+        std::scoped_lock lock(s.mutex);
+        s.load_errors++;
+        s.pack_load_in_progress--;
+        w.erase(coord_);
+      }
       cond.notify_all();
       throw;
     }
 
+    obj->SetOwner(this);
     {
-      obj->SetOwner(this);
-      std::scoped_lock m_obj_guard(mm::TraceableObject::GetLockingMutex());
-      std::scoped_lock lock(m_cache_mutex);
-      if constexpr (U::ID == COORD_TYPE::PACK) {
-        m_packLoads++;
-        obj->TrackAccess();
-      }
-      m_packLoadInProgress--;
+      std::scoped_lock lock(s.mutex);
+      if constexpr (U::ID == COORD_TYPE::PACK)
+        s.pack_loads++;
+      s.pack_load_in_progress--;
       DEBUG_ASSERT(c.find(coord_) == c.end());
       c.insert(std::make_pair(coord_, obj));
       w.erase(coord_);
     }
     cond.notify_all();
 
+    // the fetched object is still locked by the fetcher, so it cannot be
+    // released before it is tracked
+    if constexpr (U::ID == COORD_TYPE::PACK)
+      CountSegmentAccess(obj->TrackAccess(), false);
+
     return obj;
   }
 
-  template <typename T>
-  std::unordered_map<T, TraceableObjectPtr, T> &cache();
+  // Read a pack into the cache ahead of its use. The pack is left unlocked,
+  // so the memory manager may push it out again before anybody asks for it.
+  // Returns false if the pack is already cached or being loaded.
+  template <typename T, typename U, typename V>
+  bool PrefetchObject(U const &coord_, V *fetcher_) {
+    uint64_t generation = m_packGeneration;
+    if (!BeginPrefetch(coord_))
+      return false;
+    FinishPrefetch<T>(coord_, fetcher_, generation);
+    return true;
+  }
 
-  template <typename T>
-  std::unordered_set<T, T> &waitIO();
+  // The two halves of PrefetchObject(), for callers reading several packs in
+  // one batch. BeginPrefetch() registers the pack as being loaded (threads
+  // asking for it will wait) and returns false if it is cached or being
+  // loaded already. Every successful BeginPrefetch() must be followed by
+  // FinishPrefetch(), which also cleans up if the fetcher throws. The
+  // generation passed to FinishPrefetch() is getPackGeneration() taken before
+  // the packs were claimed, the query the id of the statement they are read for.
+  template <typename U>
+  bool BeginPrefetch(U const &coord_) {
+    static_assert(U::ID == COORD_TYPE::PACK, "only packs are read ahead");
+    Shard &s(shard(coord_));
+    auto &c(s.cache<U>());
+    auto &w(s.waitIO<U>());
+    {
+      std::scoped_lock lock(s.mutex);
+      if (c.find(coord_) != c.end() || w.find(coord_) != w.end())
+        return false;
+      w.insert(coord_);
+      s.pack_load_in_progress++;
+    }
+    ++m_prefetchIssued;
+    return true;
+  }
 
-  template <typename T>
-  std::condition_variable_any &condition();
+  template <typename T, typename U, typename V>
+  void FinishPrefetch(U const &coord_, V *fetcher_, uint64_t generation, uint64_t query = 0) {
+    Shard &s(shard(coord_));
+    auto &c(s.cache<U>());
+    auto &w(s.waitIO<U>());
+    auto &cond(s.condition<U>());
 
-  template <typename T>
-  std::unordered_map<T, TraceableObjectPtr, T> const &cache() const;
+    std::shared_ptr<T> obj;
+    try {
+      obj = fetcher_->Fetch(coord_);
+    } catch (...) {
+      {
+        std::scoped_lock lock(s.mutex);
+        s.load_errors++;
+        s.pack_load_in_progress--;
+        w.erase(coord_);
+      }
+      cond.notify_all();
+      throw;
+    }
+
+    bool stale;
+    {
+      // same lock order as ReleasePacks(), so the table cannot be purged
+      // between the generation check and the insert
+      std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
+      std::scoped_lock lock(s.mutex);
+      s.pack_load_in_progress--;
+      w.erase(coord_);
+      stale = (m_packGeneration != generation);
+      if (!stale) {
+        // mark it before it becomes visible, a waiter may pin it right away
+        obj->SetOwner(this);
+        obj->setPrefetchUnused();
+        m_prefetchBytes += obj->SizeAllocated();
+        s.pack_loads++;
+        DEBUG_ASSERT(c.find(coord_) == c.end());
+        c.insert(std::make_pair(coord_, obj));
+      }
+    }
+    cond.notify_all();
+    if (stale) {
+      ++m_prefetchWasted;
+      return;  // still locked and not owned by the cache, deleted with obj
+    }
+
+    {
+      std::scoped_lock m_locking_guard(mm::TraceableObject::GetLockingMutex());
+      obj->TrackAccess(mm::PackAccess::PREFETCH, query);
+      obj->Unlock();  // drop the lock taken by the constructor
+    }
+  }
 };
 }  // namespace core
 }  // namespace Tianmu
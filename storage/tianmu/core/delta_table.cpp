@@ -15,6 +15,8 @@
    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
 */
 
+#include <chrono>
+
 #include "core/delta_table.h"
 #include "core/table_share.h"
 #include "core/transaction.h"
@@ -105,6 +107,33 @@ common::ErrorCode DeltaTable::DropDeltaTable(const std::string &table_name) {
   return ha_kvstore_->KVDelDeltaMeta(normalized_name);
 }
 
+namespace {
+int64_t SteadySeconds() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+uint64_t DeltaTable::LagSeconds() {
+  uint64_t merged = merge_id.load();
+  std::scoped_lock guard(write_times_mtx_);
+  while (write_times_.size() > 1 && write_times_[1].first <= merged) write_times_.pop_front();
+  if (CountRecords() == 0 || write_times_.empty())
+    return 0;
+  int64_t lag = SteadySeconds() - write_times_.front().second;
+  return lag > 0 ? lag : 0;
+}
+
+// called before load_id is advanced for a new record
+void DeltaTable::SampleWriteTime() {
+  int64_t now = SteadySeconds();
+  if (last_write_second_.load(std::memory_order_relaxed) == now)
+    return;
+  std::scoped_lock guard(write_times_mtx_);
+  if (write_times_.empty() || write_times_.back().second != now)
+    write_times_.emplace_back(load_id.load(), now);
+  last_write_second_.store(now, std::memory_order_relaxed);
+}
+
 void DeltaTable::Init(uint64_t base_row_num) {
   index::KVTransaction kv_trans;
   uchar entry_key[sizeof(uint32_t)];
@@ -126,6 +155,8 @@ void DeltaTable::Init(uint64_t base_row_num) {
     load_id.fetch_add(load_num);
     iter->Next();
   }
+  // the age of records found at startup is not known, count it from now
+  SampleWriteTime();
 }
 
 void DeltaTable::AddInsertRecord(Transaction *tx, uint64_t row_id, std::unique_ptr<char[]> buf, uint32_t size) {
@@ -144,6 +175,7 @@ void DeltaTable::AddInsertRecord(Transaction *tx, uint64_t row_id, std::unique_p
     throw common::Exception("Error,kv_trans.PutData failed,date size: " + std::to_string(size) +
                             " date:" + std::string(buf.get()));
   }
+  SampleWriteTime();
   tx->AddInsertRowNum();
   if (tx->GetInsertRowNum() >= tianmu_sysvar_insert_write_batch_size) {
     kv_trans.Commit();
@@ -172,6 +204,7 @@ void DeltaTable::AddRecord(Transaction *tx, uint64_t row_id, std::unique_ptr<cha
     throw common::Exception("Error,kv_trans.PutData failed,date size: " + std::to_string(size) +
                             " date:" + std::string(buf.get()));
   }
+  SampleWriteTime();
   load_id++;
   stat.write_cnt++;
   stat.write_bytes += size;
@@ -195,6 +228,11 @@ void DeltaTable::Truncate(Transaction *tx) {
   row_id.store(0);
   load_id.store(0);
   merge_id.store(0);
+  {
+    std::scoped_lock guard(write_times_mtx_);
+    write_times_.clear();
+    last_write_second_.store(-1);
+  }
   stat.write_cnt.store(0);
   stat.write_bytes.store(0);
   stat.read_cnt.store(0);
@@ -238,6 +276,7 @@ DeltaIterator::DeltaIterator(DeltaTable *table, const std::vector<bool> &attrs)
   read_options.total_order_seek = true;
   read_options.snapshot = snapshot;
   it_ = std::unique_ptr<rocksdb::Iterator>(ha_kvstore_->GetRdb()->NewIterator(read_options, table_->GetCFHandle()));
+  table_->stat.scan_cnt++;
   uchar entry_key[sizeof(uint32_t)];
   uint32_t table_id = table_->GetDeltaTableID();
   index::be_store_index(entry_key, table_id);
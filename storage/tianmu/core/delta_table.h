@@ -18,6 +18,8 @@
 #define TIANMU_CORE_DELTA_TABLE_H_
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include <string>
 
 #include "common/exception.h"
@@ -46,7 +48,9 @@ class DeltaTable {
   void Init(uint64_t base_row_num);
   std::string FullName() { return fullname_; }
   [[nodiscard]] uint32_t GetDeltaTableID() const { return delta_tid_; }
-  uint64_t CountRecords() { return load_id.load() - merge_id.load(); }
+  uint64_t CountRecords() const { return load_id.load() - merge_id.load(); }
+  // merge lag: CountRecords() rows, the oldest of them written LagSeconds() ago
+  uint64_t LagSeconds();
   rocksdb::ColumnFamilyHandle *GetCFHandle() { return cf_handle_; }
   common::ErrorCode Rename(const std::string &to);
   bool ExistDeleteRow(Transaction *tx, int64_t obj);
@@ -63,6 +67,7 @@ class DeltaTable {
     std::atomic_ulong write_bytes{0};
     std::atomic_ulong read_cnt{0};
     std::atomic_ulong read_bytes{0};
+    std::atomic_ulong scan_cnt{0};  // query scans over the delta, raise the merge priority
   } stat;
   std::atomic<uint64_t> load_id{0};
   std::atomic<uint64_t> merge_id{0};
@@ -72,6 +77,14 @@ class DeltaTable {
   std::string fullname_;
   uint32_t delta_tid_ = 0;
   rocksdb::ColumnFamilyHandle *cf_handle_ = nullptr;
+  // Write times of the delta records, for LagSeconds(): (load_id, steady
+  // clock seconds) of the first record written in every second. Records are
+  // merged in the order they were written, so the first sample not yet
+  // passed by merge_id dates the oldest unmerged record.
+  void SampleWriteTime();
+  std::mutex write_times_mtx_;
+  std::deque<std::pair<uint64_t, int64_t>> write_times_;
+  std::atomic<int64_t> last_write_second_{-1};
 };
 
 class DeltaIterator {
@@ -1919,7 +1919,7 @@ bool Descriptor::IsleftIndexSearch() const {
 
       if (indextab) {
         std::vector<uint> keycols = indextab->KeyCols();
-        if (keycols.size() > 0 && colid == keycols[0])
+        if ((keycols.size() > 0 && colid == keycols[0]) || indextab->SecondaryKeyOn(colid))
           return true;
       }
     }
@@ -20,6 +20,7 @@
 #include <sys/sysinfo.h>
 #include <boost/algorithm/string.hpp>
 #include <set>
+#include <shared_mutex>
 #include <tuple>
 
 #include "common/common_definitions.h"
@@ -41,6 +42,7 @@
 #include "thr_lock.h"
 #include "util/bitset.h"
 #include "util/fs.h"
+#include "util/simd_filter.h"
 #include "util/thread_pool.h"
 
 namespace Tianmu {
@@ -196,6 +198,8 @@ Engine::Engine()
       delete_or_update_thread_pool("delete_or_update", tianmu_sysvar_delete_or_update_threads
                                                            ? tianmu_sysvar_delete_or_update_threads
                                                            : std::thread::hardware_concurrency()),
+      prefetch_thread_pool("prefetch", tianmu_sysvar_prefetch_threads ? tianmu_sysvar_prefetch_threads
+                                                                      : std::thread::hardware_concurrency()),
       insert_buffer(BUFFER_FILE, tianmu_sysvar_insert_buffer_size) {
   tianmu_data_dir = mysql_real_data_home;
 }
@@ -262,6 +266,13 @@ int Engine::Init(uint engine_slot) {
   TIANMU_LOG(LogCtl_Level::INFO, "Tianmu thread pool for background load, size = %ld", bg_load_thread_pool.size());
   TIANMU_LOG(LogCtl_Level::INFO, "Tianmu thread pool for load, size = %ld", load_thread_pool.size());
   TIANMU_LOG(LogCtl_Level::INFO, "Tianmu thread pool for query, size = %ld", query_thread_pool.size());
+  TIANMU_LOG(LogCtl_Level::INFO, "Tianmu thread pool for prefetch, size = %ld", prefetch_thread_pool.size());
+
+  io_engine_ = system::IOEngine::Create(static_cast<system::IOEngine::Backend>(tianmu_sysvar_io_backend),
+                                        tianmu_sysvar_io_threads ? tianmu_sysvar_io_threads
+                                                                 : std::thread::hardware_concurrency());
+  TIANMU_LOG(LogCtl_Level::INFO, "Tianmu pack I/O backend: %s", io_engine_->Name());
+  TIANMU_LOG(LogCtl_Level::INFO, "Tianmu filter kernels: %s", utils::simd::LevelName(utils::simd::ActiveLevel()));
 
   m_monitor_thread = std::thread([this] {
     TIANMU_LOG(LogCtl_Level::INFO, "Tianmu monitor thread start...");
@@ -274,9 +285,11 @@ int Engine::Init(uint engine_slot) {
          [this]() {
            for (auto &delta : m_table_deltas) {
              TIANMU_LOG(LogCtl_Level::INFO,
-                        "delta table id: %d delta_size: %d, current load id: %d, merge id: %d, current row_id: %d",
+                        "delta table id: %d delta_size: %d, current load id: %d, merge id: %d, current row_id: %d, "
+                        "merge lag: %lu s",
                         delta.second->GetDeltaTableID(), delta.second->load_id.load() - delta.second->merge_id.load(),
-                        delta.second->load_id.load(), delta.second->merge_id.load(), delta.second->row_id.load());
+                        delta.second->load_id.load(), delta.second->merge_id.load(), delta.second->row_id.load(),
+                        delta.second->LagSeconds());
            }
          }},
         {tianmu_sysvar_log_loop_interval * 5,
@@ -373,6 +386,13 @@ Engine::~Engine() {
   m_purge_thread.join();
   m_monitor_thread.join();
 
+  // read-ahead tasks use the cache and the memory manager, wait for them
+  prefetch_stopped_ = true;
+  {
+    std::unique_lock lk(prefetch_mtx_);
+    prefetch_done_.wait(lk, [this] { return prefetch_in_flight_ == 0; });
+  }
+
   cache.ReleaseAll();
   table_share_map.clear();
   m_table_deltas.clear();
@@ -526,7 +546,7 @@ const char *Engine::StrToFiled(const char *ptr, Field *field, DeltaRecordHead *d
       auto dec_field = static_cast<Field_new_decimal *>(field);
       decimal_round(&md, &md, dec_field->decimals(), HALF_UP);
       decimal2bin(&md, (uchar *)field->ptr, dec_field->precision, dec_field->decimals());
-    }
+    } break;
     case MYSQL_TYPE_TIME:
     case MYSQL_TYPE_TIME2: {
       uint64_t v = *(uint64_t *)ptr;
@@ -786,6 +806,9 @@ std::shared_ptr<TableOption> Engine::GetTableOption(const std::string &table, TA
 
 void Engine::CreateTable(const std::string &table, TABLE *form, HA_CREATE_INFO *create_info) {
   TianmuTable::CreateNew(GetTableOption(table, form, create_info));
+  // tables without primary key keep an index table only for their secondary keys
+  if (tianmu_sysvar_secondary_index && form->s->keys > 0 && !index::TianmuTableIndex::FindIndexTable(table))
+    index::TianmuTableIndex::CreateIndexTable(table, form);
 }
 
 AttributeTypeInfo Engine::GetAttrTypeInfo(const Field &field) {
@@ -821,6 +844,17 @@ AttributeTypeInfo Engine::GetAttrTypeInfo(const Field &field) {
     fmt = common::PackFmt::LZ4;
   else if (str.find("ZLIB") != std::string::npos)
     fmt = common::PackFmt::ZLIB;
+  else if (str.find("BITPACK") != std::string::npos) {
+    if (field.result_type() == INT_RESULT || field.result_type() == DECIMAL_RESULT || field.is_temporal())
+      fmt = common::PackFmt::BITPACK;
+    else {
+      std::string s =
+          "BITPACK can only be declared on integer, decimal and temporal columns. Ignored on "
+          "column ";
+      s = s + (field.table ? std::string(field.table->s->table_name.str) + "." : "") + field.field_name;
+      push_warning(current_thd, Sql_condition::SL_WARNING, WARN_OPTION_IGNORED, s.c_str());
+    }
+  }
 
   switch (field.type()) {
     case MYSQL_TYPE_SHORT:
@@ -1442,7 +1476,20 @@ void Engine::ProcessDeltaStoreMerge() {
   }
   mysql_mutex_unlock(&LOCK_server_started);
 
+  // Tables are merged independently on the background load pool: a table
+  // with a large backlog occupies one worker and does not hold back the
+  // others. When more tables are due than there are workers, the ones with
+  // the biggest backlog, the most query scans over their delta since the last
+  // merge and the longest wait go first. Each merge moves at most
+  // merge_rocks_expected_count rows and builds the packs of all columns in
+  // parallel (TianmuTable::AsyncParseInsertRecords()).
+  struct MergeCandidate {
+    std::string name;
+    std::shared_ptr<DeltaTable> delta;
+    double priority;
+  };
   std::map<std::string, uint> sleep_cnts;
+  std::map<std::string, uint64_t> last_scan_cnts;
   TIANMU_LOG(LogCtl_Level::INFO, "Tianmu merge delta store thread start...");
   while (!exiting) {
     if (!tianmu_sysvar_enable_rowstore) {
@@ -1451,56 +1498,118 @@ void Engine::ProcessDeltaStoreMerge() {
       continue;
     }
 
-    std::unordered_map<uint32_t, std::vector<std::unique_ptr<char[]>>> need_merge_table;
-    {
+    for (auto it = merges_in_flight_.begin(); it != merges_in_flight_.end();) {
+      if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        ++it;
+        continue;
+      }
       try {
-        std::scoped_lock guard(mem_table_mutex);
-        for (auto &[name, delta_table] : m_table_deltas) {
-          uint64_t record_count = delta_table->CountRecords();
-          if ((record_count >= tianmu_sysvar_insert_numthreshold ||
-               (sleep_cnts.count(name) && sleep_cnts[name] > tianmu_sysvar_insert_cntthreshold))) {
-            auto share = ha_tianmu_engine_->getTableShare(name);
-            auto table_id = share->TabID();
-            utils::BitSet null_mask(share->NumOfCols());
-            std::unique_ptr<char[]> buf(new char[sizeof(uint32_t) + name.size() + 1 + null_mask.data_size()]);
-            char *ptr = buf.get();
-            *(uint32_t *)ptr = table_id;  // table id
-            ptr += sizeof(uint32_t);
-            std::memcpy(ptr, name.c_str(), name.size());
-            ptr += name.size();
-            *ptr++ = 0;  // end with NUL
-            std::memcpy(ptr, null_mask.data(), null_mask.data_size());
-            need_merge_table[table_id].emplace_back(std::move(buf));
-            sleep_cnts[name] = 0;
-          } else if (record_count > 0) {
-            if (sleep_cnts.count(name))
-              sleep_cnts[name]++;
-            else
-              sleep_cnts[name] = 0;
-          }
+        it->second.get();
+      } catch (std::exception &e) {
+        TIANMU_LOG(LogCtl_Level::ERROR, "Tianmu merge delta store of %s failed. %s", it->first.c_str(), e.what());
+      }
+      it = merges_in_flight_.erase(it);
+    }
+
+    std::vector<MergeCandidate> candidates;
+    {
+      std::shared_lock<std::shared_mutex> guard(mem_table_mutex);
+      for (auto &[name, delta_table] : m_table_deltas) {
+        uint64_t record_count = delta_table->CountRecords();
+        if (record_count == 0)
+          continue;
+        if (merges_in_flight_.count(name))
+          continue;
+        if (record_count >= tianmu_sysvar_insert_numthreshold ||
+            (sleep_cnts.count(name) && sleep_cnts[name] > tianmu_sysvar_insert_cntthreshold)) {
+          uint64_t scans = delta_table->stat.scan_cnt.load() - last_scan_cnts[name];
+          candidates.push_back(
+              {name, delta_table, double(record_count) * (1 + scans) * (1 + delta_table->LagSeconds())});
+        } else if (sleep_cnts.count(name)) {
+          sleep_cnts[name]++;
+        } else {
+          sleep_cnts[name] = 0;
         }
+      }
+    }
+
+    size_t max_merges = tianmu_sysvar_merge_threads ? tianmu_sysvar_merge_threads : bg_load_thread_pool.size();
+    size_t free_slots = max_merges > merges_in_flight_.size() ? max_merges - merges_in_flight_.size() : 0;
+    if (candidates.size() > free_slots)
+      std::partial_sort(candidates.begin(), candidates.begin() + free_slots, candidates.end(),
+                        [](const MergeCandidate &a, const MergeCandidate &b) { return a.priority > b.priority; });
+
+    size_t started = 0;
+    for (size_t i = 0; i < candidates.size() && i < free_slots; i++) {
+      auto &name = candidates[i].name;
+      try {
+        auto share = getTableShare(name);
+        auto table_id = share->TabID();
+        utils::BitSet null_mask(share->NumOfCols());
+        std::unique_ptr<char[]> buf(new char[sizeof(uint32_t) + name.size() + 1 + null_mask.data_size()]);
+        char *ptr = buf.get();
+        *(uint32_t *)ptr = table_id;  // table id
+        ptr += sizeof(uint32_t);
+        std::memcpy(ptr, name.c_str(), name.size());
+        ptr += name.size();
+        *ptr++ = 0;  // end with NUL
+        std::memcpy(ptr, null_mask.data(), null_mask.data_size());
+        auto records = std::make_shared<std::vector<std::unique_ptr<char[]>>>();
+        records->emplace_back(std::move(buf));
+        merges_in_flight_[name] = bg_load_thread_pool.add_task([this, table_id, records] {
+          HandleDelayedLoad(table_id, *records);
+          cv_merge.notify_one();  // let the scheduler reuse the worker
+        });
+        sleep_cnts[name] = 0;
+        last_scan_cnts[name] = candidates[i].delta->stat.scan_cnt.load();
+        started++;
       } catch (common::Exception &e) {
         TIANMU_LOG(LogCtl_Level::ERROR, "Tianmu merge delta store  failed. %s %s", e.what(), e.trace().c_str());
-        std::unique_lock<std::mutex> lk(cv_merge_mtx);
-        cv_merge.wait_for(lk, std::chrono::milliseconds(tianmu_sysvar_insert_wait_ms));
-        continue;
       } catch (...) {
         TIANMU_LOG(LogCtl_Level::ERROR, "Tianmu merge delta store failed.");
-        std::unique_lock<std::mutex> lk(cv_merge_mtx);
-        cv_merge.wait_for(lk, std::chrono::milliseconds(tianmu_sysvar_insert_wait_ms));
-        continue;
       }
     }
-    if (!need_merge_table.empty())
-      DistributeLoad(need_merge_table);
-    else {
+    if (started == 0) {
       std::unique_lock<std::mutex> lk(cv_merge_mtx);
       cv_merge.wait_for(lk, std::chrono::milliseconds(tianmu_sysvar_insert_wait_ms));
     }
   }
+  for (auto &[name, merge] : merges_in_flight_) merge.wait();
+  merges_in_flight_.clear();
   TIANMU_LOG(LogCtl_Level::INFO, "Tianmu merge delta store thread exiting...");
 }
 
+void Engine::DeltaMergeLag(uint64_t &rows, uint64_t &seconds) {
+  rows = seconds = 0;
+  std::shared_lock<std::shared_mutex> guard(mem_table_mutex);
+  for (auto &[name, delta_table] : m_table_deltas) {
+    rows += delta_table->CountRecords();
+    seconds = std::max(seconds, delta_table->LagSeconds());
+  }
+}
+
+std::string Engine::DeltaMergeLagStat(size_t max_len) {
+  std::vector<std::tuple<uint64_t, uint64_t, std::string>> lags;  // rows, seconds, table
+  {
+    std::shared_lock<std::shared_mutex> guard(mem_table_mutex);
+    for (auto &[name, delta_table] : m_table_deltas) {
+      uint64_t rows = delta_table->CountRecords();
+      if (rows > 0)
+        lags.emplace_back(rows, delta_table->LagSeconds(), name);
+    }
+  }
+  std::sort(lags.begin(), lags.end(), std::greater<>());
+  std::string res;
+  for (auto &[rows, seconds, name] : lags) {
+    std::string item =
+        (res.empty() ? "" : ", ") + name + ":" + std::to_string(rows) + "/" + std::to_string(seconds) + "s";
+    if (res.size() + item.size() > max_len)
+      break;
+    res += item;
+  }
+  return res;
+}
+
 void Engine::LogStat() {
   static long last_sample_time = 0;
   static query_id_t saved_query_id = 0;
@@ -1690,6 +1799,8 @@ void Engine::UpdateToDelta(const std::string &table_path, std::shared_ptr<TableS
     }
   }
 
+  tm_table->UpdateSecondaryIndex(table, row_id, old_data, new_data);
+
   uint32_t buf_sz = 0;
   std::unique_ptr<char[]> buf;
   EncodeUpdateRecord(table_path, update_fields, table->s->fields, table->s->blob_fields, buf, buf_sz, table->in_use);
@@ -2303,6 +2414,72 @@ void Engine::UnregisterDeltaTable(const std::string &from, const std::string &to
   }
 }
 
+namespace {
+// DataCache fetcher building a pack from an image read in a batch
+struct PackImageFetcher {
+  ColumnShare *col;
+  const char *image;
+  std::shared_ptr<Pack> Fetch(const PackCoordinate &pc) { return col->Fetch(pc, image); }
+};
+}  // namespace
+
+bool Engine::PrefetchAllowed() const {
+  return tianmu_sysvar_prefetch_depth > 0 && !prefetch_stopped_ &&
+         cache.getPrefetchBytes() < (int64_t(tianmu_sysvar_prefetch_buffer_size) << 20);
+}
+
+// Queue reading of packs pcs of column col. The request is dropped when the
+// pool is already saturated: read-ahead is only a hint and must never make
+// the query wait.
+void Engine::PrefetchPacks(std::shared_ptr<TableShare> share, ColumnShare *col, std::vector<PackCoordinate> pcs) {
+  if (prefetch_in_flight_ >= int(prefetch_thread_pool.size() * 4))
+    return;
+
+  // the packs are admitted to the cache on behalf of the requesting statement
+  uint64_t query = current_txn_ ? current_txn_->QueryID() : 0;
+  // taken before queuing, so a table released while the task waits in the
+  // queue invalidates it
+  uint64_t generation = cache.getPackGeneration();
+  ++prefetch_in_flight_;
+  try {
+    prefetch_thread_pool.add_task([this, share, col, pcs, query, generation]() {
+      // claim the packs first, then read all their images in one batch
+      std::vector<PackCoordinate> claimed;
+      for (auto const &pc : pcs) {
+        if (!PrefetchAllowed())
+          break;
+        if (cache.BeginPrefetch(pc))
+          claimed.push_back(pc);
+      }
+
+      std::vector<std::unique_ptr<char[]>> images;
+      col->ReadPackImages(claimed, images);
+
+      for (size_t i = 0; i < claimed.size(); i++) {
+        PackImageFetcher fetcher{col, images[i].get()};
+        try {
+          cache.FinishPrefetch<Pack>(claimed[i], &fetcher, generation, query);
+        } catch (std::exception &e) {
+          TIANMU_LOG(LogCtl_Level::DEBUG, "Pack read-ahead of %s failed: %s", share->Path().c_str(), e.what());
+        } catch (...) {
+          TIANMU_LOG(LogCtl_Level::DEBUG, "Pack read-ahead of %s failed.", share->Path().c_str());
+        }
+      }
+      PrefetchDone();
+    });
+  } catch (...) {
+    PrefetchDone();
+  }
+}
+
+void Engine::PrefetchDone() {
+  {
+    std::scoped_lock lk(prefetch_mtx_);
+    --prefetch_in_flight_;
+  }
+  prefetch_done_.notify_all();
+}
+
 void Engine::ResetTaskExecutor(int percent) {
   if (percent > 0) {
     if (task_executor) {
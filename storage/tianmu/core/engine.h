@@ -18,7 +18,9 @@
 #define TIANMU_CORE_ENGINE_H_
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <future>
 #include <list>
 #include <mutex>
 #include <thread>
@@ -38,6 +40,7 @@
 #include "index/tianmu_table_index.h"
 #include "log.h"
 #include "sql_table.h"
+#include "system/io_engine.h"
 #include "system/io_parameters.h"
 #include "system/tianmu_system.h"
 #include "util/fs.h"
@@ -123,6 +126,11 @@ class Engine final {
   void DeleteToDelta(std::shared_ptr<TableShare> &share, TABLE *table, uint64_t row_id);
   std::string DelayedBufferStat() { return insert_buffer.Status(); }
   std::string DeltaStoreStat();
+  // delta store merge lag over all tables: rows not merged yet and the
+  // longest wait in seconds
+  void DeltaMergeLag(uint64_t &rows, uint64_t &seconds);
+  // the same per table, most lagging first, cut to at most max_len characters
+  std::string DeltaMergeLagStat(size_t max_len);
   void UnRegisterTable(const std::string &table_path);
   std::shared_ptr<TableShare> GetTableShare(const TABLE_SHARE *table_share);
   common::TX_ID MinXID() const { return min_xid; }
@@ -139,7 +147,12 @@ class Engine final {
   void DropSignal() { cv_drop_.notify_one(); }
   void ResetTaskExecutor(int percent);
   TaskExecutor *GetTaskExecutor() const { return task_executor.get(); }
+  system::IOEngine *GetIOEngine() const { return io_engine_.get(); }
   void AddTableDelta(TABLE *form, std::shared_ptr<TableShare> share);
+  // asynchronous pack read-ahead, see VCPackGuardian
+  bool PrefetchAllowed() const;
+  void PrefetchPacks(std::shared_ptr<TableShare> share, ColumnShare *col, std::vector<PackCoordinate> pcs);
+  void PrefetchDone();
   void UnregisterDeltaTable(const std::string &from, const std::string &to);
 
  public:
@@ -149,6 +162,8 @@ class Engine final {
   utils::thread_pool delete_or_update_thread_pool;
   DataCache cache;
   ObjectCache<FilterCoordinate, RSIndex, FilterCoordinate> filter_cache;
+  // must be destroyed before the cache, the read-ahead tasks fill it
+  utils::thread_pool prefetch_thread_pool;
 
  public:
   static common::ColumnType GetCorrespondingType(const Field &field);
@@ -217,6 +232,11 @@ class Engine final {
     unsigned long update;
   } tianmu_stat{};
 
+  std::atomic<int> prefetch_in_flight_{0};  // read-ahead tasks queued or running
+  std::atomic<bool> prefetch_stopped_{false};
+  std::mutex prefetch_mtx_;
+  std::condition_variable prefetch_done_;  // signalled when prefetch_in_flight_ drops
+
   std::thread m_load_thread;
   std::thread m_merge_thread;
   std::thread m_monitor_thread;
@@ -237,6 +257,9 @@ class Engine final {
   std::mutex cv_mtx;
   std::condition_variable cv_merge;
   std::mutex cv_merge_mtx;
+  // delta store merges started by ProcessDeltaStoreMerge() and not reaped
+  // yet, by table path; used by the merge thread only
+  std::unordered_map<std::string, std::future<void>> merges_in_flight_;
 
   system::ResourceManager *m_resourceManager = nullptr;
 
@@ -280,6 +303,7 @@ class Engine final {
   std::condition_variable cv_drop_;
   std::mutex cv_drop_mtx_;
   std::unique_ptr<TaskExecutor> task_executor;
+  std::unique_ptr<system::IOEngine> io_engine_;
 };
 
 class ResultSender {
@@ -314,6 +338,9 @@ class ResultSender {
   int64_t rows_sent;
   int64_t affect_rows;
 
+  // rows converted together by Send(TempTable *)
+  static constexpr uint64_t kSendBatchRows = 1024;
+
   virtual void Init(TempTable *t);
   virtual void SendRecord(const std::vector<std::unique_ptr<types::TianmuDataType>> &record);
 };
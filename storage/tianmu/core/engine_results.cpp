@@ -15,7 +15,9 @@
    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
 */
 
+#include <algorithm>
 #include <cinttypes>
+#include <future>
 
 #include "common/data_format.h"
 #include "core/engine.h"
@@ -369,10 +371,66 @@ void ResultSender::SendRecord(const std::vector<std::unique_ptr<types::TianmuDat
 void ResultSender::Send(TempTable *t) {
   DEBUG_ASSERT(t->IsMaterialized());
   t->CreateDisplayableAttrP();
-  TempTable::RecordIterator iter = t->begin();
-  TempTable::RecordIterator iter_end = t->end();
-  for (; iter != iter_end; ++iter) {
-    Send(iter);
+  uint64_t no_obj = t->NumOfObj();
+  if (no_obj == 0)
+    return;
+
+  if (!is_initialized) {
+    Init(t);
+    is_initialized = true;
+  }
+  if (!t->IsSent())
+    t->SetIsSent();
+
+  // func found_rows() need limit_found_rows, which counts the rows cut off by
+  // OFFSET and LIMIT as well, so they are only counted, never converted
+  thd->current_found_rows += no_obj;
+  thd->update_previous_found_rows();
+  uint64_t row = 0;
+  if (offset && *offset > 0) {
+    row = std::min<uint64_t>(*offset, no_obj);
+    *offset -= row;
+  }
+  uint64_t end_row = no_obj;
+  if (limit) {
+    end_row = row + std::min<uint64_t>(*limit, no_obj - row);
+    *limit -= end_row - row;
+  }
+  if (row == end_row)
+    return;
+
+  // The next batch is converted on a helper thread while the current one is
+  // sent. Both batches keep their value objects between rounds.
+  std::vector<TempTable::RecordValues> batches[2];
+  int cur = 0;
+  batches[cur].resize(std::min(kSendBatchRows, end_row - row));
+  t->GetDisplayableValues(current_txn_, row, batches[cur]);
+  while (row < end_row) {
+    if (current_txn_->Killed())
+      throw common::KilledException();
+
+    uint64_t next_row = row + batches[cur].size();
+    std::future<void> next_batch;
+    if (next_row < end_row) {
+      auto &batch = batches[cur ^ 1];
+      batch.resize(std::min(kSendBatchRows, end_row - next_row));
+      next_batch = ha_tianmu_engine_->query_thread_pool.add_task(&TempTable::GetDisplayableValues, t, current_txn_,
+                                                                  next_row, std::ref(batch));
+    }
+    try {
+      for (auto &record : batches[cur]) {
+        SendRecord(record);
+        rows_sent++;
+      }
+    } catch (...) {
+      if (next_batch.valid())
+        next_batch.wait();
+      throw;
+    }
+    if (next_batch.valid())
+      next_batch.get();
+    row = next_row;
+    cur ^= 1;
   }
 }
 
@@ -634,6 +634,27 @@ void Filter::And(Filter &f2) {
   }
 }
 
+void Filter::AndMask(size_t b, const uint32_t *mask, int n) {
+  MEASURE_FET("Filter::AndMask(...)");
+  DEBUG_ASSERT(b < no_blocks);
+  block_changed[b] = true;
+  if (block_status[b] == FB_EMPTY)
+    return;
+  int end_block = (b == no_blocks - 1 ? no_of_bits_in_last_block - 1 : (pack_def - 1));
+  if (block_status[b] == FB_FULL) {
+    int last_one = block_last_one[b];
+    blocks[b] = block_allocator->Alloc();
+    new (blocks[b]) Block(block_filter, end_block + 1, true);  // block_filter->this
+    block_status[b] = FB_MIXED;
+    if (last_one < end_block)
+      blocks[b]->Reset(last_one + 1, end_block);
+  }
+  if (blocks[b]->And(mask, n))
+    ResetBlock(b);
+  else if (blocks[b]->NumOfOnes() == uint(end_block + 1))
+    SetBlock(b);
+}
+
 void Filter::Or(Filter &f2, int pack) {
   auto mb = std::min(f2.NumOfBlocks(), NumOfBlocks());
   size_t b = (pack == -1 ? 0 : pack);
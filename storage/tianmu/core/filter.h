@@ -136,6 +136,9 @@ class Filter final : public mm::TraceableObject {
   // Logical operations on filter
   bool IsEqual(Filter &sec);
   void And(Filter &f2);
+  // AND block b with a row bitmap of n rows (row i is bit i & 31 of
+  // mask[i >> 5]); rows from n on are left unchanged
+  void AndMask(size_t b, const uint32_t *mask, int n);
   void Or(Filter &f2,
           int pack = -1);  // if pack is specified, then only one pack is to be ORed
   void Not();
@@ -269,6 +272,7 @@ class Filter final : public mm::TraceableObject {
     bool Get(int n) { return (block_table[n >> 5] & lshift1[n & 31]); }
     bool IsEqual(Block &b2);
     bool And(Block &b2);  // true => block is empty
+    bool And(const uint32_t *mask, int n);  // true => block is empty
     bool Or(Block &b2);   // true => block is full
     void Not();
     bool AndNot(Block &b2);  // true => block is empty
@@ -266,6 +266,21 @@ bool Filter::Block::And(Block &b2) {
   return (no_set_bits == 0);
 }
 
+bool Filter::Block::And(const uint32_t *mask, int n) {
+  DEBUG_ASSERT(n <= no_obj);
+  int words = n / 32;
+  for (int i = 0; i < words; i++) block_table[i] &= mask[i];
+  if (n % 32)
+    block_table[words] &= mask[words] | (0xFFFFFFFF << (n % 32));
+  int new_set_bits = 0;
+  int no_positions = no_obj / 32;
+  for (int i = 0; i < no_positions; i++) new_set_bits += CalculateBinSum(block_table[i]);
+  if (no_obj % 32)
+    new_set_bits += CalculateBinSum(block_table[no_positions] & (0xFFFFFFFF >> (32 - no_obj % 32)));
+  no_set_bits = new_set_bits;
+  return (no_set_bits == 0);
+}
+
 bool Filter::Block::Or(Block &b2) {
   int new_set_bits = 0;
   int no_positions = NumOfObj() / 32;
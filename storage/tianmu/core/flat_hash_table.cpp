@@ -0,0 +1,382 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/assert.h"
+#include "core/flat_hash_table.h"
+#include "core/transaction.h"
+
+namespace Tianmu {
+namespace core {
+namespace {
+const int kMaxHashConflicts = 128;
+const signed char kEmptySlot = -128;  // 0x80, hash tags are 0..127
+
+inline uint64_t MixHash(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Key hashing and comparison, specialized for the widths that fit integers.
+// W == 0 is the generic, byte-wise version.
+template <int W>
+struct FixedKey;
+
+template <typename T>
+struct IntegerKey {
+  static T Load(const unsigned char *key) {
+    T v;
+    std::memcpy(&v, key, sizeof(T));
+    return v;
+  }
+  static uint64_t Hash(const unsigned char *key, [[maybe_unused]] size_t width) { return MixHash(Load(key)); }
+  static bool Equal(const unsigned char *a, const unsigned char *b, [[maybe_unused]] size_t width) {
+    return Load(a) == Load(b);
+  }
+};
+
+template <>
+struct FixedKey<1> : IntegerKey<uint8_t> {};
+template <>
+struct FixedKey<2> : IntegerKey<uint16_t> {};
+template <>
+struct FixedKey<4> : IntegerKey<uint32_t> {};
+template <>
+struct FixedKey<8> : IntegerKey<uint64_t> {};
+
+template <>
+struct FixedKey<16> {
+  static uint64_t Hash(const unsigned char *key, [[maybe_unused]] size_t width) {
+    return MixHash(IntegerKey<uint64_t>::Load(key) ^ MixHash(IntegerKey<uint64_t>::Load(key + 8)));
+  }
+  static bool Equal(const unsigned char *a, const unsigned char *b, [[maybe_unused]] size_t width) {
+    return IntegerKey<uint64_t>::Load(a) == IntegerKey<uint64_t>::Load(b) &&
+           IntegerKey<uint64_t>::Load(a + 8) == IntegerKey<uint64_t>::Load(b + 8);
+  }
+};
+
+template <>
+struct FixedKey<0> {
+  static uint64_t Hash(const unsigned char *key, size_t width) {
+    uint64_t h = width;
+    for (; width >= 8; width -= 8, key += 8) h = MixHash(h ^ IntegerKey<uint64_t>::Load(key));
+    if (width > 0) {
+      uint64_t tail = 0;
+      std::memcpy(&tail, key, width);
+      h = MixHash(h ^ tail);
+    }
+    return h;
+  }
+  static bool Equal(const unsigned char *a, const unsigned char *b, size_t width) {
+    return std::memcmp(a, b, width) == 0;
+  }
+};
+
+// Bit i of the result is set if ctrl[i] == tag, for the 16 bytes of a group.
+inline uint32_t MatchGroup(const signed char *ctrl, signed char tag) {
+#if defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < FlatHashTable::kGroupWidth; ++i)
+    if (ctrl[i] == tag)
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
+inline signed char HashTag(uint64_t hash) { return static_cast<signed char>(hash & 0x7F); }
+
+inline size_t AlignUp(size_t size) { return (size + 63) & ~size_t(63); }
+}  // namespace
+
+FlatHashTable::FlatHashTable(const std::vector<int> &keys_length, const std::vector<int> &tuples_length) {
+  // Row format: <next row><tuple_1>...<tuple_m>, keys are stored once per slot.
+  key_buf_width_ = std::accumulate(keys_length.begin(), keys_length.end(), 0);
+
+  column_size_.assign(keys_length.begin(), keys_length.end());
+  std::copy(tuples_length.begin(), tuples_length.end(), std::back_inserter(column_size_));
+  column_offset_.resize(column_size_.size());
+
+  row_width_ = sizeof(int64_t);
+  for (size_t index = keys_length.size(); index < column_size_.size(); ++index) {
+    column_offset_[index] = row_width_;
+    row_width_ += column_size_[index];
+  }
+}
+
+FlatHashTable::~FlatHashTable() { dealloc(buffer_); }
+
+void FlatHashTable::Initialize(int64_t max_table_size, bool verbose) {
+  max_table_size = std::max(max_table_size, (int64_t)2);
+  // Leave some room, the traversed fragments are estimated.
+  rows_limit_ = max_table_size + max_table_size / 8 + 1;
+
+  // At most 7/8 of the slots are used, so a probe always meets an empty one.
+  uint64_t groups_count = 1;
+  while (groups_count * kGroupWidth * 7 / 8 < uint64_t(rows_limit_)) groups_count <<= 1;
+  groups_mask_ = groups_count - 1;
+  size_t slots_count = groups_count * kGroupWidth;
+
+  size_t slots_size = AlignUp(slots_count * sizeof(Slot));
+  size_t rows_size = AlignUp(rows_limit_ * row_width_);
+  size_t keys_size = AlignUp(slots_count * key_buf_width_);
+  size_t total_size = slots_size + rows_size + keys_size + slots_count;
+  if (verbose)
+    tianmu_control_.lock(current_txn_->GetThreadID())
+        << "Establishing hash table need " << total_size / 1024 / 1024 << "MB" << system::unlock;
+
+  // No need to cache on disk.
+  buffer_ = (unsigned char *)alloc(total_size, mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+  std::memset(buffer_, 0, slots_size + rows_size);
+  slots_ = reinterpret_cast<Slot *>(buffer_);
+  rows_ = buffer_ + slots_size;
+  slot_keys_ = rows_ + rows_size;
+  ctrl_ = reinterpret_cast<signed char *>(slot_keys_ + keys_size);
+  std::memset(ctrl_, kEmptySlot, slots_count);
+}
+
+template <int W>
+int64_t FlatHashTable::Insert(const unsigned char *key, bool *too_many_conflicts) {
+  uint64_t hash = FixedKey<W>::Hash(key, key_buf_width_);
+  signed char tag = HashTag(hash);
+  uint64_t group = (hash >> 7) & groups_mask_;
+  for (uint64_t step = 1;; ++step) {
+    const signed char *ctrl = ctrl_ + group * kGroupWidth;
+    int64_t slot = -1;
+    for (uint32_t mask = MatchGroup(ctrl, tag); mask != 0; mask &= mask - 1) {
+      int64_t candidate = group * kGroupWidth + __builtin_ctz(mask);
+      if (FixedKey<W>::Equal(slot_keys_ + candidate * key_buf_width_, key, key_buf_width_)) {
+        slot = candidate;
+        break;
+      }
+    }
+    if (slot == -1) {
+      uint32_t empty = MatchGroup(ctrl, kEmptySlot);
+      if (empty == 0) {  // triangular probing visits every group of a power of 2 table
+        group = (group + step) & groups_mask_;
+        continue;
+      }
+      slot = group * kGroupWidth + __builtin_ctz(empty);
+      ctrl_[slot] = tag;
+      std::memcpy(slot_keys_ + slot * key_buf_width_, key, key_buf_width_);
+      slots_[slot] = {common::NULL_VALUE_64, common::NULL_VALUE_64, 0};
+    }
+
+    int64_t row = rows_of_occupied_++;
+    NextRow(row) = common::NULL_VALUE_64;
+    Slot &s = slots_[slot];
+    if (s.rows == 0)
+      s.first_row = row;
+    else
+      NextRow(s.last_row) = row;
+    s.last_row = row;
+    if (++s.rows > kMaxHashConflicts && too_many_conflicts)  // a threshold for switching sides
+      *too_many_conflicts = true;
+    return row;
+  }
+}
+
+template <int W>
+int64_t FlatHashTable::FindSlot(const unsigned char *key, uint64_t hash) const {
+  signed char tag = HashTag(hash);
+  uint64_t group = (hash >> 7) & groups_mask_;
+  for (uint64_t step = 1;; ++step) {
+    const signed char *ctrl = ctrl_ + group * kGroupWidth;
+    for (uint32_t mask = MatchGroup(ctrl, tag); mask != 0; mask &= mask - 1) {
+      int64_t slot = group * kGroupWidth + __builtin_ctz(mask);
+      if (FixedKey<W>::Equal(slot_keys_ + slot * key_buf_width_, key, key_buf_width_))
+        return slot;
+    }
+    if (MatchGroup(ctrl, kEmptySlot) != 0)
+      return -1;
+    group = (group + step) & groups_mask_;
+  }
+}
+
+template <int W>
+void FlatHashTable::LookupBatchImpl(const unsigned char *keys, int n, int64_t *first_rows,
+                                    int64_t *matched_rows) const {
+  uint64_t hashes[kProbeBatch];
+  for (int start = 0; start < n; start += kProbeBatch) {
+    int count = std::min(n - start, kProbeBatch);
+    const unsigned char *batch_keys = keys + start * key_buf_width_;
+    // Hash the whole batch first and prefetch the groups, then compare while
+    // the later groups are still on their way.
+    for (int i = 0; i < count; ++i) {
+      hashes[i] = FixedKey<W>::Hash(batch_keys + i * key_buf_width_, key_buf_width_);
+      uint64_t group = (hashes[i] >> 7) & groups_mask_;
+      __builtin_prefetch(ctrl_ + group * kGroupWidth);
+      __builtin_prefetch(slot_keys_ + group * kGroupWidth * key_buf_width_);
+    }
+    for (int i = 0; i < count; ++i) {
+      int64_t slot = FindSlot<W>(batch_keys + i * key_buf_width_, hashes[i]);
+      if (slot == -1) {
+        first_rows[start + i] = common::NULL_VALUE_64;
+        matched_rows[start + i] = 0;
+      } else {
+        first_rows[start + i] = slots_[slot].first_row;
+        matched_rows[start + i] = slots_[slot].rows;
+      }
+    }
+  }
+}
+
+uint64_t FlatHashTable::HashKey(const unsigned char *key, size_t width) {
+  switch (width) {
+    case 1:
+      return FixedKey<1>::Hash(key, width);
+    case 2:
+      return FixedKey<2>::Hash(key, width);
+    case 4:
+      return FixedKey<4>::Hash(key, width);
+    case 8:
+      return FixedKey<8>::Hash(key, width);
+    case 16:
+      return FixedKey<16>::Hash(key, width);
+    default:
+      return FixedKey<0>::Hash(key, width);
+  }
+}
+
+int64_t FlatHashTable::AddKeyValue(const std::string &key_buffer, bool *too_many_conflicts) {
+  DEBUG_ASSERT(key_buffer.size() == key_buf_width_);
+  return AddKeyValue(reinterpret_cast<const unsigned char *>(key_buffer.data()), too_many_conflicts);
+}
+
+int64_t FlatHashTable::AddKeyValue(const unsigned char *key, bool *too_many_conflicts) {
+  if (rows_of_occupied_ >= rows_limit_)  // no more space
+    return common::NULL_VALUE_64;
+
+  switch (key_buf_width_) {
+    case 1:
+      return Insert<1>(key, too_many_conflicts);
+    case 2:
+      return Insert<2>(key, too_many_conflicts);
+    case 4:
+      return Insert<4>(key, too_many_conflicts);
+    case 8:
+      return Insert<8>(key, too_many_conflicts);
+    case 16:
+      return Insert<16>(key, too_many_conflicts);
+    default:
+      return Insert<0>(key, too_many_conflicts);
+  }
+}
+
+void FlatHashTable::Lookup(const unsigned char *key, int64_t *first_row, int64_t *matched_rows) const {
+  LookupBatch(key, 1, first_row, matched_rows);
+}
+
+void FlatHashTable::LookupBatch(const unsigned char *keys, int n, int64_t *first_rows, int64_t *matched_rows) const {
+  switch (key_buf_width_) {
+    case 1:
+      LookupBatchImpl<1>(keys, n, first_rows, matched_rows);
+      break;
+    case 2:
+      LookupBatchImpl<2>(keys, n, first_rows, matched_rows);
+      break;
+    case 4:
+      LookupBatchImpl<4>(keys, n, first_rows, matched_rows);
+      break;
+    case 8:
+      LookupBatchImpl<8>(keys, n, first_rows, matched_rows);
+      break;
+    case 16:
+      LookupBatchImpl<16>(keys, n, first_rows, matched_rows);
+      break;
+    default:
+      LookupBatchImpl<0>(keys, n, first_rows, matched_rows);
+      break;
+  }
+}
+
+void FlatHashTable::SetTupleValue(int col, int64_t row, int64_t value) {
+  DEBUG_ASSERT(row < rows_of_occupied_);
+  if (column_size_[col] == 4) {
+    if (value == common::NULL_VALUE_64)
+      *((int *)(rows_ + row * row_width_ + column_offset_[col])) = 0;
+    else
+      *((int *)(rows_ + row * row_width_ + column_offset_[col])) = int(value + 1);
+  } else {
+    if (value == common::NULL_VALUE_64)
+      *((int64_t *)(rows_ + row * row_width_ + column_offset_[col])) = 0;
+    else
+      *((int64_t *)(rows_ + row * row_width_ + column_offset_[col])) = value + 1;
+  }
+}
+
+int64_t FlatHashTable::GetTupleValue(int col, int64_t row) const {
+  if (column_size_[col] == 4) {
+    int value = *((int *)(rows_ + row * row_width_ + column_offset_[col]));
+    if (value == 0)
+      return common::NULL_VALUE_64;
+    return value - 1;
+  } else {
+    int64_t value = *((int64_t *)(rows_ + row * row_width_ + column_offset_[col]));
+    if (value == 0)
+      return common::NULL_VALUE_64;
+    return value - 1;
+  }
+}
+
+FlatHashTable::Finder::Finder(FlatHashTable *hash_table, std::string *key_buffer) : hash_table_(hash_table) {
+  DEBUG_ASSERT(key_buffer->size() == hash_table_->key_buf_width_);
+  hash_table_->Lookup(reinterpret_cast<const unsigned char *>(key_buffer->data()), &current_row_, &matched_rows_);
+}
+
+int64_t FlatHashTable::Finder::GetNextRow() {
+  if (current_row_ == common::NULL_VALUE_64)
+    return common::NULL_VALUE_64;
+  int64_t row_to_return = current_row_;
+  current_row_ = hash_table_->NextRow(current_row_);
+  return row_to_return;
+}
+
+FlatHashProbeBuffer::~FlatHashProbeBuffer() { dealloc(buffer_); }
+
+void FlatHashProbeBuffer::Reserve(size_t key_width, size_t values_per_key, size_t tables) {
+  const size_t batch = FlatHashTable::kProbeBatch;
+  size_t words = batch * (values_per_key + 2 * tables);
+  size_t size = words * sizeof(int64_t) + batch * key_width;
+  if (size <= size_) {
+    values_ = reinterpret_cast<int64_t *>(buffer_);
+    first_rows_ = values_ + batch * values_per_key;
+    matched_rows_ = first_rows_ + batch * tables;
+    keys_ = buffer_ + words * sizeof(int64_t);
+    return;
+  }
+  dealloc(buffer_);
+  buffer_ = nullptr;
+  size_ = 0;
+  buffer_ = (unsigned char *)alloc(size, mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+  size_ = size;
+  Reserve(key_width, values_per_key, tables);
+}
+}  // namespace core
+}  // namespace Tianmu
@@ -0,0 +1,152 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_FLAT_HASH_TABLE_H_
+#define TIANMU_CORE_FLAT_HASH_TABLE_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mm/traceable_object.h"
+
+namespace Tianmu {
+namespace core {
+// Open addressing hash table used by the traversed side of ParallelHashJoiner.
+//
+// Distinct keys live in slots grouped by 16. Every slot has a control byte
+// holding 7 bits of the key hash (or kEmptySlot), so one group is filtered by
+// a single SIMD compare before any key is touched. Rows of the same key are
+// chained in insertion order in a separate row area, where row numbers are
+// dense and stay valid for SetTupleValue()/GetTupleValue().
+//
+// Keys of 1, 2, 4, 8 and 16 bytes are hashed and compared as integers; other
+// widths fall back to a byte-wise path. The table is filled by one thread and
+// may be probed by many threads afterwards.
+class FlatHashTable : public mm::TraceableObject {
+ public:
+  class Finder;
+
+  static constexpr int kGroupWidth = 16;
+  static constexpr int kProbeBatch = 64;  // keys hashed and prefetched together by LookupBatch()
+
+  FlatHashTable(const std::vector<int> &keys_length, const std::vector<int> &tuples_length);
+  ~FlatHashTable();
+
+  void Initialize(int64_t max_table_size, bool verbose = true);
+
+  // The hash used for the slots, exposed for partitioning keys before they are
+  // added. The low bits select the slot, the high ones are free for callers.
+  static uint64_t HashKey(const unsigned char *key, size_t width);
+
+  size_t GetKeyBufferWidth() const { return key_buf_width_; }
+  int64_t GetCount() const { return rows_limit_; }  // upper bound of row numbers
+  // Returns the row for the tuple of this key, or common::NULL_VALUE_64 if
+  // there is no space left.
+  int64_t AddKeyValue(const std::string &key_buffer, bool *too_many_conflicts = nullptr);
+  int64_t AddKeyValue(const unsigned char *key, bool *too_many_conflicts = nullptr);
+  void SetTupleValue(int col, int64_t row, int64_t value);
+  int64_t GetTupleValue(int col, int64_t row) const;
+
+  void Lookup(const unsigned char *key, int64_t *first_row, int64_t *matched_rows) const;
+  // Looks up `n` keys stored one after another (GetKeyBufferWidth() each).
+  void LookupBatch(const unsigned char *keys, int n, int64_t *first_rows, int64_t *matched_rows) const;
+
+ private:
+  struct Slot {
+    int64_t first_row;
+    int64_t last_row;
+    int64_t rows;
+  };
+
+  // Overridden from mm::TraceableObject:
+  mm::TO_TYPE TraceableType() const override { return mm::TO_TYPE::TO_TEMPORARY; }
+
+  template <int W>
+  int64_t Insert(const unsigned char *key, bool *too_many_conflicts);
+  template <int W>
+  int64_t FindSlot(const unsigned char *key, uint64_t hash) const;
+  template <int W>
+  void LookupBatchImpl(const unsigned char *keys, int n, int64_t *first_rows, int64_t *matched_rows) const;
+
+  int64_t &NextRow(int64_t row) const { return *(int64_t *)(rows_ + row * row_width_); }
+
+  std::vector<int> column_size_;
+  std::vector<int> column_offset_;  // offsets of tuple columns inside a row
+  size_t key_buf_width_ = 0;        // in bytes
+  size_t row_width_ = 0;            // in bytes: <next row><tuple_1>...<tuple_m>
+  int64_t rows_limit_ = 0;
+  int64_t rows_of_occupied_ = 0;
+  uint64_t groups_mask_ = 0;
+
+  unsigned char *buffer_ = nullptr;  // one allocation for all the areas below
+  Slot *slots_ = nullptr;
+  unsigned char *rows_ = nullptr;
+  unsigned char *slot_keys_ = nullptr;
+  signed char *ctrl_ = nullptr;
+
+  friend class Finder;
+};
+
+// Scratch space of one thread probing FlatHashTables by batches: the keys, the
+// matched side values of every key and the LookupBatch() results of every
+// table. It comes from the memory manager, as the tables do.
+class FlatHashProbeBuffer : public mm::TraceableObject {
+ public:
+  FlatHashProbeBuffer() = default;
+  FlatHashProbeBuffer(const FlatHashProbeBuffer &) = delete;
+  ~FlatHashProbeBuffer();
+
+  // Room for FlatHashTable::kProbeBatch keys, keeps the buffer if it is large enough.
+  void Reserve(size_t key_width, size_t values_per_key, size_t tables);
+
+  unsigned char *Keys() { return keys_; }
+  int64_t *Values() { return values_; }
+  int64_t *FirstRows(size_t table) { return first_rows_ + table * FlatHashTable::kProbeBatch; }
+  int64_t *MatchedRows(size_t table) { return matched_rows_ + table * FlatHashTable::kProbeBatch; }
+
+ private:
+  mm::TO_TYPE TraceableType() const override { return mm::TO_TYPE::TO_TEMPORARY; }
+
+  size_t size_ = 0;
+  unsigned char *buffer_ = nullptr;
+  int64_t *values_ = nullptr;
+  int64_t *first_rows_ = nullptr;
+  int64_t *matched_rows_ = nullptr;
+  unsigned char *keys_ = nullptr;
+};
+
+class FlatHashTable::Finder {
+ public:
+  Finder(FlatHashTable *hash_table, std::string *key_buffer);
+  // For the results of FlatHashTable::LookupBatch().
+  Finder(FlatHashTable *hash_table, int64_t first_row, int64_t matched_rows)
+      : hash_table_(hash_table), matched_rows_(matched_rows), current_row_(first_row) {}
+  ~Finder() = default;
+
+  int64_t GetMatchedRows() const { return matched_rows_; }
+  // If null rows, return common::NULL_VALUE_64.
+  int64_t GetNextRow();
+
+ private:
+  FlatHashTable *hash_table_ = nullptr;
+  int64_t matched_rows_ = 0;
+  int64_t current_row_ = 0;  // row value to be returned by the next GetNextRow() function
+};
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_FLAT_HASH_TABLE_H_
@@ -0,0 +1,113 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "group_spill.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Tianmu {
+namespace core {
+std::atomic<int64_t> GroupSpill::total_tuples_{0};
+std::atomic<int64_t> GroupSpill::total_bytes_{0};
+
+GroupSpill::GroupSpill(int level) : system::CacheableItem("JW", "GSP"), level_(std::min(level, kMaxLevel)) {}
+
+GroupSpill::~GroupSpill() {
+  for (auto &p : parts_) dealloc(p.buf);
+  dealloc(read_buf_);
+}
+
+void GroupSpill::Put(unsigned int hash, const unsigned char *rec, uint32_t len) {
+  Partition &p = parts_[PartitionOf(hash)];
+  uint32_t rec_size = sizeof(uint32_t) + len;
+  if (p.used + rec_size > kBlockSize)
+    Flush(p);
+  if (rec_size > kBlockSize) {  // e.g. long strings - the record is a block on its own
+    std::vector<unsigned char> big(rec_size);
+    std::memcpy(big.data(), &len, sizeof(uint32_t));
+    std::memcpy(big.data() + sizeof(uint32_t), rec, len);
+    CI_Put(no_blocks_, big.data(), rec_size);
+    p.blocks.emplace_back(no_blocks_++, rec_size);
+  } else {
+    if (p.buf == nullptr)
+      p.buf = (unsigned char *)alloc(kBlockSize, mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+    std::memcpy(p.buf + p.used, &len, sizeof(uint32_t));
+    std::memcpy(p.buf + p.used + sizeof(uint32_t), rec, len);
+    p.used += rec_size;
+  }
+  p.no_tuples++;
+  no_tuples_++;
+  no_bytes_ += rec_size;
+  total_tuples_++;
+  total_bytes_ += rec_size;
+}
+
+void GroupSpill::Flush(Partition &p) {
+  if (p.used == 0)
+    return;
+  CI_Put(no_blocks_, p.buf, p.used);
+  p.blocks.emplace_back(no_blocks_++, p.used);
+  p.used = 0;
+}
+
+void GroupSpill::Rewind(int part) {
+  read_part_ = part;
+  read_block_ = 0;
+  read_data_ = nullptr;
+  read_size_ = 0;
+  read_pos_ = 0;
+}
+
+bool GroupSpill::Next(const unsigned char *&rec, uint32_t &len) {
+  DEBUG_ASSERT(read_part_ >= 0);
+  Partition &p = parts_[read_part_];
+  while (read_pos_ >= read_size_) {
+    if (read_block_ < p.blocks.size()) {
+      auto [block, size] = p.blocks[read_block_];
+      if (size > read_buf_size_) {
+        dealloc(read_buf_);
+        read_buf_ = (unsigned char *)alloc(size, mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+        read_buf_size_ = size;
+      }
+      CI_Get(block, read_buf_);
+      read_data_ = read_buf_;
+      read_size_ = size;
+    } else if (read_block_ == p.blocks.size() && p.used > 0) {
+      read_data_ = p.buf;  // the last block was never written
+      read_size_ = p.used;
+    } else
+      return false;
+    read_block_++;
+    read_pos_ = 0;
+  }
+  std::memcpy(&len, read_data_ + read_pos_, sizeof(uint32_t));
+  rec = read_data_ + read_pos_ + sizeof(uint32_t);
+  read_pos_ += sizeof(uint32_t) + len;
+  return true;
+}
+
+void GroupSpill::ReleasePartition(int part) {
+  Partition &p = parts_[part];
+  dealloc(p.buf);
+  p.buf = nullptr;
+  p.used = 0;
+  if (read_part_ == part)
+    read_part_ = -1;
+}
+}  // namespace core
+}  // namespace Tianmu
@@ -0,0 +1,105 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_GROUP_SPILL_H_
+#define TIANMU_CORE_GROUP_SPILL_H_
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "mm/traceable_object.h"
+#include "system/cacheable_item.h"
+
+namespace Tianmu {
+namespace core {
+/*
+ * Overflow storage for a GROUP BY whose GroupTable is full.
+ *   - tuples are radix-partitioned by the hash of their grouping key, so every
+ *     group lands in exactly one partition and partitions may be aggregated
+ *     independently,
+ *   - each partition keeps one block in memory, full blocks are cached on disk,
+ *   - a partition which still does not fit is split again on the next hash
+ *     bits (a GroupSpill of the next level).
+ * Records are opaque byte strings, written once and read once.
+ * Blocks come from alloc(), so the memory manager limits apply. A level holds
+ * at most kPartitions write blocks and one read block, (kPartitions + 1) *
+ * kBlockSize = 8.5 MB, and each nested level being read adds as much.
+ * */
+
+class GroupSpill : private system::CacheableItem, public mm::TraceableObject {
+ public:
+  static constexpr int kPartitionBits = 4;
+  static constexpr int kPartitions = 1 << kPartitionBits;
+  static constexpr int kMaxLevel = 32 / kPartitionBits - 1;  // the last level reuses its bits
+
+  explicit GroupSpill(int level = 0);
+  ~GroupSpill();
+
+  void Put(unsigned int hash, const unsigned char *rec, uint32_t len);
+
+  void Rewind(int part);                                // start reading a partition
+  bool Next(const unsigned char *&rec, uint32_t &len);  // false at the end of the partition
+  void ReleasePartition(int part);                      // the partition will not be read again
+
+  int Level() const { return level_; }
+  int64_t NumOfTuples() const { return no_tuples_; }
+  int64_t NumOfTuples(int part) const { return parts_[part].no_tuples; }
+  int64_t ByteSize() const { return no_bytes_; }
+
+  // totals of all spills since startup, for status variables
+  static int64_t TotalTuples() { return total_tuples_; }
+  static int64_t TotalBytes() { return total_bytes_; }
+
+  mm::TO_TYPE TraceableType() const override { return mm::TO_TYPE::TO_TEMPORARY; }
+
+ private:
+  static constexpr uint32_t kBlockSize = 512_KB;
+
+  struct Partition {
+    std::vector<std::pair<int, uint32_t>> blocks;  // block number and size on disk
+    unsigned char *buf = nullptr;                  // the current (last) block
+    uint32_t used = 0;
+    int64_t no_tuples = 0;
+  };
+
+  int PartitionOf(unsigned int hash) const {
+    return (hash >> (32 - (level_ + 1) * kPartitionBits)) & (kPartitions - 1);
+  }
+  void Flush(Partition &p);
+
+  int level_;
+  Partition parts_[kPartitions];
+  int no_blocks_ = 0;
+  int64_t no_tuples_ = 0;
+  int64_t no_bytes_ = 0;
+
+  // reading
+  int read_part_ = -1;
+  size_t read_block_ = 0;  // next disk block; blocks.size() - the in-memory one
+  unsigned char *read_buf_ = nullptr;
+  uint32_t read_buf_size_ = 0;
+  const unsigned char *read_data_ = nullptr;
+  uint32_t read_size_ = 0;
+  uint32_t read_pos_ = 0;
+
+  static std::atomic<int64_t> total_tuples_;
+  static std::atomic<int64_t> total_bytes_;
+};
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_GROUP_SPILL_H_
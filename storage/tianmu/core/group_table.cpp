@@ -71,6 +71,8 @@ GroupTable::GroupTable(const GroupTable &sec) : mm::TraceableObject(sec) {
   aggregator.resize(no_attr);
   encoder.resize(no_attr);
   vc.resize(no_attr);
+  value_reader.resize(no_attr);
+  batch.resize(no_attr);
 
   if (sec.vm_tab)
     vm_tab.reset(sec.vm_tab->Clone());
@@ -163,6 +165,8 @@ void GroupTable::Initialize(int64_t max_no_groups, bool parallel_allowed) {
   aggregator.resize(no_attr);
   encoder.resize(no_attr);
   vc.resize(no_attr);
+  value_reader.resize(no_attr);
+  batch.resize(no_attr);
 
   // rewrite column descriptions (defaults, to be verified)
   int no_columns_with_distinct = 0;
@@ -465,6 +469,36 @@ void GroupTable::Merge(GroupTable &sec, Transaction *m_conn) {
   sec.vm_tab->Clear();
 }
 
+// Rows of sec are visited by GetNthRow() instead of its iterator and never released,
+// so several partitions of sec may be merged concurrently.
+void GroupTable::Merge(GroupTable &sec, int part, int no_parts, Transaction *m_conn) {
+  DEBUG_ASSERT(total_width == sec.total_width);
+  int64_t row;
+  not_full = true;  // ensure all the new values will be added
+  int64_t sec_rows = sec.vm_tab->NoRows();
+  for (int64_t n = 0; n < sec_rows; n++) {
+    int64_t sec_row = sec.vm_tab->GetNthRow(n);
+    if (m_conn->Killed())
+      throw common::KilledException();
+    if (grouping_and_UTF_width > 0) {
+      unsigned char *key = sec.vm_tab->GetGroupingRow(sec_row);
+      // high bits of the hash, as the low ones select a position in vm_tab
+      if (int((uint64_t(HashValue(key, grouping_buf_width)) * no_parts) >> 32) != part)
+        continue;
+      std::memcpy(input_buffer.data(), key, grouping_and_UTF_width);
+    } else if (part != 0)
+      continue;
+    FindCurrentRow(row);
+    if (row != common::NULL_VALUE_64) {
+      unsigned char *p1 = vm_tab->GetAggregationRow(row);
+      unsigned char *p2 = sec.vm_tab->GetAggregationRow(sec_row);
+      for (int col = no_grouping_attr; col < no_attr; col++) {
+        aggregator[col]->Merge(p1 + aggregated_col_offset[col], p2 + sec.aggregated_col_offset[col]);
+      }
+    }
+  }
+}
+
 int64_t GroupTable::GetValue64(int col, int64_t row) {
   if (col >= no_grouping_attr) {
     return aggregator[col]->GetValue64(vm_tab->GetAggregationRow(row) + aggregated_col_offset[col]);
@@ -588,7 +622,7 @@ bool GroupTable::PutAggregatedValue(int col, int64_t row, MIIterator &mit, int64
   } else {
     // note: it is too costly to check nulls separately (e.g. for complex
     // expressions)
-    int64_t v = vc[col]->GetValueInt64(mit);
+    int64_t v = value_reader[col].GetValueInt64(vc[col], mit);
     if (v == common::NULL_VALUE_64 && cur_aggr->IgnoreNulls())
       return true;
     cur_aggr->PutAggregatedValue(vm_tab->GetAggregationRow(row) + aggregated_col_offset[col], v, factor);
@@ -596,6 +630,45 @@ bool GroupTable::PutAggregatedValue(int col, int64_t row, MIIterator &mit, int64
   return true;
 }
 
+void GroupTable::PutBatchValue(int col, int64_t row, MIIterator &mit) {
+  DEBUG_ASSERT(!distinct[col]);
+  int64_t v = value_reader[col].GetValueInt64(vc[col], mit);
+  if (v == common::NULL_VALUE_64 && aggregator[col]->IgnoreNulls())
+    return;
+  AggregationBatch &b = batch[col];
+  unsigned char *p = vm_tab->GetAggregationRow(row) + aggregated_col_offset[col];
+  if (!b.bufs.empty() && b.bufs[0] != p)
+    b.one_group = false;
+  b.bufs.push_back(p);
+  b.vals.push_back(v);
+}
+
+void GroupTable::PutBatchValue(int col, int64_t row) {
+  DEBUG_ASSERT(operation[col] == GT_Aggregation::GT_COUNT);  // count aggregators ignore the value
+  AggregationBatch &b = batch[col];
+  unsigned char *p = vm_tab->GetAggregationRow(row) + aggregated_col_offset[col];
+  if (!b.bufs.empty() && b.bufs[0] != p)
+    b.one_group = false;
+  b.bufs.push_back(p);
+  b.vals.push_back(0);
+}
+
+void GroupTable::FlushBatch(int col, int64_t factor) {
+  AggregationBatch &b = batch[col];
+  if (b.bufs.empty())
+    return;
+  TIANMUAggregator *cur_aggr = aggregator[col];
+  if (factor == common::NULL_VALUE_64 && cur_aggr->FactorNeeded())
+    throw common::NotImplementedException("Aggregation overflow.");
+  if (b.one_group)
+    cur_aggr->PutAggregatedBatch(b.bufs[0], b.vals.data(), int(b.vals.size()), factor);
+  else
+    cur_aggr->PutAggregatedBatch(b.bufs.data(), b.vals.data(), int(b.vals.size()), factor);
+  b.bufs.clear();
+  b.vals.clear();
+  b.one_group = true;
+}
+
 bool GroupTable::PutAggregatedNull(int col, int64_t row, bool as_string) {
   if (distinct[col])
     return true;  // null omitted
@@ -610,6 +683,26 @@ bool GroupTable::PutAggregatedNull(int col, int64_t row, bool as_string) {
   return true;
 }
 
+bool GroupTable::PutAggregatedValue(int col, int64_t row, int64_t v, int64_t factor) {
+  DEBUG_ASSERT(!distinct[col]);
+  TIANMUAggregator *cur_aggr = aggregator[col];
+  if (factor == common::NULL_VALUE_64 && cur_aggr->FactorNeeded())
+    throw common::NotImplementedException("Aggregation overflow.");
+  if (v == common::NULL_VALUE_64 && cur_aggr->IgnoreNulls())
+    return true;
+  cur_aggr->PutAggregatedValue(vm_tab->GetAggregationRow(row) + aggregated_col_offset[col], v, factor);
+  return true;
+}
+
+bool GroupTable::PutAggregatedValue(int col, int64_t row, types::BString &v, int64_t factor) {
+  DEBUG_ASSERT(!distinct[col]);
+  TIANMUAggregator *cur_aggr = aggregator[col];
+  if (factor == common::NULL_VALUE_64 && cur_aggr->FactorNeeded())
+    throw common::NotImplementedException("Aggregation overflow.");
+  cur_aggr->PutAggregatedValue(vm_tab->GetAggregationRow(row) + aggregated_col_offset[col], v, factor);
+  return true;
+}
+
 bool GroupTable::PutCachedValue(int col, GroupDistinctCache &cache,
                                 bool as_text)  // for all numerical values
 {
@@ -102,6 +102,14 @@ class GroupTable : public mm::TraceableObject {
                           int64_t factor);  // for aggregations which do not need any value
   bool PutAggregatedValue(int col, int64_t row, MIIterator &mit, int64_t factor, bool as_string);
   bool PutAggregatedNull(int col, int64_t row, bool as_string);
+  // values read back from a GroupSpill (no distinct aggregations there)
+  bool PutAggregatedValue(int col, int64_t row, int64_t v, int64_t factor);
+  bool PutAggregatedValue(int col, int64_t row, types::BString &v, int64_t factor);
+  // batch aggregation: numerical values of a packrow are collected per column
+  // and passed to the aggregator at once by FlushBatch()
+  void PutBatchValue(int col, int64_t row, MIIterator &mit);
+  void PutBatchValue(int col, int64_t row);  // for aggregations which do not need any value
+  void FlushBatch(int col, int64_t factor);
   // mainly for numerics, and only some aggregators
   bool PutCachedValue(int col, GroupDistinctCache &cache, bool as_text);
   // a size of distinct cache for one value
@@ -111,8 +119,18 @@ class GroupTable : public mm::TraceableObject {
                      int64_t row);  // aggregate based on parameters stored in the aggregator
 
   void AddCurrentValueToCache(int col, GroupDistinctCache &cache);
+
+  // grouping key of the current input row, as used by GroupSpill
+  unsigned char *InputBuffer() { return input_buffer.data(); }
+  int InputKeyWidth() const { return grouping_and_UTF_width; }
+  unsigned int InputKeyHash() { return HashValue(input_buffer.data(), grouping_buf_width); }
+  // an input value of an aggregated column, as it would be aggregated
+  int64_t GetAggregatedInput64(int col, MIIterator &mit) { return value_reader[col].GetValueInt64(vc[col], mit); }
+  void GetAggregatedInputT(int col, types::BString &v, MIIterator &mit) { vc[col]->GetValueString(v, mit); }
   void Merge(GroupTable &sec,
              Transaction *m_conn);  // merge values from another (compatible) GroupTable
+  void Merge(GroupTable &sec, int part, int no_parts,
+             Transaction *m_conn);  // as above, but only groups of one hash partition
   // Group table output and info
 
   bool IsFull() { return !not_full; }  // no place left or all groups found
@@ -131,6 +149,7 @@ class GroupTable : public mm::TraceableObject {
   bool SetCurrentRow(int64_t row) { return vm_tab->SetCurrentRow(row); }
   bool SetEndRow(int64_t row) { return vm_tab->SetEndRow(row); }
   int64_t GetNoOfGroups() { return vm_tab->NoRows(); }
+  int64_t ByteSize() { return vm_tab->ByteSize(); }
   int MemoryBlocksLeft();  // no place left for more packs (soft limit)
 
   int64_t GetValue64(int col, int64_t row);  // columns have common numbering
@@ -215,6 +234,15 @@ class GroupTable : public mm::TraceableObject {
   std::vector<GT_Aggregation> operation;  // Note: these tables will be created in Initialize()
   std::vector<bool> distinct;
   std::vector<vcolumn::VirtualColumn *> vc;
+  std::vector<vcolumn::PackValueReader> value_reader;  // per-pack decoding of aggregated columns
+
+  // values collected by PutBatchValue(), not yet aggregated
+  struct AggregationBatch {
+    std::vector<unsigned char *> bufs;  // counters to be updated
+    std::vector<int64_t> vals;
+    bool one_group = true;  // all values go to bufs[0]
+  };
+  std::vector<AggregationBatch> batch;
   std::vector<TIANMUAggregator *> aggregator;  // a table of actual aggregators
   std::vector<ColumnBinEncoder *> encoder;     // encoders for grouping columns
 
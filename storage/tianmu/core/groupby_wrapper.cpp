@@ -269,13 +269,22 @@ void GroupByWrapper::Initialize(int64_t upper_approx_of_groups, bool parallel_al
 void GroupByWrapper::Merge(GroupByWrapper &sec) {
   int64_t old_groups = gt.GetNoOfGroups();
   gt.Merge(sec.gt, m_conn);
+
+  // note that no_groups may be different than gt->..., because it is global
+  no_groups += gt.GetNoOfGroups() - old_groups;
+}
+
+void GroupByWrapper::Merge(GroupByWrapper &sec, int part, int no_parts) {
+  int64_t old_groups = gt.GetNoOfGroups();
+  gt.Merge(sec.gt, part, no_parts, m_conn);
+  no_groups += gt.GetNoOfGroups() - old_groups;
+}
+
+void GroupByWrapper::MergeStatus(GroupByWrapper &sec) {
   if (tuple_left)
     tuple_left->And(*(sec.tuple_left));
   packrows_omitted += sec.packrows_omitted;
   packrows_part_omitted += sec.packrows_part_omitted;
-
-  // note that no_groups may be different than gt->..., because it is global
-  no_groups += gt.GetNoOfGroups() - old_groups;
 }
 
 bool GroupByWrapper::AggregatePackInOneGroup(int attr_no, MIIterator &mit, int64_t uniform_pos, int64_t rows_in_pack,
@@ -520,6 +529,20 @@ bool GroupByWrapper::PutAggregatedValue(int gr_a, int64_t pos, MIIterator &mit,
   return gt.PutAggregatedValue(gr_a, pos, mit, factor, (input_mode[gr_a] == GBInputMode::GBIMODE_AS_TEXT));
 }
 
+void GroupByWrapper::PutBatchValue(int gr_a, int64_t pos, MIIterator &mit) {
+  DEBUG_ASSERT(BatchAggregated(gr_a));
+  if (input_mode[gr_a] == GBInputMode::GBIMODE_NO_VALUE)
+    gt.PutBatchValue(gr_a, pos);
+  else
+    gt.PutBatchValue(gr_a, pos, mit);
+}
+
+void GroupByWrapper::FlushBatches(int64_t factor) {
+  for (int gr_a = no_grouping_attr; gr_a < no_attr; gr_a++)
+    if (BatchAggregated(gr_a))
+      gt.FlushBatch(gr_a, factor);
+}
+
 types::BString GroupByWrapper::GetValueT(int col, int64_t row) {
   if (is_lookup[col]) {
     int64_t v = GetValue64(col, row);  // lookup code
@@ -659,6 +682,78 @@ void GroupByWrapper::InitTupleLeft(int64_t n) {
   tuple_left->Set();
 }
 
+void GroupByWrapper::InitSpill() {
+  if (gt.MayBeParallel())  // i.e. no distinct or group_concat, which need all values of a group at once
+    spill = std::make_unique<GroupSpill>(DBUG_EVALUATE_IF("tianmu_groupby_spill_max_level", GroupSpill::kMaxLevel, 0));
+}
+
+// Record layout: grouping key (input buffer), then the input of every
+// aggregated column: nothing for count(*), int64 or a length-prefixed string
+// (kNullLength for null).
+static constexpr uint32_t kNullLength = 0xFFFFFFFF;
+
+void GroupByWrapper::SpillCurrentTuple(MIIterator &mit) {
+  DEBUG_ASSERT(spill);
+  auto append = [this](const void *p, size_t n) {
+    spill_record.insert(spill_record.end(), (const unsigned char *)p, (const unsigned char *)p + n);
+  };
+  spill_record.clear();
+  append(gt.InputBuffer(), gt.InputKeyWidth());
+  for (int gr_a = no_grouping_attr; gr_a < no_attr; gr_a++) {
+    DEBUG_ASSERT(input_mode[gr_a] != GBInputMode::GBIMODE_NOT_SET);
+    if (input_mode[gr_a] == GBInputMode::GBIMODE_NO_VALUE)
+      continue;
+    if (input_mode[gr_a] == GBInputMode::GBIMODE_AS_TEXT) {
+      types::BString v;
+      gt.GetAggregatedInputT(gr_a, v, mit);
+      uint32_t len = v.IsNull() ? kNullLength : uint32_t(v.len_);
+      append(&len, sizeof(uint32_t));
+      if (!v.IsNull())
+        append(v.GetDataBytesPointer(), v.len_);
+    } else {
+      int64_t v = gt.GetAggregatedInput64(gr_a, mit);
+      append(&v, sizeof(int64_t));
+    }
+  }
+  spill->Put(gt.InputKeyHash(), spill_record.data(), uint32_t(spill_record.size()));
+}
+
+bool GroupByWrapper::AggregateSpilled(const unsigned char *rec, uint32_t len, int64_t factor) {
+  std::memcpy(gt.InputBuffer(), rec, gt.InputKeyWidth());
+  int64_t pos = 0;
+  bool existed = gt.FindCurrentRow(pos);
+  if (pos == common::NULL_VALUE_64)
+    return false;
+  if (!existed) {
+    AddGroup();
+    if (!gt.IsFull() && gt.MemoryBlocksLeft() == 0)
+      gt.SetAsFull();
+  }
+  const unsigned char *p = rec + gt.InputKeyWidth();
+  for (int gr_a = no_grouping_attr; gr_a < no_attr; gr_a++) {
+    if (input_mode[gr_a] == GBInputMode::GBIMODE_NO_VALUE) {
+      gt.PutAggregatedValue(gr_a, pos, factor);
+    } else if (input_mode[gr_a] == GBInputMode::GBIMODE_AS_TEXT) {
+      uint32_t v_len;
+      std::memcpy(&v_len, p, sizeof(uint32_t));
+      p += sizeof(uint32_t);
+      types::BString v;
+      if (v_len != kNullLength) {
+        v = types::BString(v_len > 0 ? (const char *)p : "", v_len);
+        p += v_len;
+      }
+      gt.PutAggregatedValue(gr_a, pos, v, factor);
+    } else {
+      int64_t v;
+      std::memcpy(&v, p, sizeof(int64_t));
+      p += sizeof(int64_t);
+      gt.PutAggregatedValue(gr_a, pos, v, factor);
+    }
+  }
+  DEBUG_ASSERT(p == rec + len);
+  return true;
+}
+
 bool GroupByWrapper::AnyTuplesLeft(int64_t from, int64_t to) {
   if (tuple_left == nullptr)
     return true;
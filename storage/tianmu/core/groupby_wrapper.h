@@ -19,6 +19,7 @@
 #pragma once
 
 #include "core/group_distinct_cache.h"
+#include "core/group_spill.h"
 #include "core/group_table.h"
 #include "core/pack_guardian.h"
 #include "core/temp_table.h"
@@ -82,6 +83,13 @@ class GroupByWrapper final {
   void PutGroupingValue(int gr_a, MIIterator &mit) { gt.PutGroupingValue(gr_a, mit); }
   bool PutAggregatedNull(int gr_a, int64_t pos);
   bool PutAggregatedValue(int gr_a, int64_t pos, MIIterator &mit, int64_t factor = 1);
+  // numerical aggregations without DISTINCT may be collected for the whole
+  // packrow and aggregated at once by FlushBatches()
+  bool BatchAggregated(int gr_a) {
+    return input_mode[gr_a] != GBInputMode::GBIMODE_AS_TEXT && !gt.AttrDistinct(gr_a);
+  }
+  void PutBatchValue(int gr_a, int64_t pos, MIIterator &mit);
+  void FlushBatches(int64_t factor);
   // return value: true if value checked in, false if not (DISTINCT buffer
   // overflow) functionalities around DISTINCT
   bool PutAggregatedValueForCount(int gr_a, int64_t pos,
@@ -116,6 +124,7 @@ class GroupByWrapper final {
   bool SetCurrentRow(int64_t row) { return gt.SetCurrentRow(row); }
   bool SetEndRow(int64_t row) { return gt.SetEndRow(row); }
   int64_t GetRowsNo() { return gt.GetNoOfGroups(); }
+  int64_t ByteSize() { return gt.ByteSize(); }
   types::BString GetValueT(int col, int64_t row);
 
   void Clear();  // reset all contents of the grouping table and statistics
@@ -143,6 +152,8 @@ class GroupByWrapper final {
   bool IsOnePass() { return gt.IsOnePass(); }
   int MemoryBlocksLeft() { return gt.MemoryBlocksLeft(); }  // no place left for more packs (soft limit)
   void Merge(GroupByWrapper &sec);
+  void Merge(GroupByWrapper &sec, int part, int no_parts);  // one hash partition of groups, sec is read only
+  void MergeStatus(GroupByWrapper &sec);                    // rows left to aggregate and statistics
   // A filter of rows to be aggregated
 
   void InitTupleLeft(int64_t n);
@@ -167,6 +178,16 @@ class GroupByWrapper final {
   }
   bool TuplesGet(int64_t pos) { return (tuple_left == nullptr) || tuple_left->Get(pos); }
   int64_t TuplesNoOnes() { return (tuple_left == nullptr ? 0 : tuple_left->NumOfOnes()); }
+
+  // Tuples of new groups which do not fit into a full table are spilled to
+  // disk partitions instead of being left for the next pass
+  void InitSpill();
+  bool IsSpilling() { return spill != nullptr; }
+  GroupSpill *Spill() { return spill.get(); }
+  void SpillCurrentTuple(MIIterator &mit);
+  // false if the tuple is of a new group and there is no place left
+  bool AggregateSpilled(const unsigned char *rec, uint32_t len, int64_t factor);
+  unsigned int CurrentKeyHash() { return gt.InputKeyHash(); }
   // Locking packs etc.
 
   void LockPack(int i, MIIterator &mit);
@@ -216,6 +237,8 @@ class GroupByWrapper final {
   GroupTable gt;
 
   Filter *tuple_left;  // a mask of all rows still to be aggregated
+  std::unique_ptr<GroupSpill> spill;
+  std::vector<unsigned char> spill_record;
   bool just_distinct;
 };
 }  // namespace core
@@ -0,0 +1,37 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/join_bloom_filter.h"
+
+namespace Tianmu {
+namespace core {
+namespace {
+const int64_t kBitsPerKey = 12;  // about 0.5% of false positives
+}  // namespace
+
+JoinBloomFilter::JoinBloomFilter(int64_t expected_keys) {
+  blocks_count_ = std::max<int64_t>(expected_keys * kBitsPerKey / (kWordsPerBlock * 64), 1);
+  blocks_ = (uint64_t *)alloc(ByteSize(), mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+  std::memset(blocks_, 0, ByteSize());
+}
+
+JoinBloomFilter::~JoinBloomFilter() { dealloc(blocks_); }
+}  // namespace core
+}  // namespace Tianmu
@@ -0,0 +1,110 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_JOIN_BLOOM_FILTER_H_
+#define TIANMU_CORE_JOIN_BLOOM_FILTER_H_
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mm/traceable_object.h"
+
+namespace Tianmu {
+namespace core {
+// Blocked Bloom filter of the join keys of a hash join build side, checked on
+// the probe side before the rows are hashed into the join hash tables.
+//
+// Every key sets one bit in each of the 8 words of a single 64 byte block, so
+// a check touches one cache line. Keys are given by their 64-bit hash (see
+// FlatHashTable::HashKey()): the high half selects the block, the low half the
+// bits. Insert() may be called by many threads at once. The blocks come from
+// the memory manager.
+class JoinBloomFilter : public mm::TraceableObject {
+ public:
+  explicit JoinBloomFilter(int64_t expected_keys);
+  JoinBloomFilter(const JoinBloomFilter &) = delete;
+  ~JoinBloomFilter();
+
+  void Insert(uint64_t hash) {
+    uint64_t *block = Block(hash);
+    for (int i = 0; i < kWordsPerBlock; ++i) {
+      uint64_t bit = BitOf(hash, i);
+      if ((__atomic_load_n(&block[i], __ATOMIC_RELAXED) & bit) == 0)
+        __atomic_fetch_or(&block[i], bit, __ATOMIC_RELAXED);
+    }
+  }
+  bool MayContain(uint64_t hash) const {
+    const uint64_t *block = Block(hash);
+    for (int i = 0; i < kWordsPerBlock; ++i)
+      if ((block[i] & BitOf(hash, i)) == 0)
+        return false;
+    return true;
+  }
+  size_t ByteSize() const { return blocks_count_ * kWordsPerBlock * sizeof(uint64_t); }
+
+ private:
+  static constexpr int kWordsPerBlock = 8;
+  static constexpr uint32_t kSalts[kWordsPerBlock] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                      0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+  mm::TO_TYPE TraceableType() const override { return mm::TO_TYPE::TO_TEMPORARY; }
+
+  static uint64_t BitOf(uint64_t hash, int word) {
+    return uint64_t(1) << ((uint32_t(hash) * kSalts[word]) >> 26);
+  }
+  uint64_t *Block(uint64_t hash) { return blocks_ + ((hash >> 32) * blocks_count_ >> 32) * kWordsPerBlock; }
+  const uint64_t *Block(uint64_t hash) const {
+    return blocks_ + ((hash >> 32) * blocks_count_ >> 32) * kWordsPerBlock;
+  }
+
+  uint64_t blocks_count_ = 0;
+  uint64_t *blocks_ = nullptr;
+};
+
+// A JoinBloomFilter as used by one probing thread. Checking costs a hash per
+// row, so the probe stops checking when the first rows show the filter hardly
+// rejects anything.
+class JoinBloomProbe {
+ public:
+  explicit JoinBloomProbe(const JoinBloomFilter *filter = nullptr) : filter_(filter) {}
+
+  bool Enabled() const { return filter_ != nullptr; }
+  int64_t RejectedRows() const { return rejected_rows_; }
+  bool MayContain(uint64_t hash) {
+    if (filter_->MayContain(hash))
+      return CountRow(true);
+    rejected_rows_++;
+    return CountRow(false);
+  }
+
+ private:
+  static constexpr int64_t kSampleRows = 65536;
+
+  bool CountRow(bool result) {
+    if (++checked_rows_ == kSampleRows && rejected_rows_ < kSampleRows / 16)
+      filter_ = nullptr;
+    return result;
+  }
+
+  const JoinBloomFilter *filter_ = nullptr;
+  int64_t checked_rows_ = 0;
+  int64_t rejected_rows_ = 0;
+};
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_JOIN_BLOOM_FILTER_H_
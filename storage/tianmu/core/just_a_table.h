@@ -40,6 +40,8 @@ class JustATable : public std::enable_shared_from_this<JustATable> {
   }  // null pack number (interpreted properly)
   virtual void LockPackForUse(unsigned attr, unsigned pack_no) = 0;
   virtual void UnlockPackFromUse(unsigned attr, unsigned pack_no) = 0;
+  // hint that the packs will be locked soon; by default nothing is read ahead
+  virtual void PrefetchPacks([[maybe_unused]] unsigned attr, [[maybe_unused]] const std::vector<int> &packs) {}
   virtual int64_t NumOfObj() const = 0;
   virtual uint NumOfAttrs() const = 0;
   virtual uint NumOfDisplaybleAttrs() const = 0;
@@ -0,0 +1,80 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "core/like_matcher.h"
+
+#include <cstring>
+
+#include "util/simd_filter.h"
+
+namespace Tianmu {
+namespace core {
+
+LikeMatcher::LikeMatcher(const types::BString &pattern, char escape) : escape_(escape) {
+  pattern_.PersistentCopy(pattern);
+  std::vector<std::string> parts(1);
+  for (uint i = 0; i < pattern.len_; i++) {
+    char c = pattern[i];
+    if (c == '_' || c == escape) {
+      simple_ = false;
+      break;
+    }
+    if (c == '%')
+      parts.emplace_back();
+    else {
+      parts.back() += c;
+      min_len_++;
+    }
+  }
+  if (!simple_)
+    return;
+  exact_ = (parts.size() == 1);  // also an empty pattern, matching only an empty value
+  prefix_ = parts.front();
+  if (parts.size() > 1) {
+    suffix_ = parts.back();
+    for (size_t i = 1; i + 1 < parts.size(); i++)
+      if (!parts[i].empty())
+        middle_.push_back(parts[i]);
+  }
+}
+
+bool LikeMatcher::Match(const char *s, size_t len) const {
+  if (!simple_) {
+    types::BString v(len == 0 ? "" : s, len);
+    return v.Like(pattern_, escape_);
+  }
+  if (len < min_len_)
+    return false;
+  if (exact_)
+    return len == prefix_.size() && std::memcmp(s, prefix_.data(), len) == 0;
+  if (std::memcmp(s, prefix_.data(), prefix_.size()) != 0)
+    return false;
+  size_t end = len - suffix_.size();  // min_len_ keeps prefix and suffix apart
+  if (std::memcmp(s + end, suffix_.data(), suffix_.size()) != 0)
+    return false;
+  size_t begin = prefix_.size();
+  for (auto &part : middle_) {
+    const char *found = utils::simd::FindSubstring(s + begin, end - begin, part.data(), part.size());
+    if (found == nullptr)
+      return false;
+    begin = found - s + part.size();
+  }
+  return true;
+}
+
+}  // namespace core
+}  // namespace Tianmu
@@ -0,0 +1,58 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_LIKE_MATCHER_H_
+#define TIANMU_CORE_LIKE_MATCHER_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "types/tianmu_data_types.h"
+
+namespace Tianmu {
+namespace core {
+
+/*! \brief Binary LIKE pattern compiled once per pack.
+ *
+ * Patterns using '%' as the only wildcard ('abc', 'abc%', '%abc', '%abc%',
+ * 'a%b%c', ...) are split into literal parts matched with memcmp and a SIMD
+ * substring search; the result is the same as BString::Like(). Patterns with
+ * '_' or the escape character are matched by BString::Like().
+ */
+class LikeMatcher final {
+ public:
+  LikeMatcher(const types::BString &pattern, char escape);
+
+  bool Match(const char *s, size_t len) const;
+  // the number of fixed characters, no shorter value matches
+  size_t MinLen() const { return min_len_; }
+
+ private:
+  types::BString pattern_;
+  char escape_;
+  bool simple_ = true;  // only '%' wildcards
+  bool exact_ = false;  // no wildcards at all
+  size_t min_len_ = 0;
+  std::string prefix_;  // literal before the first '%', empty if none
+  std::string suffix_;  // literal after the last '%', empty if none
+  std::vector<std::string> middle_;
+};
+
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_LIKE_MATCHER_H_
@@ -0,0 +1,70 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "morsel_queue.h"
+
+#include "common/assert.h"
+
+namespace Tianmu {
+namespace core {
+MorselQueue::MorselQueue(int no_items, int no_workers)
+    : no_workers_(no_workers), ranges_(new std::atomic<uint64_t>[no_workers]) {
+  DEBUG_ASSERT(no_workers > 0 && no_items >= 0);
+  for (int i = 0; i < no_workers; i++)
+    ranges_[i] = Range(uint32_t(int64_t(no_items) * i / no_workers), uint32_t(int64_t(no_items) * (i + 1) / no_workers));
+}
+
+bool MorselQueue::Next(int worker, int &item) {
+  std::atomic<uint64_t> &own = ranges_[worker];
+  uint64_t r = own.load();
+  while (Begin(r) < End(r)) {
+    if (own.compare_exchange_weak(r, Range(Begin(r) + 1, End(r)))) {
+      item = Begin(r);
+      return true;
+    }
+  }
+  return Steal(worker, item);
+}
+
+bool MorselQueue::Steal(int worker, int &item) {
+  for (;;) {
+    int victim = -1;
+    uint64_t r = 0;
+    uint32_t longest = 0;
+    for (int i = 0; i < no_workers_; i++) {
+      uint64_t cur = ranges_[i].load();
+      if (End(cur) - Begin(cur) > longest) {
+        longest = End(cur) - Begin(cur);
+        victim = i;
+        r = cur;
+      }
+    }
+    if (victim == -1)
+      return false;
+    // the victim keeps the front half (it is going there), the thief takes the rest
+    uint32_t mid = Begin(r) + (End(r) - Begin(r)) / 2;
+    if (ranges_[victim].compare_exchange_strong(r, Range(Begin(r), mid))) {
+      item = mid;
+      // our own range is empty, so nobody else can change it meanwhile
+      ranges_[worker].store(Range(mid + 1, End(r)));
+      no_steals_++;
+      return true;
+    }
+  }
+}
+}  // namespace core
+}  // namespace Tianmu
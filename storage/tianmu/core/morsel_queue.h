@@ -0,0 +1,57 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_MORSEL_QUEUE_H_
+#define TIANMU_CORE_MORSEL_QUEUE_H_
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace Tianmu {
+namespace core {
+/*
+ * Work distribution for parallel scans: items (e.g. packrows) 0..n-1 are
+ * split into one contiguous range per worker. A worker takes items from the
+ * front of its own range; when it is empty, it steals the back half of the
+ * largest range left. Each range is one atomic word, so neither the owner nor
+ * a thief needs a lock.
+ * Items taken by one worker are increasing, except after a steal.
+ * */
+
+class MorselQueue {
+ public:
+  MorselQueue(int no_items, int no_workers);
+  ~MorselQueue() = default;
+
+  bool Next(int worker, int &item);  // false if nothing is left for anybody
+  int64_t NumOfSteals() const { return no_steals_; }
+
+ private:
+  static uint64_t Range(uint32_t begin, uint32_t end) { return (uint64_t(begin) << 32) | end; }
+  static uint32_t Begin(uint64_t r) { return uint32_t(r >> 32); }
+  static uint32_t End(uint64_t r) { return uint32_t(r); }
+
+  bool Steal(int worker, int &item);
+
+  int no_workers_;
+  std::unique_ptr<std::atomic<uint64_t>[]> ranges_;
+  std::atomic<int64_t> no_steals_{0};
+};
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_MORSEL_QUEUE_H_
@@ -0,0 +1,714 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "native_expression.h"
+
+#include <cmath>
+
+#include "common/assert.h"
+#include "core/item_tianmu_field.h"
+#include "item_cmpfunc.h"
+#include "item_timefunc.h"
+#include "types/tianmu_data_types.h"
+
+namespace Tianmu {
+namespace core {
+namespace {
+// the largest magnitude of an int64_t converted to double without rounding
+constexpr int64_t kMaxExactDouble = int64_t(1) << 53;
+constexpr int kMaxDecimalScale = 18;
+}  // namespace
+
+std::unique_ptr<NativeExpression> NativeExpression::Build(MysqlExpression &expr,
+                                                          const std::map<VarID, ColumnType> &columns,
+                                                          const ColumnType &result_type) {
+  BuildContext ctx{columns, {}};
+  for (auto &it : expr.GetTIANMUItems())
+    for (auto &field : it.second) ctx.fields.emplace(field, it.first);
+
+  std::unique_ptr<NativeExpression> native(new NativeExpression());
+  int root = native->Compile(expr.GetItem(), ctx);
+  if (root < 0)
+    return nullptr;
+
+  // the same conversion as MysqlExpression::Evaluate() does for the result
+  switch (expr.GetItem()->result_type()) {
+    case INT_RESULT:
+      native->result_type_ = ValueType::INT;
+      break;
+    case DECIMAL_RESULT:
+      native->result_type_ = ValueType::DECIMAL;
+      break;
+    case REAL_RESULT:
+      native->result_type_ = ValueType::REAL;
+      break;
+    default:
+      return nullptr;
+  }
+  root = native->Convert(root, native->result_type_, result_type.GetScale());
+  if (root < 0)
+    return nullptr;
+  DEBUG_ASSERT(root == int(native->ops_.size()) - 1);
+  return native;
+}
+
+bool NativeExpression::ResultType(Item *item, ValueType &type, int &scale) {
+  if (item->unsigned_flag)
+    return false;
+  scale = 0;
+  switch (item->result_type()) {
+    case INT_RESULT:
+      type = ValueType::INT;
+      return true;
+    case DECIMAL_RESULT:
+      type = ValueType::DECIMAL;
+      scale = item->decimals;
+      return scale <= kMaxDecimalScale;
+    case REAL_RESULT:
+      type = ValueType::REAL;
+      return true;
+    default:
+      return false;
+  }
+}
+
+int NativeExpression::Add(Operation &&operation) {
+  ops_.push_back(std::move(operation));
+  return int(ops_.size()) - 1;
+}
+
+int NativeExpression::Convert(int arg, ValueType type, int scale) {
+  if (arg < 0)
+    return -1;
+  const Operation &a = ops_[arg];
+  if (a.type == ValueType::DATETIME || type == ValueType::DATETIME)
+    return -1;
+  if (a.type == type && (type != ValueType::DECIMAL || a.scale == scale))
+    return arg;
+  if (a.type == ValueType::INT && type == ValueType::DECIMAL && scale == 0)
+    return arg;  // the same encoding
+
+  Operation o;
+  o.type = type;
+  o.args = {arg};
+  if (type == ValueType::REAL) {
+    o.op = Op::TO_REAL;
+    return Add(std::move(o));
+  }
+  if (type == ValueType::INT || a.type == ValueType::REAL)
+    return -1;  // MySQL would round
+  // INT => DECIMAL or a DECIMAL with more digits after the point
+  int from_scale = (a.type == ValueType::DECIMAL ? a.scale : 0);
+  if (scale < from_scale)
+    return -1;
+  o.op = Op::TO_DECIMAL;
+  o.scale = scale;
+  return Add(std::move(o));
+}
+
+int NativeExpression::IsTrue(int arg) {
+  if (arg < 0 || ops_[arg].type == ValueType::DATETIME)
+    return -1;
+  Operation o;
+  o.op = Op::IS_TRUE;
+  o.type = ValueType::INT;
+  o.args = {arg};
+  return Add(std::move(o));
+}
+
+int NativeExpression::Compile(Item *item, BuildContext &ctx) {
+  switch (static_cast<int>(item->type())) {
+    case static_cast<int>(Item_tianmufield::enumTIANMUFiledItem::TIANMUFIELD_ITEM):
+      return CompileColumn(item, ctx);
+    case Item::INT_ITEM:
+    case Item::REAL_ITEM:
+    case Item::DECIMAL_ITEM:
+    case Item::NULL_ITEM:
+      return CompileConstant(item);
+    case Item::FUNC_ITEM:
+      return CompileFunction(static_cast<Item_func *>(item), ctx);
+    case Item::COND_ITEM: {
+      Item_func::Functype type = static_cast<Item_cond *>(item)->functype();
+      if (type == Item_func::COND_AND_FUNC)
+        return CompileCondition(Op::AND, item, ctx);
+      if (type == Item_func::COND_OR_FUNC)
+        return CompileCondition(Op::OR, item, ctx);
+      return -1;
+    }
+    case Item::REF_ITEM: {
+      Item_ref *iref = static_cast<Item_ref *>(item);
+      if (!iref->ref || !*iref->ref)
+        return -1;
+      return Compile(*iref->ref, ctx);
+    }
+    default:
+      return -1;
+  }
+}
+
+int NativeExpression::CompileColumn(Item *item, BuildContext &ctx) {
+  Item_tianmufield *field = static_cast<Item_tianmufield *>(item);
+  auto var = ctx.fields.find(item);
+  if (field->IsAggregation() || var == ctx.fields.end())
+    return -1;
+  auto column = ctx.columns.find(var->second);
+  if (column == ctx.columns.end())
+    return -1;
+  const ColumnType &ct = column->second;
+  if (ct.Lookup() || ct.GetUnsigned())
+    return -1;
+
+  Operation o;
+  o.op = Op::COLUMN;
+  switch (ct.GetTypeName()) {
+    case common::ColumnType::BYTEINT:
+    case common::ColumnType::SMALLINT:
+    case common::ColumnType::MEDIUMINT:
+    case common::ColumnType::INT:
+    case common::ColumnType::BIGINT:
+      o.type = ValueType::INT;
+      break;
+    case common::ColumnType::NUM:
+      if (ct.GetScale() > kMaxDecimalScale)
+        return -1;
+      o.type = ValueType::DECIMAL;
+      o.scale = ct.GetScale();
+      break;
+    case common::ColumnType::REAL:
+    case common::ColumnType::FLOAT:
+      o.type = ValueType::REAL;
+      break;
+    case common::ColumnType::DATE:
+    case common::ColumnType::DATETIME:  // TIMESTAMP needs a time zone conversion
+      o.type = ValueType::DATETIME;
+      o.datetime_type = ct.GetTypeName();
+      break;
+    default:
+      return -1;
+  }
+
+  // every variable is read once, even if the tree refers to it many times
+  for (size_t i = 0; i < inputs_.size(); i++)
+    if (inputs_[i] == var->second)
+      return input_ops_[i];
+  inputs_.push_back(var->second);
+  input_ops_.push_back(Add(std::move(o)));
+  return input_ops_.back();
+}
+
+int NativeExpression::CompileConstant(Item *item) {
+  Operation o;
+  o.op = Op::CONST;
+  if (item->type() == Item::NULL_ITEM) {
+    o.type = ValueType::INT;
+    o.constant_null = true;
+    return Add(std::move(o));
+  }
+  if (!ResultType(item, o.type, o.scale))
+    return -1;
+  switch (o.type) {
+    case ValueType::INT:
+      o.constant = item->val_int();
+      break;
+    case ValueType::REAL: {
+      double v = item->val_real();
+      o.constant = MysqlExpression::AsValue(v);
+    } break;
+    case ValueType::DECIMAL:
+      try {
+        std::shared_ptr<ValueOrNull> v = MysqlExpression::ItemDecimal2ValueOrNull(item, o.scale);
+        o.constant = v->Get64();
+      } catch (common::Exception &) {
+        return -1;  // does not fit in 18 digits
+      }
+      break;
+    default:
+      return -1;
+  }
+  o.constant_null = item->null_value;
+  return Add(std::move(o));
+}
+
+int NativeExpression::CompileFunction(Item_func *item, BuildContext &ctx) {
+  Item **args = item->arguments();
+  uint arg_count = item->argument_count();
+  switch (item->functype()) {
+    case Item_func::EQ_FUNC:
+      return CompileComparison(Op::EQ, item, ctx);
+    case Item_func::NE_FUNC:
+      return CompileComparison(Op::NE, item, ctx);
+    case Item_func::LT_FUNC:
+      return CompileComparison(Op::LT, item, ctx);
+    case Item_func::LE_FUNC:
+      return CompileComparison(Op::LE, item, ctx);
+    case Item_func::GT_FUNC:
+      return CompileComparison(Op::GT, item, ctx);
+    case Item_func::GE_FUNC:
+      return CompileComparison(Op::GE, item, ctx);
+    case Item_func::NOT_FUNC:
+      return CompileCondition(Op::NOT, item, ctx);
+    default:
+      break;
+  }
+
+  Operation o;
+  if (!ResultType(item, o.type, o.scale))
+    return -1;
+
+  if (dynamic_cast<Item_func_plus *>(item) || dynamic_cast<Item_func_minus *>(item) ||
+      dynamic_cast<Item_func_mul *>(item)) {
+    if (arg_count != 2)
+      return -1;
+    o.op = dynamic_cast<Item_func_plus *>(item) ? Op::ADD : (dynamic_cast<Item_func_minus *>(item) ? Op::SUB : Op::MUL);
+    int a = Compile(args[0], ctx);
+    int b = (a < 0 ? -1 : Compile(args[1], ctx));
+    if (b < 0)
+      return -1;
+    if (o.op == Op::MUL && o.type == ValueType::DECIMAL) {
+      // the scales of the arguments add up
+      if (ops_[a].type == ValueType::REAL || ops_[b].type == ValueType::REAL ||
+          ops_[a].type == ValueType::DATETIME || ops_[b].type == ValueType::DATETIME ||
+          ops_[a].scale + ops_[b].scale != o.scale)
+        return -1;
+    } else {
+      a = Convert(a, o.type, o.scale);
+      b = Convert(b, o.type, o.scale);
+      if (a < 0 || b < 0)
+        return -1;
+    }
+    o.args = {a, b};
+    return Add(std::move(o));
+  }
+
+  if (item->functype() == Item_func::NEG_FUNC) {
+    int a = Convert(Compile(args[0], ctx), o.type, o.scale);
+    if (a < 0)
+      return -1;
+    o.op = Op::NEG;
+    o.args = {a};
+    return Add(std::move(o));
+  }
+
+  if (dynamic_cast<Item_func_if *>(item)) {
+    if (arg_count != 3)
+      return -1;
+    int cond = IsTrue(Compile(args[0], ctx));
+    int a = (cond < 0 ? -1 : Convert(Compile(args[1], ctx), o.type, o.scale));
+    int b = (a < 0 ? -1 : Convert(Compile(args[2], ctx), o.type, o.scale));
+    if (b < 0)
+      return -1;
+    o.op = Op::IF;
+    o.args = {cond, a, b};
+    return Add(std::move(o));
+  }
+
+  if (dynamic_cast<Item_func_coalesce *>(item)) {  // IFNULL() too
+    o.op = Op::COALESCE;
+    for (uint i = 0; i < arg_count; i++) {
+      int a = Convert(Compile(args[i], ctx), o.type, o.scale);
+      if (a < 0)
+        return -1;
+      o.args.push_back(a);
+    }
+    return o.args.empty() ? -1 : Add(std::move(o));
+  }
+
+  if (dynamic_cast<Item_func_year *>(item))
+    o.op = Op::YEAR;
+  else if (dynamic_cast<Item_func_quarter *>(item))
+    o.op = Op::QUARTER;
+  else if (dynamic_cast<Item_func_month *>(item))
+    o.op = Op::MONTH;
+  else if (dynamic_cast<Item_func_dayofmonth *>(item))
+    o.op = Op::DAY;
+  else if (dynamic_cast<Item_func_hour *>(item))
+    o.op = Op::HOUR;
+  else if (dynamic_cast<Item_func_minute *>(item))
+    o.op = Op::MINUTE;
+  else if (dynamic_cast<Item_func_second *>(item))
+    o.op = Op::SECOND;
+  else
+    return -1;
+  int a = (arg_count == 1 && o.type == ValueType::INT ? Compile(args[0], ctx) : -1);
+  if (a < 0 || ops_[a].type != ValueType::DATETIME)
+    return -1;
+  // MySQL takes the time of a DATE from bits which are not the time of day
+  if (ops_[a].datetime_type != common::ColumnType::DATETIME &&
+      (o.op == Op::HOUR || o.op == Op::MINUTE || o.op == Op::SECOND))
+    return -1;
+  o.args = {a};
+  return Add(std::move(o));
+}
+
+int NativeExpression::CompileComparison(Op op, Item_func *item, BuildContext &ctx) {
+  if (item->argument_count() != 2)
+    return -1;
+  int a = Compile(item->arguments()[0], ctx);
+  int b = (a < 0 ? -1 : Compile(item->arguments()[1], ctx));
+  if (b < 0 || ops_[a].type == ValueType::DATETIME || ops_[b].type == ValueType::DATETIME)
+    return -1;
+
+  // the comparison type of Arg_comparator for numbers
+  ValueType type = ValueType::INT;
+  int scale = 0;
+  if (ops_[a].type == ValueType::REAL || ops_[b].type == ValueType::REAL) {
+    // with fixed decimals on both sides MySQL compares with a tolerance
+    if (item->arguments()[0]->decimals < NOT_FIXED_DEC && item->arguments()[1]->decimals < NOT_FIXED_DEC)
+      return -1;
+    type = ValueType::REAL;
+  } else if (ops_[a].type == ValueType::DECIMAL || ops_[b].type == ValueType::DECIMAL) {
+    type = ValueType::DECIMAL;
+    scale = std::max(ops_[a].type == ValueType::DECIMAL ? ops_[a].scale : 0,
+                     ops_[b].type == ValueType::DECIMAL ? ops_[b].scale : 0);
+  }
+  a = Convert(a, type, scale);
+  b = Convert(b, type, scale);
+  if (a < 0 || b < 0)
+    return -1;
+  Operation o;
+  o.op = op;
+  o.type = ValueType::INT;
+  o.args = {a, b};
+  return Add(std::move(o));
+}
+
+int NativeExpression::CompileCondition(Op op, Item *item, BuildContext &ctx) {
+  Operation o;
+  o.op = op;
+  o.type = ValueType::INT;
+  if (op == Op::NOT) {
+    Item_func *ifunc = static_cast<Item_func *>(item);
+    int a = (ifunc->argument_count() == 1 ? IsTrue(Compile(ifunc->arguments()[0], ctx)) : -1);
+    if (a < 0)
+      return -1;
+    o.args = {a};
+    return Add(std::move(o));
+  }
+  List_iterator<Item> li(*static_cast<Item_cond *>(item)->argument_list());
+  Item *arg;
+  while ((arg = li++)) {
+    int a = IsTrue(Compile(arg, ctx));
+    if (a < 0)
+      return -1;
+    o.args.push_back(a);
+  }
+  return o.args.empty() ? -1 : Add(std::move(o));
+}
+
+void NativeExpression::Reset(Block &block, size_t rows) const {
+  block.values.resize(ops_.size());
+  block.nulls.resize(ops_.size());
+  for (size_t i = 0; i < ops_.size(); i++) {
+    block.values[i].resize(rows);
+    block.nulls[i].resize(rows);
+  }
+  block.size = rows;
+}
+
+void NativeExpression::EvaluateArithmetic(const Operation &o, Block &block, bool &failed) const {
+  size_t n = block.size;
+  int64_t *res = block.values[&o - ops_.data()].data();
+  char *res_null = block.nulls[&o - ops_.data()].data();
+  const int64_t *a = block.values[o.args[0]].data();
+  const char *a_null = block.nulls[o.args[0]].data();
+
+  if (o.op == Op::NEG) {
+    bool overflow = false;
+    for (size_t i = 0; i < n; i++) {
+      res_null[i] = a_null[i];
+      if (o.type == ValueType::REAL) {
+        MysqlExpression::AsReal(res[i]) = -MysqlExpression::AsReal(a[i]);
+      } else {
+        overflow |= (a[i] == INT64_MIN) & !a_null[i];
+        res[i] = int64_t(0 - uint64_t(a[i]));
+      }
+    }
+    failed |= overflow;
+    return;
+  }
+
+  const int64_t *b = block.values[o.args[1]].data();
+  const char *b_null = block.nulls[o.args[1]].data();
+  for (size_t i = 0; i < n; i++) res_null[i] = a_null[i] | b_null[i];
+
+  bool overflow = false;
+  if (o.type == ValueType::REAL) {
+    const double *x = &MysqlExpression::AsReal(a[0]);
+    const double *y = &MysqlExpression::AsReal(b[0]);
+    double *r = &MysqlExpression::AsReal(res[0]);
+    switch (o.op) {
+      case Op::ADD:
+        for (size_t i = 0; i < n; i++) r[i] = x[i] + y[i];
+        break;
+      case Op::SUB:
+        for (size_t i = 0; i < n; i++) r[i] = x[i] - y[i];
+        break;
+      default:
+        for (size_t i = 0; i < n; i++) r[i] = x[i] * y[i];
+        break;
+    }
+    // MySQL reports an error for an infinite result
+    for (size_t i = 0; i < n; i++) overflow |= !std::isfinite(r[i]) & !res_null[i];
+  } else {
+    switch (o.op) {
+      case Op::ADD:
+        for (size_t i = 0; i < n; i++) overflow |= __builtin_add_overflow(a[i], b[i], &res[i]) & !res_null[i];
+        break;
+      case Op::SUB:
+        for (size_t i = 0; i < n; i++) overflow |= __builtin_sub_overflow(a[i], b[i], &res[i]) & !res_null[i];
+        break;
+      default:
+        for (size_t i = 0; i < n; i++) overflow |= __builtin_mul_overflow(a[i], b[i], &res[i]) & !res_null[i];
+        break;
+    }
+  }
+  failed |= overflow;
+}
+
+void NativeExpression::EvaluateComparison(const Operation &o, Block &block) const {
+  size_t n = block.size;
+  int64_t *res = block.values[&o - ops_.data()].data();
+  char *res_null = block.nulls[&o - ops_.data()].data();
+  const int64_t *a = block.values[o.args[0]].data();
+  const int64_t *b = block.values[o.args[1]].data();
+  const char *a_null = block.nulls[o.args[0]].data();
+  const char *b_null = block.nulls[o.args[1]].data();
+  for (size_t i = 0; i < n; i++) res_null[i] = a_null[i] | b_null[i];
+
+  auto compare = [n, res, &o](const auto *x, const auto *y) {
+    switch (o.op) {
+      case Op::EQ:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] == y[i]);
+        break;
+      case Op::NE:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] != y[i]);
+        break;
+      case Op::LT:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] < y[i]);
+        break;
+      case Op::LE:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] <= y[i]);
+        break;
+      case Op::GT:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] > y[i]);
+        break;
+      default:
+        for (size_t i = 0; i < n; i++) res[i] = (x[i] >= y[i]);
+        break;
+    }
+  };
+  if (ops_[o.args[0]].type == ValueType::REAL)
+    compare(&MysqlExpression::AsReal(a[0]), &MysqlExpression::AsReal(b[0]));
+  else
+    compare(a, b);
+}
+
+void NativeExpression::EvaluateDateTime(const Operation &o, Block &block) const {
+  size_t n = block.size;
+  int64_t *res = block.values[&o - ops_.data()].data();
+  char *res_null = block.nulls[&o - ops_.data()].data();
+  const int64_t *a = block.values[o.args[0]].data();
+  const char *a_null = block.nulls[o.args[0]].data();
+  common::ColumnType at = ops_[o.args[0]].datetime_type;
+  for (size_t i = 0; i < n; i++) {
+    res_null[i] = a_null[i];
+    if (a_null[i]) {
+      res[i] = 0;
+      continue;
+    }
+    types::TianmuDateTime dt(a[i], at);
+    switch (o.op) {
+      case Op::YEAR:
+        res[i] = dt.Year();
+        break;
+      case Op::QUARTER:
+        res[i] = (dt.Month() + 2) / 3;
+        break;
+      case Op::MONTH:
+        res[i] = dt.Month();
+        break;
+      case Op::DAY:
+        res[i] = dt.Day();
+        break;
+      case Op::HOUR:
+        res[i] = dt.Hour();
+        break;
+      case Op::MINUTE:
+        res[i] = dt.Minute();
+        break;
+      default:
+        res[i] = dt.Second();
+        break;
+    }
+  }
+}
+
+bool NativeExpression::Evaluate(Block &block) const {
+  size_t n = block.size;
+  bool failed = false;
+  for (size_t k = 0; k < ops_.size() && !failed; k++) {
+    const Operation &o = ops_[k];
+    int64_t *res = block.values[k].data();
+    char *res_null = block.nulls[k].data();
+    switch (o.op) {
+      case Op::COLUMN:  // values given by the caller
+        for (size_t i = 0; i < n; i++) res_null[i] = (res[i] == common::NULL_VALUE_64);
+        break;
+      case Op::CONST:
+        std::fill_n(res, n, o.constant);
+        std::fill_n(res_null, n, o.constant_null);
+        break;
+      case Op::ADD:
+      case Op::SUB:
+      case Op::MUL:
+      case Op::NEG:
+        EvaluateArithmetic(o, block, failed);
+        break;
+      case Op::TO_DECIMAL: {
+        const int64_t *a = block.values[o.args[0]].data();
+        const char *a_null = block.nulls[o.args[0]].data();
+        int64_t multiplier = types::Int64PowOfTen(o.scale - (ops_[o.args[0]].type == ValueType::DECIMAL
+                                                                 ? ops_[o.args[0]].scale
+                                                                 : 0));
+        bool overflow = false;
+        for (size_t i = 0; i < n; i++) {
+          res_null[i] = a_null[i];
+          overflow |= __builtin_mul_overflow(a[i], multiplier, &res[i]) & !a_null[i];
+        }
+        failed |= overflow;
+      } break;
+      case Op::TO_REAL: {
+        const Operation &arg = ops_[o.args[0]];
+        const int64_t *a = block.values[o.args[0]].data();
+        const char *a_null = block.nulls[o.args[0]].data();
+        double *r = &MysqlExpression::AsReal(res[0]);
+        if (arg.type == ValueType::INT || arg.scale == 0) {
+          for (size_t i = 0; i < n; i++) r[i] = double(a[i]);
+        } else {
+          // one division by an exact power of ten is rounded as MySQL rounds
+          // the decimal, as long as the digits fit in a double
+          double divisor = double(types::Int64PowOfTen(arg.scale));
+          bool inexact = false;
+          for (size_t i = 0; i < n; i++) {
+            inexact |= ((a[i] > kMaxExactDouble) | (a[i] < -kMaxExactDouble)) & !a_null[i];
+            r[i] = double(a[i]) / divisor;
+          }
+          failed |= inexact;
+        }
+        std::copy_n(a_null, n, res_null);
+      } break;
+      case Op::IS_TRUE: {
+        const int64_t *a = block.values[o.args[0]].data();
+        std::copy_n(block.nulls[o.args[0]].data(), n, res_null);
+        if (ops_[o.args[0]].type == ValueType::REAL)
+          for (size_t i = 0; i < n; i++) res[i] = (MysqlExpression::AsReal(a[i]) != 0.0);
+        else
+          for (size_t i = 0; i < n; i++) res[i] = (a[i] != 0);
+      } break;
+      case Op::EQ:
+      case Op::NE:
+      case Op::LT:
+      case Op::LE:
+      case Op::GT:
+      case Op::GE:
+        EvaluateComparison(o, block);
+        break;
+      case Op::NOT: {
+        const int64_t *a = block.values[o.args[0]].data();
+        std::copy_n(block.nulls[o.args[0]].data(), n, res_null);
+        for (size_t i = 0; i < n; i++) res[i] = !a[i];
+      } break;
+      case Op::AND:
+      case Op::OR: {
+        // three-valued logic: a false (true for OR) argument decides, otherwise
+        // a NULL argument makes the result NULL
+        int64_t decisive = (o.op == Op::AND ? 0 : 1);
+        std::fill_n(res, n, 1 - decisive);
+        std::fill_n(res_null, n, 0);
+        for (int arg : o.args) {
+          const int64_t *a = block.values[arg].data();
+          const char *a_null = block.nulls[arg].data();
+          for (size_t i = 0; i < n; i++) {
+            bool decides = !a_null[i] && a[i] == decisive;
+            res[i] = (decides ? decisive : res[i]);
+            res_null[i] = (res[i] != decisive) & (res_null[i] | a_null[i]);
+          }
+        }
+      } break;
+      case Op::IF: {
+        const int64_t *cond = block.values[o.args[0]].data();
+        const char *cond_null = block.nulls[o.args[0]].data();
+        const int64_t *a = block.values[o.args[1]].data();
+        const int64_t *b = block.values[o.args[2]].data();
+        const char *a_null = block.nulls[o.args[1]].data();
+        const char *b_null = block.nulls[o.args[2]].data();
+        for (size_t i = 0; i < n; i++) {
+          bool first = !cond_null[i] && cond[i];
+          res[i] = (first ? a[i] : b[i]);
+          res_null[i] = (first ? a_null[i] : b_null[i]);
+        }
+      } break;
+      case Op::COALESCE: {
+        std::copy_n(block.values[o.args[0]].data(), n, res);
+        std::copy_n(block.nulls[o.args[0]].data(), n, res_null);
+        for (size_t j = 1; j < o.args.size(); j++) {
+          const int64_t *a = block.values[o.args[j]].data();
+          const char *a_null = block.nulls[o.args[j]].data();
+          for (size_t i = 0; i < n; i++) {
+            res[i] = (res_null[i] ? a[i] : res[i]);
+            res_null[i] &= a_null[i];
+          }
+        }
+      } break;
+      default:
+        EvaluateDateTime(o, block);
+        break;
+    }
+  }
+  return !failed;
+}
+
+void NativeExpression::GetValue(const Block &block, size_t row, ValueOrNull &v) const {
+  DEBUG_ASSERT(row < block.size);
+  if (block.nulls.back()[row]) {
+    v = ValueOrNull();
+    return;
+  }
+  int64_t x = block.values.back()[row];
+  // the same normalization as in MysqlExpression::ItemInt2ValueOrNull() etc.
+  switch (result_type_) {
+    case ValueType::INT:
+      if (x == common::NULL_VALUE_64)
+        x++;
+      v.SetFixed(x);
+      break;
+    case ValueType::REAL: {
+      double d = MysqlExpression::AsReal(x);
+      if (d == -0.0)
+        d = 0.0;
+      int64_t bits = MysqlExpression::AsValue(d);
+      if (bits == common::NULL_VALUE_64)
+        bits++;
+      v.SetDouble(MysqlExpression::AsReal(bits));
+    } break;
+    default:
+      v.SetFixed(x);
+      break;
+  }
+}
+}  // namespace core
+}  // namespace Tianmu
@@ -0,0 +1,146 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_CORE_NATIVE_EXPRESSION_H_
+#define TIANMU_CORE_NATIVE_EXPRESSION_H_
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/column_type.h"
+#include "core/mysql_expression.h"
+#include "core/value_or_null.h"
+#include "core/var_id.h"
+
+namespace Tianmu {
+namespace core {
+// A numerical subset of MysqlExpression compiled into a list of operations on
+// vectors. Instead of pushing one row at a time through the Item tree, a block
+// of rows is evaluated one operation at a time into typed value vectors with
+// null flags. Supported are:
+//  - columns of signed integer, DECIMAL, FLOAT/DOUBLE, DATE and DATETIME types,
+//    numerical constants and NULL,
+//  - + - * and unary minus, = <> < <= > >=, NOT, AND, OR,
+//  - IF(), IFNULL(), COALESCE(),
+//  - YEAR(), QUARTER(), MONTH(), DAYOFMONTH(), HOUR(), MINUTE(), SECOND().
+// Build() returns nullptr for anything else, which stays evaluated by
+// MysqlExpression::Evaluate(). Evaluate() gives up on a block where MySQL would
+// raise an error or round differently (e.g. on integer overflow), so the block
+// can be evaluated again row by row with the exact MySQL semantics.
+class NativeExpression {
+ public:
+  // Results of the operations for a block of rows, reused between blocks.
+  struct Block {
+    std::vector<std::vector<int64_t>> values;  // int64_t, scaled decimals or double bits
+    std::vector<std::vector<char>> nulls;
+    size_t size = 0;
+  };
+
+  // `columns` gives the types of the variables of `expr`, `result_type` is the
+  // one of the ExpressionColumn (i.e. MysqlExpression::EvalType()).
+  static std::unique_ptr<NativeExpression> Build(MysqlExpression &expr, const std::map<VarID, ColumnType> &columns,
+                                                 const ColumnType &result_type);
+
+  // Variables read by the expression, in the order of Input().
+  const std::vector<VarID> &GetInputs() const { return inputs_; }
+
+  // Prepares `block` for `rows` rows. Then the caller stores the values of the
+  // inputs in Input(block, i), encoded as by JustATable::GetTable64().
+  void Reset(Block &block, size_t rows) const;
+  int64_t *Input(Block &block, size_t i) const { return block.values[input_ops_[i]].data(); }
+
+  // Returns false if the block must be evaluated by MysqlExpression.
+  bool Evaluate(Block &block) const;
+  // Result for a row of an evaluated block, as MysqlExpression::Evaluate() gives it.
+  void GetValue(const Block &block, size_t row, ValueOrNull &v) const;
+
+ private:
+  enum class Op {
+    COLUMN,
+    CONST,
+    ADD,
+    SUB,
+    MUL,
+    NEG,
+    TO_DECIMAL,  // scales up INT/DECIMAL
+    TO_REAL,
+    IS_TRUE,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    NOT,
+    AND,
+    OR,
+    IF,
+    COALESCE,
+    YEAR,
+    QUARTER,
+    MONTH,
+    DAY,
+    HOUR,
+    MINUTE,
+    SECOND
+  };
+  enum class ValueType { INT, DECIMAL, REAL, DATETIME };
+
+  struct Operation {
+    Op op;
+    ValueType type;
+    int scale = 0;  // of a DECIMAL result; for TO_DECIMAL the number of digits to add
+    common::ColumnType datetime_type = common::ColumnType::DATETIME;
+    std::vector<int> args;  // indexes of earlier operations
+    int64_t constant = 0;
+    bool constant_null = false;
+  };
+
+  struct BuildContext {
+    const std::map<VarID, ColumnType> &columns;
+    std::map<Item *, VarID> fields;  // Item_tianmufield => variable
+  };
+
+  NativeExpression() = default;
+
+  int Compile(Item *item, BuildContext &ctx);
+  int CompileColumn(Item *item, BuildContext &ctx);
+  int CompileConstant(Item *item);
+  int CompileFunction(Item_func *item, BuildContext &ctx);
+  int CompileComparison(Op op, Item_func *item, BuildContext &ctx);
+  int CompileCondition(Op op, Item *item, BuildContext &ctx);
+  int Convert(int arg, ValueType type, int scale);
+  int IsTrue(int arg);
+  int Add(Operation &&operation);
+
+  // the type an Item gives its result in, false if not supported
+  static bool ResultType(Item *item, ValueType &type, int &scale);
+
+  void EvaluateArithmetic(const Operation &o, Block &block, bool &failed) const;
+  void EvaluateComparison(const Operation &o, Block &block) const;
+  void EvaluateDateTime(const Operation &o, Block &block) const;
+
+  std::vector<Operation> ops_;  // the last one gives the result
+  ValueType result_type_ = ValueType::INT;
+  std::vector<VarID> inputs_;
+  std::vector<int> input_ops_;
+};
+}  // namespace core
+}  // namespace Tianmu
+
+#endif  // TIANMU_CORE_NATIVE_EXPRESSION_H_
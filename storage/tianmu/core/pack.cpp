@@ -25,6 +25,7 @@
 #include "core/value.h"
 #include "loader/value_cache.h"
 #include "system/tianmu_file.h"
+#include "util/simd_filter.h"
 
 namespace Tianmu {
 namespace core {
@@ -72,6 +73,13 @@ void Pack::Release() {
     owner->DropObjectByMM(GetPackCoordinate());
 }
 
+void Pack::MaskNulls(uint32_t *mask) const {
+  if (dpn_->NullOnly())
+    std::memset(mask, 0, utils::simd::MaskWords(dpn_->numOfRecords) * sizeof(uint32_t));
+  else if (dpn_->numOfNulls > 0)
+    utils::simd::MaskAndNot(mask, nulls_ptr_.get(), dpn_->numOfRecords);
+}
+
 bool Pack::ShouldNotCompress() const {
   return (dpn_->numOfRecords < (1U << col_share_->pss)) ||
          (col_share_->ColType().GetFmt() == common::PackFmt::NOCOMPRESS);
@@ -95,6 +95,8 @@ class Pack : public mm::TraceableObject {
   }
 
   bool NotNull(int locationInPack) const { return !IsNull(locationInPack); }
+  // clear null rows in a row bitmap of the pack (layout as in Filter::Block)
+  void MaskNulls(uint32_t *mask) const;
   void InitNull() {
     if (dpn_->NullOnly()) {
       for (uint i = 0; i < dpn_->numOfNulls; i++) SetNull(i);
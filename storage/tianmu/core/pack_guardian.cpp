@@ -21,6 +21,7 @@
 
 #include "core/just_a_table.h"
 #include "core/mi_iterator.h"
+#include "system/configuration.h"
 #include "vc/virtual_column.h"
 
 namespace Tianmu {
@@ -55,6 +56,25 @@ void VCPackGuardian::ResizeLastPack(int taskNum) {
   guardian_threads_ = taskNum;
 }
 
+void VCPackGuardian::PrefetchNext(const MIIterator &mit, JustATable *tab, int dim, int col_index) {
+  int depth = tianmu_sysvar_prefetch_depth;
+  if (depth <= 0 || !mit.IsValid() || !mit.DimUsed(dim))
+    return;
+
+  std::vector<int> packs;
+  int prev = mit.GetCurPackrow(dim);
+  for (int ahead = 1; ahead <= depth; ++ahead) {
+    int pack = mit.GetNextPackrow(dim, ahead);
+    // lookahead gives -1 or repeats the last pack when nothing is left
+    if (pack < 0 || pack == prev)
+      break;
+    packs.push_back(pack);
+    prev = pack;
+  }
+  if (!packs.empty())
+    tab->PrefetchPacks(col_index, packs);
+}
+
 void VCPackGuardian::LockPackrow(const MIIterator &mit) {
   switch (current_strategy_) {
     case GUARDIAN_LOCK_STRATEGY::LOCK_ONE:
@@ -119,6 +139,7 @@ void VCPackGuardian::LockPackrowOnLockOneByThread(const MIIterator &mit) {
 
     try {
       tab->LockPackForUse(col_index, cur_pack);
+      PrefetchNext(mit, tab, cur_dim, col_index);
     } catch (...) {
       TIANMU_LOG(LogCtl_Level::ERROR,
                  "LockPackrowOnLockOneByThread LockPackForUse fail, cur_dim: %d col_index: %d cur_pack: %d", cur_dim,
@@ -211,6 +232,7 @@ void VCPackGuardian::LockPackrowOnLockOne(const MIIterator &mit) {
         tab->UnlockPackFromUse(iter->col_ndx, last_pack_[cur_dim][threadId]);
       try {
         tab->LockPackForUse(iter->col_ndx, mit.GetCurPackrow(cur_dim));
+        PrefetchNext(mit, tab, cur_dim, iter->col_ndx);
       } catch (...) {
         TIANMU_LOG(LogCtl_Level::ERROR,
                    "LockPackrowOnLockOne LockPackForUse fail, cur_dim: %d threadId: %d cur_pack: %d", cur_dim, threadId,
@@ -27,6 +27,7 @@ namespace vcolumn {
 class VirtualColumn;
 }  // namespace vcolumn
 namespace core {
+class JustATable;
 class MIIterator;
 
 class VCPackGuardian final {
@@ -47,6 +48,8 @@ class VCPackGuardian final {
  private:
   void Initialize(int no_th);
   void ResizeLastPack(int taskNum);  // used only when Initialize is done
+  // read ahead the packs of the column which the iterator visits next
+  void PrefetchNext(const MIIterator &mit, JustATable *tab, int dim, int col_index);
 
   vcolumn::VirtualColumn &my_vc_;
   bool initialized_{false};  // false if the object was not initialized yet.
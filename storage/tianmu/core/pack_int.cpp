@@ -18,8 +18,10 @@
 #include "core/pack_int.h"
 
 #include <algorithm>
+#include <type_traits>
 #include <unordered_map>
 
+#include "compress/bit_packer.h"
 #include "compress/bit_stream_compressor.h"
 #include "compress/num_compressor.h"
 #include "core/bin_tools.h"
@@ -27,13 +29,16 @@
 #include "core/value.h"
 #include "loader/value_cache.h"
 #include "system/tianmu_file.h"
+#include "util/simd_filter.h"
 
 namespace Tianmu {
 namespace core {
-PackInt::PackInt(DPN *dpn, PackCoordinate pc, ColumnShare *s) : Pack(dpn, pc, s) {
+PackInt::PackInt(DPN *dpn, PackCoordinate pc, ColumnShare *s, system::Stream *src) : Pack(dpn, pc, s) {
   is_real_ = ATI::IsRealType(s->ColType().GetTypeName());
 
-  if (dpn_->NotTrivial()) {
+  if (dpn_->NotTrivial() && src) {
+    LoadDataFromFile(src);
+  } else if (dpn_->NotTrivial()) {
     system::TianmuFile f;
     f.OpenReadOnly(s->DataFile());
     f.Seek(dpn_->dataAddress, SEEK_SET);
@@ -258,6 +263,7 @@ void PackInt::UpdateValueFloat(size_t locationInPack, const Value &v) {
 void PackInt::UpdateValue(size_t locationInPack, const Value &v) {
   if (IsDeleted(locationInPack))
     return;
+  ClearRuns();
   if (is_real_)
     UpdateValueFloat(locationInPack, v);
   else
@@ -275,6 +281,7 @@ void PackInt::UpdateValue(size_t locationInPack, const Value &v) {
 void PackInt::DeleteByRow(size_t locationInPack) {
   if (IsDeleted(locationInPack))
     return;
+  ClearRuns();
   dpn_->synced = false;
 
   if (!IsNull(locationInPack)) {
@@ -501,7 +508,67 @@ void PackInt::LoadValuesDouble(const loader::ValueCache *vc, const std::optional
   dpn_->max_d = new_max;
 }
 
+void PackInt::BetweenMask(int64_t lo, int64_t hi, bool negate, uint32_t *mask) const {
+  ASSERT(!is_real_ && !data_.empty());
+  if (!run_ends_.empty()) {
+    std::vector<uint32_t> run_mask(utils::simd::MaskWords(run_ends_.size()));
+    utils::simd::BetweenMask(run_values_.data(), data_.value_type_, run_ends_.size(), lo, hi, run_mask.data());
+    ExpandRunMask(run_mask.data(), mask);
+  } else
+    utils::simd::BetweenMask(data_.ptr_, data_.value_type_, dpn_->numOfRecords, lo, hi, mask);
+  if (negate)
+    utils::simd::MaskNot(mask, dpn_->numOfRecords);
+  MaskNulls(mask);
+}
+
+void PackInt::InMask(const int64_t *vals, size_t nvals, bool negate, uint32_t *mask) const {
+  ASSERT(!is_real_ && !data_.empty());
+  if (!run_ends_.empty()) {
+    std::vector<uint32_t> run_mask(utils::simd::MaskWords(run_ends_.size()));
+    utils::simd::InMask(run_values_.data(), data_.value_type_, run_ends_.size(), vals, nvals, run_mask.data());
+    ExpandRunMask(run_mask.data(), mask);
+  } else
+    utils::simd::InMask(data_.ptr_, data_.value_type_, dpn_->numOfRecords, vals, nvals, mask);
+  if (negate)
+    utils::simd::MaskNot(mask, dpn_->numOfRecords);
+  MaskNulls(mask);
+}
+
+void PackInt::ExpandRunMask(const uint32_t *run_mask, uint32_t *mask) const {
+  std::memset(mask, 0, utils::simd::MaskWords(dpn_->numOfRecords) * sizeof(uint32_t));
+  uint begin = 0;
+  for (size_t r = 0; r < run_ends_.size(); r++) {
+    uint end = run_ends_[r];
+    if ((run_mask[r >> 5] >> (r & 31)) & 1) {
+      for (uint i = begin; i < end;) {
+        if ((i & 31) == 0 && i + 32 <= end) {
+          mask[i >> 5] = ~uint32_t(0);
+          i += 32;
+        } else {
+          mask[i >> 5] |= uint32_t(1) << (i & 31);
+          i++;
+        }
+      }
+    }
+    begin = end;
+  }
+}
+
+void PackInt::BetweenMaskDouble(double lo, double hi, bool negate, uint32_t *mask) const {
+  ASSERT(is_real_ && !data_.empty());
+  utils::simd::BetweenMaskDouble(data_.ptr_double_, dpn_->numOfRecords, lo, hi, mask);
+  if (negate)
+    utils::simd::MaskNot(mask, dpn_->numOfRecords);
+  MaskNulls(mask);
+}
+
+void PackInt::GetValuesInt(int64_t *out) const {
+  ASSERT(!is_real_ && !data_.empty());
+  utils::simd::Widen(data_.ptr_, data_.value_type_, dpn_->numOfRecords, out);
+}
+
 void PackInt::LoadValues(const loader::ValueCache *vc, const std::optional<common::double_int_t> &nv) {
+  ClearRuns();
   if (is_real_)
     LoadValuesDouble(vc, nv);
   else
@@ -560,24 +627,28 @@ void PackInt::LoadValuesFixed(const loader::ValueCache *vc, const std::optional<
 
   dpn_->synced = false;
 
-  for (size_t i = 0; i < vc->NumOfValues(); i++) {
-    if (vc->NotNull(i)) {
-      AppendValue(*(reinterpret_cast<uint64_t *>(const_cast<char *>(vc->GetDataBytesPointer(i)))) - new_min);
-    } else {
-      if (nv.has_value())
-        AppendValue(nv->i - new_min);
-      else
-        AppendNull();
-      if (vc->IsDelete(i)) {
-        if (!IsNull(dpn_->numOfRecords - 1)) {
-          SetNull(dpn_->numOfRecords - 1);
-          dpn_->numOfNulls++;
+  VisitMutableValues([&](auto *values, [[maybe_unused]] size_t no_values) {
+    using value_t = std::remove_pointer_t<decltype(values)>;
+    for (size_t i = 0; i < vc->NumOfValues(); i++) {
+      if (vc->NotNull(i)) {
+        values[dpn_->numOfRecords++] =
+            value_t(*(reinterpret_cast<uint64_t *>(const_cast<char *>(vc->GetDataBytesPointer(i)))) - new_min);
+      } else {
+        if (nv.has_value())
+          values[dpn_->numOfRecords++] = value_t(nv->i - new_min);
+        else
+          AppendNull();
+        if (vc->IsDelete(i)) {
+          if (!IsNull(dpn_->numOfRecords - 1)) {
+            SetNull(dpn_->numOfRecords - 1);
+            dpn_->numOfNulls++;
+          }
+          SetDeleted(dpn_->numOfRecords - 1);
+          dpn_->numOfDeleted++;
         }
-        SetDeleted(dpn_->numOfRecords - 1);
-        dpn_->numOfDeleted++;
       }
     }
-  }
+  });
   // sum has already been updated outside
   dpn_->min_i = new_min;
   dpn_->max_i = new_max;
@@ -586,6 +657,7 @@ void PackInt::LoadValuesFixed(const loader::ValueCache *vc, const std::optional<
 void PackInt::Destroy() {
   dealloc(data_.ptr_);
   data_.ptr_ = 0;
+  ClearRuns();
 }
 
 PackInt::~PackInt() {
@@ -667,19 +739,14 @@ void PackInt::LoadDataFromFile(system::Stream *fcurfile) {
 
       if (IsModeDataCompressed() && data_.value_type_ > 0 &&
           *reinterpret_cast<uint64_t *>(cur_buf + 1) != (uint64_t)0) {
-        if (data_.value_type_ == 1) {
-          compress::NumCompressor<uchar> nc;
-          DecompressAndInsertNulls(nc, cur_buf);
-        } else if (data_.value_type_ == 2) {
-          compress::NumCompressor<ushort> nc;
-          DecompressAndInsertNulls(nc, cur_buf);
-        } else if (data_.value_type_ == 4) {
-          compress::NumCompressor<uint> nc;
-          DecompressAndInsertNulls(nc, cur_buf);
-        } else {
-          compress::NumCompressor<uint64_t> nc;
-          DecompressAndInsertNulls(nc, cur_buf);
-        }
+        if (data_.value_type_ == 1)
+          DecompressData<uchar>(cur_buf);
+        else if (data_.value_type_ == 2)
+          DecompressData<ushort>(cur_buf);
+        else if (data_.value_type_ == 4)
+          DecompressData<uint>(cur_buf);
+        else
+          DecompressData<uint64_t>(cur_buf);
       } else if (data_.value_type_ > 0) {
         for (uint o = 0; o < dpn_->numOfRecords; o++)
           if (!IsNull(int(o)))
@@ -730,9 +797,57 @@ void PackInt::SaveUncompressed(system::Stream *f) {
     f->WriteExact(data_.ptr_, data_.value_type_ * dpn_->numOfRecords);
 }
 
+bool PackInt::UseBitPack() const {
+  return !is_real_ && col_share_->ColType().GetFmt() == common::PackFmt::BITPACK;
+}
+
+template <typename etype>
+void PackInt::CompressData(mm::MMGuard<char> &tmp_comp_buffer, uint &tmp_cb_len, uint64_t &maxv) {
+  uint no_values = dpn_->numOfRecords - dpn_->numOfNulls;
+  if (UseBitPack()) {
+    compress::BitPacker<etype> bp;
+    tmp_cb_len = compress::BitPacker<etype>::MaxSize(no_values);
+    tmp_comp_buffer = mm::MMGuard<char>(
+        reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
+    RemoveNullsAndCompress(bp, tmp_comp_buffer.get(), tmp_cb_len, maxv);
+  } else {
+    compress::NumCompressor<etype> nc;
+    tmp_cb_len = no_values * sizeof(etype) + 20;
+    tmp_comp_buffer = mm::MMGuard<char>(
+        reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
+    RemoveNullsAndCompress(nc, tmp_comp_buffer.get(), tmp_cb_len, maxv);
+  }
+}
+
 template <typename etype>
-void PackInt::RemoveNullsAndCompress(compress::NumCompressor<etype> &nc, char *tmp_comp_buffer, uint &tmp_cb_len,
-                                     uint64_t &maxv) {
+void PackInt::DecompressData(uint *&cur_buf) {
+  if (UseBitPack()) {
+    compress::BitPacker<etype> bp;
+    DecompressAndInsertNulls(bp, cur_buf);
+    if (dpn_->numOfNulls == 0)
+      LoadRuns<etype>(reinterpret_cast<char *>(cur_buf + 3), *cur_buf);
+  } else {
+    compress::NumCompressor<etype> nc;
+    DecompressAndInsertNulls(nc, cur_buf);
+  }
+}
+
+template <typename etype>
+void PackInt::LoadRuns(const char *src, uint len) {
+  std::vector<etype> values;
+  std::vector<uint> lengths;
+  // only worth it when a run covers a few mask words on average
+  if (!compress::BitPacker<etype>::Runs(src, len, values, lengths) || values.size() * 64 > dpn_->numOfRecords)
+    return;
+  run_values_.resize(values.size() * sizeof(etype));
+  std::memcpy(run_values_.data(), values.data(), run_values_.size());
+  run_ends_.resize(lengths.size());
+  uint end = 0;
+  for (size_t r = 0; r < lengths.size(); r++) run_ends_[r] = end += lengths[r];
+}
+
+template <typename etype, template <class> class Compressor>
+void PackInt::RemoveNullsAndCompress(Compressor<etype> &nc, char *tmp_comp_buffer, uint &tmp_cb_len, uint64_t &maxv) {
   mm::MMGuard<etype> tmp_data;
   if (dpn_->numOfNulls > 0) {
     tmp_data = mm::MMGuard<etype>(static_cast<etype *>(alloc((dpn_->numOfRecords - dpn_->numOfNulls) * sizeof(etype),
@@ -755,10 +870,10 @@ void PackInt::RemoveNullsAndCompress(compress::NumCompressor<etype> &nc, char *t
   }
 }
 
-template <typename etype>
-void PackInt::DecompressAndInsertNulls(compress::NumCompressor<etype> &nc, uint *&cur_buf) {
+template <typename etype, template <class> class Compressor>
+void PackInt::DecompressAndInsertNulls(Compressor<etype> &nc, uint *&cur_buf) {
   CprsErr res =
-      nc.Decompress(data_.ptr_, reinterpret_cast<char *>((cur_buf + 3)), *cur_buf,
+      nc.Decompress(static_cast<etype *>(data_.ptr_), reinterpret_cast<char *>((cur_buf + 3)), *cur_buf,
                     dpn_->numOfRecords - dpn_->numOfNulls, (etype) * (reinterpret_cast<uint64_t *>(cur_buf + 1)));
   if (res != CprsErr::CPRS_SUCCESS) {
     std::stringstream msg_buf;
@@ -786,48 +901,30 @@ std::pair<PackInt::UniquePtr, size_t> PackInt::Compress() {
 
   uint64_t maxv = 0;
   if (data_.ptr_) {  // else maxv remains 0
-    uint64_t cv = 0;
-    for (uint o = 0; o < dpn_->numOfRecords; o++) {
-      if (!IsNull(o)) {
-        cv = (uint64_t)GetValInt(o);
-        if (cv > maxv)
-          maxv = cv;
+    maxv = VisitValues([this](const auto *values, size_t no_values) {
+      uint64_t m = 0;
+      if (dpn_->numOfNulls == 0) {
+        for (size_t o = 0; o < no_values; o++) m = std::max<uint64_t>(m, values[o]);
+      } else {
+        for (size_t o = 0; o < no_values; o++)
+          if (!IsNull(o))
+            m = std::max<uint64_t>(m, values[o]);
       }
-    }
+      return m;
+    });
   }
 
   if (maxv != 0) {
     // ASSERT(last_set + 1 == dpn_->numOfRecords - dpn_->numOfNulls, "Expression evaluation
     // failed!");
-    if (data_.value_type_ == 1) {
-      compress::NumCompressor<uchar> nc;
-      tmp_cb_len = (dpn_->numOfRecords - dpn_->numOfNulls) * sizeof(uchar) + 20;
-      if (tmp_cb_len)
-        tmp_comp_buffer = mm::MMGuard<char>(
-            reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
-      RemoveNullsAndCompress(nc, tmp_comp_buffer.get(), tmp_cb_len, maxv);
-    } else if (data_.value_type_ == 2) {
-      compress::NumCompressor<ushort> nc;
-      tmp_cb_len = (dpn_->numOfRecords - dpn_->numOfNulls) * sizeof(ushort) + 20;
-      if (tmp_cb_len)
-        tmp_comp_buffer = mm::MMGuard<char>(
-            reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
-      RemoveNullsAndCompress(nc, tmp_comp_buffer.get(), tmp_cb_len, maxv);
-    } else if (data_.value_type_ == 4) {
-      compress::NumCompressor<uint> nc;
-      tmp_cb_len = (dpn_->numOfRecords - dpn_->numOfNulls) * sizeof(uint) + 20;
-      if (tmp_cb_len)
-        tmp_comp_buffer = mm::MMGuard<char>(
-            reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
-      RemoveNullsAndCompress(nc, tmp_comp_buffer.get(), tmp_cb_len, maxv);
-    } else {
-      compress::NumCompressor<uint64_t> nc;
-      tmp_cb_len = (dpn_->numOfRecords - dpn_->numOfNulls) * sizeof(uint64_t) + 20;
-      if (tmp_cb_len)
-        tmp_comp_buffer = mm::MMGuard<char>(
-            reinterpret_cast<char *>(alloc(tmp_cb_len * sizeof(char), mm::BLOCK_TYPE::BLOCK_TEMPORARY)), *this);
-      RemoveNullsAndCompress(nc, tmp_comp_buffer.get(), tmp_cb_len, maxv);
-    }
+    if (data_.value_type_ == 1)
+      CompressData<uchar>(tmp_comp_buffer, tmp_cb_len, maxv);
+    else if (data_.value_type_ == 2)
+      CompressData<ushort>(tmp_comp_buffer, tmp_cb_len, maxv);
+    else if (data_.value_type_ == 4)
+      CompressData<uint>(tmp_comp_buffer, tmp_cb_len, maxv);
+    else
+      CompressData<uint64_t>(tmp_comp_buffer, tmp_cb_len, maxv);
     buffer_size += tmp_cb_len;
   }
   buffer_size += 12;
@@ -34,6 +34,8 @@ class ValueCache;
 namespace compress {
 template <class T>
 class NumCompressor;
+template <class T>
+class BitPacker;
 }  // namespace compress
 
 namespace core {
@@ -41,7 +43,9 @@ class ColumnShare;
 
 class PackInt final : public Pack {
  public:
-  PackInt(DPN *dpn, PackCoordinate pc, ColumnShare *s);
+  // src supplies the on-disk image of the pack; if null it is read from
+  // the column's DATA file
+  PackInt(DPN *dpn, PackCoordinate pc, ColumnShare *s, system::Stream *src = nullptr);
   ~PackInt();
 
   // overrides
@@ -59,6 +63,45 @@ class PackInt final : public Pack {
   }
   bool IsFixed() const { return !is_real_; }
 
+  // Typed access to the raw 2-level encoded values, so that loops over a
+  // whole pack are compiled once per value width instead of switching on the
+  // width for every value. Values<T>() needs T to be the storage type of the
+  // pack; VisitValues(f) calls f(T *values, size_t no_values) with the right
+  // one of uint8_t, uint16_t, uint32_t or uint64_t (also used for doubles).
+  template <typename T>
+  const T *Values() const {
+    DEBUG_ASSERT(sizeof(T) == data_.value_type_);
+    return static_cast<const T *>(data_.ptr_);
+  }
+  template <typename F>
+  decltype(auto) VisitValues(F &&f) const {
+    DEBUG_ASSERT(!data_.empty());
+    switch (data_.value_type_) {
+      case 1:
+        return f(const_cast<const uint8_t *>(data_.ptr_int8_), size_t(dpn_->numOfRecords));
+      case 2:
+        return f(const_cast<const uint16_t *>(data_.ptr_int16_), size_t(dpn_->numOfRecords));
+      case 4:
+        return f(const_cast<const uint32_t *>(data_.ptr_int32_), size_t(dpn_->numOfRecords));
+      default:
+        return f(const_cast<const uint64_t *>(data_.ptr_int64_), size_t(dpn_->numOfRecords));
+    }
+  }
+
+  // Row bitmaps of a predicate over the whole pack of 2-level encoded values,
+  // with null rows cleared; `negate` inverts the predicate, not the nulls.
+  // Packs of BITPACK columns loaded from runs evaluate once per run.
+  void BetweenMask(int64_t lo, int64_t hi, bool negate, uint32_t *mask) const;
+  void InMask(const int64_t *vals, size_t nvals, bool negate, uint32_t *mask) const;
+  void BetweenMaskDouble(double lo, double hi, bool negate, uint32_t *mask) const;
+  // GetValInt() of every row, nulls included
+  void GetValuesInt(int64_t *out) const;
+  // GetValDouble() of every row, nulls included
+  const double *GetValuesDouble() const {
+    ASSERT(is_real_);
+    return data_.ptr_double_;
+  }
+
  protected:
   std::pair<UniquePtr, size_t> Compress() override;
   void Destroy() override;
@@ -108,6 +151,21 @@ class PackInt final : public Pack {
     else
       SetNull(n);
   }
+  // as VisitValues(), for filling the pack
+  template <typename F>
+  decltype(auto) VisitMutableValues(F &&f) {
+    DEBUG_ASSERT(!data_.empty());
+    switch (data_.value_type_) {
+      case 1:
+        return f(data_.ptr_int8_, size_t(dpn_->numOfRecords));
+      case 2:
+        return f(data_.ptr_int16_, size_t(dpn_->numOfRecords));
+      case 4:
+        return f(data_.ptr_int32_, size_t(dpn_->numOfRecords));
+      default:
+        return f(data_.ptr_int64_, size_t(dpn_->numOfRecords));
+    }
+  }
   void UpdateValueFloat(size_t locationInPack, const Value &v);
   void UpdateValueFixed(size_t locationInPack, const Value &v);
   void ExpandOrShrink(uint64_t maxv, int64_t delta);
@@ -118,11 +176,25 @@ class PackInt final : public Pack {
 
   uint8_t GetValueSize(uint64_t v) const;
 
+  // BITPACK columns use compress::BitPacker instead of NumCompressor
+  bool UseBitPack() const;
+  template <typename etype>
+  void CompressData(mm::MMGuard<char> &tmp_comp_buffer, uint &tmp_cb_len, uint64_t &maxv);
   template <typename etype>
-  void DecompressAndInsertNulls(compress::NumCompressor<etype> &nc, uint *&cur_buf);
+  void DecompressData(uint *&cur_buf);
+  template <typename etype, template <class> class Compressor>
+  void DecompressAndInsertNulls(Compressor<etype> &nc, uint *&cur_buf);
+  template <typename etype, template <class> class Compressor>
+  void RemoveNullsAndCompress(Compressor<etype> &nc, char *tmp_comp_buffer, uint &tmp_cb_len, uint64_t &maxv);
+  // keeps the runs of an RLE compressed BITPACK pack without nulls
   template <typename etype>
-  void RemoveNullsAndCompress(compress::NumCompressor<etype> &nc, char *tmp_comp_buffer, uint &tmp_cb_len,
-                              uint64_t &maxv);
+  void LoadRuns(const char *src, uint len);
+  void ClearRuns() {
+    run_values_.clear();
+    run_ends_.clear();
+  }
+  // row bitmap of a bitmap over the runs
+  void ExpandRunMask(const uint32_t *run_mask, uint32_t *mask) const;
 
   bool is_real_ = false;
   struct {
@@ -153,6 +225,11 @@ class PackInt final : public Pack {
       void *ptr_;
     };
   } data_ = {};
+
+  // value (of data_.value_type_ bytes) and end row of each run, empty if the
+  // pack was not loaded from runs or has changed since
+  std::vector<char> run_values_;
+  std::vector<uint> run_ends_;
 };
 }  // namespace core
 }  // namespace Tianmu
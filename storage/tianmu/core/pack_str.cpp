@@ -37,7 +37,8 @@
 
 namespace Tianmu {
 namespace core {
-PackStr::PackStr(DPN *dpn, PackCoordinate pc, ColumnShare *col_share) : Pack(dpn, pc, col_share) {
+PackStr::PackStr(DPN *dpn, PackCoordinate pc, ColumnShare *col_share, system::Stream *src)
+    : Pack(dpn, pc, col_share) {
   auto t = col_share->ColType().GetTypeName();
 
   if (t == common::ColumnType::BIN || t == common::ColumnType::LONGTEXT)
@@ -50,7 +51,9 @@ PackStr::PackStr(DPN *dpn, PackCoordinate pc, ColumnShare *col_share) : Pack(dpn
     data_.lens = alloc((data_.len_mode * (1 << col_share->pss)), mm::BLOCK_TYPE::BLOCK_UNCOMPRESSED);
     std::memset(data_.lens, 0, data_.len_mode * (1 << col_share->pss));
 
-    if (!dpn_->NullOnly()) {
+    if (!dpn_->NullOnly() && src) {
+      LoadDataFromFile(src);
+    } else if (!dpn_->NullOnly()) {
       system::TianmuFile f;
       f.OpenReadOnly(col_share->DataFile());
       f.Seek(dpn_->dataAddress, SEEK_SET);
@@ -776,18 +779,5 @@ bool PackStr::Lookup(const types::BString &pattern, uint16_t &id) {
 }
 
 bool PackStr::IsNotMatched(int row, uint16_t &id) { return ids_array_[row] != id; }
-
-bool PackStr::LikePrefix(const types::BString &pattern, std::size_t prefixlen, std::unordered_set<uint16_t> &ids) {
-  marisa::Agent agent;
-  agent.set_query(pattern.begin(), prefixlen);
-  while (marisa_trie_.predictive_search(agent)) {
-    ids.insert((uint16_t)agent.key().id());
-  }
-  return true;
-}
-
-bool PackStr::IsNotMatched(int row, const std::unordered_set<uint16_t> &ids) {
-  return ids.find(ids_array_[row]) == ids.end();
-}
 }  // namespace core
 }  // namespace Tianmu
@@ -18,7 +18,9 @@
 #define TIANMU_CORE_PACK_STR_H_
 #pragma once
 
+#include <string_view>
 #include <unordered_set>
+#include <vector>
 
 #include "core/pack.h"
 #include "marisa.h"
@@ -33,7 +35,9 @@ namespace core {
 
 class PackStr final : public Pack {
  public:
-  PackStr(DPN *dpn, PackCoordinate pc, ColumnShare *s);
+  // src supplies the on-disk image of the pack; if null it is read from
+  // the column's DATA file
+  PackStr(DPN *dpn, PackCoordinate pc, ColumnShare *s, system::Stream *src = nullptr);
   ~PackStr() {
     DestructionLock();
     Destroy();
@@ -51,9 +55,28 @@ class PackStr final : public Pack {
   void LoadValues(const loader::ValueCache *vc);
   bool IsTrie() const { return pack_str_state_ == PackStrtate::kPackTrie; }
   bool Lookup(const types::BString &pattern, uint16_t &id);
-  bool LikePrefix(const types::BString &pattern, std::size_t prefixlen, std::unordered_set<uint16_t> &ids);
   bool IsNotMatched(int row, uint16_t &id);
-  bool IsNotMatched(int row, const std::unordered_set<uint16_t> &ids);
+
+  // Batch access for predicate evaluation. GetValueView() reads a not null
+  // value of an array pack in place; a trie pack is instead evaluated once
+  // per distinct key: matched[id] = pred(key) for every key id, and
+  // GetKeyId() maps rows to ids.
+  std::string_view GetValueView(int locationInPack) const {
+    DEBUG_ASSERT(!IsTrie());
+    size_t str_size = (data_.len_mode == sizeof(ushort)) ? data_.lens16[locationInPack] : data_.lens32[locationInPack];
+    return std::string_view(data_.index[locationInPack], str_size);
+  }
+  uint16_t GetKeyId(int locationInPack) const { return ids_array_[locationInPack]; }
+  size_t NumOfKeys() const { return marisa_trie_.num_keys(); }
+  template <typename F>
+  void EvaluateKeys(F &&pred, std::vector<uint8_t> &matched) const {
+    DEBUG_ASSERT(IsTrie());
+    matched.assign(marisa_trie_.num_keys(), 0);
+    marisa::Agent agent;
+    agent.set_query("", 0);
+    while (marisa_trie_.predictive_search(agent))
+      matched[agent.key().id()] = pred(agent.key().ptr(), agent.key().length());
+  }
 
  protected:
   std::pair<UniquePtr, size_t> Compress() override;
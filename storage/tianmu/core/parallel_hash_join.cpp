@@ -15,7 +15,9 @@
    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
 */
 
+#include <algorithm>
 #include <list>
+#include <numeric>
 
 #include "common/assert.h"
 #include "core/engine.h"
@@ -28,6 +30,7 @@
 #include "core/transaction.h"
 #include "system/fet.h"
 #include "util/thread_pool.h"
+#include "vc/single_column.h"
 #include "vc/virtual_column.h"
 
 namespace Tianmu {
@@ -35,6 +38,14 @@ namespace core {
 namespace {
 const int kJoinSplittedMinPacks = 5;
 const int kTraversedPacksPerFragment = 30;
+const int kRadixMaxBits = 12;
+const int64_t kRadixMinTraversedRows = 65536;     // smaller hash tables stay in the cache anyway
+const int64_t kRadixPartitionBytes = 256 * 1024;  // hash table of one partition, about the L2 size
+const int kRadixBlockBytes = 16_KB;               // memory blocks of the partitions, from the memory manager
+const int64_t kRuntimeFilterMinRows = 65536;      // smaller matched sides are not worth the filter
+const int64_t kRuntimeFilterMaxKeys = 16 * 1024 * 1024;
+const size_t kRuntimeFilterMaxValues = 1024;  // distinct traversed keys checked against the rough set indexes
+const size_t kRuntimeFilterPackChecks = 64;   // values checked for one packrow at most
 
 int EvaluateTraversedFragments(int packs_count) {
   const int kMaxTraversedFragmentCount = 8;
@@ -164,8 +175,8 @@ TraversedHashTable::TraversedHashTable(const std::vector<int> &keys_length, cons
       watch_traversed_(watch_traversed) {}
 
 void TraversedHashTable::Initialize() {
-  hash_table_.reset(new HashTable(keys_length_, tuples_length_));
-  hash_table_->Initialize(max_table_size_, false);
+  hash_table_.reset(new FlatHashTable(keys_length_, tuples_length_));
+  hash_table_->Initialize(max_table_size_);
   if (watch_traversed_) {
     outer_filter_.reset(new MutexFilter(hash_table_->GetCount(), pack_power_));
   }
@@ -200,7 +211,17 @@ ParallelHashJoiner::MatchTaskParams::~MatchTaskParams() {
   }
 }
 
+ParallelHashJoiner::RadixPartitionParams::~RadixPartitionParams() {
+  if (task_miter) {
+    delete task_miter;
+    task_miter = nullptr;
+  }
+}
+
 // ParallelHashJoiner
+std::atomic<int64_t> ParallelHashJoiner::runtime_filter_rows_{0};
+std::atomic<int64_t> ParallelHashJoiner::runtime_filter_packrows_{0};
+
 ParallelHashJoiner::ParallelHashJoiner(MultiIndex *multi_index, TempTable *temp_table, JoinTips &join_tips)
     : TwoDimensionalJoiner(multi_index, temp_table, join_tips), interrupt_matching_(false) {
   pack_power_ = multi_index->ValueOfPower();
@@ -425,7 +446,15 @@ void ParallelHashJoiner::ExecuteJoin() {
   actually_traversed_rows_ = 0;
   outer_tuples_ = 0;
 
-  if (traversed_dims_size > 0 && matched_dims_size > 0) {
+  if (traversed_dims_size > 0 && matched_dims_size > 0)
+    PrepareRuntimeFilter(traversed_dims_size, matched_dims_size);
+
+  radix_bits_ = (traversed_dims_size > 0 && matched_dims_size > 0) ? EvaluateRadixPartitions(traversed_dims_size) : 0;
+  if (radix_bits_ > 0) {
+    int64_t outer_tuples = 0;
+    joined_tuples += RadixJoin(traversed_mit, match_mit, &outer_tuples);
+    outer_tuples_ += outer_tuples;
+  } else if (traversed_dims_size > 0 && matched_dims_size > 0) {
     int64_t outer_tuples = 0;
     TraverseDim(traversed_mit, &outer_tuples);
 
@@ -478,23 +507,22 @@ void ParallelHashJoiner::ExecuteJoin() {
   mind->UnlockAllFromUse();
 }
 
-int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples) {
-  int64_t rows_count = mind->NumOfTuples(traversed_dims_);
+void ParallelHashJoiner::CreateTraversingTasks(MIIterator &mit, int64_t rows_count,
+                                               std::vector<MITaskIterator *> *task_iterators,
+                                               std::string *splitting_type) {
   int availabled_packs = (int)((rows_count + (1 << pack_power_) - 1) >> pack_power_);
 
-  std::string splitting_type("none");
-  std::vector<MITaskIterator *> task_iterators;
   MIIterator::SliceCapability slice_capability = mit.GetSliceCapability();
   if (slice_capability.type == MIIterator::SliceCapability::Type::kFixed) {
     DEBUG_ASSERT(!slice_capability.slices.empty());
-    splitting_type = "fixed";
+    *splitting_type = "fixed";
     size_t slices_size = slice_capability.slices.size();
     int64_t rows_started = 0;
     for (size_t index = 0; index < slices_size; ++index) {
       MITaskIterator *iter = new MIFixedTaskIterator(pack_power_, mind, traversed_dims_, index, slices_size,
                                                      slice_capability.slices[index], rows_started, index);
       rows_started += slice_capability.slices[index];
-      task_iterators.push_back(iter);
+      task_iterators->push_back(iter);
     }
   } else if ((slice_capability.type == MIIterator::SliceCapability::Type::kLinear) &&
              (availabled_packs > kTraversedPacksPerFragment * 2)) {
@@ -505,7 +533,7 @@ int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples)
       }
     }
 
-    splitting_type = "packs";
+    *splitting_type = "packs";
     int packs_count = (int)((origin_size + (1 << pack_power_) - 1) >> pack_power_);
     int split_count = EvaluateTraversedFragments(packs_count);
     int packs_per_fragment = packs_count / split_count;
@@ -519,12 +547,21 @@ int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples)
 
       MITaskIterator *iter = new MILinearPackTaskIterator(pack_power_, mind, traversed_dims_, index, split_count,
                                                           rows_length, packs_started, packs_started + packs_increased);
-      task_iterators.push_back(iter);
+      task_iterators->push_back(iter);
     }
   } else {
     MITaskIterator *iter = new MITaskIterator(mind, traversed_dims_, 0, 1, rows_count);
-    task_iterators.push_back(iter);
+    task_iterators->push_back(iter);
   }
+}
+
+int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples) {
+  int64_t rows_count = mind->NumOfTuples(traversed_dims_);
+  int availabled_packs = (int)((rows_count + (1 << pack_power_) - 1) >> pack_power_);
+
+  std::string splitting_type("none");
+  std::vector<MITaskIterator *> task_iterators;
+  CreateTraversingTasks(mit, rows_count, &task_iterators, &splitting_type);
 
   int traversed_fragment_count = (int)task_iterators.size();
   tianmu_control_.lock(m_conn->GetThreadID()) << "Begin traversed with " << traversed_fragment_count << " threads with "
@@ -594,6 +631,14 @@ int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples)
     multi_index_builder_->AddBuildItem(params.build_item);
   }
 
+  std::vector<std::vector<int64_t> *> key_values;
+  bool too_many_key_values = false;
+  for (auto &params : traverse_task_params) {
+    key_values.push_back(&params.key_values);
+    too_many_key_values = too_many_key_values || params.too_many_key_values;
+  }
+  FinishRuntimeFilter(key_values, too_many_key_values);
+
   for (int index = 0; index < cond_hashed_; ++index) {
     vc1_[index]->UnlockSourcePacks();
   }
@@ -604,7 +649,7 @@ int64_t ParallelHashJoiner::TraverseDim(MIIterator &mit, int64_t *outer_tuples)
 int64_t ParallelHashJoiner::AsyncTraverseDim(TraverseTaskParams *params) {
   params->traversed_hash_table->Initialize();
 
-  HashTable *hash_table = params->traversed_hash_table->hash_table();
+  FlatHashTable *hash_table = params->traversed_hash_table->hash_table();
 
   std::string key_input_buffer(hash_table->GetKeyBufferWidth(), 0);
 
@@ -647,6 +692,12 @@ int64_t ParallelHashJoiner::AsyncTraverseDim(TraverseTaskParams *params) {
       if (watch_traversed_)
         params->traversed_hash_table->outer_filter()->Set(hash_row);
 
+      if (runtime_bloom_ || collect_key_values_)
+        AddRuntimeFilterKey(
+            FlatHashTable::HashKey(reinterpret_cast<const unsigned char *>(key_input_buffer.data()),
+                                   key_input_buffer.size()),
+            miter, &params->key_values, &params->too_many_key_values);
+
       actually_traversed_rows_++;
 
       // Put the tuple column. Note: needed also for count_only_now, because
@@ -795,6 +846,7 @@ int64_t ParallelHashJoiner::MatchDim(MIIterator &mit) {
         ftht.GetColumnEncoder(&params.column_bin_encoder);
         params.build_item = multi_index_builder_->CreateBuildItem();
         params.task_miter = iter;
+        params.bloom_probe = JoinBloomProbe(runtime_bloom_.get());
 
         res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&ParallelHashJoiner::AsyncMatchDim, this, &params));
       }
@@ -822,6 +874,7 @@ int64_t ParallelHashJoiner::MatchDim(MIIterator &mit) {
     ftht.GetColumnEncoder(&params.column_bin_encoder);
     params.build_item = multi_index_builder_->CreateBuildItem();
     params.task_miter = *task_iterators.begin();
+    params.bloom_probe = JoinBloomProbe(runtime_bloom_.get());
     matched_rows = AsyncMatchDim(&params);
   }
 
@@ -833,6 +886,7 @@ int64_t ParallelHashJoiner::MatchDim(MIIterator &mit) {
 
   for (auto &params : match_task_params) {
     multi_index_builder_->AddBuildItem(params.build_item);
+    runtime_filter_rows_ += params.bloom_probe.RejectedRows();
   }
 
   for (int index = 0; index < cond_hashed_; ++index) {
@@ -869,34 +923,7 @@ int64_t ParallelHashJoiner::AsyncMatchDim(MatchTaskParams *params) {
     bool omit_this_packrow = false;
     bool packrow_uniform = false;  // if the packrow is uniform, process it massively
     if (miter.PackrowStarted()) {
-      packrow_uniform = true;
-
-      for (int index = 0; index < cond_hashed_; ++index) {
-        if (column_bin_encoder[index].IsString()) {
-          if (!vc2_[index]->Type().Lookup()) {  // lookup treated as string, when the
-                                                // dictionaries aren't convertible
-            types::BString local_min = vc2_[index]->GetMinString(miter);
-            types::BString local_max = vc2_[index]->GetMaxString(miter);
-            if (!local_min.IsNull() && !local_max.IsNull() && ImpossibleValues(index, local_min, local_max)) {
-              omit_this_packrow = true;
-              break;
-            }
-          }
-          packrow_uniform = false;
-        } else {
-          int64_t local_min = vc2_[index]->GetMinInt64(miter);
-          int64_t local_max = vc2_[index]->GetMaxInt64(miter);
-          if (local_min == common::NULL_VALUE_64 || local_max == common::NULL_VALUE_64 ||  // common::NULL_VALUE_64
-                                                                                           // only for nulls only
-              ImpossibleValues(index, local_min, local_max)) {
-            omit_this_packrow = true;
-            break;
-          }
-          if (other_cond_exist_ || local_min != local_max || vc2_[index]->IsNullsPossible()) {
-            packrow_uniform = false;
-          }
-        }
-      }
+      omit_this_packrow = ImpossiblePackrow(column_bin_encoder, miter, &packrow_uniform);
 
       packrows_matched_++;
 
@@ -908,8 +935,8 @@ int64_t ParallelHashJoiner::AsyncMatchDim(MatchTaskParams *params) {
         }
 
         for (auto &traversed_hash_table : traversed_hash_tables_) {
-          HashTable *hash_table = traversed_hash_table.hash_table();
-          HashTable::Finder hash_table_finder(hash_table, &key_input_buffer);
+          FlatHashTable *hash_table = traversed_hash_table.hash_table();
+          FlatHashTable::Finder hash_table_finder(hash_table, &key_input_buffer);
           int64_t matching_rows = hash_table_finder.GetMatchedRows() * miter.GetPackSizeLeft();
           if (!tips.count_only)
             while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
@@ -943,9 +970,14 @@ int64_t ParallelHashJoiner::AsyncMatchDim(MatchTaskParams *params) {
 
       for (int i = 0; i < cond_hashed_; i++) vc2_[i]->LockSourcePacks(miter);
     }
+    if (!other_cond_exist_) {
+      // Basic case - just equalities, the keys are probed in batches
+      MatchPackrowBatch(params, &matching_row, &joined_tuples);
+      continue;
+    }
     // Exact part - make the key row ready for comparison
     bool null_found = false;
-    bool non_matching_sizes = false;
+    bool filtered_out = false;
     for (int index = 0; index < cond_hashed_; ++index) {
       if (vc2_[index]->IsNull(miter)) {
         null_found = true;
@@ -953,56 +985,41 @@ int64_t ParallelHashJoiner::AsyncMatchDim(MatchTaskParams *params) {
       }
       column_bin_encoder[index].Encode(reinterpret_cast<unsigned char *>(key_input_buffer.data()), miter, vc2_[index]);
     }
+    if (!null_found && params->bloom_probe.Enabled())
+      filtered_out = !params->bloom_probe.MayContain(FlatHashTable::HashKey(
+          reinterpret_cast<const unsigned char *>(key_input_buffer.data()), key_input_buffer.size()));
 
-    if (!null_found && !non_matching_sizes) {  // else go to the next row -
-                                               // equality cannot be fulfilled
+    if (!null_found && !filtered_out) {  // else go to the next row -
+                                         // equality cannot be fulfilled
       for (auto &traversed_hash_table : traversed_hash_tables_) {
-        HashTable *hash_table = traversed_hash_table.hash_table();
-        HashTable::Finder hash_table_finder(hash_table, &key_input_buffer);
-        int64_t matching_rows = hash_table_finder.GetMatchedRows();
-        // Find all matching rows
-        if (!other_cond_exist_) {
-          // Basic case - just equalities
-          if (!tips.count_only)
-            while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64)
-              SubmitJoinedTuple(params->build_item.get(), &traversed_hash_table, hash_row, miter);
-          else if (watch_traversed_) {
-            while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
-              traversed_hash_table.outer_filter()->Reset(hash_row, true);
-            }
+        FlatHashTable *hash_table = traversed_hash_table.hash_table();
+        FlatHashTable::Finder hash_table_finder(hash_table, &key_input_buffer);
+        // Complex case: different types of join conditions mixed together
+        combined_mit.Combine(miter);
+        while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
+          bool other_cond_true = true;
+          for (int i = 0; i < mind->NumOfDimensions(); i++) {
+            if (traversed_dims_[i])
+              combined_mit.Set(i, hash_table->GetTupleValue(traversed_hash_column_[i], hash_row));
           }
-          if (watch_matched_ && matching_rows > 0) {
-            outer_matched_filter_->ResetDelayed(matching_row, true);
-          }
-          joined_tuples += matching_rows;
-        } else {
-          // Complex case: different types of join conditions mixed together
-          combined_mit.Combine(miter);
-          while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
-            bool other_cond_true = true;
-            for (int i = 0; i < mind->NumOfDimensions(); i++) {
-              if (traversed_dims_[i])
-                combined_mit.Set(i, hash_table->GetTupleValue(traversed_hash_column_[i], hash_row));
+          for (auto &j : other_cond_) {
+            j.LockSourcePacks(combined_mit);
+            if (j.CheckCondition(combined_mit) == false) {
+              other_cond_true = false;
+              break;
             }
-            for (auto &j : other_cond_) {
-              j.LockSourcePacks(combined_mit);
-              if (j.CheckCondition(combined_mit) == false) {
-                other_cond_true = false;
-                break;
-              }
+          }
+          if (other_cond_true) {
+            if (!tips.count_only)
+              SubmitJoinedTuple(params->build_item.get(), &traversed_hash_table, hash_row,
+                                miter);  // use the multiindex iterator position
+            else if (watch_traversed_) {
+              traversed_hash_table.outer_filter()->Reset(hash_row, true);
             }
-            if (other_cond_true) {
-              if (!tips.count_only)
-                SubmitJoinedTuple(params->build_item.get(), &traversed_hash_table, hash_row,
-                                  miter);  // use the multiindex iterator position
-              else if (watch_traversed_) {
-                traversed_hash_table.outer_filter()->Reset(hash_row, true);
-              }
 
-              joined_tuples++;
-              if (watch_matched_) {
-                outer_matched_filter_->ResetDelayed(matching_row, true);
-              }
+            joined_tuples++;
+            if (watch_matched_) {
+              outer_matched_filter_->ResetDelayed(matching_row, true);
             }
           }
         }
@@ -1029,6 +1046,42 @@ int64_t ParallelHashJoiner::AsyncMatchDim(MatchTaskParams *params) {
   return joined_tuples;
 }
 
+// Returns true if no row of the current packrow of `miter` may match the
+// traversed keys. Sets `*packrow_uniform` if all its keys are the same value.
+bool ParallelHashJoiner::ImpossiblePackrow(std::vector<ColumnBinEncoder> &column_bin_encoder, MIIterator &miter,
+                                           bool *packrow_uniform) {
+  *packrow_uniform = true;
+  for (int index = 0; index < cond_hashed_; ++index) {
+    if (column_bin_encoder[index].IsString()) {
+      if (!vc2_[index]->Type().Lookup()) {  // lookup treated as string, when the
+                                            // dictionaries aren't convertible
+        types::BString local_min = vc2_[index]->GetMinString(miter);
+        types::BString local_max = vc2_[index]->GetMaxString(miter);
+        if (!local_min.IsNull() && !local_max.IsNull() && ImpossibleValues(index, local_min, local_max)) {
+          return true;
+        }
+      }
+      *packrow_uniform = false;
+    } else {
+      int64_t local_min = vc2_[index]->GetMinInt64(miter);
+      int64_t local_max = vc2_[index]->GetMaxInt64(miter);
+      if (local_min == common::NULL_VALUE_64 || local_max == common::NULL_VALUE_64 ||  // common::NULL_VALUE_64
+                                                                                       // only for nulls only
+          ImpossibleValues(index, local_min, local_max)) {
+        return true;
+      }
+      if (other_cond_exist_ || local_min != local_max || vc2_[index]->IsNullsPossible()) {
+        *packrow_uniform = false;
+      }
+    }
+  }
+  if (runtime_pack_column_ && RuntimeFilterExcludesPack(miter)) {
+    runtime_filter_packrows_++;
+    return true;
+  }
+  return false;
+}
+
 void ParallelHashJoiner::SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_item,
                                            TraversedHashTable *traversed_hash_table, int64_t hash_row,
                                            MIIterator &mit) {
@@ -1038,7 +1091,7 @@ void ParallelHashJoiner::SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_i
   // assumption: SetNewTableValue is called once for each dimension involved (no
   // integrity checking)
   if (!outer_nulls_only_) {
-    HashTable *hash_table = traversed_hash_table->hash_table();
+    FlatHashTable *hash_table = traversed_hash_table->hash_table();
     for (int index = 0; index < mind->NumOfDimensions(); ++index) {
       if (matched_dims_[index]) {
         build_item->SetTableValue(index, mit[index]);
@@ -1050,6 +1103,98 @@ void ParallelHashJoiner::SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_i
   }
 }
 
+void ParallelHashJoiner::SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_item,
+                                           TraversedHashTable *traversed_hash_table, int64_t hash_row,
+                                           const int64_t *matched_values) {
+  if (watch_traversed_) {
+    traversed_hash_table->outer_filter()->Reset(hash_row, true);
+  }
+  if (!outer_nulls_only_) {
+    FlatHashTable *hash_table = traversed_hash_table->hash_table();
+    for (int index = 0; index < mind->NumOfDimensions(); ++index) {
+      if (matched_dims_[index]) {
+        build_item->SetTableValue(index, matched_values[index]);
+      } else if (traversed_dims_[index]) {
+        build_item->SetTableValue(index, hash_table->GetTupleValue(traversed_hash_column_[index], hash_row));
+      }
+    }
+    build_item->CommitTableValues();
+  }
+}
+
+void ParallelHashJoiner::MatchPackrowBatch(MatchTaskParams *params, int64_t *matching_row, int64_t *joined_tuples) {
+  const int batch_size = FlatHashTable::kProbeBatch;
+  const int dims = mind->NumOfDimensions();
+  const size_t tables = traversed_hash_tables_.size();
+  const size_t key_width = traversed_hash_tables_[0].hash_table()->GetKeyBufferWidth();
+  if (!params->batch) {
+    params->batch = std::make_shared<FlatHashProbeBuffer>();
+    params->batch->Reserve(key_width, dims + 1, tables);
+  }
+  unsigned char *batch_keys = params->batch->Keys();
+  int64_t *batch_values = params->batch->Values();
+  int64_t *batch_matching_rows = batch_values + batch_size * dims;
+
+  // Encode the keys of the rest of the packrow, up to one batch.
+  MIIterator &miter(*params->task_miter->GetIter());
+  int rows = 0;
+  do {
+    unsigned char *key = batch_keys + rows * key_width;
+    bool omit_this_row = false;
+    for (int index = 0; index < cond_hashed_; ++index) {
+      if (vc2_[index]->IsNull(miter)) {
+        omit_this_row = true;
+        break;
+      }
+      params->column_bin_encoder[index].Encode(key, miter, vc2_[index]);
+    }
+    if (!omit_this_row && params->bloom_probe.Enabled())
+      omit_this_row = !params->bloom_probe.MayContain(FlatHashTable::HashKey(key, key_width));
+    if (!omit_this_row) {  // else go to the next row - equality cannot be fulfilled
+      for (int index = 0; index < dims; ++index)
+        if (matched_dims_[index])
+          batch_values[rows * dims + index] = miter[index];
+      batch_matching_rows[rows] = *matching_row;
+      rows++;
+    }
+    ++miter;
+    (*matching_row)++;
+  } while (rows < batch_size && params->task_miter->IsValid() && !miter.PackrowStarted());
+
+  for (size_t t = 0; t < tables; ++t)
+    traversed_hash_tables_[t].hash_table()->LookupBatch(batch_keys, rows, params->batch->FirstRows(t),
+                                                        params->batch->MatchedRows(t));
+
+  int64_t hash_row = 0;
+  for (int i = 0; i < rows; ++i) {
+    for (size_t t = 0; t < tables; ++t) {
+      auto &traversed_hash_table = traversed_hash_tables_[t];
+      int64_t matching_rows = params->batch->MatchedRows(t)[i];
+      FlatHashTable::Finder hash_table_finder(traversed_hash_table.hash_table(), params->batch->FirstRows(t)[i],
+                                              matching_rows);
+      if (!tips.count_only)
+        while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64)
+          SubmitJoinedTuple(params->build_item.get(), &traversed_hash_table, hash_row, &batch_values[i * dims]);
+      else if (watch_traversed_) {
+        while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
+          traversed_hash_table.outer_filter()->Reset(hash_row, true);
+        }
+      }
+      if (watch_matched_ && matching_rows > 0) {
+        outer_matched_filter_->ResetDelayed(batch_matching_rows[i], true);
+      }
+      *joined_tuples += matching_rows;
+    }
+
+    if (!outer_nulls_only_) {
+      if (tips.limit != -1 && tips.limit <= *joined_tuples) {
+        interrupt_matching_ = true;
+        break;
+      }
+    }
+  }
+}
+
 // outer part
 
 void ParallelHashJoiner::InitOuter(Condition &cond) {
@@ -1091,7 +1236,7 @@ int64_t ParallelHashJoiner::SubmitOuterTraversed() {
     if (tips.count_only) {
       outer_added += outer_filter->GetOnesCount();
     } else {
-      HashTable *hash_table = it.hash_table();
+      FlatHashTable *hash_table = it.hash_table();
       for (int64_t hash_row = 0; hash_row < hash_table->GetCount(); ++hash_row) {
         if (outer_filter->Get(hash_row)) {
           for (int index = 0; index < mind->NumOfDimensions(); ++index) {
@@ -1193,6 +1338,489 @@ int64_t ParallelHashJoiner::SubmitOuterMatched(MIIterator &miter) {
   return outer_added;
 }
 
+// radix part
+
+// The runtime filter lets the matched side drop rows, and whole packrows, whose
+// keys cannot be in the traversed hash tables before they are probed. Rows
+// dropped this way stay unmatched, so they are still emitted by outer joins.
+void ParallelHashJoiner::PrepareRuntimeFilter(int64_t traversed_rows, int64_t matched_rows) {
+  runtime_bloom_.reset();
+  collect_key_values_ = false;
+  runtime_key_values_.clear();
+  runtime_pack_column_ = nullptr;
+  if (!tianmu_sysvar_join_runtime_filter || matched_rows < kRuntimeFilterMinRows || matched_rows < traversed_rows)
+    return;
+
+  if (traversed_rows <= kRuntimeFilterMaxKeys)
+    runtime_bloom_.reset(new JoinBloomFilter(traversed_rows));
+
+  // The values of the first key are checked against the rough set indexes of
+  // the matched column, so both sides must hold them the same way.
+  const ColumnType &type = vc2_[0]->Type();
+  collect_key_values_ = !type.IsString() && !type.IsFloat() && !type.Lookup() && vc1_[0]->Type() == type &&
+                        vc2_[0]->IsSingleColumn() == vcolumn::VirtualColumn::single_col_t::SC_RCATTR;
+}
+
+void ParallelHashJoiner::AddRuntimeFilterKey(uint64_t hash, MIIterator &miter, std::vector<int64_t> *key_values,
+                                             bool *too_many_key_values) {
+  if (runtime_bloom_)
+    runtime_bloom_->Insert(hash);
+
+  if (!collect_key_values_ || *too_many_key_values)
+    return;
+  key_values->push_back(vc1_[0]->GetNotNullValueInt64(miter));
+  if (key_values->size() > 4 * kRuntimeFilterMaxValues) {
+    std::sort(key_values->begin(), key_values->end());
+    key_values->erase(std::unique(key_values->begin(), key_values->end()), key_values->end());
+    if (key_values->size() > kRuntimeFilterMaxValues) {
+      *too_many_key_values = true;
+      std::vector<int64_t>().swap(*key_values);
+    }
+  }
+}
+
+void ParallelHashJoiner::FinishRuntimeFilter(std::vector<std::vector<int64_t> *> &key_values,
+                                             bool too_many_key_values) {
+  if (collect_key_values_ && !too_many_key_values) {
+    for (auto *values : key_values) runtime_key_values_.insert(runtime_key_values_.end(), values->begin(), values->end());
+    std::sort(runtime_key_values_.begin(), runtime_key_values_.end());
+    runtime_key_values_.erase(std::unique(runtime_key_values_.begin(), runtime_key_values_.end()),
+                              runtime_key_values_.end());
+    if (runtime_key_values_.size() <= kRuntimeFilterMaxValues && !runtime_key_values_.empty()) {
+      runtime_pack_column_ = static_cast<vcolumn::SingleColumn *>(vc2_[0])->GetPhysical();
+      runtime_pack_dim_ = vc2_[0]->GetDim();
+    } else {
+      runtime_key_values_.clear();
+    }
+  }
+  for (auto *values : key_values) std::vector<int64_t>().swap(*values);
+
+  if (runtime_bloom_ || runtime_pack_column_)
+    tianmu_control_.lock(m_conn->GetThreadID())
+        << "Runtime filter: " << (runtime_bloom_ ? runtime_bloom_->ByteSize() / 1024 : 0) << " KB bloom filter, "
+        << runtime_key_values_.size() << " key values for packrows." << system::unlock;
+}
+
+// Returns true if the rough set indexes of the current packrow of `miter`
+// exclude all the traversed values of the first key.
+bool ParallelHashJoiner::RuntimeFilterExcludesPack(MIIterator &miter) {
+  int64_t local_min = vc2_[0]->GetMinInt64(miter);
+  int64_t local_max = vc2_[0]->GetMaxInt64(miter);
+  if (local_min == common::NULL_VALUE_64 || local_max == common::NULL_VALUE_64)
+    return false;
+  auto begin = std::lower_bound(runtime_key_values_.begin(), runtime_key_values_.end(), local_min);
+  auto end = std::upper_bound(begin, runtime_key_values_.end(), local_max);
+  if (begin == end)
+    return true;
+  if (size_t(end - begin) > kRuntimeFilterPackChecks)
+    return false;
+
+  int pack = miter.GetCurPackrow(runtime_pack_dim_);
+  if (pack < 0)
+    return false;
+  std::scoped_lock guard(runtime_pack_mutex_);
+  for (auto it = begin; it != end; ++it)
+    if (runtime_pack_column_->RoughCheckBetween(pack, *it, *it) != common::RoughSetValue::RS_NONE)
+      return false;
+  return true;
+}
+
+int ParallelHashJoiner::EvaluateRadixPartitions(int64_t traversed_rows) {
+  if (tianmu_sysvar_join_radix_partitions == 0 || other_cond_exist_)
+    return 0;
+
+  radix_key_width_ = std::accumulate(hash_table_key_size_.begin(), hash_table_key_size_.end(), size_t(0));
+  int64_t partitions = tianmu_sysvar_join_radix_partitions;
+  if (partitions == 1) {
+    if (traversed_rows < kRadixMinTraversedRows)
+      return 0;
+    // Enough partitions for the hash table of each one to stay in the cache,
+    // and for all the threads to have some left to take.
+    int64_t row_bytes = radix_key_width_ + 8 * (hash_table_tuple_size_.size() + 1) + 32;
+    partitions = std::max<int64_t>(traversed_rows * row_bytes / kRadixPartitionBytes,
+                                   4 * ha_tianmu_engine_->query_thread_pool.size());
+  }
+
+  int bits = 1;
+  while (bits < kRadixMaxBits && (int64_t(1) << bits) < partitions) bits++;
+  return bits;
+}
+
+// Records of the partitions are rows of int64_t:
+// - traversed: <key, padded to 8 bytes><value of radix_traversed_dims_[0]>...,
+// - matched: <key, padded to 8 bytes><matching row><value of radix_matched_dims_[0]>...
+// kept in blocks given by one MemBlockManager per side.
+int64_t ParallelHashJoiner::RadixJoin(MIIterator &traversed_mit, MIIterator &match_mit, int64_t *outer_tuples) {
+  MEASURE_FET("ParallelHashJoiner::RadixJoin(...)");
+
+  const size_t partitions_count = size_t(1) << radix_bits_;
+  radix_traversed_dims_.clear();
+  radix_matched_dims_.clear();
+  for (int index = 0; index < mind->NumOfDimensions(); ++index) {
+    if (traversed_dims_[index] && traversed_hash_column_[index] != -1)
+      radix_traversed_dims_.push_back(index);
+    if (matched_dims_[index] && !tips.count_only)
+      radix_matched_dims_.push_back(index);
+  }
+  const size_t key_words = (radix_key_width_ + 7) / 8;
+  const int traversed_record = int((key_words + radix_traversed_dims_.size()) * sizeof(int64_t));
+  const int matched_record = int((key_words + 1 + radix_matched_dims_.size()) * sizeof(int64_t));
+  const int threads = std::max<int>(ha_tianmu_engine_->query_thread_pool.size(), 1);
+  auto traversed_blocks = std::make_shared<MemBlockManager>(-1, threads);
+  auto matched_blocks = std::make_shared<MemBlockManager>(-1, threads);
+
+  // Scatter the traversed side.
+  int64_t rows_count = mind->NumOfTuples(traversed_dims_);
+  std::string splitting_type("none");
+  std::vector<MITaskIterator *> task_iterators;
+  CreateTraversingTasks(traversed_mit, rows_count, &task_iterators, &splitting_type);
+  tianmu_control_.lock(m_conn->GetThreadID())
+      << "Begin radix join with " << partitions_count << " partitions, traversed with " << task_iterators.size()
+      << " threads with " << splitting_type << " type." << system::unlock;
+
+  std::vector<RadixPartitionParams> traversed_partitions;
+  traversed_partitions.reserve(task_iterators.size());
+  traversed_hash_tables_.reserve(task_iterators.size());
+  {
+    int availabled_packs = (int)((rows_count + (1 << pack_power_) - 1) >> pack_power_);
+    TempTablePackLocker temptable_pack_locker(vc1_, cond_hashed_, availabled_packs);
+    utils::result_set<int64_t> res;
+    try {
+      for (MITaskIterator *iter : task_iterators) {
+        // Only the encoders are used, they gather the statistics for the rough matching.
+        auto &ht = traversed_hash_tables_.emplace_back(hash_table_key_size_, hash_table_tuple_size_,
+                                                       iter->GetRowsLength(), pack_power_, false);
+        ht.AssignColumnEncoder(column_bin_encoder_);
+
+        auto &params = traversed_partitions.emplace_back();
+        params.partitions.resize(partitions_count);
+        for (auto &partition : params.partitions)
+          partition.Init(traversed_record, traversed_blocks, 0, kRadixBlockBytes);
+        params.traversed_hash_table = &ht;
+        params.build_item = multi_index_builder_->CreateBuildItem();
+        params.task_miter = iter;
+
+        res.insert(
+            ha_tianmu_engine_->query_thread_pool.add_task(&ParallelHashJoiner::AsyncPartitionTraversed, this, &params));
+      }
+    } catch (std::exception &e) {
+      res.get_all_with_except();
+      throw e;
+    } catch (...) {
+      res.get_all_with_except();
+      throw;
+    }
+    res.get_all_with_except();
+  }
+  for (int index = 0; index < cond_hashed_; ++index) vc1_[index]->UnlockSourcePacks();
+  std::vector<std::vector<int64_t> *> key_values;
+  bool too_many_key_values = false;
+  for (auto &params : traversed_partitions) {
+    *outer_tuples += params.outer_tuples;
+    multi_index_builder_->AddBuildItem(params.build_item);
+    key_values.push_back(&params.key_values);
+    too_many_key_values = too_many_key_values || params.too_many_key_values;
+  }
+  FinishRuntimeFilter(key_values, too_many_key_values);
+
+  if (m_conn->Killed())
+    throw common::KilledException();
+
+  // Scatter the matched side.
+  rows_count = mind->NumOfTuples(matched_dims_);
+  task_iterators.clear();
+  CreateMatchingTasks(match_mit, rows_count, &task_iterators, &splitting_type);
+
+  std::vector<RadixPartitionParams> matched_partitions;
+  matched_partitions.reserve(task_iterators.size());
+  {
+    int availabled_packs = (int)((rows_count + (1 << pack_power_) - 1) >> pack_power_);
+    TempTablePackLocker temptable_pack_locker(vc2_, cond_hashed_, availabled_packs);
+    utils::result_set<int64_t> res;
+    try {
+      for (MITaskIterator *iter : task_iterators) {
+        auto &params = matched_partitions.emplace_back();
+        params.partitions.resize(partitions_count);
+        for (auto &partition : params.partitions) partition.Init(matched_record, matched_blocks, 0, kRadixBlockBytes);
+        traversed_hash_tables_[0].GetColumnEncoder(&params.column_bin_encoder);
+        params.task_miter = iter;
+        params.bloom_probe = JoinBloomProbe(runtime_bloom_.get());
+
+        res.insert(
+            ha_tianmu_engine_->query_thread_pool.add_task(&ParallelHashJoiner::AsyncPartitionMatched, this, &params));
+      }
+    } catch (std::exception &e) {
+      res.get_all_with_except();
+      throw e;
+    } catch (...) {
+      res.get_all_with_except();
+      throw;
+    }
+    res.get_all_with_except();
+  }
+  for (int index = 0; index < cond_hashed_; ++index) vc2_[index]->UnlockSourcePacks();
+  for (auto &params : matched_partitions) runtime_filter_rows_ += params.bloom_probe.RejectedRows();
+
+  if (m_conn->Killed())
+    throw common::KilledException();
+
+  // Join the partitions, every worker with its own output.
+  size_t workers = std::min(partitions_count, std::max<size_t>(ha_tianmu_engine_->query_thread_pool.size(), 1));
+  std::vector<RadixJoinParams> join_params(workers);
+  std::atomic<int> next_partition(0);
+  {
+    utils::result_set<void> res;
+    try {
+      for (auto &params : join_params) {
+        params.build_item = multi_index_builder_->CreateBuildItem();
+        res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&ParallelHashJoiner::AsyncJoinPartitions, this,
+                                                                 &params, &traversed_partitions,
+                                                                 &matched_partitions, &next_partition));
+      }
+    } catch (std::exception &e) {
+      res.get_all_with_except();
+      throw e;
+    } catch (...) {
+      res.get_all_with_except();
+      throw;
+    }
+    res.get_all_with_except();
+  }
+
+  if (m_conn->Killed())
+    throw common::KilledException();
+
+  int64_t joined_tuples = 0;
+  for (auto &params : join_params) {
+    multi_index_builder_->AddBuildItem(params.build_item);
+    joined_tuples += params.joined_tuples;
+    *outer_tuples += params.outer_tuples;
+    if (watch_matched_)
+      for (int64_t matching_row : params.matched_rows) outer_matched_filter_->Reset(matching_row);
+  }
+
+  tianmu_control_.lock(m_conn->GetThreadID())
+      << "End radix join. Produced tuples:" << joined_tuples << "/" << rows_count << system::unlock;
+
+  if (outer_nulls_only_)
+    joined_tuples = 0;  // outer tuples added later
+  return joined_tuples;
+}
+
+int64_t ParallelHashJoiner::AsyncPartitionTraversed(RadixPartitionParams *params) {
+  const size_t key_words = (radix_key_width_ + 7) / 8;
+  std::vector<int64_t> record(key_words + radix_traversed_dims_.size(), 0);
+  MIIterator &miter(*params->task_miter->GetIter());
+
+  int64_t traversed_rows = 0;
+  int64_t partitioned_rows = 0;
+  while (params->task_miter->IsValid()) {
+    if (m_conn->Killed())
+      break;
+
+    if (miter.PackrowStarted()) {
+      for (int index = 0; index < cond_hashed_; ++index) vc1_[index]->LockSourcePacks(miter);
+    }
+
+    bool omit_this_row = false;
+    for (int index = 0; index < cond_hashed_; index++) {
+      if (vc1_[index]->IsNull(miter)) {
+        omit_this_row = true;
+        break;
+      }
+      params->traversed_hash_table->GetColumnEncoder(index)->Encode(reinterpret_cast<unsigned char *>(record.data()),
+                                                                    miter, nullptr, true);
+    }
+
+    if (!omit_this_row) {
+      for (size_t i = 0; i < radix_traversed_dims_.size(); ++i)
+        record[key_words + i] = miter[radix_traversed_dims_[i]];
+      uint64_t hash = FlatHashTable::HashKey(reinterpret_cast<const unsigned char *>(record.data()), radix_key_width_);
+      if (runtime_bloom_ || collect_key_values_)
+        AddRuntimeFilterKey(hash, miter, &params->key_values, &params->too_many_key_values);
+      params->partitions[RadixPartition(hash)].AddRow(record.data());
+      partitioned_rows++;
+    } else if (watch_traversed_) {
+      for (int index = 0; index < mind->NumOfDimensions(); ++index) {
+        if (matched_dims_[index]) {
+          params->build_item->SetTableValue(index, common::NULL_VALUE_64);
+        } else if (traversed_dims_[index]) {
+          params->build_item->SetTableValue(index, miter[index]);
+        }
+      }
+      params->build_item->CommitTableValues();
+      partitioned_rows++;
+      params->outer_tuples++;
+    }
+    ++miter;
+    traversed_rows++;
+  }
+  actually_traversed_rows_ += partitioned_rows;
+
+  params->build_item->Finish();
+
+  return traversed_rows;
+}
+
+int64_t ParallelHashJoiner::AsyncPartitionMatched(RadixPartitionParams *params) {
+  const size_t key_words = (radix_key_width_ + 7) / 8;
+  std::vector<int64_t> record(key_words + 1 + radix_matched_dims_.size(), 0);
+  MIIterator &miter(*params->task_miter->GetIter());
+
+  int64_t matched_rows = 0;
+  int64_t matching_row = params->task_miter->GetStartPackrows();
+  while (params->task_miter->IsValid()) {
+    if (m_conn->Killed())
+      break;
+
+    if (miter.PackrowStarted()) {
+      bool packrow_uniform = false;
+      packrows_matched_++;
+      if (ImpossiblePackrow(params->column_bin_encoder, miter, &packrow_uniform)) {
+        matching_row += miter.GetPackSizeLeft();
+        miter.NextPackrow();
+        packrows_omitted_++;
+        continue;
+      }
+      for (int index = 0; index < cond_hashed_; ++index) vc2_[index]->LockSourcePacks(miter);
+    }
+
+    bool null_found = false;
+    for (int index = 0; index < cond_hashed_; ++index) {
+      if (vc2_[index]->IsNull(miter)) {
+        null_found = true;
+        break;
+      }
+      params->column_bin_encoder[index].Encode(reinterpret_cast<unsigned char *>(record.data()), miter, vc2_[index]);
+    }
+
+    uint64_t hash = 0;
+    if (!null_found) {
+      hash = FlatHashTable::HashKey(reinterpret_cast<const unsigned char *>(record.data()), radix_key_width_);
+      null_found = params->bloom_probe.Enabled() && !params->bloom_probe.MayContain(hash);
+    }
+    if (!null_found) {  // else the row may only be an outer one
+      record[key_words] = matching_row;
+      for (size_t i = 0; i < radix_matched_dims_.size(); ++i)
+        record[key_words + 1 + i] = miter[radix_matched_dims_[i]];
+      params->partitions[RadixPartition(hash)].AddRow(record.data());
+      matched_rows++;
+    }
+    ++miter;
+    matching_row++;
+  }
+
+  return matched_rows;
+}
+
+void ParallelHashJoiner::AsyncJoinPartitions(RadixJoinParams *params,
+                                             std::vector<RadixPartitionParams> *traversed_partitions,
+                                             std::vector<RadixPartitionParams> *matched_partitions,
+                                             std::atomic<int> *next_partition) {
+  const int batch_size = FlatHashTable::kProbeBatch;
+  const size_t key_words = (radix_key_width_ + 7) / 8;
+  const int partitions_count = 1 << radix_bits_;
+  const bool submit_tuples = !tips.count_only && !outer_nulls_only_;
+  MultiIndexBuilder::BuildItem *build_item = params->build_item.get();
+
+  FlatHashProbeBuffer batch;
+  batch.Reserve(radix_key_width_, 0, 1);
+  unsigned char *batch_keys = batch.Keys();
+  int64_t *first_rows = batch.FirstRows(0);
+  int64_t *matched_rows = batch.MatchedRows(0);
+  std::vector<bool> traversed_used;
+
+  int partition = 0;
+  while ((partition = next_partition->fetch_add(1)) < partitions_count && !interrupt_matching_) {
+    if (m_conn->Killed())
+      break;
+
+    int64_t rows_count = 0;
+    for (auto &it : *traversed_partitions) rows_count += it.partitions[partition].NoRows();
+    if (rows_count == 0)
+      continue;  // the matched rows of this partition stay unused
+
+    FlatHashTable hash_table(hash_table_key_size_, hash_table_tuple_size_);
+    hash_table.Initialize(rows_count, false);
+    for (auto &it : *traversed_partitions) {
+      BlockedRowMemStorage &records = it.partitions[partition];
+      for (int64_t pos = 0; pos < records.NoRows(); ++pos) {
+        const int64_t *record = static_cast<const int64_t *>(records.GetRow(pos));
+        int64_t hash_row = hash_table.AddKeyValue(reinterpret_cast<const unsigned char *>(record));
+        DEBUG_ASSERT(hash_row != common::NULL_VALUE_64);
+        for (size_t i = 0; i < radix_traversed_dims_.size(); ++i)
+          hash_table.SetTupleValue(traversed_hash_column_[radix_traversed_dims_[i]], hash_row, record[key_words + i]);
+      }
+      records.Clear();
+    }
+
+    if (watch_traversed_)
+      traversed_used.assign(rows_count, false);
+
+    for (auto &it : *matched_partitions) {
+      BlockedRowMemStorage &records = it.partitions[partition];
+      int64_t records_count = records.NoRows();
+      for (int64_t start = 0; start < records_count && !interrupt_matching_; start += batch_size) {
+        int count = int(std::min<int64_t>(records_count - start, batch_size));
+        for (int i = 0; i < count; ++i)
+          std::memcpy(&batch_keys[i * radix_key_width_], records.GetRow(start + i), radix_key_width_);
+        hash_table.LookupBatch(batch_keys, count, first_rows, matched_rows);
+
+        for (int i = 0; i < count; ++i) {
+          if (matched_rows[i] == 0)
+            continue;
+          const int64_t *record = static_cast<const int64_t *>(records.GetRow(start + i));
+          if (submit_tuples || watch_traversed_) {
+            FlatHashTable::Finder hash_table_finder(&hash_table, first_rows[i], matched_rows[i]);
+            int64_t hash_row = 0;
+            while ((hash_row = hash_table_finder.GetNextRow()) != common::NULL_VALUE_64) {
+              if (watch_traversed_)
+                traversed_used[hash_row] = true;
+              if (submit_tuples) {
+                for (size_t d = 0; d < radix_matched_dims_.size(); ++d)
+                  build_item->SetTableValue(radix_matched_dims_[d], record[key_words + 1 + d]);
+                for (int index : radix_traversed_dims_)
+                  build_item->SetTableValue(index, hash_table.GetTupleValue(traversed_hash_column_[index], hash_row));
+                build_item->CommitTableValues();
+              }
+            }
+          }
+          if (watch_matched_)
+            params->matched_rows.push_back(record[key_words]);
+          params->joined_tuples += matched_rows[i];
+
+          if (!outer_nulls_only_ && tips.limit != -1 && tips.limit <= params->joined_tuples) {
+            interrupt_matching_ = true;
+            break;
+          }
+        }
+      }
+      records.Clear();
+    }
+
+    if (watch_traversed_) {
+      // Traversed rows without a partner, added with nulls on the matched side.
+      for (int64_t hash_row = 0; hash_row < rows_count; ++hash_row) {
+        if (traversed_used[hash_row])
+          continue;
+        params->outer_tuples++;
+        if (!tips.count_only) {
+          for (int index = 0; index < mind->NumOfDimensions(); ++index) {
+            if (matched_dims_[index])
+              build_item->SetTableValue(index, common::NULL_VALUE_64);
+            else if (traversed_dims_[index])
+              build_item->SetTableValue(index, hash_table.GetTupleValue(traversed_hash_column_[index], hash_row));
+          }
+          build_item->CommitTableValues();
+          actually_traversed_rows_++;
+        }
+      }
+    }
+  }
+
+  build_item->Finish();
+}
+
 std::unique_ptr<TwoDimensionalJoiner> CreateHashJoiner(MultiIndex *multi_index, TempTable *temp_table,
                                                        JoinTips &join_tips) {
   TwoDimensionalJoiner *joiner = nullptr;
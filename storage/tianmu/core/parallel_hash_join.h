@@ -20,10 +20,14 @@
 
 #include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "core/blocked_mem_table.h"
 #include "core/column_bin_encoder.h"
-#include "core/hash_table.h"
+#include "core/flat_hash_table.h"
+#include "core/join_bloom_filter.h"
 #include "core/joiner.h"
 #include "core/multi_index_builder.h"
 
@@ -82,7 +86,7 @@ class TraversedHashTable {
 
   void Initialize();
 
-  HashTable *hash_table() const { return hash_table_.get(); }
+  FlatHashTable *hash_table() const { return hash_table_.get(); }
   MutexFilter *outer_filter() const { return outer_filter_.get(); }
   void AssignColumnEncoder(const std::vector<ColumnBinEncoder> &column_bin_encoder);
   void GetColumnEncoder(std::vector<ColumnBinEncoder> *column_bin_encoder);
@@ -93,7 +97,7 @@ class TraversedHashTable {
   std::vector<int> tuples_length_;
   int64_t max_table_size_ = 2;
   uint32_t pack_power_ = 0;
-  std::unique_ptr<HashTable> hash_table_;
+  std::unique_ptr<FlatHashTable> hash_table_;
   bool watch_traversed_ = false;
   std::unique_ptr<MutexFilter> outer_filter_;
   std::vector<ColumnBinEncoder> column_bin_encoder_;
@@ -128,6 +132,8 @@ class ParallelHashJoiner : public TwoDimensionalJoiner {
     int outer_tuples = 0;             // For output.
     bool no_space_left = false;       // For output.
     MITaskIterator *task_miter = nullptr;
+    std::vector<int64_t> key_values;  // For output, see AddRuntimeFilterKey().
+    bool too_many_key_values = false;
 
     ~TraverseTaskParams();
   };
@@ -136,14 +142,48 @@ class ParallelHashJoiner : public TwoDimensionalJoiner {
     std::shared_ptr<MultiIndexBuilder::BuildItem> build_item;
     MITaskIterator *task_miter = nullptr;
     std::vector<ColumnBinEncoder> column_bin_encoder;
+    JoinBloomProbe bloom_probe;
+
+    // Scratch space of MatchPackrowBatch(): per row the matched side tuples
+    // (NumOfDimensions()) and the matching row, and the results of every
+    // traversed hash table.
+    std::shared_ptr<FlatHashProbeBuffer> batch;
 
     ~MatchTaskParams();
   };
 
+  // One fragment of either side scattered into the radix partitions.
+  struct RadixPartitionParams {
+    std::vector<BlockedRowMemStorage> partitions;  // records, see RadixJoin()
+    TraversedHashTable *traversed_hash_table = nullptr;  // encoders of the traversed side
+    std::vector<ColumnBinEncoder> column_bin_encoder;  // encoders of the matched side
+    std::shared_ptr<MultiIndexBuilder::BuildItem> build_item;  // traversed rows with null keys
+    int64_t outer_tuples = 0;                                  // For output.
+    MITaskIterator *task_miter = nullptr;
+    std::vector<int64_t> key_values;  // For output, see AddRuntimeFilterKey().
+    bool too_many_key_values = false;
+    JoinBloomProbe bloom_probe;
+
+    ~RadixPartitionParams();
+  };
+
+  // Output of one worker joining radix partitions.
+  struct RadixJoinParams {
+    std::shared_ptr<MultiIndexBuilder::BuildItem> build_item;
+    std::vector<int64_t> matched_rows;  // matched side rows with a partner, for outer_matched_filter_
+    int64_t joined_tuples = 0;
+    int64_t outer_tuples = 0;
+  };
+
  public:
   ParallelHashJoiner(MultiIndex *multi_index, TempTable *temp_table, JoinTips &join_tips);
   ~ParallelHashJoiner();
 
+  // totals of the matched side rows and packrows dropped by the runtime filter
+  // since startup, for status variables
+  static int64_t RuntimeFilterRows() { return runtime_filter_rows_; }
+  static int64_t RuntimeFilterPackrows() { return runtime_filter_packrows_; }
+
   // Overridden from TwoDimensionalJoiner:
   void ExecuteJoinConditions(Condition &cond) override;
   void ForceSwitchingSides() override;
@@ -151,10 +191,27 @@ class ParallelHashJoiner : public TwoDimensionalJoiner {
  private:
   bool PrepareBeforeJoin(Condition &cond);
   bool AddKeyColumn(vcolumn::VirtualColumn *vc, vcolumn::VirtualColumn *vc_matching);
+  void CreateTraversingTasks(MIIterator &mit, int64_t rows_count, std::vector<MITaskIterator *> *task_iterators,
+                             std::string *splitting_type);
   int64_t TraverseDim(MIIterator &mit, int64_t *outer_tuples);
   int64_t MatchDim(MIIterator &mit);
   int64_t AsyncTraverseDim(TraverseTaskParams *params);
   int64_t AsyncMatchDim(MatchTaskParams *params);
+  bool ImpossiblePackrow(std::vector<ColumnBinEncoder> &column_bin_encoder, MIIterator &miter, bool *packrow_uniform);
+
+  void PrepareRuntimeFilter(int64_t traversed_rows, int64_t matched_rows);
+  void AddRuntimeFilterKey(uint64_t hash, MIIterator &miter, std::vector<int64_t> *key_values,
+                           bool *too_many_key_values);
+  void FinishRuntimeFilter(std::vector<std::vector<int64_t> *> &key_values, bool too_many_key_values);
+  bool RuntimeFilterExcludesPack(MIIterator &miter);
+
+  int EvaluateRadixPartitions(int64_t traversed_rows);
+  int64_t RadixJoin(MIIterator &traversed_mit, MIIterator &match_mit, int64_t *outer_tuples);
+  int64_t AsyncPartitionTraversed(RadixPartitionParams *params);
+  int64_t AsyncPartitionMatched(RadixPartitionParams *params);
+  void AsyncJoinPartitions(RadixJoinParams *params, std::vector<RadixPartitionParams> *traversed_partitions,
+                           std::vector<RadixPartitionParams> *matched_partitions, std::atomic<int> *next_partition);
+  size_t RadixPartition(uint64_t hash) const { return hash >> (64 - radix_bits_); }
 
   void ExecuteJoin();
 
@@ -164,6 +221,10 @@ class ParallelHashJoiner : public TwoDimensionalJoiner {
   void InitOuter(Condition &cond);
   void SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_item, TraversedHashTable *traversed_hash_table,
                          int64_t hash_row, MIIterator &mit);
+  // The same for a row of the matched side given by its tuple values (`matched_values[dim]`).
+  void SubmitJoinedTuple(MultiIndexBuilder::BuildItem *build_item, TraversedHashTable *traversed_hash_table,
+                         int64_t hash_row, const int64_t *matched_values);
+  void MatchPackrowBatch(MatchTaskParams *params, int64_t *matching_row, int64_t *joined_tuples);
   int64_t SubmitOuterTraversed();
   int64_t SubmitOuterMatched(MIIterator &miter);
 
@@ -199,6 +260,26 @@ class ParallelHashJoiner : public TwoDimensionalJoiner {
   std::vector<vcolumn::VirtualColumn *> vc2_;
   int cond_hashed_;
 
+  // Radix join: both sides are scattered by the top radix_bits_ of the key
+  // hash and every partition is joined by one thread on its own.
+  int radix_bits_ = 0;
+  size_t radix_key_width_ = 0;              // in bytes, padded to 8 in the records
+  std::vector<int> radix_traversed_dims_;  // dimensions stored in traversed records
+  std::vector<int> radix_matched_dims_;    // dimensions stored in matched records
+
+  // Runtime filter of the matched side, built from the traversed keys: a Bloom
+  // filter checked before the rows are hashed, and, if the first key is a
+  // numerical column with few distinct traversed values, these values checked
+  // against the histograms and Bloom filters of the matched packs.
+  std::unique_ptr<JoinBloomFilter> runtime_bloom_;
+  bool collect_key_values_ = false;
+  std::vector<int64_t> runtime_key_values_;  // sorted, distinct
+  PhysicalColumn *runtime_pack_column_ = nullptr;
+  int runtime_pack_dim_ = -1;
+  std::mutex runtime_pack_mutex_;  // the rough set indexes are loaded lazily
+  static std::atomic<int64_t> runtime_filter_rows_;
+  static std::atomic<int64_t> runtime_filter_packrows_;
+
   bool force_switching_sides_;  // set true if the join should be done in
                                 // different order than optimizer suggests
   bool too_many_conflicts_;     // true if the algorithm is in the state of exiting
@@ -169,6 +169,10 @@ class PhysicalColumn : public Column {
     return empty;
   }
 
+  //! GetValueInt64() of every row of the (locked) pack, indexed by the row
+  //! position in the pack; false if the column has no such one-pass path
+  virtual bool GetValuesInt64([[maybe_unused]] int pack, [[maybe_unused]] int64_t *out) const { return false; }
+
   //! provide the most probable approximation of number of objects matching the
   //! condition
   virtual uint64_t ApproxAnswerSize([[maybe_unused]] Descriptor &d) {
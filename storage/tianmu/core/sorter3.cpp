@@ -14,15 +14,18 @@
    along with this program; if not, write to the Free Software
    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
 */
+#include <algorithm>
 #include <iostream>
 
 #include "common/common_definitions.h"
 #include "core/bin_tools.h"
+#include "core/engine.h"
 #include "core/tools.h"
 #include "core/transaction.h"
 #include "sorter3.h"
 #include "system/fet.h"
 #include "system/tianmu_system.h"
+#include "util/thread_pool.h"
 
 namespace Tianmu {
 namespace core {
@@ -35,6 +38,7 @@ Sorter3 *Sorter3::CreateSorter(int64_t size, uint key_bytes, uint total_bytes, i
                    2;  // *2, because we allow sorter buffers to be exceptionally big
 
   int64_t max_no_rows = max_mem_size / total_bytes;
+  int64_t max_no_indexed_rows = max_mem_size / (total_bytes + RadixSortIndex::BytesPerRow());
   if (limit != -1 && limit < max_no_rows / 3 && limit < size / 3) {
     DEBUG_ASSERT(limit >= 0);
     return new SorterLimit((uint)limit, key_bytes, total_bytes);
@@ -43,10 +47,191 @@ Sorter3 *Sorter3::CreateSorter(int64_t size, uint key_bytes, uint total_bytes, i
     if (max_no_rows > size * 2 &&  // two buffers needed for counting sort
         ((key_bytes == 1 && size > 1024) || (key_bytes == 2 && size > 256000)))
       return new SorterCounting((uint)size, key_bytes, total_bytes);
+    else if (key_bytes > 0 && size > 1024 && max_no_indexed_rows > size)  // quicksort is good enough for less
+      return new SorterRadix((uint)size, key_bytes, total_bytes);
     else
       return new SorterOnePass((uint)size, key_bytes, total_bytes);
   }
-  return new SorterMultiPass((uint)max_no_rows, key_bytes, total_bytes);
+  return new SorterMultiPass((uint)max_no_indexed_rows, key_bytes, total_bytes);
+}
+
+void RadixSortIndex::Sort(unsigned char *begin, unsigned char *end) {
+#ifdef FUNCTIONS_EXECUTION_TIMES
+  FETOperator feto("RadixSortIndex::Sort(...)");
+#endif
+  size_t no_rows = size_t(end - begin) / total_bytes;
+  if (no_rows > capacity) {
+    Clear();
+    entries = (Entry *)alloc(no_rows * sizeof(Entry), mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+    scratch = (Entry *)alloc(no_rows * sizeof(Entry), mm::BLOCK_TYPE::BLOCK_TEMPORARY);
+    capacity = no_rows;
+  }
+  no_entries = no_rows;
+  for (size_t i = 0; i < no_rows; i++) entries[i].row = begin + i * total_bytes;
+  if (key_bytes == 0 || no_rows < 2)
+    return;
+  int no_tasks = 1;
+  if (no_rows >= 2 * kParallelRows && !ha_tianmu_engine_->query_thread_pool.is_owner())
+    no_tasks = int(std::min(ha_tianmu_engine_->query_thread_pool.size(), no_rows / kParallelRows));
+  if (no_tasks > 1) {
+    ParallelSort(no_tasks);
+  } else {
+    LoadPrefixes(0, no_rows, 0);
+    SortRange(0, no_rows, 0);
+  }
+}
+
+void RadixSortIndex::Clear() {
+  dealloc(entries);
+  dealloc(scratch);
+  entries = nullptr;
+  scratch = nullptr;
+  no_entries = 0;
+  capacity = 0;
+}
+
+void RadixSortIndex::LoadPrefixes(size_t lo, size_t hi, uint depth) {
+  uint len = std::min(8u, key_bytes - depth);
+  for (size_t i = lo; i < hi; i++) {
+    const unsigned char *p = entries[i].row + depth;
+    uint64_t v = 0;
+    if (len == 8) {
+      std::memcpy(&v, p, 8);
+      v = __builtin_bswap64(v);  // keys are compared as big endian numbers
+    } else {
+      for (uint b = 0; b < len; b++) v = (v << 8) | p[b];
+      v <<= 8 * (8 - len);
+    }
+    entries[i].prefix = v;
+  }
+}
+
+void RadixSortIndex::SortSmallRange(size_t lo, size_t hi, uint depth) {
+  uint len = key_bytes - depth;
+  std::sort(entries + lo, entries + hi, [depth, len](const Entry &a, const Entry &b) {
+    return std::memcmp(a.row + depth, b.row + depth, len) < 0;
+  });
+}
+
+void RadixSortIndex::SortRange(size_t lo, size_t hi, uint depth) {
+  // an explicit stack instead of recursion: long keys may need many levels
+  std::vector<Range> ranges{{lo, hi, depth}};
+  size_t offsets[256];
+  while (!ranges.empty()) {
+    Range r = ranges.back();
+    ranges.pop_back();
+    if (r.hi - r.lo > kParallelRows && conn->Killed())
+      throw common::KilledException();
+    while (r.hi - r.lo > kSmallRange && r.depth < key_bytes) {
+      if (r.depth % 8 == 0 && r.depth > 0)
+        LoadPrefixes(r.lo, r.hi, r.depth);
+      std::fill(offsets, offsets + 256, 0);
+      for (size_t i = r.lo; i < r.hi; i++) offsets[Byte(entries[i], r.depth)]++;
+      if (offsets[Byte(entries[r.lo], r.depth)] == r.hi - r.lo) {  // one bucket only
+        r.depth++;
+        continue;
+      }
+      size_t pos = r.lo;
+      for (int c = 0; c < 256; c++) {
+        size_t cnt = offsets[c];
+        offsets[c] = pos;
+        pos += cnt;
+      }
+      for (size_t i = r.lo; i < r.hi; i++) scratch[offsets[Byte(entries[i], r.depth)]++] = entries[i];
+      std::copy(scratch + r.lo, scratch + r.hi, entries + r.lo);
+      // offsets[c] is the end of bucket c now
+      size_t start = r.lo;
+      for (int c = 0; c < 256; c++) {
+        if (offsets[c] - start > 1)
+          ranges.push_back({start, offsets[c], r.depth + 1});
+        start = offsets[c];
+      }
+      r.hi = r.lo;  // done, the buckets are on the stack
+    }
+    if (r.hi - r.lo > 1 && r.depth < key_bytes)
+      SortSmallRange(r.lo, r.hi, r.depth);
+  }
+}
+
+void RadixSortIndex::ParallelSort(int no_tasks) {
+  size_t no_rows = no_entries;
+  std::vector<size_t> offsets(no_tasks * 256);  // histograms of the first byte, then scatter positions
+  {
+    utils::result_set<void> res;
+    for (int t = 0; t < no_tasks; t++)
+      res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&RadixSortIndex::TaskHistogram, this,
+                                                               no_rows * t / no_tasks, no_rows * (t + 1) / no_tasks,
+                                                               &offsets[t * 256]));
+    res.wait_all();
+    res.get_all_with_except();
+  }
+  std::vector<size_t> bucket_start(257);
+  size_t pos = 0;
+  for (int c = 0; c < 256; c++) {
+    bucket_start[c] = pos;
+    for (int t = 0; t < no_tasks; t++) {
+      size_t cnt = offsets[t * 256 + c];
+      offsets[t * 256 + c] = pos;
+      pos += cnt;
+    }
+  }
+  bucket_start[256] = pos;
+  {
+    utils::result_set<void> res;
+    for (int t = 0; t < no_tasks; t++)
+      res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&RadixSortIndex::TaskScatter, this,
+                                                               no_rows * t / no_tasks, no_rows * (t + 1) / no_tasks,
+                                                               &offsets[t * 256]));
+    res.wait_all();
+    res.get_all_with_except();
+  }
+  std::swap(entries, scratch);
+  if (conn->Killed())
+    throw common::KilledException();
+
+  std::atomic<int> next_bucket{0};
+  utils::result_set<void> res;
+  for (int t = 0; t < no_tasks; t++)
+    res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&RadixSortIndex::TaskSortBuckets, this, &bucket_start,
+                                                             &next_bucket));
+  res.wait_all();
+  res.get_all_with_except();
+}
+
+void RadixSortIndex::TaskHistogram(size_t lo, size_t hi, size_t *counts) {
+  LoadPrefixes(lo, hi, 0);
+  for (size_t i = lo; i < hi; i++) counts[Byte(entries[i], 0)]++;
+}
+
+void RadixSortIndex::TaskScatter(size_t lo, size_t hi, size_t *offsets) {
+  for (size_t i = lo; i < hi; i++) scratch[offsets[Byte(entries[i], 0)]++] = entries[i];
+}
+
+void RadixSortIndex::TaskSortBuckets(const std::vector<size_t> *bucket_start, std::atomic<int> *next_bucket) {
+  // the buckets are taken one by one, so that a large one does not wait behind others
+  for (int c = next_bucket->fetch_add(1); c < 256; c = next_bucket->fetch_add(1))
+    if ((*bucket_start)[c + 1] - (*bucket_start)[c] > 1)
+      SortRange((*bucket_start)[c], (*bucket_start)[c + 1], 1);
+}
+
+void RadixSortIndex::PermuteRows(unsigned char *begin, unsigned char *tmp_row) {
+  // follow the cycles of the permutation, one temporary row is enough
+  for (size_t i = 0; i < no_entries; i++) {
+    if (entries[i].row == begin + i * total_bytes)
+      continue;
+    std::memcpy(tmp_row, begin + i * total_bytes, total_bytes);
+    size_t j = i;
+    for (;;) {
+      size_t k = size_t(entries[j].row - begin) / total_bytes;  // the row to be moved to j
+      entries[j].row = begin + j * total_bytes;
+      if (k == i) {
+        std::memcpy(begin + j * total_bytes, tmp_row, total_bytes);
+        break;
+      }
+      std::memcpy(begin + j * total_bytes, begin + k * total_bytes, total_bytes);
+      j = k;
+    }
+  }
 }
 
 SorterOnePass::SorterOnePass(uint _size, uint _key_bytes, uint _total_bytes)
@@ -222,8 +407,24 @@ void SorterOnePass::BubbleSort(unsigned char *s1,
   } while (j != nullptr);
 }
 
+SorterRadix::SorterRadix(uint _size, uint _key_bytes, uint _total_bytes)
+    : SorterOnePass(_size, _key_bytes, _total_bytes), index(_key_bytes, _total_bytes, conn), output_pos(0) {}
+
+unsigned char *SorterRadix::GetNextValue() {
+  if (!already_sorted) {
+    index.Sort(buf, buf_input_pos);
+    already_sorted = true;
+    output_pos = 0;
+  }
+  if (output_pos >= index.Size())
+    return nullptr;
+  return index.Row(output_pos++);
+}
+
 SorterMultiPass::SorterMultiPass(uint _size, uint _key_bytes, uint _total_bytes)
-    : SorterOnePass(_size, _key_bytes, _total_bytes), system::CacheableItem("JW", "SR3") {
+    : SorterOnePass(_size, _key_bytes, _total_bytes),
+      system::CacheableItem("JW", "SR3"),
+      index(_key_bytes, _total_bytes, conn) {
   no_blocks = 0;
   last_row = new unsigned char[total_bytes];
 }
@@ -232,7 +433,7 @@ SorterMultiPass::~SorterMultiPass() { delete[] last_row; }
 
 bool SorterMultiPass::PutValue(unsigned char *b) {
   if (buf_input_pos == buf_end) {
-    QuickSort();
+    SortBlock();
     blocks.push_back(BlockDescription(int(buf_input_pos - buf)));
     CI_Put(no_blocks, buf, int(buf_input_pos - buf));
     no_blocks++;
@@ -251,7 +452,7 @@ bool SorterMultiPass::PutValue([[maybe_unused]] Sorter3 *s) {
 
 unsigned char *SorterMultiPass::GetNextValue() {
   if (!already_sorted) {
-    QuickSort();
+    SortBlock();
     blocks.push_back(BlockDescription(int(buf_input_pos - buf)));
     CI_Put(no_blocks, buf, int(buf_input_pos - buf));
     no_blocks++;
@@ -273,6 +474,12 @@ unsigned char *SorterMultiPass::GetNextValue() {
   return res;
 }
 
+void SorterMultiPass::SortBlock() {
+  index.Sort(buf, buf_input_pos);
+  index.PermuteRows(buf, buf_tmp);  // blocks are written and merged as sorted rows
+  index.Clear();
+}
+
 void SorterMultiPass::Rewind() {
   while (!heap.empty())  // clear the heap
     heap.pop();
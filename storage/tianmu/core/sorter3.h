@@ -18,7 +18,9 @@
 #define TIANMU_CORE_SORTER3_H_
 #pragma once
 
+#include <atomic>
 #include <queue>
+#include <vector>
 
 #include "common/common_definitions.h"
 #include "mm/traceable_object.h"
@@ -59,6 +61,12 @@ class Sorter3 : public mm::TraceableObject {
   */
 
   virtual void Rewind() = 0;
+  /*
+        For sorters with a limit: the row holding the worst key still kept,
+        once the limit is reached (i.e. rows with larger keys are not needed).
+        Return nullptr if not known.
+  */
+  virtual unsigned char *LimitBound() { return nullptr; }
   /*
         Memory management
         For internal use only.
@@ -84,6 +92,59 @@ class Sorter3 : public mm::TraceableObject {
   uint no_obj;  // a number of values already added
 };
 
+// MSD radix sort of row pointers by binary-comparable keys; rows are not moved.
+// Large inputs are partitioned by the first key byte in parallel, then the
+// partitions are sorted as separate tasks of the query thread pool. The index
+// is allocated from the memory manager, as the sorted rows are.
+
+class RadixSortIndex : public mm::TraceableObject {
+ public:
+  RadixSortIndex(uint _key_bytes, uint _total_bytes, core::Transaction *_conn)
+      : key_bytes(_key_bytes), total_bytes(_total_bytes), conn(_conn) {}
+  RadixSortIndex(const RadixSortIndex &) = delete;
+  ~RadixSortIndex() { Clear(); }
+
+  void Sort(unsigned char *begin, unsigned char *end);  // rows in [begin, end)
+  size_t Size() const { return no_entries; }
+  unsigned char *Row(size_t i) const { return entries[i].row; }
+  // reorder the rows in their buffer, so that they follow the sorted index
+  void PermuteRows(unsigned char *begin, unsigned char *tmp_row);
+  void Clear();
+
+  // additional memory needed for one row
+  static constexpr uint BytesPerRow() { return 2 * sizeof(Entry); }
+
+ private:
+  static constexpr size_t kSmallRange = 48;           // sorted by comparisons
+  static constexpr size_t kParallelRows = 64 * 1024;  // smaller inputs are sorted by one thread
+
+  struct Entry {
+    uint64_t prefix;  // the key bytes starting at the current depth, big endian
+    unsigned char *row;
+  };
+  struct Range {
+    size_t lo, hi;
+    uint depth;  // the first key byte not known to be equal in the range
+  };
+  void LoadPrefixes(size_t lo, size_t hi, uint depth);
+  void SortRange(size_t lo, size_t hi, uint depth);
+  void SortSmallRange(size_t lo, size_t hi, uint depth);
+  void ParallelSort(int no_tasks);
+  void TaskHistogram(size_t lo, size_t hi, size_t *counts);
+  void TaskScatter(size_t lo, size_t hi, size_t *offsets);
+  void TaskSortBuckets(const std::vector<size_t> *bucket_start, std::atomic<int> *next_bucket);
+  int Byte(const Entry &e, uint depth) const { return int((e.prefix >> (56 - 8 * (depth % 8))) & 0xFF); }
+  mm::TO_TYPE TraceableType() const override { return mm::TO_TYPE::TO_SORTER; }
+
+  uint key_bytes;
+  uint total_bytes;
+  core::Transaction *conn;
+  Entry *entries = nullptr;
+  Entry *scratch = nullptr;  // scatter target, the same size as entries
+  size_t no_entries = 0;
+  size_t capacity = 0;  // of both entries and scratch
+};
+
 // quicksort on one memory buffer
 
 class SorterOnePass : public Sorter3 {
@@ -138,6 +199,9 @@ class SorterMultiPass : public SorterOnePass, private system::CacheableItem {
      // from disk on next use
 
  private:
+  void SortBlock();  // sort the current buffer before it is written as a block
+
+  RadixSortIndex index;
   int no_blocks;  // current input block number or a number of blocks
 
   class Keyblock {
@@ -174,6 +238,21 @@ class SorterMultiPass : public SorterOnePass, private system::CacheableItem {
   std::vector<BlockDescription> blocks;  // a list of blocks
 };
 
+// radix sort of a row index on one memory buffer
+
+class SorterRadix : public SorterOnePass {
+ public:
+  SorterRadix(uint _size, uint _key_bytes, uint _total_bytes);
+
+  unsigned char *GetNextValue() override;
+  void Rewind() override { output_pos = 0; }
+  const char *Name() const override { return "Radix Sort"; }
+
+ private:
+  RadixSortIndex index;
+  size_t output_pos;  // the next position of index to return
+};
+
 // counting sort for low-cardinality keys (up to 2 bytes); needs two buffers
 
 class SorterCounting : public Sorter3 {
@@ -215,6 +294,7 @@ class SorterLimit : public SorterOnePass {
 
   bool PutValue(unsigned char *buf) override;
   bool PutValue(Sorter3 *s) override;
+  unsigned char *LimitBound() override { return (key_bytes > 0 && size > 0 && no_obj == size) ? buf : nullptr; }
   const char *Name() const override { return "Heap Sort"; }
 
  private:
@@ -227,15 +227,17 @@ bool SorterWrapper::InitPackrow(MIIterator &mit)  // return true if the packrow
     return false;  // trivial sorter (constant values)
 
   // rough sort: exclude packs which are for sure out of scope
-  if (rough_sort_by > -1 && limit > -1 && no_values_encoded >= limit) {
+  if (rough_sort_by > -1 && limit > -1 && (no_values_encoded >= limit || shared_limit)) {
     // nontrivial rough_sort_by => numerical case only
     vcolumn::VirtualColumn *vc = input_cols[rough_sort_by].col;
     if (vc->GetNumOfNulls(mit) == 0) {
       bool asc = (input_cols[rough_sort_by].sort_order > 0);  // ascending sort
       int64_t local_min = (asc ? vc->GetMinInt64(mit) : common::MINUS_INF_64);
       int64_t local_max = (asc ? common::PLUS_INF_64 : vc->GetMaxInt64(mit));
-      if (scol[rough_sort_by].ImpossibleValues(local_min, local_max))
+      if (no_values_encoded >= limit && scol[rough_sort_by].ImpossibleValues(local_min, local_max))
         return true;  // exclude
+      if (RoughLimitExcludes(asc, local_min, local_max))
+        return true;
     }
   }
 
@@ -255,6 +257,34 @@ bool SorterWrapper::InitPackrow(MIIterator &mit)  // return true if the packrow
   return false;
 }
 
+int64_t SorterWrapper::RoughLimitStart() {
+  if (rough_sort_by > -1 && input_cols[rough_sort_by].sort_order < 0)
+    return common::MINUS_INF_64;
+  return common::PLUS_INF_64;
+}
+
+bool SorterWrapper::RoughLimitExcludes(bool asc, int64_t pack_min, int64_t pack_max) {
+  // The worst row kept by a full limit sorter bounds the first sort column:
+  // a pack entirely behind it cannot contribute. Rows equal to the bound may
+  // still win on further sort columns, so the comparisons are strict.
+  int64_t bound = (asc ? common::PLUS_INF_64 : common::MINUS_INF_64);
+  unsigned char *bound_row = s->LimitBound();
+  if (bound_row) {
+    bool is_null = false;
+    int64_t v = scol[rough_sort_by].GetValue64(bound_row, cur_mit, is_null);
+    if (!is_null)
+      bound = v;
+  }
+  if (shared_limit) {
+    // local heaps are merged at the end, so the best bound of any worker is valid for all of them
+    int64_t cur = shared_limit->load();
+    while ((asc ? bound < cur : bound > cur) && !shared_limit->compare_exchange_weak(cur, bound)) {
+    }
+    bound = (asc ? std::min(bound, cur) : std::max(bound, cur));
+  }
+  return (asc ? pack_min > bound : pack_max < bound);
+}
+
 bool SorterWrapper::PutValues(MIIterator &mit) {
   if (s == nullptr)
     return false;  // trivial sorter (constant values)
@@ -18,6 +18,8 @@
 #define TIANMU_CORE_SORTER_WRAPPER_H_
 #pragma once
 
+#include <atomic>
+
 #include "core/column_bin_encoder.h"
 #include "core/mi_iterator.h"
 #include "core/multi_index.h"
@@ -53,10 +55,15 @@ class SorterWrapper {
   int64_t GetValue64(int col, bool &is_null) { return scol[col].GetValue64(cur_val, cur_mit, is_null); }
   types::BString GetValueT(int col) { return scol[col].GetValueT(cur_val, cur_mit); }
   void SortRoughly(std::vector<PackOrderer> &po);
+  // parallel top-N: the workers share the best known limit value of the first
+  // sort column, initialized by RoughLimitStart()
+  void ShareRoughLimit(std::atomic<int64_t> *limit_value) { shared_limit = limit_value; }
+  int64_t RoughLimitStart();
   Sorter3 *GetSorter() { return s; }
 
  private:
   int64_t GetEncodedValNum() { return no_values_encoded; }
+  bool RoughLimitExcludes(bool asc, int64_t pack_min, int64_t pack_max);
   Sorter3 *s;
   MultiindexPositionEncoder *mi_encoder;  // if null, then no multiindex position encoding is needed
   int64_t limit;
@@ -67,6 +74,7 @@ class SorterWrapper {
   unsigned char *cur_val;     // a pointer to the current (last fetched) output row
   unsigned char *input_buf;   // a buffer of buf_size to prepare rows
   MIDummyIterator cur_mit;    // a position of multiindex for implicit (virtual) columns
+  std::atomic<int64_t> *shared_limit = nullptr;  // see ShareRoughLimit()
 
   std::vector<ColumnBinEncoder> scol;  // encoders for sorted columns
 
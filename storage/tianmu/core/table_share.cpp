@@ -16,11 +16,14 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <mutex>
 
+#include "core/engine.h"
 #include "core/table_share.h"
 #include "core/tianmu_table.h"
+#include "util/thread_pool.h"
 
 namespace Tianmu {
 namespace core {
@@ -40,18 +43,43 @@ TableShare::TableShare(const fs::path &table_path, const TABLE_SHARE *table_shar
     throw common::DatabaseException("Bad format of table definition in " + table_path.string() +
                                     ": invalid pack size shift " + std::to_string(meta.pss));
 
-  m_columns.reserve(no_cols);
+  auto open_start = std::chrono::steady_clock::now();
 
+  std::vector<common::TX_ID> xids(no_cols);
   system::TianmuFile fv;
   fv.OpenReadOnly(table_path / common::TABLE_VERSION_FILE);
-  for (uint i = 0; i < no_cols; i++) {
-    common::TX_ID xid;
-    fv.ReadExact(&xid, sizeof(xid));
-    Field *field = table_share->field[i];
+  fv.ReadExact(xids.data(), sizeof(common::TX_ID) * no_cols);
+
+  // Columns are opened independently of each other, wide tables on the query
+  // thread pool, unless this already runs on one of its threads (add_task()
+  // does not accept tasks from the pool's own workers).
+  m_columns.resize(no_cols);
+  auto open_column = [this, &table_path, &xids, table_share](uint i) {
     auto colpath = table_path / common::COLUMN_DIR / std::to_string(i);
-    m_columns.emplace_back(std::make_unique<ColumnShare>(this, xid, i, colpath, field));
+    m_columns[i] = std::make_unique<ColumnShare>(this, xids[i], i, colpath, table_share->field[i]);
+  };
+  if (no_cols < kParallelOpenMinCols || ha_tianmu_engine_->query_thread_pool.size() <= 1 ||
+      ha_tianmu_engine_->query_thread_pool.is_owner()) {
+    for (uint i = 0; i < no_cols; i++) open_column(i);
+  } else {
+    utils::result_set<void> res;
+    try {
+      for (uint i = 0; i < no_cols; i++) res.insert(ha_tianmu_engine_->query_thread_pool.add_task(open_column, i));
+      res.get_all_with_except();
+    } catch (...) {
+      res.wait_all();  // the tasks refer to the locals above
+      throw;
+    }
   }
   thr_lock_init(&thr_lock);
+
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - open_start).count();
+  if (tianmu_sysvar_slow_query_record_interval > 0 && elapsed >= 1000 * tianmu_sysvar_slow_query_record_interval)
+    TIANMU_LOG(LogCtl_Level::INFO, "Opened table %s with %lu columns in %ld ms", table_path.c_str(), no_cols, elapsed);
+  else
+    TIANMU_LOG(LogCtl_Level::DEBUG, "Opened table %s with %lu columns in %ld ms", table_path.c_str(), no_cols,
+               elapsed);
 }
 
 TableShare::~TableShare() {
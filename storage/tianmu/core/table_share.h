@@ -23,6 +23,7 @@
 #include "core/column_share.h"
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -38,7 +39,7 @@ struct TABLE_META {
   uint32_t pss = 16;
 };
 
-class TableShare final {
+class TableShare final : public std::enable_shared_from_this<TableShare> {
  public:
   TableShare(const fs::path &table_path, const TABLE_SHARE *table_share);
   TableShare() = delete;
@@ -68,6 +69,8 @@ class TableShare final {
   THR_LOCK thr_lock;
 
  private:
+  static constexpr size_t kParallelOpenMinCols = 8;
+
   TABLE_META meta;
   size_t no_cols;
   fs::path table_path;
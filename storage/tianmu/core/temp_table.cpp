@@ -2149,6 +2149,106 @@ void TempTable::Materialize(bool in_subq, ResultSender *sender, bool lazy) {
 }
 
 // here we deal with both signed/unsigned, the exact values will be converted on send results phase.
+namespace {
+types::TianmuDataType *NewDisplayableValue(common::ColumnType att_type) {
+  if (att_type == common::ColumnType::INT || att_type == common::ColumnType::MEDIUMINT ||
+      att_type == common::ColumnType::SMALLINT || att_type == common::ColumnType::BYTEINT ||
+      ATI::IsRealType(att_type) || att_type == common::ColumnType::NUM || att_type == common::ColumnType::BIGINT ||
+      att_type == common::ColumnType::BIT)
+    return new types::TianmuNum();
+  if (ATI::IsDateTimeType(att_type))
+    return new types::TianmuDateTime();
+  ASSERT(ATI::IsStringType(att_type), "not all possible attr_types checked");
+  return new types::BString();
+}
+
+// Converts one attribute of rows [first_row, first_row + rows.size()) with
+// the type dispatch hoisted out of the row loop.
+template <typename T, typename F>
+void FillColumnValues(AttrBuffer<T> &buf, uint att, uint64_t first_row,
+                      std::vector<TempTable::RecordValues> &rows, F assign) {
+  for (size_t i = 0; i < rows.size(); i++) assign(*rows[i][att], buf[first_row + i]);
+}
+}  // namespace
+
+void TempTable::GetDisplayableValues(Transaction *txn, uint64_t first_row, std::vector<RecordValues> &rows) {
+  DEBUG_ASSERT(first_row + rows.size() <= uint64_t(NumOfObj()));
+  // save TLS for mysql function and the memory manager
+  common::SetMySQLTHD(txn->Thd());
+  current_txn_ = txn;
+  uint no_disp_attr = NumOfDisplaybleAttrs();
+  for (auto &r : rows)
+    if (r.size() != no_disp_attr) {
+      r.clear();
+      for (uint att = 0; att < no_disp_attr; ++att)
+        r.emplace_back(NewDisplayableValue(GetDisplayableAttrP(att)->TypeName()));
+    }
+
+  for (uint att = 0; att < no_disp_attr; ++att) {
+    Attr *attr = GetDisplayableAttrP(att);
+    common::ColumnType attrt_tmp = attr->TypeName();
+    if (attrt_tmp == common::ColumnType::INT || attrt_tmp == common::ColumnType::MEDIUMINT) {
+      FillColumnValues(*(AttrBuffer<int> *)attr->buffer, att, first_row, rows,
+                       [attrt_tmp](types::TianmuDataType &dt, int v) {
+                         if (v == common::NULL_VALUE_32)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuNum &)dt).Assign(v, 0, false, attrt_tmp);
+                       });
+    } else if (attrt_tmp == common::ColumnType::SMALLINT) {
+      FillColumnValues(*(AttrBuffer<short> *)attr->buffer, att, first_row, rows,
+                       [attrt_tmp](types::TianmuDataType &dt, short v) {
+                         if (v == common::NULL_VALUE_SH)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuNum &)dt).Assign(v, 0, false, attrt_tmp);
+                       });
+    } else if (attrt_tmp == common::ColumnType::BYTEINT) {
+      FillColumnValues(*(AttrBuffer<char> *)attr->buffer, att, first_row, rows,
+                       [attrt_tmp](types::TianmuDataType &dt, char v) {
+                         if (v == common::NULL_VALUE_C)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuNum &)dt).Assign(v, 0, false, attrt_tmp);
+                       });
+    } else if (ATI::IsRealType(attrt_tmp)) {
+      FillColumnValues(*(AttrBuffer<double> *)attr->buffer, att, first_row, rows,
+                       [](types::TianmuDataType &dt, double v) {
+                         if (v == NULL_VALUE_D)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuNum &)dt).Assign(v);
+                       });
+    } else if (attrt_tmp == common::ColumnType::NUM || attrt_tmp == common::ColumnType::BIGINT ||
+               attrt_tmp == common::ColumnType::BIT) {
+      int scale = attr->Type().GetScale();
+      FillColumnValues(*(AttrBuffer<int64_t> *)attr->buffer, att, first_row, rows,
+                       [attrt_tmp, scale](types::TianmuDataType &dt, int64_t v) {
+                         if (v == common::NULL_VALUE_64)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuNum &)dt).Assign(v, scale, false, attrt_tmp);
+                       });
+    } else if (ATI::IsDateTimeType(attrt_tmp)) {
+      FillColumnValues(*(AttrBuffer<int64_t> *)attr->buffer, att, first_row, rows,
+                       [attrt_tmp](types::TianmuDataType &dt, int64_t v) {
+                         if (v == common::NULL_VALUE_64)
+                           dt.SetToNull();
+                         else
+                           ((types::TianmuDateTime &)dt).Assign(v, attrt_tmp);
+                       });
+    } else {
+      ASSERT(ATI::IsStringType(attrt_tmp), "not all possible attr_types checked");
+      auto &buf = *(AttrBuffer<types::BString> *)attr->buffer;
+      types::BString s;
+      for (size_t i = 0; i < rows.size(); i++) {
+        buf.GetString(s, first_row + i);
+        ((types::BString &)*rows[i][att]).PersistentCopy(s);
+      }
+    }
+  }
+}
+
 void TempTable::RecordIterator::PrepareValues() {
   if (_currentRNo < uint64_t(table->NumOfObj())) {
     uint no_disp_attr = table->NumOfDisplaybleAttrs();
@@ -2218,20 +2318,8 @@ TempTable::RecordIterator::RecordIterator(TempTable *table_, Transaction *conn_,
     : table(table_), _currentRNo(rowNo_), _conn(conn_), is_prepared(false) {
   DEBUG_ASSERT(table != 0);
   DEBUG_ASSERT(_currentRNo <= uint64_t(table->NumOfObj()));
-  for (uint att = 0; att < table->NumOfDisplaybleAttrs(); att++) {
-    common::ColumnType att_type = table->GetDisplayableAttrP(att)->TypeName();
-    if (att_type == common::ColumnType::INT || att_type == common::ColumnType::MEDIUMINT ||
-        att_type == common::ColumnType::SMALLINT || att_type == common::ColumnType::BYTEINT ||
-        ATI::IsRealType(att_type) || att_type == common::ColumnType::NUM || att_type == common::ColumnType::BIGINT ||
-        att_type == common::ColumnType::BIT)
-      dataTypes.emplace_back(new types::TianmuNum());
-    else if (ATI::IsDateTimeType(att_type))
-      dataTypes.emplace_back(new types::TianmuDateTime());
-    else {
-      ASSERT(ATI::IsStringType(att_type), "not all possible attr_types checked");
-      dataTypes.emplace_back(new types::BString());
-    }
-  }
+  for (uint att = 0; att < table->NumOfDisplaybleAttrs(); att++)
+    dataTypes.emplace_back(NewDisplayableValue(table->GetDisplayableAttrP(att)->TypeName()));
 }
 
 TempTable::RecordIterator::RecordIterator(RecordIterator const &it)
@@ -18,6 +18,7 @@
 #define TIANMU_CORE_TEMP_TABLE_H_
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "common/common_definitions.h"
@@ -386,7 +387,8 @@ class TempTable : public JustATable {
   void MoveVC(vcolumn::VirtualColumn *vc, std::vector<vcolumn::VirtualColumn *> &from,
               std::vector<vcolumn::VirtualColumn *> &to);
   void FillbufferTask(Attr *attr, Transaction *txn, MIIterator *page_start, int64_t start_row, int64_t page_end);
-  size_t TaskPutValueInST(MIIterator *it, Transaction *ci, SorterWrapper *st);
+  size_t TaskPutValueInST(MIIterator *it, Transaction *ci, SorterWrapper *st, int dim, const std::vector<int> *packs,
+                          std::atomic<size_t> *next_pack);
   bool HasTempTable() const { return has_temp_table; }
 
   void MarkCondPush() { can_cond_push_down = true; };
@@ -451,6 +453,13 @@ class TempTable : public JustATable {
   virtual RecordIterator begin(Transaction *conn = nullptr);
   virtual RecordIterator end(Transaction *conn = nullptr);
 
+  using RecordValues = std::vector<std::unique_ptr<types::TianmuDataType>>;
+  // Fills `rows` with the displayable values of rows [first_row, first_row + rows.size()),
+  // one attribute at a time. Strings are copied, so the values stay valid after
+  // the attribute buffers move to other pages. Value objects are reused across calls.
+  // May run on a pool thread, txn is the transaction of the sending query.
+  void GetDisplayableValues(Transaction *txn, uint64_t first_row, std::vector<RecordValues> &rows);
+
  public:
   Transaction *m_conn;  // external pointer
 
@@ -79,7 +79,7 @@ bool TempTable::OrderByAndMaterialize(
   //   Xeon(R) CPU E5-2430 0 @ 2.20GHz
   // 2. Cannot support multi-dimension(join) case as MIIndex rewind so far does
   // not support it.
-  if (tianmu_sysvar_orderby_speedup && packs_no > 20 && no_dims == 1) {
+  if (tianmu_sysvar_orderby_speedup && packs_no > 20 && no_dims == 1 && one_dim != -1) {
     task_num = 8;
     // recheck the up threashold for each SortLimit sub-sortedtable
     if (((packs_no - 1) * ((1 << filter.mind_->ValueOfPower()) - 1)) / task_num < (limit + offset)) {
@@ -182,8 +182,21 @@ bool TempTable::OrderByAndMaterialize(
             << system::unlock;
     }
   } else {
-    int mod = packs_no % task_num;
-    int num = packs_no / task_num;
+    // The workers take packs one by one from a common list, the most
+    // promising ones first (as in the single-threaded rough sort), and share
+    // the current limit value to skip packs which cannot beat it.
+    std::vector<int> pack_order;
+    pack_order.reserve(packs_no);
+    std::vector<PackOrderer> rough_po(filter.mind_->NumOfDimensions());
+    sorted_table.SortRoughly(rough_po);
+    if (rough_po[one_dim].Initialized()) {
+      for (rough_po[one_dim].Rewind(); rough_po[one_dim].IsValid(); ++rough_po[one_dim])
+        pack_order.push_back(rough_po[one_dim].Current());
+    } else {
+      for (int i = 0; i < packs_no; i++) pack_order.push_back(i);
+    }
+    std::atomic<size_t> next_pack{0};
+    std::atomic<int64_t> shared_limit{sorted_table.RoughLimitStart()};
 
     std::vector<MultiIndex> mis;
     mis.reserve(task_num);
@@ -191,30 +204,29 @@ bool TempTable::OrderByAndMaterialize(
     taskIterator.reserve(task_num);
 
     for (int i = 0; i < task_num; ++i) {
-      int pstart = ((i == 0) ? 0 : mod + i * num);
-      int pend = mod + (i + 1) * num - 1;
-      TIANMU_LOG(LogCtl_Level::INFO, "create new MIIterator: start pack %d, endpack %d", pstart, pend);
-
       auto &mi = mis.emplace_back(*filter.mind_, true);
 
       auto &mii = taskIterator.emplace_back(&mi, all_dims, po);
       mii.SetTaskNum(task_num);
       mii.SetTaskId(i);
-      mii.SetNoPacksToGo(pend);
-      mii.RewindToPack(pstart);
     }
 
     TIANMU_LOG(LogCtl_Level::DEBUG, "table statistic  no_dim %d, packs_no %d \n", one_dim, packs_no);
-    // Repeat the same logic to prepare the new sort tables
-    // Note: Don't RoughSort them as it would impact initPack logic
-    // and some rows would be skipped from adding in the sort table
+    // The sub-tables are not rough sorted themselves: their workers follow
+    // pack_order (the rough order of sorted_table) and skip packs against the
+    // shared limit instead.
 
-    for (int i = 0; i < task_num; i++) subsorted_table[i].InitSorter(*(filter.mind_), false);
+    for (int i = 0; i < task_num; i++) {
+      subsorted_table[i].InitSorter(*(filter.mind_), false);
+      subsorted_table[i].ShareRoughLimit(&shared_limit);
+    }
 
     utils::result_set<size_t> res;
     for (int i = 0; i < task_num; i++)
       res.insert(ha_tianmu_engine_->query_thread_pool.add_task(&TempTable::TaskPutValueInST, this, &taskIterator[i],
-                                                               current_txn_, &subsorted_table[i]));
+                                                               current_txn_, &subsorted_table[i], one_dim, &pack_order,
+                                                               &next_pack));
+    res.wait_all();
     if (filter.mind_->m_conn->Killed())
       throw common::KilledException("Query killed by user");
 
@@ -567,32 +579,34 @@ void TempTable::FillbufferTask(Attr *attr, Transaction *txn, MIIterator *page_st
   }
 }
 
-size_t TempTable::TaskPutValueInST(MIIterator *it, Transaction *ci, SorterWrapper *st) {
+size_t TempTable::TaskPutValueInST(MIIterator *it, Transaction *ci, SorterWrapper *st, int dim,
+                                   const std::vector<int> *packs, std::atomic<size_t> *next_pack) {
   size_t local_row = 0;
   bool continue_now = true;
   current_txn_ = ci;
-  while (it->IsValid() && continue_now) {
+  for (size_t n = next_pack->fetch_add(1); n < packs->size() && continue_now; n = next_pack->fetch_add(1)) {
     if (m_conn->Killed())
       throw common::KilledException();
 
-    if (it->PackrowStarted()) {
-      if (st->InitPackrow(*it)) {
-        local_row += it->GetPackSizeLeft();
-        it->NextPackrow();
-
-        TIANMU_LOG(LogCtl_Level::DEBUG, "skip this pack it %x", it);
-        continue;
-      }
+    int pack = (*packs)[n];
+    if (!it->RewindToPack(pack) || !it->IsValid() || it->GetCurPackrow(dim) != pack)
+      continue;  // no rows left in this pack
+    if (st->InitPackrow(*it)) {
+      local_row += it->GetPackSizeLeft();
+      TIANMU_LOG(LogCtl_Level::DEBUG, "skip this pack %d", pack);
+      continue;
     }
 
-    continue_now = st->PutValues(*it);  // return false if a limit is already reached (min. values only)
-    ++(*it);
+    do {
+      continue_now = st->PutValues(*it);  // return false if a limit is already reached (min. values only)
+      ++(*it);
 
-    local_row++;
-    if (local_row % 10000000 == 0)
-      tianmu_control_.lock(m_conn->GetThreadID())
-          << "Preparing values to sort (" << int(local_row / double(filter.mind_->NumOfTuples()) * 100) << "% done)."
-          << system::unlock;
+      local_row++;
+      if (local_row % 10000000 == 0)
+        tianmu_control_.lock(m_conn->GetThreadID())
+            << "Preparing values to sort (" << int(local_row / double(filter.mind_->NumOfTuples()) * 100)
+            << "% done)." << system::unlock;
+    } while (continue_now && it->IsValid() && !it->PackrowStarted());
   }
 
   return local_row;
@@ -797,25 +797,51 @@ void TianmuAttr::LockPackForUse(common::PACK_INDEX pn) {
         sp = ha_tianmu_engine_->cache.GetOrFetchObject<Pack>(get_pc(pn), this);
       } catch (std::exception &e) {
         dpn->SetPackPtr(0);
+        ha_tianmu_engine_->cache.NotifyPackLoaded(dpn);
         TIANMU_LOG(LogCtl_Level::ERROR, "An exception is caught: %s", e.what());
         throw e;
       } catch (...) {
         dpn->SetPackPtr(0);
+        ha_tianmu_engine_->cache.NotifyPackLoaded(dpn);
         TIANMU_LOG(LogCtl_Level::ERROR, "An unknown system exception error caught.");
         throw;
       }
 
       uint64_t newv = reinterpret_cast<unsigned long>(sp.get()) + tag_one;
       uint64_t expected = loading_flag;
-      ASSERT(dpn->CAS(expected, newv),
+      bool published = dpn->CAS(expected, newv);
+      ha_tianmu_engine_->cache.NotifyPackLoaded(dpn);
+      ASSERT(published,
              "bad loading flag" + std::to_string(newv) + ". " + Path().string() + " index:" + std::to_string(pn));
       return;
     }
-    // some one is loading data, wait a while and retry
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    // some one is loading data, sleep until it is published and retry
+    ha_tianmu_engine_->cache.WaitForPackLoad(dpn);
   }
 }
 
+// Read the given packs into the data cache in the background, so that a
+// following LockPackForUse() finds them there. Packs which are trivial,
+// local to the current transaction or already attached to their DPN are
+// skipped. The coordinates are taken here, the background task only needs
+// the column share, which it keeps alive through its table share.
+void TianmuAttr::PrefetchPacks(const std::vector<int> &packs) {
+  if (m_idx.empty() || !ha_tianmu_engine_->PrefetchAllowed())
+    return;
+
+  std::vector<PackCoordinate> pcs;
+  for (auto pn : packs) {
+    if (pn < 0 || size_t(pn) >= m_idx.size())
+      continue;
+    auto const &dpn(get_dpn(pn));
+    if (dpn.IsLocal() || dpn.Trivial() || dpn.GetPackPtr() != 0)
+      continue;
+    pcs.push_back(get_pc(pn));
+  }
+  if (!pcs.empty())
+    ha_tianmu_engine_->PrefetchPacks(m_share->owner->shared_from_this(), m_share, std::move(pcs));
+}
+
 void TianmuAttr::UnlockPackFromUse(common::PACK_INDEX pn) {
   if (m_idx.empty()) {  // in case table not insert data
     return;
@@ -863,12 +889,7 @@ void TianmuAttr::Collapse() {
 
 void TianmuAttr::Release() { Collapse(); }
 
-std::shared_ptr<Pack> TianmuAttr::Fetch(const PackCoordinate &pc) {
-  auto dpn = m_share->get_dpn_ptr(pc_dp(pc));
-  if (GetPackType() == common::PackType::STR)
-    return std::make_shared<PackStr>(dpn, pc, m_share);
-  return std::make_shared<PackInt>(dpn, pc, m_share);
-}
+std::shared_ptr<Pack> TianmuAttr::Fetch(const PackCoordinate &pc) { return m_share->Fetch(pc); }
 
 std::shared_ptr<FTree> TianmuAttr::Fetch([[maybe_unused]] const FTreeCoordinate &coord) {
   auto sp = std::make_shared<FTree>();
@@ -204,6 +204,7 @@ class TianmuAttr final : public mm::TraceableObject, public PhysicalColumn, publ
 
   void LockPackForUse(common::PACK_INDEX pi);
   void UnlockPackFromUse(common::PACK_INDEX pi);
+  void PrefetchPacks(const std::vector<int> &packs);
 
   void CopyPackForWrite(common::PACK_INDEX pi);
 
@@ -349,6 +350,7 @@ class TianmuAttr final : public mm::TraceableObject, public PhysicalColumn, publ
   void GetTextStat(types::TextStat &s, Filter *f = nullptr) override;
 
   std::vector<int64_t> GetListOfDistinctValuesInPack(int pack) override;
+  bool GetValuesInt64(int pack, int64_t *out) const override;
 
   void LoadData(loader::ValueCache *nvs, Transaction *conn_info = nullptr);
   void LoadPackInfo(Transaction *trans_ = current_txn_);
@@ -708,6 +708,36 @@ std::vector<int64_t> TianmuAttr::GetListOfDistinctValuesInPack(int pack) {
   return list_vals;
 }
 
+bool TianmuAttr::GetValuesInt64(int pack, int64_t *out) const {
+  if (GetPackType() != common::PackType::INT || pack < 0)
+    return false;
+  auto const &dpn(get_dpn(pack));
+  if (dpn.NullOnly()) {
+    std::fill_n(out, dpn.numOfRecords, common::NULL_VALUE_64);
+    return true;
+  }
+  auto p = get_packN(pack);
+  if (dpn.min_i == dpn.max_i) {  // uniform, possibly with nulls
+    std::fill_n(out, dpn.numOfRecords, dpn.min_i);
+  } else {
+    if (p == nullptr || !p->IsLocked())
+      return false;
+    // 2-level encoding, doubles are stored natively
+    int64_t base = ATI::IsRealType(TypeName()) ? 0 : dpn.min_i;
+    p->VisitValues([out, base](const auto *values, size_t no_values) {
+      for (size_t i = 0; i < no_values; i++) out[i] = int64_t(values[i]) + base;
+    });
+  }
+  if (dpn.numOfNulls > 0) {
+    if (p == nullptr || !p->IsLocked())
+      return false;
+    for (uint i = 0; i < dpn.numOfRecords; i++)
+      if (p->IsNull(i))
+        out[i] = common::NULL_VALUE_64;
+  }
+  return true;
+}
+
 uint64_t TianmuAttr::ApproxDistinctVals(bool incl_nulls, Filter *f, common::RoughSetValue *rf,
                                         bool outer_nulls_possible) {
   LoadPackInfo();
@@ -20,8 +20,11 @@
  mechanisms
 */
 
+#include <algorithm>
+
 #include "common/assert.h"
 #include "core/cq_term.h"
+#include "core/like_matcher.h"
 #include "core/pack_guardian.h"
 #include "core/pack_str.h"
 #include "core/tianmu_attr.h"
@@ -30,6 +33,7 @@
 #include "core/transaction.h"
 #include "core/value_set.h"
 #include "util/hash64.h"
+#include "util/simd_filter.h"
 #include "vc/const_column.h"
 #include "vc/in_set_column.h"
 #include "vc/single_column.h"
@@ -37,6 +41,75 @@
 namespace Tianmu {
 namespace core {
 
+namespace {
+// Per thread scratch for the whole-pack kernels used when a filter block is
+// evaluated in one pass (see utils::simd).
+uint32_t *PackMaskBuffer(size_t rows) {
+  thread_local std::vector<uint32_t> buf;
+  buf.resize(utils::simd::MaskWords(rows));
+  return buf.data();
+}
+
+int64_t *PackValueBuffer(size_t rows, int which) {
+  thread_local std::vector<int64_t> buf[2];
+  buf[which].resize(rows);
+  return buf[which].data();
+}
+
+// values of a uniform double pack, which may not be loaded
+const double *UniformDoubles(size_t rows, double v, int which) {
+  thread_local std::vector<double> buf[2];
+  buf[which].assign(rows, v);
+  return buf[which].data();
+}
+
+bool ToCmpOp(common::Operator op, utils::simd::CmpOp &res) {
+  switch (op) {
+    case common::Operator::O_EQ:
+      res = utils::simd::CmpOp::EQ;
+      return true;
+    case common::Operator::O_NOT_EQ:
+      res = utils::simd::CmpOp::NE;
+      return true;
+    case common::Operator::O_LESS:
+      res = utils::simd::CmpOp::LT;
+      return true;
+    case common::Operator::O_LESS_EQ:
+      res = utils::simd::CmpOp::LE;
+      return true;
+    case common::Operator::O_MORE:
+      res = utils::simd::CmpOp::GT;
+      return true;
+    case common::Operator::O_MORE_EQ:
+      res = utils::simd::CmpOp::GE;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// IN lists longer than this are cheaper to probe through the hash set
+constexpr size_t kInMaskMaxValues = 32;
+
+// predicate result per distinct value of a trie encoded string pack
+std::vector<uint8_t> &PackKeyBuffer() {
+  thread_local std::vector<uint8_t> buf;
+  return buf;
+}
+
+// A trie pack is evaluated once per distinct key only when it has no more
+// keys than rows left to visit; under a sparse filter most keys would be
+// evaluated for nothing.
+bool EvaluatePerKey(PackStr *p, MIUpdatingIterator &mit, int dim, int pack, size_t rows) {
+  if (!p->IsTrie())
+    return false;
+  auto filter = mit.GetMultiIndex()->GetFilter(dim);
+  if (filter)
+    rows = filter->NumOfOnes(pack);
+  return p->NumOfKeys() <= rows;
+}
+}  // namespace
+
 void TianmuAttr::EvaluatePack(MIUpdatingIterator &mit, int dim, Descriptor &d) {
   MEASURE_FET("TianmuAttr::EvaluatePack(...)");
   ASSERT(d.encoded, "Descriptor is not encoded!");
@@ -119,14 +192,20 @@ common::ErrorCode TianmuAttr::EvaluateOnIndex_BetweenInt(MIUpdatingIterator &mit
   if (d.op != common::Operator::O_NOT_BETWEEN)
     filter->Reset();
 
+  // the primary key if it leads with this column, else a secondary key on it
   std::vector<uint> keycols = indextab->KeyCols();
-  if (keycols.size() > 0 && keycols[0] == ColId()) {
+  bool on_pk = keycols.size() > 0 && keycols[0] == ColId();
+  auto sk = on_pk ? nullptr : indextab->SecondaryKeyOn(ColId());
+  if (on_pk || sk) {
     int64_t passed = 0;
     index::KeyIterator iter(&current_txn_->KVTrans());
     std::vector<std::string> fields;
     fields.emplace_back((const char *)&pv1, sizeof(int64_t));
 
-    iter.ScanToKey(indextab, fields, common::Operator::O_MORE_EQ);
+    if (on_pk)
+      iter.ScanToKey(indextab, fields, common::Operator::O_MORE_EQ);
+    else
+      iter.ScanToKey(*sk, fields, {false}, common::Operator::O_MORE_EQ);
     while (iter.IsValid()) {
       uint64_t row = 0;
       std::vector<std::string> vkeys;
@@ -183,14 +262,21 @@ common::ErrorCode TianmuAttr::EvaluateOnIndex_BetweenString(MIUpdatingIterator &
   if (d.op != common::Operator::O_NOT_BETWEEN)
     filter->Reset();
 
+  // the primary key if it leads with this column, else a secondary key on it
   std::vector<uint> keycols = indextab->KeyCols();
-  if (keycols.size() > 0 && keycols[0] == ColId()) {
+  bool on_pk = keycols.size() > 0 && keycols[0] == ColId();
+  auto sk = on_pk ? nullptr : indextab->SecondaryKeyOn(ColId());
+  if (on_pk || sk) {
     int64_t passed = 0;
     index::KeyIterator iter(&current_txn_->KVTrans());
     std::vector<std::string> fields;
     fields.emplace_back(pv1.GetDataBytesPointer(), pv1.size());
 
-    iter.ScanToKey(indextab, fields, (d.sharp ? common::Operator::O_MORE : common::Operator::O_MORE_EQ));
+    common::Operator op = d.sharp ? common::Operator::O_MORE : common::Operator::O_MORE_EQ;
+    if (on_pk)
+      iter.ScanToKey(indextab, fields, op);
+    else
+      iter.ScanToKey(*sk, fields, {false}, op);
     while (iter.IsValid()) {
       uint64_t row = 0;
       std::vector<std::string> vkeys;
@@ -249,13 +335,20 @@ common::ErrorCode TianmuAttr::EvaluateOnIndex_BetweenString_UTF(MIUpdatingIterat
   if (d.op != common::Operator::O_NOT_BETWEEN)
     filter->Reset();
 
+  // the primary key if it leads with this column, else a secondary key on it
   std::vector<uint> keycols = indextab->KeyCols();
-  if (keycols.size() > 0 && keycols[0] == ColId()) {
+  bool on_pk = keycols.size() > 0 && keycols[0] == ColId();
+  auto sk = on_pk ? nullptr : indextab->SecondaryKeyOn(ColId());
+  if (on_pk || sk) {
     int64_t passed = 0;
     index::KeyIterator iter(&current_txn_->KVTrans());
     std::vector<std::string> fields;
     fields.emplace_back(pv1.GetDataBytesPointer(), pv1.size());
-    iter.ScanToKey(indextab, fields, (d.sharp ? common::Operator::O_MORE : common::Operator::O_MORE_EQ));
+    common::Operator op = d.sharp ? common::Operator::O_MORE : common::Operator::O_MORE_EQ;
+    if (on_pk)
+      iter.ScanToKey(indextab, fields, op);
+    else
+      iter.ScanToKey(*sk, fields, {false}, op);
     DTCollation coll = d.GetCollation();
     while (iter.IsValid()) {
       uint64_t row = 0;
@@ -391,8 +484,6 @@ void TianmuAttr::EvaluatePack_NotNull(MIUpdatingIterator &mit, int dim) {
   }
 }
 
-bool IsSpecialChar(char c, Descriptor &d) { return c == '%' || c == '_' || c == d.like_esc; }
-
 void TianmuAttr::EvaluatePack_Like(MIUpdatingIterator &mit, int dim, Descriptor &d) {
   MEASURE_FET("TianmuAttr::EvaluatePack_Like(...)");
   int pack = mit.GetCurPackrow(dim);
@@ -409,58 +500,34 @@ void TianmuAttr::EvaluatePack_Like(MIUpdatingIterator &mit, int dim, Descriptor
   }
   types::BString pattern;
   d.val1.vc->GetValueString(pattern, mit);
-  size_t min_len = 0;  // the number of fixed characters
-  for (uint i = 0; i < pattern.len_; i++) {
-    if (pattern[i] != '%')
-      min_len++;
-    if (pattern[i] == d.like_esc) {  // disable optimization, escape character
-                                     // may do a lot of mess
-      min_len = 0;
-      break;
-    }
-  }
-  std::unordered_set<uint16_t> possible_ids;
-  bool use_trie = false;
-  bool pure_prefix = false;
-  if (!pattern.IsNullOrEmpty() && !IsSpecialChar(pattern[0], d) && p->IsTrie()) {
-    auto first_wildcard = pattern.begin();
-    std::size_t prefixlen = 0;
-    while (first_wildcard != pattern.end() && !IsSpecialChar(*first_wildcard, d)) {
-      first_wildcard++;
-      prefixlen++;
-    }
-    use_trie = p->LikePrefix(pattern, prefixlen, possible_ids);
-    if (possible_ids.empty()) {
+  LikeMatcher matcher(pattern, d.like_esc);
+  bool not_like = (d.op == common::Operator::O_NOT_LIKE);
+  auto passes = [&matcher, not_like](const char *s, size_t len) { return matcher.Match(s, len) != not_like; };
+  std::vector<uint8_t> &key_passes = PackKeyBuffer();
+  bool per_key = EvaluatePerKey(p, mit, dim, pack, get_dpn(pack).numOfRecords);
+  if (per_key) {
+    // one evaluation per distinct value instead of one per row
+    p->EvaluateKeys(passes, key_passes);
+    if (std::find(key_passes.begin(), key_passes.end(), 1) == key_passes.end()) {
       mit.ResetCurrentPack();
       mit.NextPackrow();
       return;
     }
-    if (first_wildcard == pattern.end() || (*first_wildcard == '%' && (++first_wildcard) == pattern.end()))
-      pure_prefix = true;
   }
   do {
     int inpack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || p->IsNull(inpack)) {
       mit.ResetCurrent();
-    } else if (use_trie && p->IsNotMatched(inpack, possible_ids)) {
-      mit.ResetCurrent();
-    } else if (pure_prefix) {
-      // The query is something like 'Pattern%' or 'Pattern', so
-      // if p->IsNotMatched() == false, then this is a match and
-      // there is no need to check it here.
-    } else {
+    } else if (per_key) {
+      if (!key_passes[p->GetKeyId(inpack)])
+        mit.ResetCurrent();
+    } else if (p->IsTrie()) {
       types::BString v(p->GetValueBinary(inpack));
-      auto len = v.size();
-      bool res;
-      if (len < min_len)
-        res = false;
-      else {
-        v.MakePersistent();
-        res = v.Like(pattern, d.like_esc);
-      }
-      if (d.op == common::Operator::O_NOT_LIKE)
-        res = !res;
-      if (!res)
+      if (!passes(v.val_, v.len_))
+        mit.ResetCurrent();
+    } else {
+      std::string_view v = p->GetValueView(inpack);
+      if (!passes(v.data(), v.size()))
         mit.ResetCurrent();
     }
     ++mit;
@@ -491,50 +558,38 @@ void TianmuAttr::EvaluatePack_Like_UTF(MIUpdatingIterator &mit, int dim, Descrip
   for (uint i = 0; i < pattern.len_; i++)
     if (pattern[i] != '%' && pattern[i] != '\\' && pattern[i] != d.like_esc)
       min_len++;
-  std::unordered_set<uint16_t> possible_ids;
-  bool use_trie = false;
-  bool pure_prefix = false;
-  if (!pattern.IsNullOrEmpty() && !IsSpecialChar(pattern[0], d) && p->IsTrie()) {
-    auto first_wildcard = pattern.begin();
-    std::size_t prefixlen = 0;
-    while (first_wildcard != pattern.end() && !IsSpecialChar(*first_wildcard, d)) {
-      first_wildcard++;
-      prefixlen++;
-    }
-    use_trie = p->LikePrefix(pattern, prefixlen, possible_ids);
-    if (possible_ids.empty()) {
+  DTCollation coll = d.GetCollation();
+  bool not_like = (d.op == common::Operator::O_NOT_LIKE);
+  auto passes = [&](const char *s, size_t len) {
+    bool res = false;
+    if (len >= min_len)
+      res = (common::wildcmp(coll, s, s + len, pattern.val_, pattern.val_ + pattern.len_, d.like_esc, '_', '%') == 0);
+    return res != not_like;
+  };
+  std::vector<uint8_t> &key_passes = PackKeyBuffer();
+  bool per_key = EvaluatePerKey(p, mit, dim, pack, get_dpn(pack).numOfRecords);
+  if (per_key) {
+    p->EvaluateKeys(passes, key_passes);
+    if (std::find(key_passes.begin(), key_passes.end(), 1) == key_passes.end()) {
       mit.ResetCurrentPack();
       mit.NextPackrow();
       return;
     }
-    if (first_wildcard == pattern.end() || (*first_wildcard == '%' && (++first_wildcard) == pattern.end()))
-      pure_prefix = true;
   }
   do {
     int inpack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || p->IsNull(inpack)) {
       mit.ResetCurrent();
-    } else if (use_trie && p->IsNotMatched(inpack, possible_ids)) {
-      mit.ResetCurrent();
-    } else if (pure_prefix) {
-      // The query is something like 'Pattern%' or 'Pattern', so
-      // if p->IsNotMatched() == false, then this is a match and
-      // there is no need to check it here.
-    } else {
+    } else if (per_key) {
+      if (!key_passes[p->GetKeyId(inpack)])
+        mit.ResetCurrent();
+    } else if (p->IsTrie()) {
       types::BString v(p->GetValueBinary(inpack));
-      auto len = v.size();
-      bool res;
-      if (len < min_len)
-        res = false;
-      else {
-        v.MakePersistent();
-        int x = common::wildcmp(d.GetCollation(), v.val_, v.val_ + v.len_, pattern.val_, pattern.val_ + pattern.len_,
-                                d.like_esc, '_', '%');
-        res = (x == 0 ? true : false);
-      }
-      if (d.op == common::Operator::O_NOT_LIKE)
-        res = !res;
-      if (!res)
+      if (!passes(v.val_, v.len_))
+        mit.ResetCurrent();
+    } else {
+      std::string_view v = p->GetValueView(inpack);
+      if (!passes(v.data(), v.size()))
         mit.ResetCurrent();
     }
     ++mit;
@@ -558,21 +613,38 @@ void TianmuAttr::EvaluatePack_InString(MIUpdatingIterator &mit, int dim, Descrip
   DEBUG_ASSERT(dynamic_cast<vcolumn::MultiValColumn *>(d.val1.vc) != nullptr);
   vcolumn::MultiValColumn *multival_column = static_cast<vcolumn::MultiValColumn *>(d.val1.vc);
   bool encoded_set = multival_column->IsSetEncoded(TypeName(), ct.GetScale());
+  bool not_in = (d.op == common::Operator::O_NOT_IN);
+  // values are probed in place; an encoded set is a hash lookup
+  auto passes = [&](const char *s, size_t len) {
+    common::Tribool res;
+    types::BString v(len == 0 ? ZERO_LENGTH_STRING : s, len);
+    if (encoded_set)  // fast path for numerics vs. encoded constant set
+      res = multival_column->ContainsString(mit, v);
+    else
+      res = multival_column->Contains(mit, v);
+    if (not_in)
+      res = !res;
+    return res == true;
+  };
+  std::vector<uint8_t> &key_passes = PackKeyBuffer();
+  bool per_key = (encoded_set || multival_column->IsConst()) &&
+                 EvaluatePerKey(p, mit, dim, pack, get_dpn(pack).numOfRecords);
+  if (per_key)
+    p->EvaluateKeys(passes, key_passes);
   do {
     int inpack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || p->IsNull(inpack))
       mit.ResetCurrent();
-    else {
-      common::Tribool res;
-      types::BString s;
-      s.PersistentCopy(p->GetValueBinary(inpack));
-      if (encoded_set)  // fast path for numerics vs. encoded constant set
-        res = multival_column->ContainsString(mit, s);
-      else
-        res = multival_column->Contains(mit, s);
-      if (d.op == common::Operator::O_NOT_IN)
-        res = !res;
-      if (res != true)
+    else if (per_key) {
+      if (!key_passes[p->GetKeyId(inpack)])
+        mit.ResetCurrent();
+    } else if (p->IsTrie()) {
+      types::BString s(p->GetValueBinary(inpack));
+      if (!passes(s.val_, s.len_))
+        mit.ResetCurrent();
+    } else {
+      std::string_view v = p->GetValueView(inpack);
+      if (!passes(v.data(), v.size()))
         mit.ResetCurrent();
     }
     if (current_txn_->Killed())
@@ -601,28 +673,45 @@ void TianmuAttr::EvaluatePack_InString_UTF(MIUpdatingIterator &mit, int dim, Des
   vcolumn::MultiValColumn *multival_column = static_cast<vcolumn::MultiValColumn *>(d.val1.vc);
   DTCollation coll = d.GetCollation();
   int arraysize = d.val1.cond_value.size();
+  bool short_list = (arraysize > 0 && arraysize < 10);
+  bool not_in = (d.op == common::Operator::O_NOT_IN);
+  auto passes = [&](const char *s, size_t len) {
+    common::Tribool res = false;
+    if (short_list) {
+      for (auto &it : d.val1.cond_value) {
+        if (coll.collation->coll->strnncoll(coll.collation, (const uchar *)it.val_, it.len_, (const uchar *)s, len,
+                                            0) == 0) {
+          res = true;
+          break;
+        }
+      }
+    } else {
+      types::BString vt(len == 0 ? ZERO_LENGTH_STRING : s, len);
+      res = multival_column->Contains(mit, vt);
+    }
+    if (not_in)
+      res = !res;
+    return res == true;
+  };
+  std::vector<uint8_t> &key_passes = PackKeyBuffer();
+  bool per_key = (short_list || multival_column->IsConst()) &&
+                 EvaluatePerKey(p, mit, dim, pack, get_dpn(pack).numOfRecords);
+  if (per_key)
+    p->EvaluateKeys(passes, key_passes);
   do {
     int inpack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || p->IsNull(inpack))
       mit.ResetCurrent();
-    else {
-      common::Tribool res = false;
-      types::BString vt(p->GetValueBinary(inpack));  //, true
-      if (arraysize > 0 && arraysize < 10) {
-        for (auto &it : d.val1.cond_value) {
-          if (coll.collation->coll->strnncoll(coll.collation, (const uchar *)it.val_, it.len_, (const uchar *)vt.val_,
-                                              vt.len_, 0) == 0) {
-            res = true;
-            break;
-          }
-        }
-      } else {
-        res = multival_column->Contains(mit, vt);
-      }
-
-      if (d.op == common::Operator::O_NOT_IN)
-        res = !res;
-      if (res != true)
+    else if (per_key) {
+      if (!key_passes[p->GetKeyId(inpack)])
+        mit.ResetCurrent();
+    } else if (p->IsTrie()) {
+      types::BString vt(p->GetValueBinary(inpack));
+      if (!passes(vt.val_, vt.len_))
+        mit.ResetCurrent();
+    } else {
+      std::string_view v = p->GetValueView(inpack);
+      if (!passes(v.data(), v.size()))
         mit.ResetCurrent();
     }
     if (current_txn_->Killed())
@@ -695,6 +784,22 @@ void TianmuAttr::EvaluatePack_InNum(MIUpdatingIterator &mit, int dim, Descriptor
       } while (mit.IsValid() && !mit.PackrowStarted());
     }
   } else {
+    auto filter = mit.GetMultiIndex()->GetFilter(dim);
+    if (tianmu_sysvar_filterevaluation_speedup && filter && arraysize > 0 && arraysize < 100 && p->IsFixed() &&
+        !ATI::IsRealType(TypeName()) && filter->NumOfOnes(pack) > static_cast<uint>(1 << (mit.GetPower() - 1))) {
+      // encode the set the way the pack stores values, dropping what cannot occur
+      std::vector<int64_t> vals;
+      for (auto v : d.val1.cond_numvalue->Values())
+        if (v >= local_min && v <= local_max)
+          vals.push_back(v - local_min);
+      if (vals.size() <= kInMaskMaxValues) {
+        uint32_t *mask = PackMaskBuffer(dpn.numOfRecords);
+        p->InMask(vals.data(), vals.size(), not_in, mask);
+        filter->AndMask(pack, mask, dpn.numOfRecords);
+        mit.NextPackrow();
+        return;
+      }
+    }
     do {
       if (mit[dim] == common::NULL_VALUE_64 || p->IsNull(mit.GetCurInpack(dim)))
         mit.ResetCurrent();
@@ -895,28 +1000,11 @@ void TianmuAttr::EvaluatePack_BetweenInt(MIUpdatingIterator &mit, int dim, Descr
     // Loop without it when packs are nearly full
     if (tianmu_sysvar_filterevaluation_speedup && filter &&
         filter->NumOfOnes(pack) > static_cast<uint>(1 << (mit.GetPower() - 1))) {
-      if (d.op == common::Operator::O_BETWEEN && !mit.NullsPossibleInPack(dim) && dpn.numOfNulls == 0) {
-        // easy and fast case - no "if"s
-        for (uint32_t n = 0; n < dpn.numOfRecords; n++) {
-          auto v = p->GetValInt(n);
-          if (pv1 > v || v > pv2)
-            filter->Reset(pack, n);
-        }
-      } else {
-        // more general case
-        for (uint32_t n = 0; n < dpn.numOfRecords; n++) {
-          if (unlikely(p->IsNull(n)))
-            filter->Reset(pack, n);
-          else {
-            auto v = p->GetValInt(n);
-            bool res = (pv1 <= v && v <= pv2);
-            if (d.op == common::Operator::O_NOT_BETWEEN)
-              res = !res;
-            if (!res)
-              filter->Reset(pack, n);
-          }
-        }
-      }
+      // predicate and nulls of the whole pack in one bitmap, ANDed into the
+      // filter block at once
+      uint32_t *mask = PackMaskBuffer(dpn.numOfRecords);
+      p->BetweenMask(pv1, pv2, d.op == common::Operator::O_NOT_BETWEEN, mask);
+      filter->AndMask(pack, mask, dpn.numOfRecords);
       mit.NextPackrow();
     } else {
       if (d.op == common::Operator::O_BETWEEN && !mit.NullsPossibleInPack(dim) && dpn.numOfNulls == 0) {
@@ -983,18 +1071,9 @@ void TianmuAttr::EvaluatePack_BetweenReal(MIUpdatingIterator &mit, int dim, Desc
     // Loop without it when packs are nearly full
     if (tianmu_sysvar_filterevaluation_speedup && filter &&
         filter->NumOfOnes(pack) > static_cast<uint>(1 << (mit.GetPower() - 1))) {
-      for (uint32_t n = 0; n < dpn.numOfRecords; n++) {
-        if (p->IsNull(n))
-          filter->Reset(pack, n);
-        else {
-          double v = p->GetValDouble(n);
-          bool res = (dv1 <= v && v <= dv2);
-          if (d.op == common::Operator::O_NOT_BETWEEN)
-            res = !res;
-          if (!res)
-            filter->Reset(pack, n);
-        }
-      }
+      uint32_t *mask = PackMaskBuffer(dpn.numOfRecords);
+      p->BetweenMaskDouble(dv1, dv2, d.op == common::Operator::O_NOT_BETWEEN, mask);
+      filter->AndMask(pack, mask, dpn.numOfRecords);
       mit.NextPackrow();
     } else {
       do {
@@ -1047,6 +1126,35 @@ void TianmuAttr::EvaluatePack_AttrAttr(MIUpdatingIterator &mit, int dim, Descrip
   bool pack1_uniform = (min1 == max1);
   bool pack2_uniform = (min2 == max2);
   int64_t val1_offset = min1 - min2;  // GetVal_1 + val_offset = GetVal_2
+  auto filter = mit.GetMultiIndex()->GetFilter(dim);
+  utils::simd::CmpOp op;
+  // the mask covers the null rows of the packs only, so outer join nulls of
+  // the dimension and unloaded packs with nulls take the row by row path
+  if (tianmu_sysvar_filterevaluation_speedup && filter && ToCmpOp(d.op, op) && !mit.NullsPossibleInPack(dim) &&
+      (p1 || get_dpn(pack).numOfNulls == 0) && (p2 || a2->get_dpn(pack).numOfNulls == 0) &&
+      filter->NumOfOnes(pack) > static_cast<uint>(1 << (mit.GetPower() - 1))) {
+    uint32_t no_rows = get_dpn(pack).numOfRecords;
+    DEBUG_ASSERT(a2->get_dpn(pack).numOfRecords == no_rows);
+    int64_t *v1 = PackValueBuffer(no_rows, 0);
+    int64_t *v2 = PackValueBuffer(no_rows, 1);
+    if (pack1_uniform)
+      std::fill_n(v1, no_rows, 0);
+    else
+      p1->GetValuesInt(v1);
+    if (pack2_uniform)
+      std::fill_n(v2, no_rows, 0);
+    else
+      p2->GetValuesInt(v2);
+    uint32_t *mask = PackMaskBuffer(no_rows);
+    utils::simd::CompareMask(v1, v2, no_rows, val1_offset, op, mask);
+    if (p1)
+      p1->MaskNulls(mask);
+    if (p2)
+      p2->MaskNulls(mask);
+    filter->AndMask(pack, mask, no_rows);
+    mit.NextPackrow();
+    return;
+  }
   do {
     int obj_in_pack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || (p1 && p1->IsNull(obj_in_pack)) ||
@@ -1109,6 +1217,25 @@ void TianmuAttr::EvaluatePack_AttrAttrReal(MIUpdatingIterator &mit, int dim, Des
   int64_t max2 = a2->get_dpn(pack).max_i;
   bool pack1_uniform = (min1 == max1);
   bool pack2_uniform = (min2 == max2);
+  auto filter = mit.GetMultiIndex()->GetFilter(dim);
+  utils::simd::CmpOp op;
+  if (tianmu_sysvar_filterevaluation_speedup && filter && ToCmpOp(d.op, op) && !mit.NullsPossibleInPack(dim) &&
+      (p1 || get_dpn(pack).numOfNulls == 0) && (p2 || a2->get_dpn(pack).numOfNulls == 0) &&
+      filter->NumOfOnes(pack) > static_cast<uint>(1 << (mit.GetPower() - 1))) {
+    uint32_t no_rows = get_dpn(pack).numOfRecords;
+    DEBUG_ASSERT(a2->get_dpn(pack).numOfRecords == no_rows);
+    const double *v1 = pack1_uniform ? UniformDoubles(no_rows, get_dpn(pack).min_d, 0) : p1->GetValuesDouble();
+    const double *v2 = pack2_uniform ? UniformDoubles(no_rows, a2->get_dpn(pack).min_d, 1) : p2->GetValuesDouble();
+    uint32_t *mask = PackMaskBuffer(no_rows);
+    utils::simd::CompareMaskDouble(v1, v2, no_rows, op, mask);
+    if (p1)
+      p1->MaskNulls(mask);
+    if (p2)
+      p2->MaskNulls(mask);
+    filter->AndMask(pack, mask, no_rows);
+    mit.NextPackrow();
+    return;
+  }
   do {
     int obj_in_pack = mit.GetCurInpack(dim);
     if (mit[dim] == common::NULL_VALUE_64 || (p1 && p1->IsNull(obj_in_pack)) ||
@@ -524,6 +524,10 @@ void TianmuTable::UnlockPackFromUse(unsigned attr, unsigned pack_no) {
   m_attrs[attr]->UnlockPackFromUse(pack_no);
 }
 
+void TianmuTable::PrefetchPacks(unsigned attr, const std::vector<int> &packs) {
+  m_attrs[attr]->PrefetchPacks(packs);
+}
+
 int TianmuTable::GetID() const { return share->TabID(); }
 
 std::vector<AttrInfo> TianmuTable::GetAttributesInfo() {
@@ -582,6 +586,9 @@ bool TianmuTable::Verify() {
 }
 
 void TianmuTable::CommitVersion() {
+  // the keys of the buffered rows are committed with the transaction anyway
+  EndBulkInsert();
+
   if (Verify())
     throw common::DatabaseException("Data integrity is broken in table " + m_path.string());
 
@@ -822,7 +829,7 @@ void TianmuTable::LoadDataInfile(system::IOParameters &iop) {
   }
 }
 
-void TianmuTable::Field2VC(Field *f, loader::ValueCache &vc, size_t col) {
+void TianmuTable::Field2VC(Field *f, loader::ValueCache &vc, size_t col, bool for_key) {
   if (f->is_null()) {
     vc.ExpectedNull(true);
     return;
@@ -835,6 +842,11 @@ void TianmuTable::Field2VC(Field *f, loader::ValueCache &vc, size_t col) {
     case MYSQL_TYPE_INT24:
     case MYSQL_TYPE_LONGLONG: {
       int64_t value = f->val_int();
+      if (for_key) {
+        *reinterpret_cast<int64_t *>(vc.Prepare(sizeof(int64_t))) = value;
+        vc.ExpectedSize(sizeof(int64_t));
+        break;
+      }
       common::PushWarningIfOutOfRange(current_txn_->Thd(), std::string(f->field_name), value, f->type(),
                                       f->flags & UNSIGNED_FLAG);
       if (m_attrs[col]->GetIfAutoInc() && value == 0) {
@@ -928,7 +940,7 @@ void TianmuTable::Field2VC(Field *f, loader::ValueCache &vc, size_t col) {
     case MYSQL_TYPE_STRING: {
       String buf;
       f->val_str(&buf);
-      if (m_attrs[col]->Type().Lookup()) {
+      if (m_attrs[col]->Type().Lookup() && !for_key) {
         types::BString s(buf.length() == 0 ? "" : buf.ptr(), buf.length());
         int64_t *buf = reinterpret_cast<int64_t *>(vc.Prepare(sizeof(int64_t)));
         *buf = m_attrs[col]->EncodeValue_T(s, true);
@@ -950,6 +962,9 @@ void TianmuTable::Field2VC(Field *f, loader::ValueCache &vc, size_t col) {
 }
 
 int TianmuTable::Insert(TABLE *table) {
+  if (bulk_insert_)
+    return BulkInsert(table);
+
   FunctionExecutor fe(std::bind(&TianmuTable::LockPackInfoForUse, this),
                       std::bind(&TianmuTable::UnlockPackInfoFromUse, this));
 
@@ -977,6 +992,7 @@ int TianmuTable::Insert(TABLE *table) {
       TIANMU_LOG(LogCtl_Level::INFO, "Insert duplicate key on row %d", NumOfObj() - 1);
       return HA_ERR_FOUND_DUPP_KEY;
     }
+    InsertSecondaryIndex(table, NumOfObj());
   }
   for (uint i = 0; i < NumOfAttrs(); i++) {
     m_attrs[i]->LoadData(&vcs[i]);
@@ -984,11 +1000,97 @@ int TianmuTable::Insert(TABLE *table) {
   return 0;
 }
 
+void TianmuTable::StartBulkInsert() {
+  if (bulk_insert_)
+    FlushBulkInsert();
+  bulk_insert_ = true;
+  bulk_next_row_ = NumOfObj();
+}
+
+void TianmuTable::EndBulkInsert() {
+  if (!bulk_insert_)
+    return;
+  bulk_insert_ = false;
+  FlushBulkInsert();
+}
+
+int TianmuTable::BulkInsert(TABLE *table) {
+  my_bitmap_map *org_bitmap = dbug_tmp_use_all_columns(table, table->read_set);
+  std::shared_ptr<void> defer(nullptr,
+                              [org_bitmap, table](...) { dbug_tmp_restore_column_map(table->read_set, org_bitmap); });
+
+  if (bulk_buffers_.empty()) {
+    // up to the end of the current packrow, as TianmuAttr::LoadData() does not
+    // go beyond it
+    size_t rows = share->PackSize() - (bulk_next_row_ % share->PackSize());
+    bulk_buffers_.reserve(NumOfAttrs());
+    for (uint i = 0; i < NumOfAttrs(); i++) bulk_buffers_.emplace_back(rows, rows * sizeof(int64_t));
+  }
+
+  uint committed = 0;
+  try {
+    for (; committed < NumOfAttrs(); committed++) {
+      Field2VC(table->field[committed], bulk_buffers_[committed], committed);
+      bulk_buffers_[committed].Commit();
+    }
+  } catch (...) {
+    for (uint i = 0; i < committed; i++) bulk_buffers_[i].Rollback();
+    throw;
+  }
+
+  std::shared_ptr<index::TianmuTableIndex> tab = ha_tianmu_engine_->GetTableIndex(share->Path());
+  if (tab) {
+    size_t row = bulk_buffers_[0].NumOfValues() - 1;
+    std::vector<std::string> fields;
+    std::vector<uint> cols = tab->KeyCols();
+    for (auto &col : cols) {
+      fields.emplace_back(bulk_buffers_[col].GetDataBytesPointer(row), bulk_buffers_[col].Size(row));
+    }
+
+    if (tab->InsertIndex(current_txn_, fields, bulk_next_row_) == common::ErrorCode::DUPP_KEY) {
+      TIANMU_LOG(LogCtl_Level::INFO, "Insert duplicate key on row %ld", bulk_next_row_);
+      for (auto &vc : bulk_buffers_) vc.Rollback();
+      return HA_ERR_FOUND_DUPP_KEY;
+    }
+    InsertSecondaryIndex(table, bulk_next_row_);
+  }
+
+  bulk_next_row_++;
+  if (bulk_next_row_ % share->PackSize() == 0)
+    FlushBulkInsert();
+  return 0;
+}
+
+void TianmuTable::FlushBulkInsert() {
+  if (bulk_buffers_.empty())
+    return;
+  if (bulk_buffers_[0].NumOfValues() == 0) {
+    bulk_buffers_.clear();
+    return;
+  }
+
+  FunctionExecutor fe(std::bind(&TianmuTable::LockPackInfoForUse, this),
+                      std::bind(&TianmuTable::UnlockPackInfoFromUse, this));
+  utils::result_set<void> res;
+  try {
+    for (uint att = 0; att < m_attrs.size(); ++att)
+      res.insert(ha_tianmu_engine_->load_thread_pool.add_task(&TianmuAttr::LoadData, m_attrs[att].get(),
+                                                              &bulk_buffers_[att], current_txn_));
+    res.get_all_with_except();
+  } catch (...) {
+    res.wait_all();
+    bulk_buffers_.clear();
+    throw;
+  }
+  bulk_buffers_.clear();
+}
+
 int TianmuTable::Update(TABLE *table, uint64_t row_id, const uchar *old_data, uchar *new_data) {
   // todo(dfx): move to before for loop, need test
   my_bitmap_map *org_bitmap2 = dbug_tmp_use_all_columns(table, table->read_set);
   std::shared_ptr<void> defer(nullptr,
                               [org_bitmap2, table](...) { dbug_tmp_restore_column_map(table->read_set, org_bitmap2); });
+  UpdateSecondaryIndex(table, row_id, old_data, new_data);
   utils::result_set<void> res;
   for (uint col_id = 0; col_id < table->s->fields; col_id++) {
     if (!bitmap_is_set(table->write_set, col_id)) {
@@ -1023,6 +1125,7 @@ int TianmuTable::Update(TABLE *table, uint64_t row_id, const uchar *old_data, uc
 }
 
 int TianmuTable::Delete(TABLE *table, uint64_t row_id) {
+  DeleteSecondaryIndex(table, row_id);
   utils::result_set<void> res;
   for (uint i = 0; i < table->s->fields; i++) {
     res.insert(ha_tianmu_engine_->delete_or_update_thread_pool.add_task(&core::TianmuTable::DeleteItem, this, row_id, i,
@@ -1056,22 +1159,40 @@ uint64_t TianmuTable::ProceedNormal(system::IOParameters &iop) {
 
   uint to_prepare;
   uint no_of_rows_returned;
+  int64_t no_of_obj = m_attrs[0]->NumOfObj();
   utils::Timer timer;
 
-  do {
-    to_prepare = share->PackSize() - (m_attrs[0]->NumOfObj() % share->PackSize());
-    std::vector<loader::ValueCache> value_buffers;
-    no_of_rows_returned = parser.GetPackrow(to_prepare, value_buffers);
-    no_dup_rows += parser.GetDupRow();
-    if (parser.GetNoRow() > 0) {
-      utils::result_set<void> res;
-      for (uint att = 0; att < m_attrs.size(); ++att) {
-        res.insert(ha_tianmu_engine_->load_thread_pool.add_task(&TianmuAttr::LoadData, m_attrs[att].get(),
-                                                                &value_buffers[att], current_txn_));
+  // A packrow is compressed and saved while the next one is parsed. Lookup columns
+  // are waited for at once, as the parser encodes into the same dictionaries.
+  std::vector<loader::ValueCache> saving_buffers;
+  utils::result_set<void> saving;
+  utils::result_set<void> lookups;
+  try {
+    do {
+      to_prepare = share->PackSize() - (no_of_obj % share->PackSize());
+      std::vector<loader::ValueCache> value_buffers;
+      no_of_rows_returned = parser.GetPackrow(to_prepare, value_buffers);
+      no_dup_rows += parser.GetDupRow();
+      saving.get_all();
+      saving = utils::result_set<void>();
+      if (parser.GetNoRow() > 0) {
+        saving_buffers = std::move(value_buffers);
+        lookups = utils::result_set<void>();
+        for (uint att = 0; att < m_attrs.size(); ++att) {
+          auto &res = m_attrs[att]->Type().Lookup() ? lookups : saving;
+          res.insert(ha_tianmu_engine_->load_thread_pool.add_task(&TianmuAttr::LoadData, m_attrs[att].get(),
+                                                                  &saving_buffers[att], current_txn_));
+        }
+        lookups.get_all();
+        no_of_obj += no_of_rows_returned;
       }
-      res.get_all();
-    }
-  } while (no_of_rows_returned == to_prepare);
+    } while (no_of_rows_returned == to_prepare);
+    saving.get_all();
+  } catch (...) {
+    lookups.wait_all();
+    saving.wait_all();
+    throw;
+  }
 
   auto no_loaded_rows = parser.GetNoRow();
 
@@ -1497,6 +1618,7 @@ void TianmuTable::InsertIndexForDelta(TABLE *table, uint64_t row_id) {
       throw common::DupKeyException("Insert duplicate key on row: " + std::to_string(row_id) +
                                     ", pk: " + std::to_string(*(uint64_t *)(fields[0].data())));
     }
+    InsertSecondaryIndex(table, row_id);
   }
 }
 
@@ -1526,6 +1648,95 @@ void TianmuTable::DeleteIndexForDelta(TABLE *table, uint64_t row_id) {
       TIANMU_LOG(LogCtl_Level::DEBUG, "Delete row: %s for primary key field", row_id);
       throw common::Exception("Delete row: " + std::to_string(row_id) + " for primary key field");
     }
+    DeleteSecondaryIndex(table, row_id);
+  }
+}
+
+void TianmuTable::SecondaryKeyFields(TABLE *table, const std::vector<uint> &cols, my_ptrdiff_t offset,
+                                     std::vector<std::string> &fields, std::vector<bool> &nulls) {
+  fields.clear();
+  nulls.clear();
+  for (auto &col : cols) {
+    Field *f = table->field[col];
+    f->move_field_offset(offset);
+    std::shared_ptr<void> restore(nullptr, [f, offset](...) { f->move_field_offset(-offset); });
+    if (f->is_null()) {
+      fields.emplace_back();
+      nulls.push_back(true);
+      continue;
+    }
+    loader::ValueCache vc(1, 128);
+    Field2VC(f, vc, col, true);
+    vc.Commit();
+    fields.emplace_back(vc.GetDataBytesPointer(0), vc.Size(0));
+    nulls.push_back(false);
+  }
+}
+
+void TianmuTable::SecondaryKeyFields(std::vector<std::unique_ptr<TianmuAttr>> &attrs,
+                                     std::vector<loader::ValueCache> &vcs, size_t row, const std::vector<uint> &cols,
+                                     std::vector<std::string> &fields, std::vector<bool> &nulls) {
+  fields.clear();
+  nulls.clear();
+  for (auto &col : cols) {
+    if (vcs[col].IsNull(row)) {
+      fields.emplace_back();
+      nulls.push_back(true);
+      continue;
+    }
+    if (attrs[col]->Type().Lookup()) {
+      types::BString s = attrs[col]->DecodeValue_S(*reinterpret_cast<int64_t *>(vcs[col].GetDataBytesPointer(row)));
+      fields.emplace_back(s.len_ == 0 ? "" : s.val_, s.len_);
+    } else {
+      fields.emplace_back(vcs[col].GetDataBytesPointer(row), vcs[col].Size(row));
+    }
+    nulls.push_back(false);
+  }
+}
+
+void TianmuTable::InsertSecondaryIndex(TABLE *table, uint64_t row_id) {
+  std::shared_ptr<index::TianmuTableIndex> tab = ha_tianmu_engine_->GetTableIndex(share->Path());
+  if (!tab)
+    return;
+  std::vector<std::string> fields;
+  std::vector<bool> nulls;
+  for (auto &sk : tab->SecondaryKeys()) {
+    SecondaryKeyFields(table, sk.cols, 0, fields, nulls);
+    if (tab->InsertSecondary(current_txn_, sk, fields, nulls, row_id) != common::ErrorCode::SUCCESS)
+      throw common::Exception("Insert row: " + std::to_string(row_id) + " for secondary key " +
+                              std::to_string(sk.keyno));
+  }
+}
+
+void TianmuTable::UpdateSecondaryIndex(TABLE *table, uint64_t row_id, const uchar *old_data, const uchar *new_data) {
+  std::shared_ptr<index::TianmuTableIndex> tab = ha_tianmu_engine_->GetTableIndex(share->Path());
+  if (!tab)
+    return;
+  std::vector<std::string> ofields, nfields;
+  std::vector<bool> onulls, nnulls;
+  for (auto &sk : tab->SecondaryKeys()) {
+    SecondaryKeyFields(table, sk.cols, old_data - table->record[0], ofields, onulls);
+    SecondaryKeyFields(table, sk.cols, new_data - table->record[0], nfields, nnulls);
+    if (ofields == nfields && onulls == nnulls)
+      continue;
+    if (tab->DeleteSecondary(current_txn_, sk, ofields, onulls, row_id) != common::ErrorCode::SUCCESS ||
+        tab->InsertSecondary(current_txn_, sk, nfields, nnulls, row_id) != common::ErrorCode::SUCCESS)
+      throw common::Exception("Update row: " + std::to_string(row_id) + " for secondary key " +
+                              std::to_string(sk.keyno));
+  }
+}
+
+void TianmuTable::DeleteSecondaryIndex(TABLE *table, uint64_t row_id) {
+  std::shared_ptr<index::TianmuTableIndex> tab = ha_tianmu_engine_->GetTableIndex(share->Path());
+  if (!tab)
+    return;
+  std::vector<std::string> fields;
+  std::vector<bool> nulls;
+  for (auto &sk : tab->SecondaryKeys()) {
+    SecondaryKeyFields(table, sk.cols, 0, fields, nulls);
+    if (tab->DeleteSecondary(current_txn_, sk, fields, nulls, row_id) != common::ErrorCode::SUCCESS)
+      throw common::Exception("Delete row: " + std::to_string(row_id) + " for secondary key " +
+                              std::to_string(sk.keyno));
   }
 }
 
@@ -1647,7 +1858,7 @@ int TianmuTable::AsyncParseInsertRecords(system::IOParameters *iop, std::vector<
       throw common::FormatException("Write insert to load binlog fail!");
     }
 
-  if ((t2.tv_sec - t1.tv_sec > 15) && index_table) {
+  if ((t2.tv_sec - t1.tv_sec > 15) && index_table && index_table->HasPrimaryKey()) {
     TIANMU_LOG(LogCtl_Level::WARN, "Latency of index table %s larger than 15s, compact manually.",
                share->Path().c_str());
     ha_kvstore_->GetRdb()->CompactRange(rocksdb::CompactRangeOptions(), index_table->rocksdb_key_->get_cf(), nullptr,
@@ -1675,7 +1886,7 @@ int TianmuTable::AsyncParseUpdateRecords(system::IOParameters *iop,
   }
   clock_gettime(CLOCK_REALTIME, &t2);
 
-  if ((t2.tv_sec - t1.tv_sec > 15) && index_table) {
+  if ((t2.tv_sec - t1.tv_sec > 15) && index_table && index_table->HasPrimaryKey()) {
     TIANMU_LOG(LogCtl_Level::WARN, "Latency of index table %s larger than 15s, compact manually.",
                share->Path().c_str());
     ha_kvstore_->GetRdb()->CompactRange(rocksdb::CompactRangeOptions(), index_table->rocksdb_key_->get_cf(), nullptr,
@@ -80,6 +80,7 @@ class TianmuTable final : public JustATable {
   void UnlockPackInfoFromUse();  // return attribute data to memory manager
   void LockPackForUse(unsigned attr, unsigned pack_no) override;
   void UnlockPackFromUse(unsigned attr, unsigned pack_no) override;
+  void PrefetchPacks(unsigned attr, const std::vector<int> &packs) override;
 
   int GetID() const;
   TType TableType() const override { return TType::TABLE; }
@@ -131,6 +132,11 @@ class TianmuTable final : public JustATable {
 
   // directly (no delta)
   int Insert(TABLE *table);
+  // Between these, rows given to Insert() are gathered into packrow-sized
+  // value caches and every complete packrow is loaded by all columns in
+  // parallel. The keys are still inserted row by row.
+  void StartBulkInsert();
+  void EndBulkInsert();
   int Update(TABLE *table, uint64_t row_id, const uchar *old_data, uchar *new_data);
   int Delete(TABLE *table, uint64_t row_id);
 
@@ -143,6 +149,18 @@ class TianmuTable final : public JustATable {
   void UpdateIndexForDelta(TABLE *table, uint64_t row_id, uint64_t col);
   void DeleteIndexForDelta(TABLE *table, uint64_t row_id);
 
+  // secondary keys, kept by row id so delta merge leaves them untouched
+  void InsertSecondaryIndex(TABLE *table, uint64_t row_id);
+  void UpdateSecondaryIndex(TABLE *table, uint64_t row_id, const uchar *old_data, const uchar *new_data);
+  void DeleteSecondaryIndex(TABLE *table, uint64_t row_id);
+  // key parts over cols of the record stored at table->record[0] + offset
+  void SecondaryKeyFields(TABLE *table, const std::vector<uint> &cols, my_ptrdiff_t offset,
+                          std::vector<std::string> &fields, std::vector<bool> &nulls);
+  // key parts over cols of row in vcs, lookup codes are decoded back to strings
+  static void SecondaryKeyFields(std::vector<std::unique_ptr<TianmuAttr>> &attrs, std::vector<loader::ValueCache> &vcs,
+                                 size_t row, const std::vector<uint> &cols, std::vector<std::string> &fields,
+                                 std::vector<bool> &nulls);
+
   // delta backend
   void LoadDataInfile(system::IOParameters &iop);
   uint64_t MergeDeltaTable(system::IOParameters &iop);
@@ -154,8 +172,11 @@ class TianmuTable final : public JustATable {
 
  private:
   uint64_t ProceedNormal(system::IOParameters &iop);
+  int BulkInsert(TABLE *table);
+  void FlushBulkInsert();
   uint64_t ProcessDelayed(system::IOParameters &iop);
-  void Field2VC(Field *f, loader::ValueCache &vc, size_t col);
+  // for_key: a key part, no side effects on autoinc and lookup strings kept as they are
+  void Field2VC(Field *f, loader::ValueCache &vc, size_t col, bool for_key = false);
   int binlog_load_query_log_event(system::IOParameters &iop);
   int binlog_insert2load_log_event(system::IOParameters &iop);
   int binlog_insert2load_block(std::vector<loader::ValueCache> &vcs, uint load_obj, system::IOParameters &iop);
@@ -177,6 +198,10 @@ class TianmuTable final : public JustATable {
   size_t no_rejected_rows = 0;
   uint64_t no_loaded_rows = 0;
   uint64_t no_dup_rows = 0;
+
+  bool bulk_insert_ = false;
+  int64_t bulk_next_row_ = 0;  // row number of the next row of the bulk insert
+  std::vector<loader::ValueCache> bulk_buffers_;
 };
 
 class TianmuIterator {
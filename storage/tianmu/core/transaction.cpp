@@ -108,6 +108,17 @@ void Transaction::Rollback([[maybe_unused]] THD *thd, bool force_error_message)
 
 ulong Transaction::GetThreadID() const { return pthread_self(); }
 
+int64_t Transaction::CountPackAccess(bool admitted) {
+  query_id_t query = QueryID();
+  if (query != pack_admission_query_) {
+    pack_admission_query_ = query;
+    pack_admissions_ = 0;
+  }
+  if (admitted)
+    pack_admissions_++;
+  return pack_admissions_;
+}
+
 void Transaction::SuspendDisplay() { display_lock_++; }
 void Transaction::ResumeDisplay() { display_lock_--; }
 
@@ -49,6 +49,10 @@ class Transaction final {
 
   uint32_t insert_row_num_ = 0;
 
+  // packs brought into the data cache by the statement pack_admission_query_
+  query_id_t pack_admission_query_ = 0;
+  int64_t pack_admissions_ = 0;
+
  public:
   ulong GetThreadID() const;
   THD *Thd() const { return thd; }
@@ -90,6 +94,12 @@ class Transaction final {
   uint32_t &GetInsertRowNum() { return insert_row_num_; }
   void AddInsertRowNum(uint32_t row_num = 1) { insert_row_num_ += row_num; }
   void ResetInsertRowNum() { insert_row_num_ = 0; }
+
+  query_id_t QueryID() const { return thd ? thd->query_id : 0; }
+  // Counts a pack access of the running statement, returns how many packs the
+  // statement has brought into the data cache so far. Called by the memory
+  // manager under its release mutex, also from the worker threads of a query.
+  int64_t CountPackAccess(bool admitted);
 };
 }  // namespace core
 }  // namespace Tianmu
@@ -52,6 +52,8 @@ void ValueMatching_HashTable::Init(int64_t mem_available, int64_t max_no_groups,
   input_buffer_width = _input_buf_width;
   DEBUG_ASSERT(input_buffer_width > 0);  // otherwise another class should be used
   one_pass = false;
+  // a table of about 2000 groups, for the tests of multi-pass and spilled aggregation
+  DBUG_EXECUTE_IF("tianmu_groupby_small_table", mem_available = std::min<int64_t>(mem_available, 64_KB););
 
   // add 4 bytes for offset
   total_width = 4 * ((total_width + 3) / 4);  // round up to 4-byte offset
@@ -100,6 +102,7 @@ void ValueMatching_HashTable::Init(int64_t mem_available, int64_t max_no_groups,
     min_block_len = 16_MB;
   else if (min_block_len > 4_MB)
     min_block_len = 4_MB;
+  DBUG_EXECUTE_IF("tianmu_groupby_small_table", min_block_len = std::min<size_t>(min_block_len, 16_KB););
 
   bmanager = std::make_shared<MemBlockManager>(mem_available, 1);
   t.Init(total_width, bmanager, 0, (int)min_block_len);
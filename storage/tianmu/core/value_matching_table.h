@@ -78,6 +78,9 @@ class ValueMatchingTable {  // abstract class: interface for value matching
   virtual bool RowValid() = 0;                    // false if there is no more rows to iterate
   virtual bool SetCurrentRow([[maybe_unused]] int64_t row) { return true; }
   virtual bool SetEndRow([[maybe_unused]] int64_t row) { return true; }
+  // the n-th stored row (n < NoRows()), as the iterator would return it; keeps no
+  // iterator state, so concurrent readers may share the table
+  virtual int64_t GetNthRow(int64_t n) { return n; }
   /*
           Selection algorithm and initialization of the created object. Input
      values:
@@ -165,6 +168,7 @@ class ValueMatching_LookupTable : public mm::TraceableObject, public ValueMatchi
   int64_t GetCurrentRow() override { return occupied_table[occupied_iterator]; }
   void NextRow() override { occupied_iterator++; }
   bool RowValid() override { return (occupied_iterator < no_rows); }
+  int64_t GetNthRow(int64_t n) override { return occupied_table[n]; }
   bool SetCurrentRow(int64_t row) override;
   bool SetEndRow(int64_t row) override;
   bool NoMoreSpace() override { return no_rows >= max_no_rows; }
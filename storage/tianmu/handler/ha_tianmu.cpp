@@ -29,6 +29,8 @@
 #include "core/compilation_tools.h"
 #include "core/compiled_query.h"
 #include "core/delta_record_head.h"
+#include "core/group_spill.h"
+#include "core/parallel_hash_join.h"
 #include "core/temp_table.h"
 #include "core/tools.h"
 #include "core/transaction.h"
@@ -90,6 +92,21 @@ const char **ha_tianmu::bas_ext() const {
   return ha_rcbase_exts;
 }
 
+ulong ha_tianmu::index_flags(uint inx, [[maybe_unused]] uint part, [[maybe_unused]] bool all_parts) const {
+  // the primary key is only searched through key lookups of its own
+  if (!table_share || inx == table_share->primary_key)
+    return 0;
+  auto index = ha_tianmu_engine_->GetTableIndex(table_name_);
+  if (!index || !index->GetSecondaryKey(inx))
+    return 0;
+  // stored parts are whole values, prefix key parts can not be matched
+  const KEY &key_info = table_share->key_info[inx];
+  for (uint i = 0; i < key_info.user_defined_key_parts; i++)
+    if (key_info.key_part[i].key_part_flag & HA_PART_KEY_SEG)
+      return 0;
+  return HA_READ_NEXT | HA_READ_RANGE;
+}
+
 namespace {
 std::vector<bool> GetAttrsUseIndicator(TABLE *table) {
   int col_id = 0;
@@ -237,6 +254,8 @@ int ha_tianmu::external_lock(THD *thd, int lock_type) {
 
 namespace {
 inline bool has_dup_key(std::shared_ptr<index::TianmuTableIndex> &indextab, TABLE *table, size_t &row) {
+  if (!indextab->HasPrimaryKey())
+    return false;
   common::ErrorCode ret = common::ErrorCode::SUCCESS;
   std::vector<std::string> records;
   KEY *key = table->key_info + table->s->primary_key;
@@ -395,6 +414,57 @@ int ha_tianmu::write_row([[maybe_unused]] uchar *buf) {
   DBUG_RETURN(ret);
 }
 
+/*
+ start_bulk_insert() is called before a statement inserts many rows, rows is
+ the expected number of them or 0 if unknown. On the direct (not delayed) path
+ the rows are then loaded a packrow at a time, the last one by
+ end_bulk_insert().
+ */
+void ha_tianmu::start_bulk_insert(ha_rows rows) {
+  DBUG_ENTER(__PRETTY_FUNCTION__);
+  bulk_insert_table_.reset();
+  if (rows == 1 || current_txn_ == nullptr || (tianmu_sysvar_insert_delayed && table->s->tmp_table == NO_TMP_TABLE))
+    DBUG_VOID_RETURN;
+  // the rows found by duplicate keys are updated in place, so they must be loaded
+  if (ha_thd()->lex->duplicates == DUP_UPDATE || ha_thd()->lex->duplicates == DUP_REPLACE)
+    DBUG_VOID_RETURN;
+
+  try {
+    current_txn_->SetLoadSource(common::LoadSource::LS_Direct);
+    bulk_insert_table_ = current_txn_->GetTableByPath(table_name_);
+    bulk_insert_table_->StartBulkInsert();
+  } catch (std::exception &e) {
+    TIANMU_LOG(LogCtl_Level::ERROR, "An exception is caught in start_bulk_insert: %s.", e.what());
+    bulk_insert_table_.reset();
+  }
+  DBUG_VOID_RETURN;
+}
+
+int ha_tianmu::end_bulk_insert() {
+  DBUG_ENTER(__PRETTY_FUNCTION__);
+  if (!bulk_insert_table_)
+    DBUG_RETURN(0);
+
+  int ret = 0;
+  try {
+    bulk_insert_table_->EndBulkInsert();
+  } catch (common::Exception &e) {
+    ret = HA_ERR_INTERNAL_ERROR;
+    TIANMU_LOG(LogCtl_Level::ERROR, "An exception is caught in end_bulk_insert: %s.", e.what());
+    my_message(static_cast<int>(common::ErrorCode::UNKNOWN_ERROR), e.what(), MYF(0));
+  } catch (std::exception &e) {
+    ret = HA_ERR_INTERNAL_ERROR;
+    TIANMU_LOG(LogCtl_Level::ERROR, "An exception is caught in end_bulk_insert: %s.", e.what());
+    my_message(static_cast<int>(common::ErrorCode::UNKNOWN_ERROR), e.what(), MYF(0));
+  } catch (...) {
+    ret = HA_ERR_INTERNAL_ERROR;
+    TIANMU_LOG(LogCtl_Level::ERROR, "An unknown system exception error caught.");
+    my_message(static_cast<int>(common::ErrorCode::UNKNOWN_ERROR), "An unknown system exception error caught.", MYF(0));
+  }
+  bulk_insert_table_.reset();
+  DBUG_RETURN(ret);
+}
+
 /*
  Yes, update_row() does what you expect, it updates a row. old_data will have
  the previous row record in it, while new_data will have the newest data in
@@ -659,8 +729,8 @@ int ha_tianmu::open(const char *name, [[maybe_unused]] int mode, [[maybe_unused]
 
     thr_lock_data_init(&share_->thr_lock, &lock_, nullptr);
     share_->thr_lock.check_status = tianmu_check_status;
-    // have primary key, use table index
-    if (table->s->primary_key != MAX_INDEXES)
+    // have primary key or secondary keys, use table index
+    if (table->s->primary_key != MAX_INDEXES || index::TianmuTableIndex::FindIndexTable(name))
       ha_tianmu_engine_->AddTableIndex(name, table, ha_thd());
     ha_tianmu_engine_->AddTableDelta(table, share_);
     ret = 0;
@@ -773,10 +843,36 @@ int ha_tianmu::index_read([[maybe_unused]] uchar *buf, [[maybe_unused]] const uc
         TIANMU_LOG(LogCtl_Level::ERROR, "Error: index_read not support prefix search");
       }
 
+    } else if (auto sk = index ? index->GetSecondaryKey(active_index) : nullptr) {
+      std::vector<std::string> fields;
+      std::vector<bool> nulls;
+      secondary_key_convert(key, key_len, *sk, fields, nulls);
+      common::Operator op = common::Operator::O_ERROR;
+      if (find_flag == HA_READ_KEY_EXACT)
+        op = common::Operator::O_EQ;
+      else if (find_flag == HA_READ_KEY_OR_NEXT)
+        op = common::Operator::O_MORE_EQ;
+      else if (find_flag == HA_READ_AFTER_KEY)
+        op = common::Operator::O_MORE;
+
+      if (op == common::Operator::O_ERROR) {
+        rc = HA_ERR_WRONG_COMMAND;
+        TIANMU_LOG(LogCtl_Level::ERROR, "Error: index_read not support prefix search");
+      } else {
+        auto iter = current_txn_->KVTrans().KeyIter();
+        iter->ScanToKey(*sk, fields, nulls, op);
+        if (iter->IsValid()) {
+          uint64_t rowid;
+          iter->GetRowid(rowid);
+          rc = fill_row_by_id(buf, rowid);
+          if (!rc)
+            table->status = 0;
+        }
+      }
     } else {
       // other index not support
       rc = HA_ERR_WRONG_INDEX;
-      TIANMU_LOG(LogCtl_Level::ERROR, "Error: index_read only support primary key");
+      TIANMU_LOG(LogCtl_Level::ERROR, "Error: index_read only support primary key and secondary keys");
     }
 
   } catch (std::exception &e) {
@@ -853,7 +949,10 @@ int ha_tianmu::index_first([[maybe_unused]] uchar *buf) {
     if (index && current_txn_) {
       uint64_t rowid;
       auto iter = current_txn_->KVTrans().KeyIter();
-      iter->ScanToEdge(index, true);
+      if (auto sk = index->GetSecondaryKey(active_index))
+        iter->ScanToEdge(*sk, true);
+      else
+        iter->ScanToEdge(index, true);
       if (iter->IsValid()) {
         iter->GetRowid(rowid);
         rc = fill_row_by_id(buf, rowid);
@@ -885,7 +984,10 @@ int ha_tianmu::index_last([[maybe_unused]] uchar *buf) {
     if (index && current_txn_) {
       uint64_t rowid;
       auto iter = current_txn_->KVTrans().KeyIter();
-      iter->ScanToEdge(index, false);
+      if (auto sk = index->GetSecondaryKey(active_index))
+        iter->ScanToEdge(*sk, false);
+      else
+        iter->ScanToEdge(index, false);
       if (iter->IsValid()) {
         iter->GetRowid(rowid);
         rc = fill_row_by_id(buf, rowid);
@@ -1172,9 +1274,50 @@ int ha_tianmu::delete_table(const char *name) {
 
  Called from opt_range.cc by check_quick_keys().
  */
-ha_rows ha_tianmu::records_in_range([[maybe_unused]] uint inx, [[maybe_unused]] key_range *min_key,
-                                    [[maybe_unused]] key_range *max_key) {
+ha_rows ha_tianmu::records_in_range(uint inx, key_range *min_key, key_range *max_key) {
   DBUG_ENTER(__PRETTY_FUNCTION__);
+  // secondary keys: count the entries in range, up to a cap past which a scan is as good
+  constexpr ha_rows kMaxCountedRows = 10000;
+  try {
+    auto index = ha_tianmu_engine_->GetTableIndex(table_name_);
+    auto sk = index ? index->GetSecondaryKey(inx) : nullptr;
+    if (sk && current_txn_) {
+      std::vector<std::string> fields;
+      std::vector<bool> nulls;
+      uint old_index = active_index;
+      active_index = inx;
+      std::shared_ptr<void> defer(nullptr, [this, old_index](...) { active_index = old_index; });
+
+      auto iter = std::make_shared<index::KeyIterator>(&current_txn_->KVTrans());
+      if (min_key) {
+        secondary_key_convert(min_key->key, min_key->length, *sk, fields, nulls);
+        iter->ScanToKey(*sk, fields, nulls,
+                        min_key->flag == HA_READ_AFTER_KEY ? common::Operator::O_MORE : common::Operator::O_MORE_EQ);
+      } else {
+        iter->ScanToEdge(*sk, true);
+      }
+      std::string max_prefix;
+      if (max_key) {
+        index::StringWriter packkey, info;
+        secondary_key_convert(max_key->key, max_key->length, *sk, fields, nulls);
+        sk->rocksdb_key->pack_secondary_key(packkey, fields, nulls, info);
+        max_prefix.assign((const char *)packkey.ptr(), packkey.length());
+      }
+      ha_rows rows = 0;
+      for (; iter->IsValid() && rows < kMaxCountedRows; ++(*iter)) {
+        if (max_key) {
+          int cmp = iter->CompareKeyPrefix(max_prefix);
+          if (cmp > 0 || (cmp == 0 && max_key->flag == HA_READ_BEFORE_KEY))
+            break;
+        }
+        rows++;
+      }
+      if (rows < kMaxCountedRows)
+        DBUG_RETURN(rows == 0 ? 1 : rows);
+    }
+  } catch (std::exception &e) {
+    TIANMU_LOG(LogCtl_Level::ERROR, "An exception is caught: %s", e.what());
+  }
   DBUG_RETURN(stats.records);  // low number to force index usage
 }
 
@@ -1572,7 +1715,7 @@ enum_alter_inplace_result ha_tianmu::check_if_supported_inplace_alter([[maybe_un
          ha_alter_info->handler_flags & Alter_inplace_info::ADD_UNIQUE_INDEX ||
          ha_alter_info->handler_flags & Alter_inplace_info::RENAME_INDEX ||
          ha_alter_info->handler_flags & Alter_inplace_info::DROP_UNIQUE_INDEX) &&
-        (sql_mode & MODE_NO_KEY_ERROR))
+        ((sql_mode & MODE_NO_KEY_ERROR) || tianmu_sysvar_secondary_index))
       DBUG_RETURN(HA_ALTER_INPLACE_NOT_SUPPORTED);
 
     DBUG_RETURN(HA_ALTER_ERROR);
@@ -1704,6 +1847,23 @@ bool ha_tianmu::commit_inplace_alter_table([[maybe_unused]] TABLE *altered_table
  key: mysql format, may be union key, need changed to kvstore key format
 
  */
+/*
+ key: mysql format over the leading parts of a secondary key, converted to its stored fields.
+ The key is restored into a scratch row: records_in_range() may run while record[0] holds a row.
+ */
+void ha_tianmu::secondary_key_convert(const uchar *key, uint key_len, const index::SecondaryKey &sk,
+                                      std::vector<std::string> &fields, std::vector<bool> &nulls) {
+  KEY *key_info = &table->key_info[active_index];
+  key_record_.assign(table->record[0], table->record[0] + table->s->reclength);
+  key_restore(key_record_.data(), (uchar *)key, key_info, key_len);
+
+  uint parts = 0;
+  for (uint len = 0; parts < key_info->user_defined_key_parts && parts < sk.cols.size() && len < key_len; parts++)
+    len += key_info->key_part[parts].store_length;
+  std::vector<uint> cols(sk.cols.begin(), sk.cols.begin() + parts);
+  share_->GetSnapshot()->SecondaryKeyFields(table, cols, key_record_.data() - table->record[0], fields, nulls);
+}
+
 void ha_tianmu::key_convert(const uchar *key, uint key_len, std::vector<uint> cols, std::vector<std::string> &keys) {
   key_restore(table->record[0], (uchar *)key, &table->key_info[active_index], key_len);
 
@@ -2111,6 +2271,33 @@ int get_RowStoreUsage_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *var, c
   return 0;
 }
 
+int get_DeltaMergeLagRows_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  uint64_t rows, seconds;
+  ha_tianmu_engine_->DeltaMergeLag(rows, seconds);
+  *((int64_t *)tmp) = rows;
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
+int get_DeltaMergeLagSeconds_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  uint64_t rows, seconds;
+  ha_tianmu_engine_->DeltaMergeLag(rows, seconds);
+  *((int64_t *)tmp) = seconds;
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
+// "table:rows/seconds" for the most lagging tables
+int get_DeltaMergeLagTables_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_CHAR;
+  var->value = buff;
+  std::string str = ha_tianmu_engine_->DeltaMergeLagStat(SHOW_VAR_FUNC_BUFF_SIZE - 1);
+  std::memcpy(buff, str.c_str(), str.length() + 1);
+  return 0;
+}
+
 int get_InsertPerMinute_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
   *((int64_t *)tmp) = ha_tianmu_engine_->GetIPM();
   outvar->value = tmp;
@@ -2132,6 +2319,34 @@ int get_LoadPerMinute_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar
   return 0;
 }
 
+int get_GroupBySpillTuples_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  *((int64_t *)tmp) = core::GroupSpill::TotalTuples();
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
+int get_GroupBySpillBytes_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  *((int64_t *)tmp) = core::GroupSpill::TotalBytes();
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
+int get_JoinRuntimeFilterRows_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  *((int64_t *)tmp) = core::ParallelHashJoiner::RuntimeFilterRows();
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
+int get_JoinRuntimeFilterPackrows_StatusVar([[maybe_unused]] MYSQL_THD thd, SHOW_VAR *outvar, char *tmp) {
+  *((int64_t *)tmp) = core::ParallelHashJoiner::RuntimeFilterPackrows();
+  outvar->value = tmp;
+  outvar->type = SHOW_LONGLONG;
+  return 0;
+}
+
 int get_Freeable_StatusVar([[maybe_unused]] MYSQL_THD thd, struct st_mysql_show_var *outvar, char *tmp) {
   *((int64_t *)tmp) = mm::TraceableObject::GetFreeableSize();
   outvar->value = tmp;
@@ -2270,8 +2485,16 @@ STATUS_FUNCTION(gdcreadwait, SHOW_LONGLONG, getReadWait)
 STATUS_FUNCTION(gdcfalsewakeup, SHOW_LONGLONG, getFalseWakeup)
 STATUS_FUNCTION(gdcreadwaitinprogress, SHOW_LONGLONG, getReadWaitInProgress)
 STATUS_FUNCTION(gdcpackloads, SHOW_LONGLONG, getPackLoads)
+STATUS_FUNCTION(gdcpacklockwaits, SHOW_LONGLONG, getPackLockWaits)
+STATUS_FUNCTION(gdcprefetchissued, SHOW_LONGLONG, getPrefetchIssued)
+STATUS_FUNCTION(gdcprefetchhits, SHOW_LONGLONG, getPrefetchHits)
+STATUS_FUNCTION(gdcprefetchwasted, SHOW_LONGLONG, getPrefetchWasted)
 STATUS_FUNCTION(gdcloaderrors, SHOW_LONGLONG, getLoadErrors)
 STATUS_FUNCTION(gdcredecompress, SHOW_LONGLONG, getReDecompress)
+STATUS_FUNCTION(gdcprobationhits, SHOW_LONGLONG, getProbationHits)
+STATUS_FUNCTION(gdcprotectedhits, SHOW_LONGLONG, getProtectedHits)
+STATUS_FUNCTION(gdcprobationmisses, SHOW_LONGLONG, getProbationMisses)
+STATUS_FUNCTION(gdcprotectedmisses, SHOW_LONGLONG, getProtectedMisses)
 
 MM_STATUS_FUNCTION(mmallocblocks, SHOW_LONGLONG, getAllocBlocks)
 MM_STATUS_FUNCTION(mmallocobjs, SHOW_LONGLONG, getAllocObjs)
@@ -2302,8 +2525,16 @@ static struct st_mysql_show_var statusvars[] = {
     STATUS_MEMBER(gdcfalsewakeup, gdc_false_wakeup),
     STATUS_MEMBER(gdcreadwaitinprogress, gdc_read_wait_in_progress),
     STATUS_MEMBER(gdcpackloads, gdc_pack_loads),
+    STATUS_MEMBER(gdcpacklockwaits, gdc_pack_lock_waits),
+    STATUS_MEMBER(gdcprefetchissued, gdc_prefetch_issued),
+    STATUS_MEMBER(gdcprefetchhits, gdc_prefetch_hits),
+    STATUS_MEMBER(gdcprefetchwasted, gdc_prefetch_wasted),
     STATUS_MEMBER(gdcloaderrors, gdc_load_errors),
     STATUS_MEMBER(gdcredecompress, gdc_redecompress),
+    STATUS_MEMBER(gdcprobationhits, gdc_probation_hits),
+    STATUS_MEMBER(gdcprotectedhits, gdc_protected_hits),
+    STATUS_MEMBER(gdcprobationmisses, gdc_probation_misses),
+    STATUS_MEMBER(gdcprotectedmisses, gdc_protected_misses),
     STATUS_MEMBER(mmrelease1, mm_release1),
     STATUS_MEMBER(mmrelease2, mm_release2),
     STATUS_MEMBER(mmrelease3, mm_release3),
@@ -2326,6 +2557,13 @@ static struct st_mysql_show_var statusvars[] = {
     STATUS_MEMBER(mmreleasetotal, mm_release_total),
     STATUS_MEMBER(DelayedBufferUsage, delay_buffer_usage),
     STATUS_MEMBER(RowStoreUsage, row_store_usage),
+    STATUS_MEMBER(DeltaMergeLagRows, delta_merge_lag_rows),
+    STATUS_MEMBER(DeltaMergeLagSeconds, delta_merge_lag_seconds),
+    STATUS_MEMBER(DeltaMergeLagTables, delta_merge_lag_tables),
+    STATUS_MEMBER(GroupBySpillTuples, groupby_spill_tuples),
+    STATUS_MEMBER(GroupBySpillBytes, groupby_spill_bytes),
+    STATUS_MEMBER(JoinRuntimeFilterRows, join_runtime_filter_rows),
+    STATUS_MEMBER(JoinRuntimeFilterPackrows, join_runtime_filter_packrows),
     STATUS_MEMBER(Freeable, mm_freeable),
     STATUS_MEMBER(InsertPerMinute, insert_per_minute),
     STATUS_MEMBER(LoadPerMinute, load_per_minute),
@@ -2389,11 +2627,24 @@ static MYSQL_SYSVAR_UINT(mm_largetempratio, tianmu_sysvar_mm_largetempratio, PLU
                          0, 0, 99, 0);
 static MYSQL_SYSVAR_UINT(mm_largetemppool_threshold, tianmu_sysvar_mm_large_threshold, PLUGIN_VAR_INT,
                          "size threshold in MB for using large temp thread pool", nullptr, nullptr, 16, 0, 10240, 0);
+static MYSQL_SYSVAR_UINT(mm_scan_threshold, tianmu_sysvar_mm_scan_threshold, PLUGIN_VAR_INT,
+                         "number of packs a query may bring into the cache before the 'arc' release policy treats "
+                         "it as a scan, 0 means never",
+                         nullptr, nullptr, 1024, 0, UINT_MAX32, 0);
 static MYSQL_SYSVAR_UINT(sync_buffers, tianmu_sysvar_sync_buffers, PLUGIN_VAR_READONLY, "-", nullptr, nullptr, 0, 0, 1,
                          0);
 
 static MYSQL_SYSVAR_UINT(query_threads, tianmu_sysvar_query_threads, PLUGIN_VAR_READONLY, "-", nullptr, nullptr, 0, 0,
                          100, 0);
+static MYSQL_SYSVAR_UINT(prefetch_threads, tianmu_sysvar_prefetch_threads, PLUGIN_VAR_READONLY,
+                         "number of threads reading packs ahead of queries, 0 means one per core", nullptr, nullptr, 0,
+                         0, 100, 0);
+static MYSQL_SYSVAR_UINT(prefetch_depth, tianmu_sysvar_prefetch_depth, PLUGIN_VAR_INT,
+                         "number of packs per column read ahead of a scan, 0 disables read-ahead", nullptr, nullptr, 2,
+                         0, 30, 0);
+static MYSQL_SYSVAR_UINT(prefetch_buffer_size, tianmu_sysvar_prefetch_buffer_size, PLUGIN_VAR_INT,
+                         "upper limit in MB for packs read ahead and not used yet", nullptr, nullptr, 256, 0, 102400,
+                         0);
 static MYSQL_SYSVAR_UINT(load_threads, tianmu_sysvar_load_threads, PLUGIN_VAR_READONLY, "-", nullptr, nullptr, 0, 0,
                          100, 0);
 static MYSQL_SYSVAR_UINT(bg_load_threads, tianmu_sysvar_bg_load_threads, PLUGIN_VAR_READONLY, "-", nullptr, nullptr, 0,
@@ -2404,6 +2655,9 @@ static MYSQL_SYSVAR_UINT(delete_or_update_threads, tianmu_sysvar_delete_or_updat
                          nullptr, nullptr, 0, 0, 100, 0);
 static MYSQL_SYSVAR_UINT(merge_rocks_expected_count, tianmu_sysvar_merge_rocks_expected_count, PLUGIN_VAR_READONLY, "-",
                          nullptr, nullptr, 65536, 0, 6553600, 0);
+static MYSQL_SYSVAR_UINT(merge_threads, tianmu_sysvar_merge_threads, PLUGIN_VAR_INT,
+                         "number of tables merged from the delta store concurrently, 0 - bg_load_threads", nullptr,
+                         nullptr, 0, 0, 100, 0);
 static MYSQL_SYSVAR_UINT(insert_write_batch_size, tianmu_sysvar_insert_write_batch_size, PLUGIN_VAR_READONLY, "-",
                          nullptr, nullptr, 10000, 0, 1000000, 0);
 static MYSQL_SYSVAR_UINT(log_loop_interval, tianmu_sysvar_log_loop_interval, PLUGIN_VAR_READONLY, "-", nullptr, nullptr,
@@ -2424,6 +2678,9 @@ static MYSQL_SYSVAR_UINT(groupby_parallel_degree, tianmu_sysvar_groupby_parallel
 static MYSQL_SYSVAR_ULONGLONG(groupby_parallel_rows_minimum, tianmu_sysvar_groupby_parallel_rows_minimum,
                               PLUGIN_VAR_LONGLONG, "group by parallel minimum rows", nullptr, nullptr, 655360, 655360,
                               INT64_MAX, 0);
+static MYSQL_SYSVAR_BOOL(groupby_spill, tianmu_sysvar_groupby_spill, PLUGIN_VAR_BOOL,
+                         "spill groups not fitting in memory to hash partitions on disk instead of rescanning the input",
+                         nullptr, nullptr, TRUE);
 static MYSQL_SYSVAR_UINT(slow_query_record_interval, tianmu_sysvar_slow_query_record_interval, PLUGIN_VAR_INT,
                          "slow Query Threshold of recording tianmu logs, in seconds", nullptr, nullptr, 0, 0, INT32_MAX,
                          0);
@@ -2431,12 +2688,19 @@ static MYSQL_SYSVAR_BOOL(orderby_speedup, tianmu_sysvar_orderby_speedup, PLUGIN_
 static MYSQL_SYSVAR_UINT(join_parallel, tianmu_sysvar_join_parallel, PLUGIN_VAR_INT,
                          "join matching parallel: 0-Disabled, 1-Auto, N-specify count", nullptr, nullptr, 1, 0, 1000,
                          1);
+static MYSQL_SYSVAR_UINT(join_radix_partitions, tianmu_sysvar_join_radix_partitions, PLUGIN_VAR_INT,
+                         "radix partitioned hash join: 0-Disabled, 1-Auto, N-specify count", nullptr, nullptr, 0, 0,
+                         4096, 0);
+static MYSQL_SYSVAR_BOOL(join_runtime_filter, tianmu_sysvar_join_runtime_filter, PLUGIN_VAR_BOOL,
+                         "filter the probe side of hash joins by the keys of the build side", nullptr, nullptr, TRUE);
 static MYSQL_SYSVAR_UINT(join_splitrows, tianmu_sysvar_join_splitrows, PLUGIN_VAR_INT,
                          "join split rows:0-Disabled, 1-Auto, N-specify count", nullptr, nullptr, 0, 0, 1000, 0);
 static MYSQL_SYSVAR_BOOL(minmax_speedup, tianmu_sysvar_minmax_speedup, PLUGIN_VAR_BOOL, "-", nullptr, nullptr, TRUE);
 static MYSQL_SYSVAR_UINT(index_cache_size, tianmu_sysvar_index_cache_size, PLUGIN_VAR_READONLY,
                          "Index cache size in MB", nullptr, nullptr, 0, 0, 65536, 0);
 static MYSQL_SYSVAR_BOOL(index_search, tianmu_sysvar_index_search, PLUGIN_VAR_BOOL, "-", nullptr, nullptr, TRUE);
+static MYSQL_SYSVAR_BOOL(secondary_index, tianmu_sysvar_secondary_index, PLUGIN_VAR_BOOL,
+                         "allow non-unique secondary indexes, kept in rocksdb", nullptr, nullptr, FALSE);
 static MYSQL_SYSVAR_BOOL(enable_rowstore, tianmu_sysvar_enable_rowstore, PLUGIN_VAR_BOOL, "-", nullptr, nullptr, TRUE);
 static MYSQL_SYSVAR_BOOL(parallel_filloutput, tianmu_sysvar_parallel_filloutput, PLUGIN_VAR_BOOL, "-", nullptr, nullptr,
                          TRUE);
@@ -2456,6 +2720,17 @@ static MYSQL_SYSVAR_ENUM(data_distribution_policy, tianmu_sysvar_dist_policy, PL
                          "Possible values are round-robin(default), random, and space",
                          nullptr, nullptr, 2, &policy_typelib_t);
 
+// keep in the order of system::IOEngine::Backend
+static const char *io_backend_names[] = {"sync", "pread", "io_uring", 0};
+static TYPELIB io_backend_typelib_t = {array_elements(io_backend_names) - 1, "io_backend_names", io_backend_names, 0};
+static MYSQL_SYSVAR_ENUM(io_backend, tianmu_sysvar_io_backend, PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+                         "How packs are read from disk. "
+                         "Possible values are sync, pread(default) and io_uring",
+                         nullptr, nullptr, 1, &io_backend_typelib_t);
+static MYSQL_SYSVAR_UINT(io_threads, tianmu_sysvar_io_threads, PLUGIN_VAR_READONLY,
+                         "number of threads of the pread I/O backend, 0 means one per core", nullptr, nullptr, 0, 0,
+                         100, 0);
+
 static MYSQL_SYSVAR_UINT(disk_usage_threshold, tianmu_sysvar_disk_usage_threshold, PLUGIN_VAR_INT,
                          "Specifies the disk usage threshold for data diretories.", nullptr, nullptr, 85, 10, 99, 0);
 
@@ -2475,6 +2750,12 @@ static MYSQL_SYSVAR_BOOL(join_disable_switch_side, tianmu_sysvar_join_disable_sw
                          nullptr, nullptr, FALSE);
 static MYSQL_SYSVAR_BOOL(enable_histogram_cmap_bloom, tianmu_sysvar_enable_histogram_cmap_bloom, PLUGIN_VAR_BOOL, "-",
                          nullptr, nullptr, FALSE);
+static MYSQL_SYSVAR_BOOL(lazy_column_init, tianmu_sysvar_lazy_column_init, PLUGIN_VAR_BOOL,
+                         "scan the pack descriptors of a column on its first use instead of on table open", nullptr,
+                         nullptr, FALSE);
+static MYSQL_SYSVAR_BOOL(native_expression, tianmu_sysvar_native_expression, PLUGIN_VAR_BOOL,
+                         "evaluate supported numerical expressions over blocks of rows instead of through MySQL items",
+                         nullptr, nullptr, TRUE);
 static MYSQL_SYSVAR_BOOL(large_prefix, tianmu_sysvar_large_prefix, PLUGIN_VAR_RQCMDARG,
                          "Support large index prefix length of 3072 bytes. If off, the maximum "
                          "index prefix length is 767.",
@@ -2551,6 +2832,7 @@ static struct st_mysql_sys_var *tianmu_showvars[] = {MYSQL_SYSVAR(bg_load_thread
                                                      MYSQL_SYSVAR(data_distribution_policy),
                                                      MYSQL_SYSVAR(delete_or_update_threads),
                                                      MYSQL_SYSVAR(merge_rocks_expected_count),
+                                                     MYSQL_SYSVAR(merge_threads),
                                                      MYSQL_SYSVAR(insert_write_batch_size),
                                                      MYSQL_SYSVAR(log_loop_interval),
                                                      MYSQL_SYSVAR(disk_usage_threshold),
@@ -2559,10 +2841,12 @@ static struct st_mysql_sys_var *tianmu_showvars[] = {MYSQL_SYSVAR(bg_load_thread
                                                      MYSQL_SYSVAR(global_debug_level),
                                                      MYSQL_SYSVAR(groupby_parallel_degree),
                                                      MYSQL_SYSVAR(groupby_parallel_rows_minimum),
+                                                     MYSQL_SYSVAR(groupby_spill),
                                                      MYSQL_SYSVAR(slow_query_record_interval),
                                                      MYSQL_SYSVAR(hugefiledir),
                                                      MYSQL_SYSVAR(index_cache_size),
                                                      MYSQL_SYSVAR(index_search),
+                                                     MYSQL_SYSVAR(secondary_index),
                                                      MYSQL_SYSVAR(enable_rowstore),
                                                      MYSQL_SYSVAR(ini_allowmysqlquerypath),
                                                      MYSQL_SYSVAR(ini_cachefolder),
@@ -2581,11 +2865,16 @@ static struct st_mysql_sys_var *tianmu_showvars[] = {MYSQL_SYSVAR(bg_load_thread
                                                      MYSQL_SYSVAR(insert_numthreshold),
                                                      MYSQL_SYSVAR(insert_wait_ms),
                                                      MYSQL_SYSVAR(insert_wait_time),
+                                                     MYSQL_SYSVAR(io_backend),
+                                                     MYSQL_SYSVAR(io_threads),
                                                      MYSQL_SYSVAR(join_disable_switch_side),
                                                      MYSQL_SYSVAR(enable_histogram_cmap_bloom),
                                                      MYSQL_SYSVAR(join_parallel),
+                                                     MYSQL_SYSVAR(join_radix_partitions),
+                                                     MYSQL_SYSVAR(join_runtime_filter),
                                                      MYSQL_SYSVAR(join_splitrows),
                                                      MYSQL_SYSVAR(large_prefix),
+                                                     MYSQL_SYSVAR(lazy_column_init),
                                                      MYSQL_SYSVAR(load_threads),
                                                      MYSQL_SYSVAR(lookup_max_size),
                                                      MYSQL_SYSVAR(max_execution_time),
@@ -2595,9 +2884,14 @@ static struct st_mysql_sys_var *tianmu_showvars[] = {MYSQL_SYSVAR(bg_load_thread
                                                      MYSQL_SYSVAR(mm_largetemppool_threshold),
                                                      MYSQL_SYSVAR(mm_policy),
                                                      MYSQL_SYSVAR(mm_releasepolicy),
+                                                     MYSQL_SYSVAR(mm_scan_threshold),
+                                                     MYSQL_SYSVAR(native_expression),
                                                      MYSQL_SYSVAR(orderby_speedup),
                                                      MYSQL_SYSVAR(parallel_filloutput),
                                                      MYSQL_SYSVAR(parallel_mapjoin),
+                                                     MYSQL_SYSVAR(prefetch_buffer_size),
+                                                     MYSQL_SYSVAR(prefetch_depth),
+                                                     MYSQL_SYSVAR(prefetch_threads),
                                                      MYSQL_SYSVAR(qps_log),
                                                      MYSQL_SYSVAR(query_threads),
                                                      MYSQL_SYSVAR(refresh_sys_tianmu),
@@ -20,6 +20,7 @@
 
 #include "common/common_definitions.h"
 #include "core/engine.h"
+#include "system/configuration.h"
 
 namespace Tianmu {
 namespace DBHandler {
@@ -50,7 +51,8 @@ class ha_tianmu final : public handler {
   ulonglong table_flags() const override {
     return HA_NON_KEY_AUTO_INC | HA_REC_NOT_IN_SEQ | HA_PARTIAL_COLUMN_READ | HA_BINLOG_STMT_CAPABLE |
            HA_BLOCK_CONST_TABLE | HA_PRIMARY_KEY_REQUIRED_FOR_POSITION | HA_NULL_IN_KEY | HA_DUPLICATE_POS |
-           HA_PRIMARY_KEY_IN_READ_INDEX | HA_BINLOG_ROW_CAPABLE | HA_NON_SECONDARY_KEY | HA_NON_UNIQUE_KEY;
+           HA_PRIMARY_KEY_IN_READ_INDEX | HA_BINLOG_ROW_CAPABLE | HA_NON_UNIQUE_KEY |
+           (tianmu_sysvar_secondary_index ? 0 : HA_NON_SECONDARY_KEY);
   }
   /*
    This is a bitmap of flags that says how the storage engine
@@ -62,10 +64,7 @@ class ha_tianmu final : public handler {
    If all_parts it's set, MySQL want to know the flags for the combined
    index up to and including 'part'.
    */
-  ulong index_flags([[maybe_unused]] uint inx, [[maybe_unused]] uint part,
-                    [[maybe_unused]] bool all_parts) const override {
-    return 0;
-  }
+  ulong index_flags(uint inx, [[maybe_unused]] uint part, [[maybe_unused]] bool all_parts) const override;
   /*
    unireg.cc will call the following to make sure that the storage engine can
    handle the data it is about to send.
@@ -98,6 +97,8 @@ class ha_tianmu final : public handler {
   int close() override;                    // required
 
   int write_row(uchar *buf __attribute__((unused))) override;
+  void start_bulk_insert(ha_rows rows) override;
+  int end_bulk_insert() override;
   int update_row(const uchar *old_data, uchar *new_data) override;
   int delete_row(const uchar *buf) override;
   int index_read(uchar *buf, const uchar *key, uint key_len, enum ha_rkey_function find_flag) override;
@@ -154,6 +155,8 @@ class ha_tianmu final : public handler {
   void update_create_info(HA_CREATE_INFO *create_info) override;
   int fill_row_by_id(uchar *buf, uint64_t rowid);
   void key_convert(const uchar *key, uint key_len, std::vector<uint> cols, std::vector<std::string> &keys);
+  void secondary_key_convert(const uchar *key, uint key_len, const index::SecondaryKey &sk,
+                             std::vector<std::string> &fields, std::vector<bool> &nulls);
 
  public:
   static const Alter_inplace_info::HA_ALTER_FLAGS TIANMU_SUPPORTED_ALTER_ADD_DROP_ORDER;
@@ -182,6 +185,8 @@ class ha_tianmu final : public handler {
   std::unique_ptr<core::CompiledQuery> cq_;
   bool result_ = false;
   std::vector<std::vector<uchar>> blob_buffers_;
+  std::vector<uchar> key_record_;  // scratch row for secondary_key_convert(), keeps record[0] intact
+  std::shared_ptr<core::TianmuTable> bulk_insert_table_;  // between start_bulk_insert() and end_bulk_insert()
 };
 
 }  // namespace DBHandler
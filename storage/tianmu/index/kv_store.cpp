@@ -358,6 +358,9 @@ void KVStore::create_rdbkey(TABLE *table, uint pos, std::shared_ptr<RdbKey> &new
   uint16_t index_ver = (key_info->actual_key_parts > 1)
                            ? static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_COLS)
                            : static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_INITIAL);
+  // non-unique secondary keys carry the row id in the key so that duplicates can coexist
+  if (pos != table->s->primary_key && !(key_info->flags & HA_NOSAME) && tianmu_sysvar_secondary_index)
+    index_ver = static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_ROWID);
 
   new_key_def = std::make_shared<RdbKey>(index_id, pos, cf_handle, index_ver, index_type, false, key_name, vcols);
 }
@@ -128,8 +128,9 @@ common::ErrorCode RdbKey::unpack_field_number(StringReader &key, std::string &fi
 
 void RdbKey::pack_field_string(StringWriter &info, StringWriter &key, std::string &field) {
   // issue1374: bug: Failed to insert a null value to the composite primary key.
-  // the empty field of primary key will be ignored.
-  if (field.length() == 0)
+  // the empty field of primary key will be ignored. Secondary keys flag nulls
+  // themselves, an empty string there is a value.
+  if (field.length() == 0 && !HasRowIdSuffix())
     return;
   // version compatible
   if (index_ver_ == static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_INITIAL)) {
@@ -214,6 +215,92 @@ common::ErrorCode RdbKey::unpack_field_string(StringReader &key, StringReader &i
   return common::ErrorCode::SUCCESS;
 }
 
+void RdbKey::pack_field(StringWriter &key, StringWriter &info, uint part, std::string &field) {
+  switch (cols_[part].col_type) {
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_TINY:
+
+    case MYSQL_TYPE_DOUBLE:
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_DATETIME2:
+    case MYSQL_TYPE_TIMESTAMP2:
+    case MYSQL_TYPE_TIME2:
+    case MYSQL_TYPE_YEAR: {
+      pack_field_number(key, field, cols_[part].col_flag);
+      break;
+    }
+
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING: {
+      pack_field_string(info, key, field);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+common::ErrorCode RdbKey::unpack_field(StringReader &key, StringReader &value, uint part, std::string &field) {
+  switch (cols_[part].col_type) {
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_DATETIME2:
+    case MYSQL_TYPE_TIMESTAMP2:
+    case MYSQL_TYPE_TIME2:
+    case MYSQL_TYPE_YEAR:
+
+    case MYSQL_TYPE_DOUBLE:
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_NEWDECIMAL: {
+      if (unpack_field_number(key, field, cols_[part].col_flag) != common::ErrorCode::SUCCESS) {
+        TIANMU_LOG(LogCtl_Level::ERROR, "unpack numeric field failed!");
+        return common::ErrorCode::FAILED;
+      }
+    } break;
+
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING: {
+      // case sensitive for character
+      if (unpack_field_string(key, value, field) != common::ErrorCode::SUCCESS) {
+        TIANMU_LOG(LogCtl_Level::ERROR, "unpack string field failed!");
+        return common::ErrorCode::FAILED;
+      }
+    } break;
+
+    default:
+      break;
+  }
+  return common::ErrorCode::SUCCESS;
+}
+
 // cmp packed
 void RdbKey::pack_key(StringWriter &key, std::vector<std::string> &fields, StringWriter &info) {
   ASSERT(cols_.size() >= fields.size(), "fields size larger than keyparts size");
@@ -225,45 +312,7 @@ void RdbKey::pack_key(StringWriter &key, std::vector<std::string> &fields, Strin
     info.write_uint16(0);
   size_t pos = info.length();
 
-  for (uint i = 0; i < fields.size(); i++) {
-    switch (cols_[i].col_type) {
-      case MYSQL_TYPE_LONGLONG:
-      case MYSQL_TYPE_LONG:
-      case MYSQL_TYPE_INT24:
-      case MYSQL_TYPE_SHORT:
-      case MYSQL_TYPE_TINY:
-
-      case MYSQL_TYPE_DOUBLE:
-      case MYSQL_TYPE_FLOAT:
-      case MYSQL_TYPE_NEWDECIMAL:
-      case MYSQL_TYPE_TIMESTAMP:
-      case MYSQL_TYPE_TIME:
-      case MYSQL_TYPE_DATE:
-      case MYSQL_TYPE_DATETIME:
-      case MYSQL_TYPE_NEWDATE:
-      case MYSQL_TYPE_DATETIME2:
-      case MYSQL_TYPE_TIMESTAMP2:
-      case MYSQL_TYPE_TIME2:
-      case MYSQL_TYPE_YEAR: {
-        pack_field_number(key, fields[i], cols_[i].col_flag);
-        break;
-      }
-
-      case MYSQL_TYPE_VARCHAR:
-      case MYSQL_TYPE_TINY_BLOB:
-      case MYSQL_TYPE_MEDIUM_BLOB:
-      case MYSQL_TYPE_LONG_BLOB:
-      case MYSQL_TYPE_BLOB:
-      case MYSQL_TYPE_VAR_STRING:
-      case MYSQL_TYPE_STRING: {
-        pack_field_string(info, key, fields[i]);
-        break;
-      }
-
-      default:
-        break;
-    }
-  }
+  for (uint i = 0; i < fields.size(); i++) pack_field(key, info, i, fields[i]);
 
   // version compatible
   if (index_ver_ > static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_INITIAL)) {
@@ -282,53 +331,55 @@ common::ErrorCode RdbKey::unpack_key(StringReader &key, StringReader &value, std
   if (index_ver_ > static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_INITIAL))
     value.read_uint16(&info_len);
 
-  for (auto &col : cols_) {
+  for (uint i = 0; i < cols_.size(); i++) {
     std::string field;
-    switch (col.col_type) {
-      case MYSQL_TYPE_LONGLONG:
-      case MYSQL_TYPE_LONG:
-      case MYSQL_TYPE_INT24:
-      case MYSQL_TYPE_SHORT:
-      case MYSQL_TYPE_TINY:
-      case MYSQL_TYPE_TIMESTAMP:
-      case MYSQL_TYPE_TIME:
-      case MYSQL_TYPE_DATE:
-      case MYSQL_TYPE_DATETIME:
-      case MYSQL_TYPE_NEWDATE:
-      case MYSQL_TYPE_DATETIME2:
-      case MYSQL_TYPE_TIMESTAMP2:
-      case MYSQL_TYPE_TIME2:
-      case MYSQL_TYPE_YEAR:
-
-      case MYSQL_TYPE_DOUBLE:
-      case MYSQL_TYPE_FLOAT:
-      case MYSQL_TYPE_NEWDECIMAL: {
-        if (unpack_field_number(key, field, col.col_flag) != common::ErrorCode::SUCCESS) {
-          TIANMU_LOG(LogCtl_Level::ERROR, "unpack numeric field failed!");
-          return common::ErrorCode::FAILED;
-        }
-      } break;
-
-      case MYSQL_TYPE_VARCHAR:
-      case MYSQL_TYPE_TINY_BLOB:
-      case MYSQL_TYPE_MEDIUM_BLOB:
-      case MYSQL_TYPE_LONG_BLOB:
-      case MYSQL_TYPE_BLOB:
-      case MYSQL_TYPE_VAR_STRING:
-      case MYSQL_TYPE_STRING: {
-        // case sensitive for character
-        if (unpack_field_string(key, value, field) != common::ErrorCode::SUCCESS) {
-          TIANMU_LOG(LogCtl_Level::ERROR, "unpack string field failed!");
-          return common::ErrorCode::FAILED;
-        }
-      } break;
+    if (unpack_field(key, value, i, field) != common::ErrorCode::SUCCESS)
+      return common::ErrorCode::FAILED;
+    fields.emplace_back(field);
+  }
 
-      default:
-        break;
+  return common::ErrorCode::SUCCESS;
+}
+
+void RdbKey::pack_secondary_key(StringWriter &key, std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                                StringWriter &info) {
+  ASSERT(cols_.size() >= fields.size(), "fields size larger than keyparts size");
+  key.clear();
+  info.clear();
+  key.write_uint32(index_pos_);
+  info.write_uint16(0);
+
+  for (uint i = 0; i < fields.size(); i++) {
+    // nulls sort first, as in mysql
+    if (i < nulls.size() && nulls[i]) {
+      key.write_uint8(0);
+      continue;
     }
-    fields.emplace_back(field);
+    key.write_uint8(1);
+    pack_field(key, info, i, fields[i]);
   }
+  info.write_uint16_at(0, info.length() - sizeof(uint16_t));
+}
 
+common::ErrorCode RdbKey::unpack_secondary_key(const rocksdb::Slice &key, StringReader &value,
+                                               std::vector<std::string> &fields, uint64_t &row) {
+  if (key.size() < INDEX_NUMBER_SIZE + sizeof(uint64_t))
+    return common::ErrorCode::FAILED;
+  row = be_to_uint64(reinterpret_cast<const uchar *>(key.data() + key.size() - sizeof(uint64_t)));
+
+  StringReader parts({key.data(), key.size() - sizeof(uint64_t)});
+  uint32_t index_number = 0;
+  uint16_t info_len = 0;
+  parts.read_uint32(&index_number);
+  value.read_uint16(&info_len);
+  for (uint i = 0; i < cols_.size(); i++) {
+    std::string field;
+    uchar not_null = 0;
+    parts.read_uint8(&not_null);
+    if (not_null && unpack_field(parts, value, i, field) != common::ErrorCode::SUCCESS)
+      return common::ErrorCode::FAILED;
+    fields.emplace_back(field);
+  }
   return common::ErrorCode::SUCCESS;
 }
 
@@ -816,7 +867,8 @@ bool DICTManager::get_index_info(const GlobalId &gl_index_id, uint16_t &index_ve
         found = true;
         break;
       }
-      case IndexInfoType::INDEX_INFO_VERSION_COLS: {
+      case IndexInfoType::INDEX_INFO_VERSION_COLS:
+      case IndexInfoType::INDEX_INFO_VERSION_ROWID: {
         uint32_t cols_sz = 0;
         reader.read_uint8(&index_type);
         reader.read_uint32(&cols_sz);
@@ -77,6 +77,8 @@ enum class VersionType {
 enum class IndexInfoType {
   INDEX_INFO_VERSION_INITIAL = 1,
   INDEX_INFO_VERSION_COLS = 2,
+  // non-unique secondary key, each part led by a null flag and the row id appended
+  INDEX_INFO_VERSION_ROWID = 3,
 };
 
 enum class IndexType { INDEX_TYPE_PRIMARY = 1, INDEX_TYPE_SECONDARY, INDEX_TYPE_HIDDEN_PRIMARY };
@@ -94,6 +96,16 @@ class RdbKey {
   void pack_key(StringWriter &key, std::vector<std::string> &fields, StringWriter &info);
   common::ErrorCode unpack_key(StringReader &key, StringReader &value, std::vector<std::string> &fields);
 
+  // Secondary key (INDEX_INFO_VERSION_ROWID): index id, then (null flag, part) for the
+  // leading fields.size() parts. The full key stored in rocksdb ends with the row id.
+  void pack_secondary_key(StringWriter &key, std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                          StringWriter &info);
+  common::ErrorCode unpack_secondary_key(const rocksdb::Slice &key, StringReader &value,
+                                         std::vector<std::string> &fields, uint64_t &row);
+  bool HasRowIdSuffix() const {
+    return index_ver_ == static_cast<uint16_t>(IndexInfoType::INDEX_INFO_VERSION_ROWID);
+  }
+
   // pack and unpack field num.
   void pack_field_number(StringWriter &key, std::string &field, uchar flag);
   common::ErrorCode unpack_field_number(StringReader &key, std::string &field, uchar flag);
@@ -155,6 +167,9 @@ class RdbKey {
   std::vector<ColAttr> GetColAttrs() const { return cols_; }
 
  private:
+  void pack_field(StringWriter &key, StringWriter &info, uint part, std::string &field);
+  common::ErrorCode unpack_field(StringReader &key, StringReader &value, uint part, std::string &field);
+
   friend class RdbTable;
   // ith pos in TABLE_SHARE::key_info[].
   const uint32_t index_pos_;
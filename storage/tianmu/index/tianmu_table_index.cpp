@@ -36,6 +36,10 @@ TianmuTableIndex::TianmuTableIndex(const std::string &name, TABLE *table) {
   TIANMU_LOG(LogCtl_Level::WARN, "normalize tablename %s, table_full_name %s!", name.c_str(), fullname.c_str());
 
   keyid_ = table->s->primary_key;
+  InitSecondaryKeys(table);
+  // a table may keep only secondary keys
+  if (keyid_ == MAX_INDEXES)
+    return;
   rocksdb_key_ = rocksdb_tbl_->GetRdbTableKeys().at(KVStore::pk_index(table, rocksdb_tbl_));
   // compatible version that primary key make up of one part
   if (table->key_info[keyid_].actual_key_parts == 1)
@@ -44,6 +48,32 @@ TianmuTableIndex::TianmuTableIndex(const std::string &name, TABLE *table) {
     rocksdb_key_->get_key_cols(index_of_columns_);
 }
 
+void TianmuTableIndex::InitSecondaryKeys(TABLE *table) {
+  secondary_keys_.clear();
+  auto &keys = rocksdb_tbl_->GetRdbTableKeys();
+  for (uint pos = 0; pos < keys.size() && pos < table->s->keys; pos++) {
+    if (pos == keyid_ || !keys[pos] || !keys[pos]->HasRowIdSuffix())
+      continue;
+    SecondaryKey sk{pos, {}, keys[pos]};
+    keys[pos]->get_key_cols(sk.cols);
+    secondary_keys_.push_back(std::move(sk));
+  }
+}
+
+const SecondaryKey *TianmuTableIndex::GetSecondaryKey(uint keyno) const {
+  for (auto &sk : secondary_keys_)
+    if (sk.keyno == keyno)
+      return &sk;
+  return nullptr;
+}
+
+const SecondaryKey *TianmuTableIndex::SecondaryKeyOn(uint col) const {
+  for (auto &sk : secondary_keys_)
+    if (!sk.cols.empty() && sk.cols[0] == col)
+      return &sk;
+  return nullptr;
+}
+
 bool TianmuTableIndex::FindIndexTable(const std::string &name) {
   std::string str;
   if (!NormalizeName(name, str)) {
@@ -66,7 +96,7 @@ common::ErrorCode TianmuTableIndex::CreateIndexTable(const std::string &name, TA
   // ColumnStore like many other analytical database engines does not support unique constraints.
   // This helps with performance and scaling out to much larger volumes than innodb supports.
   // It is assumed that your data preparation / ETL phase will ensure correct data being fed into columnstore.
-  if (table->s->keys > 1) {
+  if (table->s->keys > 1 && !tianmu_sysvar_secondary_index) {
     TIANMU_LOG(LogCtl_Level::WARN, "Table :%s have other keys except primary key, only use primary key!", name.data());
   }
 
@@ -102,7 +132,9 @@ common::ErrorCode TianmuTableIndex::RefreshIndexTable(const std::string &name) {
     TIANMU_LOG(LogCtl_Level::WARN, "table %s init ddl error", fullname.c_str());
     return common::ErrorCode::FAILED;
   }
-  rocksdb_key_ = rocksdb_tbl_->GetRdbTableKeys().at(keyid_);
+  if (keyid_ != MAX_INDEXES)
+    rocksdb_key_ = rocksdb_tbl_->GetRdbTableKeys().at(keyid_);
+  for (auto &sk : secondary_keys_) sk.rocksdb_key = rocksdb_tbl_->GetRdbTableKeys().at(sk.keyno);
   return common::ErrorCode::SUCCESS;
 }
 
@@ -167,6 +199,8 @@ common::ErrorCode TianmuTableIndex::CheckUniqueness(core::Transaction *tx, const
 }
 
 common::ErrorCode TianmuTableIndex::InsertIndex(core::Transaction *tx, std::vector<std::string> &fields, uint64_t row) {
+  if (!HasPrimaryKey())
+    return common::ErrorCode::SUCCESS;
   StringWriter value, key;
 
   rocksdb_key_->pack_key(key, fields, value);
@@ -188,6 +222,8 @@ common::ErrorCode TianmuTableIndex::InsertIndex(core::Transaction *tx, std::vect
 
 common::ErrorCode TianmuTableIndex::UpdateIndex(core::Transaction *tx, std::string &nkey, std::string &okey,
                                                 uint64_t row) {
+  if (!HasPrimaryKey())
+    return common::ErrorCode::SUCCESS;
   StringWriter value, packkey;
   std::vector<std::string> ofields, nfields;
 
@@ -208,6 +244,8 @@ common::ErrorCode TianmuTableIndex::UpdateIndex(core::Transaction *tx, std::stri
 
 common::ErrorCode TianmuTableIndex::DeleteIndex(core::Transaction *tx, std::vector<std::string> &fields,
                                                 uint64_t row [[maybe_unused]]) {
+  if (!HasPrimaryKey())
+    return common::ErrorCode::SUCCESS;
   StringWriter value, packkey;
 
   rocksdb_key_->pack_key(packkey, fields, value);
@@ -225,6 +263,8 @@ common::ErrorCode TianmuTableIndex::DeleteIndex(core::Transaction *tx, std::vect
 
 common::ErrorCode TianmuTableIndex::GetRowByKey(core::Transaction *tx, std::vector<std::string> &fields,
                                                 uint64_t &row) {
+  if (!HasPrimaryKey())
+    return common::ErrorCode::NOT_FOUND_KEY;
   std::string value;
   StringWriter packkey, info;
   rocksdb_key_->pack_key(packkey, fields, info);
@@ -249,17 +289,79 @@ common::ErrorCode TianmuTableIndex::GetRowByKey(core::Transaction *tx, std::vect
   return common::ErrorCode::SUCCESS;
 }
 
+void TianmuTableIndex::PackSecondaryEntry(const SecondaryKey &sk, std::vector<std::string> &fields,
+                                          const std::vector<bool> &nulls, uint64_t row, StringWriter &key,
+                                          StringWriter &info) {
+  sk.rocksdb_key->pack_secondary_key(key, fields, nulls, info);
+  key.write_uint64(row);
+}
+
+common::ErrorCode TianmuTableIndex::InsertSecondary(core::Transaction *tx, const SecondaryKey &sk,
+                                                    std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                                                    uint64_t row) {
+  StringWriter key, info;
+  PackSecondaryEntry(sk, fields, nulls, row, key, info);
+  // no uniqueness to check, the row id keeps equal parts apart
+  const auto s = tx->KVTrans().Put(sk.rocksdb_key->get_cf(), {(const char *)key.ptr(), key.length()},
+                                   {(const char *)info.ptr(), info.length()});
+  if (!s.ok()) {
+    TIANMU_LOG(LogCtl_Level::ERROR, "RocksDB: insert secondary key fail!");
+    return common::ErrorCode::FAILED;
+  }
+  return common::ErrorCode::SUCCESS;
+}
+
+common::ErrorCode TianmuTableIndex::DeleteSecondary(core::Transaction *tx, const SecondaryKey &sk,
+                                                    std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                                                    uint64_t row) {
+  StringWriter key, info;
+  PackSecondaryEntry(sk, fields, nulls, row, key, info);
+  const auto s = tx->KVTrans().Delete(sk.rocksdb_key->get_cf(), {(const char *)key.ptr(), key.length()});
+  if (!s.ok()) {
+    TIANMU_LOG(LogCtl_Level::ERROR, "RocksDB: delete secondary key fail!");
+    return common::ErrorCode::FAILED;
+  }
+  return common::ErrorCode::SUCCESS;
+}
+
 void KeyIterator::ScanToKey(std::shared_ptr<TianmuTableIndex> tab, std::vector<std::string> &fields,
                             common::Operator op) {
-  if (!tab || !txn_) {
+  if (!tab || !txn_ || !tab->HasPrimaryKey()) {
+    valid = false;
     return;
   }
   StringWriter packkey, info;
-  valid = true;
   rocksdb_key_ = tab->rocksdb_key_;
   rocksdb_key_->pack_key(packkey, fields, info);
-  rocksdb::Slice key_slice((const char *)packkey.ptr(), packkey.length());
+  Seek({(const char *)packkey.ptr(), packkey.length()}, op);
+}
 
+void KeyIterator::ScanToKey(const SecondaryKey &sk, std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                            common::Operator op) {
+  if (!txn_) {
+    valid = false;
+    return;
+  }
+  StringWriter packkey, info;
+  rocksdb_key_ = sk.rocksdb_key;
+  rocksdb_key_->pack_secondary_key(packkey, fields, nulls, info);
+  if (op != common::Operator::O_MORE) {
+    Seek({(const char *)packkey.ptr(), packkey.length()}, op);
+    return;
+  }
+  // '>' on a prefix: skip every entry sharing it by seeking to its successor
+  std::string next((const char *)packkey.ptr(), packkey.length());
+  while (!next.empty() && static_cast<uchar>(next.back()) == 0xFF) next.pop_back();
+  if (next.size() <= INDEX_NUMBER_SIZE) {
+    valid = false;
+    return;
+  }
+  next.back() = static_cast<char>(static_cast<uchar>(next.back()) + 1);
+  Seek({next.data(), next.length()}, common::Operator::O_MORE_EQ);
+}
+
+void KeyIterator::Seek(const rocksdb::Slice &key_slice, common::Operator op) {
+  valid = true;
   iter_ = std::shared_ptr<rocksdb::Iterator>(txn_->GetIterator(rocksdb_key_->get_cf(), true));
   switch (op) {
     case common::Operator::O_EQ:  //==
@@ -292,11 +394,25 @@ void KeyIterator::ScanToKey(std::shared_ptr<TianmuTableIndex> tab, std::vector<s
 }
 
 void KeyIterator::ScanToEdge(std::shared_ptr<TianmuTableIndex> tab, bool forward) {
-  if (!tab || !txn_) {
+  if (!tab || !txn_ || !tab->HasPrimaryKey()) {
+    valid = false;
     return;
   }
-  valid = true;
   rocksdb_key_ = tab->rocksdb_key_;
+  SeekEdge(forward);
+}
+
+void KeyIterator::ScanToEdge(const SecondaryKey &sk, bool forward) {
+  if (!txn_) {
+    valid = false;
+    return;
+  }
+  rocksdb_key_ = sk.rocksdb_key;
+  SeekEdge(forward);
+}
+
+void KeyIterator::SeekEdge(bool forward) {
+  valid = true;
   iter_ = std::shared_ptr<rocksdb::Iterator>(txn_->GetIterator(rocksdb_key_->get_cf(), true));
   std::string key = rocksdb_key_->get_boundary_key(forward);
 
@@ -347,10 +463,20 @@ KeyIterator &KeyIterator::operator--() {
   return *this;
 }
 
+int KeyIterator::CompareKeyPrefix(const std::string &prefix) const {
+  rocksdb::Slice key = iter_->key();
+  int cmp = memcmp(key.data(), prefix.data(), std::min(key.size(), prefix.size()));
+  if (cmp == 0 && key.size() < prefix.size())
+    return -1;
+  return cmp;
+}
+
 common::ErrorCode KeyIterator::GetCurKV(std::vector<std::string> &keys, uint64_t &row) {
   StringReader key({iter_->key().data(), iter_->key().size()});
   StringReader value({iter_->value().data(), iter_->value().size()});
 
+  if (rocksdb_key_->HasRowIdSuffix())
+    return rocksdb_key_->unpack_secondary_key(iter_->key(), value, keys, row);
   common::ErrorCode ret = rocksdb_key_->unpack_key(key, value, keys);
   value.read_uint64(&row);
   return ret;
@@ -35,6 +35,14 @@ class RdbKey;
 class RdbTable;
 class KVTransaction;
 
+// A non-unique secondary key of the table. Entries are (parts, row id) with an empty
+// payload besides the pack info, so duplicates of the same parts are kept apart.
+struct SecondaryKey {
+  uint keyno;  // pos in TABLE_SHARE::key_info[]
+  std::vector<uint> cols;
+  std::shared_ptr<RdbKey> rocksdb_key;
+};
+
 class TianmuTableIndex final {
  public:
   TianmuTableIndex(const TianmuTableIndex &) = delete;
@@ -45,6 +53,11 @@ class TianmuTableIndex final {
   virtual ~TianmuTableIndex() = default;
 
   const std::vector<uint> &KeyCols() { return index_of_columns_; }
+  bool HasPrimaryKey() const { return rocksdb_key_ != nullptr; }
+  const std::vector<SecondaryKey> &SecondaryKeys() const { return secondary_keys_; }
+  const SecondaryKey *GetSecondaryKey(uint keyno) const;
+  // the secondary key whose first part is column col, if any
+  const SecondaryKey *SecondaryKeyOn(uint col) const;
 
   static common::ErrorCode CreateIndexTable(const std::string &name, TABLE *table);
   static common::ErrorCode DropIndexTable(const std::string &name);
@@ -58,6 +71,10 @@ class TianmuTableIndex final {
   common::ErrorCode UpdateIndex(core::Transaction *tx, std::string &nkey, std::string &okey, uint64_t row);
   common::ErrorCode DeleteIndex(core::Transaction *tx, std::vector<std::string> &fields, uint64_t row);
   common::ErrorCode GetRowByKey(core::Transaction *tx, std::vector<std::string> &fields, uint64_t &row);
+  common::ErrorCode InsertSecondary(core::Transaction *tx, const SecondaryKey &sk, std::vector<std::string> &fields,
+                                    const std::vector<bool> &nulls, uint64_t row);
+  common::ErrorCode DeleteSecondary(core::Transaction *tx, const SecondaryKey &sk, std::vector<std::string> &fields,
+                                    const std::vector<bool> &nulls, uint64_t row);
 
  public:
   std::shared_ptr<RdbTable> rocksdb_tbl_;
@@ -67,6 +84,12 @@ class TianmuTableIndex final {
   uint keyid_ = 0;
 
  private:
+  void InitSecondaryKeys(TABLE *table);
+  static void PackSecondaryEntry(const SecondaryKey &sk, std::vector<std::string> &fields,
+                                 const std::vector<bool> &nulls, uint64_t row, StringWriter &key, StringWriter &info);
+
+  std::vector<SecondaryKey> secondary_keys_;
+
   common::ErrorCode CheckUniqueness(core::Transaction *tx, const rocksdb::Slice &pk_slice);
 };
 
@@ -77,16 +100,25 @@ class KeyIterator final {
   KeyIterator(KVTransaction *tx) : txn_(tx){};
   void ScanToKey(std::shared_ptr<TianmuTableIndex> tab, std::vector<std::string> &fields, common::Operator op);
   void ScanToEdge(std::shared_ptr<TianmuTableIndex> tab, bool forward);
+  // positions on the entries of a secondary key whose leading parts compare with fields by op
+  void ScanToKey(const SecondaryKey &sk, std::vector<std::string> &fields, const std::vector<bool> &nulls,
+                 common::Operator op);
+  void ScanToEdge(const SecondaryKey &sk, bool forward);
   common::ErrorCode GetCurKV(std::vector<std::string> &keys, uint64_t &row);
   common::ErrorCode GetRowid(uint64_t &row) {
     std::vector<std::string> keys;
     return GetCurKV(keys, row);
   }
   bool IsValid() const { return valid; }
+  // compares the leading bytes of the current key with a packed prefix
+  int CompareKeyPrefix(const std::string &prefix) const;
   KeyIterator &operator++();
   KeyIterator &operator--();
 
  protected:
+  void Seek(const rocksdb::Slice &key_slice, common::Operator op);
+  void SeekEdge(bool forward);
+
   bool valid = false;
   std::shared_ptr<rocksdb::Iterator> iter_;
   std::shared_ptr<RdbKey> rocksdb_key_;
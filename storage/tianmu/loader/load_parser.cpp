@@ -17,12 +17,16 @@
 
 #include "load_parser.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "binlog.h"
 #include "core/engine.h"
 #include "core/tianmu_attr.h"
 #include "loader/value_cache.h"
 #include "log_event.h"
 #include "system/io_parameters.h"
+#include "util/thread_pool.h"
 #include "util/timer.h"
 
 namespace Tianmu {
@@ -69,10 +73,14 @@ uint LoadParser::GetPackrow(uint no_of_rows, std::vector<ValueCache> &value_buff
     value_buffers.emplace_back(pack_size_, init_capacity);
   }
 
-  uint no_of_rows_returned;
-  for (no_of_rows_returned = 0; no_of_rows_returned < no_of_rows; no_of_rows_returned++) {
-    if (!MakeRow(value_buffers))
-      break;
+  // rows are tokenized on this thread, as that evaluates them through the table
+  // fields, then converted per column in parallel and finished in file order
+  uint no_of_rows_returned = 0;
+  bool more = true;
+  while (more && no_of_rows_returned < no_of_rows) {
+    more = ParseBatch(std::min(no_of_rows - no_of_rows_returned, kBatchRows));
+    ConvertBatch();
+    no_of_rows_returned += FinishBatch(value_buffers);
   }
 
   last_pack_size_.clear();
@@ -83,16 +91,18 @@ uint LoadParser::GetPackrow(uint no_of_rows, std::vector<ValueCache> &value_buff
   return no_of_rows_returned;
 }
 
-bool LoadParser::MakeRow(std::vector<ValueCache> &value_buffers) {
-  uint rowsize = 0;
-  int errorinfo;
-
-  bool cont = true;
+bool LoadParser::ParseBatch(uint max_rows) {
+  batch_.clear();
   bool eof = false;
 
-  while (cont) {
-    switch (strategy_->GetOneRow(cur_ptr_, buf_end_ - cur_ptr_, value_buffers, rowsize, errorinfo, eof)) {
+  while (batch_.size() < max_rows) {
+    ParsedRow parsed{};
+    int errorinfo;
+    switch (strategy_->GetOneRowFields(cur_ptr_, buf_end_ - cur_ptr_, parsed.row, parsed.size, errorinfo, eof)) {
       case ParsingStrategy::ParseResult::EOB:
+        // the batch points into the current buffer, finish it before fetching
+        if (!batch_.empty())
+          return true;
         if (mysql_bin_log.is_open())
           binlog_loaded_block(read_buffer_.Buf(), cur_ptr_);
         if (read_buffer_.BufFetch(int(buf_end_ - cur_ptr_))) {
@@ -101,77 +111,165 @@ bool LoadParser::MakeRow(std::vector<ValueCache> &value_buffers) {
         } else {
           // reaching the end of the buffer
           if (cur_ptr_ != buf_end_) {
-            // rejecter_.ConsumeBadRow(cur_ptr_, buf_end_ - cur_ptr_, cur_row_ + 1, errorinfo == -1 ? -1 : errorinfo +
-            // 1);
             // do not cousume the row, take this as the normal line
             eof = true;
           } else {
             cur_row_++;
-            cont = false;
+            return false;
           }
         }
         break;
 
       case ParsingStrategy::ParseResult::ERROR:
-        rejecter_.ConsumeBadRow(cur_ptr_, rowsize, cur_row_ + 1, errorinfo + 1);
-        cur_ptr_ += rowsize;
+        parsed.ptr = cur_ptr_;
+        parsed.row_no = cur_row_ + 1;
+        parsed.error = true;
+        parsed.errorinfo = errorinfo;
+        cur_ptr_ += parsed.size;
         cur_row_++;
-        cont = false;
+        batch_.push_back(std::move(parsed));
+        return false;
+
+      case ParsingStrategy::ParseResult::OK:
+        parsed.ptr = cur_ptr_;
+        parsed.row_no = cur_row_ + 1;
+        cur_ptr_ += parsed.size;
+        cur_row_++;
+        batch_.push_back(std::move(parsed));
+        // the warnings of a row are raised while tokenizing it, so the row
+        // number they report is advanced here rather than when it is loaded
+        io_param_.GetTHD()->get_stmt_da()->inc_current_row_for_condition();
         break;
+    }
+  }
 
-      case ParsingStrategy::ParseResult::OK: {
-        bool make_value_ok{true};
-        for (uint att = 0; make_value_ok && att < attrs_.size(); ++att)
-          if (!MakeValue(att, value_buffers[att])) {
-            rejecter_.ConsumeBadRow(cur_ptr_, rowsize, cur_row_ + 1, att + 1);
-            make_value_ok = false;
-          }
+  return true;
+}
 
-        cur_ptr_ += rowsize;
-        cur_row_++;
+void LoadParser::ConvertBatch() {
+  converted_.clear();
+  for (uint att = 0; att < attrs_.size(); att++) {
+    size_t capacity = 0;
+    for (auto &parsed : batch_)
+      if (!parsed.error)
+        capacity += std::max(parsed.row.fields[att].second, sizeof(int64_t));
+    converted_.emplace_back(batch_.size(), capacity + 64);
+  }
+  failed_rows_.assign(attrs_.size(), batch_.size());
+  failures_.assign(attrs_.size(), nullptr);
+
+  // tianmu_load_serial converts every batch here, for the tests comparing both paths
+  if (attrs_.size() == 1 || batch_.size() < kMinParallelRows || DBUG_EVALUATE_IF("tianmu_load_serial", true, false)) {
+    for (uint att = 0; att < attrs_.size(); att++) ConvertColumn(att, current_txn_);
+    return;
+  }
+
+  utils::result_set<void> res;
+  for (uint att = 0; att < attrs_.size(); att++)
+    res.insert(ha_tianmu_engine_->load_thread_pool.add_task(&LoadParser::ConvertColumn, this, att, current_txn_));
+  res.get_all();
+}
+
+void LoadParser::ConvertColumn(uint att, core::Transaction *txn) {
+  current_txn_ = txn;
+  auto &values = converted_[att];
+  for (size_t i = 0; i < batch_.size() && !batch_[i].error; i++) {
+    auto &field = batch_[i].row.fields[att];
+    try {
+      strategy_->GetValue(field.first, field.second, att, values);
+    } catch (...) {
+      // rethrown by FinishBatch once the rows before it are loaded
+      failed_rows_[att] = i;
+      failures_[att] = std::current_exception();
+      return;
+    }
+    values.Commit();
+  }
+}
+
+uint LoadParser::FinishBatch(std::vector<ValueCache> &value_buffers) {
+  size_t failed_row = batch_.size();
+  std::exception_ptr failure;
+  for (uint att = 0; att < attrs_.size(); att++)
+    if (failed_rows_[att] < failed_row) {
+      failed_row = failed_rows_[att];
+      failure = failures_[att];
+    }
+
+  uint no_of_rows = 0;
+  for (size_t i = 0; i < batch_.size(); i++) {
+    if (i == failed_row)
+      std::rethrow_exception(failure);
+
+    auto &parsed = batch_[i];
+    if (parsed.error) {
+      rejecter_.ConsumeBadRow(parsed.ptr, parsed.size, parsed.row_no, parsed.errorinfo + 1);
+      break;
+    }
+
+    for (uint att = 0; att < attrs_.size(); ++att) {
+      auto &values = converted_[att];
+      if (values.IsNull(i)) {
+        value_buffers[att].ExpectedNull(true);
+      } else {
+        auto size = values.Size(i);
+        std::memcpy(value_buffers[att].Prepare(size), values.GetDataBytesPointer(i), size);
+        value_buffers[att].ExpectedSize(size);
+      }
+    }
+
+    bool make_value_ok{true};
+    for (uint att = 0; make_value_ok && att < attrs_.size(); ++att)
+      if (!MakeValue(att, value_buffers[att])) {
+        rejecter_.ConsumeBadRow(parsed.ptr, parsed.size, parsed.row_no, att + 1);
+        make_value_ok = false;
+      }
 
-        if (!make_value_ok)
-          break;
+    if (!make_value_ok) {
+      // drop what was prepared for the rejected row
+      for (uint att = 0; att < attrs_.size(); ++att) {
+        value_buffers[att].ExpectedSize(0);
+        value_buffers[att].ExpectedNull(false);
+      }
+      continue;
+    }
 
+    for (uint att = 0; att < attrs_.size(); ++att) {
+      value_buffers[att].Commit();
+    }
+
+    num_of_row_++;
+    if (num_of_skip_ < io_param_.GetSkipLines()) /*check skip lines */
+    {
+      // does not load this line,continue to get next line
+      num_of_skip_++;
+      num_of_row_--;
+      for (uint att = 0; att < attrs_.size(); ++att) {
+        value_buffers[att].Rollback();
+
+        auto &attr(attrs_[att]);
+        attr->RollBackIfAutoInc();
+      }
+      continue;
+    } else if (tab_index_ != nullptr) { /* check duplicate */
+      if (HA_ERR_FOUND_DUPP_KEY == ProcessInsertIndex(tab_index_, value_buffers, num_of_row_ - 1)) {
+        // dose not load this line, continue to get next line
+        num_of_row_--;
+        num_of_dup_++;
         for (uint att = 0; att < attrs_.size(); ++att) {
-          value_buffers[att].Commit();
-        }
+          value_buffers[att].Rollback();
 
-        num_of_row_++;
-        io_param_.GetTHD()->get_stmt_da()->inc_current_row_for_condition();
-        if (num_of_skip_ < io_param_.GetSkipLines()) /*check skip lines */
-        {
-          // does not load this line,continue to get next line
-          num_of_skip_++;
-          num_of_row_--;
-          for (uint att = 0; att < attrs_.size(); ++att) {
-            value_buffers[att].Rollback();
-
-            auto &attr(attrs_[att]);
-            attr->RollBackIfAutoInc();
-          }
-          break;
-        } else if (tab_index_ != nullptr) { /* check duplicate */
-          if (HA_ERR_FOUND_DUPP_KEY == ProcessInsertIndex(tab_index_, value_buffers, num_of_row_ - 1)) {
-            // dose not load this line, continue to get next line
-            num_of_row_--;
-            num_of_dup_++;
-            for (uint att = 0; att < attrs_.size(); ++att) {
-              value_buffers[att].Rollback();
-
-              auto &attr(attrs_[att]);
-              attr->RollBackIfAutoInc();
-            }
-            break;
-          }
+          auto &attr(attrs_[att]);
+          attr->RollBackIfAutoInc();
         }
-
-        return true;
+        continue;
       }
     }
+
+    no_of_rows++;
   }
 
-  return false;
+  return no_of_rows;
 }
 
 bool LoadParser::MakeValue(uint att, ValueCache &buffer) {
@@ -230,6 +328,13 @@ int LoadParser::ProcessInsertIndex(std::shared_ptr<index::TianmuTableIndex> tab,
     return HA_ERR_FOUND_DUPP_KEY;
   }
 
+  std::vector<bool> nulls;
+  for (auto &sk : tab->SecondaryKeys()) {
+    core::TianmuTable::SecondaryKeyFields(attrs_, vcs, lastrow - 1, sk.cols, fields, nulls);
+    if (tab->InsertSecondary(current_txn_, sk, fields, nulls, num_of_obj_ + no_rows) != common::ErrorCode::SUCCESS)
+      throw common::Exception("Load insert secondary key " + std::to_string(sk.keyno) + " fail");
+  }
+
   return 0;
 }
 
@@ -18,6 +18,7 @@
 #define TIANMU_LOADER_LOAD_PARSER_H_
 #pragma once
 
+#include <exception>
 #include <vector>
 
 #include "loader/parsing_strategy.h"
@@ -30,7 +31,8 @@ namespace Tianmu {
 
 namespace core {
 class TianmuAttr;
-}
+class Transaction;
+}  // namespace core
 namespace index {
 class TianmuTableIndex;
 }  // namespace index
@@ -57,6 +59,19 @@ class LoadParser final {
   int64_t GetIgnoreRow() const { return num_of_skip_; }
 
  private:
+  // rows tokenized ahead and converted column by column in parallel
+  static constexpr uint kBatchRows = 4096;
+  static constexpr uint kMinParallelRows = 256;
+
+  struct ParsedRow {
+    ParsingStrategy::RowFields row;
+    const char *ptr;  // the row text, for the rejecter
+    uint size;
+    uint row_no;
+    bool error;  // the load was killed while parsing this row
+    int errorinfo;
+  };
+
   TianmuAttrPtrVect_t &attrs_;
 
   std::vector<int64_t> last_pack_size_;
@@ -78,7 +93,15 @@ class LoadParser final {
   int64_t num_of_dup_ = 0;
   int64_t num_of_skip_ = 0;
 
-  bool MakeRow(std::vector<ValueCache> &value_buffers);
+  std::vector<ParsedRow> batch_;
+  std::vector<ValueCache> converted_;
+  std::vector<size_t> failed_rows_;  // per column, the row whose conversion threw
+  std::vector<std::exception_ptr> failures_;
+
+  bool ParseBatch(uint max_rows);
+  void ConvertBatch();
+  void ConvertColumn(uint att, core::Transaction *txn);
+  uint FinishBatch(std::vector<ValueCache> &value_buffers);
   bool MakeValue(uint col, ValueCache &buffer);
   int binlog_loaded_block(const char *buf_start, const char *buf_end);
 };
@@ -49,8 +49,7 @@ ParsingStrategy::ParsingStrategy(const system::IOParameters &iop, std::vector<uc
       terminator_(iop.LineTerminator()),
       delimiter_(iop.Delimiter()),
       string_qualifier_(iop.StringQualifier()),
-      escape_char_(iop.EscapeCharacter()),
-      temp_buf_(65536) {
+      escape_char_(iop.EscapeCharacter()) {
   charset_info_ = get_charset(iop.CharsetInfoNumber(), 0);
   for (ushort i = 0; i < attr_infos_.size(); ++i) {
     if (core::ATI::IsStringType(GetATI(i).Type())) {
@@ -410,6 +409,41 @@ void ParsingStrategy::ReadField(const char *&ptr, const char *&val_beg, Item *&i
 ParsingStrategy::ParseResult ParsingStrategy::GetOneRow(const char *const buf, size_t size,
                                                         std::vector<ValueCache> &record, uint &rowsize, int &errorinfo,
                                                         bool eof) {
+  std::vector<std::pair<const char *, size_t>> vec_ptr_field;
+  ParseResult res = ParseFields(buf, size, vec_ptr_field, rowsize, errorinfo, eof);
+  if (res != ParseResult::OK)
+    return res;
+
+  // step4,row is completed, to make the whole row
+  for (uint col = 0; col < attr_infos_.size(); ++col) {
+    auto &ptr_field = vec_ptr_field[col];
+    GetValue(ptr_field.first, ptr_field.second, col, record[col]);
+  }
+  return res;
+}
+
+ParsingStrategy::ParseResult ParsingStrategy::GetOneRowFields(const char *const buf, size_t size, RowFields &row,
+                                                              uint &rowsize, int &errorinfo, bool eof) {
+  row.fields.clear();
+  row.copies.clear();
+  ParseResult res = ParseFields(buf, size, row.fields, rowsize, errorinfo, eof);
+  if (res != ParseResult::OK)
+    return res;
+
+  // default values and the set clause live in strings reused by the next row
+  row.copies.reserve(row.fields.size());
+  for (auto &ptr_field : row.fields) {
+    if (ptr_field.first == nullptr || (ptr_field.first >= buf && ptr_field.first < buf + size))
+      continue;
+    row.copies.emplace_back(ptr_field.first, ptr_field.second);
+    ptr_field.first = row.copies.back().data();
+  }
+  return res;
+}
+
+ParsingStrategy::ParseResult ParsingStrategy::ParseFields(const char *const buf, size_t size,
+                                                          std::vector<std::pair<const char *, size_t>> &vec_ptr_field,
+                                                          uint &rowsize, int &errorinfo, bool eof) {
   const char *buf_end = buf + size;
   if (!prepared_) {
     GetEOL(buf, buf_end);
@@ -419,7 +453,6 @@ ParsingStrategy::ParseResult ParsingStrategy::GetOneRow(const char *const buf, s
   if (buf == buf_end)
     return ParsingStrategy::ParseResult::EOB;
 
-  std::vector<std::pair<const char *, size_t>> vec_ptr_field;
   // default values;
   uint n_fields = table_->s->fields;
   uint i = 0;
@@ -591,10 +624,18 @@ ParsingStrategy::ParseResult ParsingStrategy::GetOneRow(const char *const buf, s
     ++field_index_in_field_list;
   }
 
-  // step4,row is completed, to make the whole row
+  // warn about the text values GetValue will truncate, while the row is still the current one
   for (uint col = 0; col < attr_infos_.size(); ++col) {
     auto &ptr_field = vec_ptr_field[col];
-    GetValue(ptr_field.first, ptr_field.second, col, record[col]);
+    if (ptr_field.first == nullptr || !core::ATI::IsTxtType(GetATI(col).Type()) ||
+        GetATI(col).Precision() >= static_cast<uint>(ptr_field.second))
+      continue;
+    std::string valueStr(ptr_field.first, ptr_field.second);
+    TIANMU_LOG(LogCtl_Level::DEBUG, "Data format error. DbName:%s ,TableName:%s ,Col %d, value:%s", dbname_.c_str(),
+               tablename_.c_str(), col, valueStr.c_str());
+    std::stringstream err_msg;
+    err_msg << "data truncate,col num" << col << " value:" << valueStr << std::endl;
+    common::PushWarning(thd_, Sql_condition::SL_WARNING, ER_UNKNOWN_ERROR, err_msg.str().c_str());
   }
 
 end:
@@ -659,17 +700,9 @@ void ParsingStrategy::GetValue(const char *value_ptr, size_t value_size, ushort
     buffer.ExpectedSize(int(value_size / 2));
 
   } else if (core::ATI::IsTxtType(ati.Type())) {
-    // process escape characters
-    if (ati.Precision() < static_cast<uint>(value_size)) {
-      std::string valueStr(value_ptr, value_size);
-
+    // process escape characters, the truncation was already warned about by ParseFields
+    if (ati.Precision() < static_cast<uint>(value_size))
       value_size = ati.Precision();
-      TIANMU_LOG(LogCtl_Level::DEBUG, "Data format error. DbName:%s ,TableName:%s ,Col %d, value:%s", dbname_.c_str(),
-                 tablename_.c_str(), col, valueStr.c_str());
-      std::stringstream err_msg;
-      err_msg << "data truncate,col num" << col << " value:" << valueStr << std::endl;
-      common::PushWarning(current_txn_->Thd(), Sql_condition::SL_WARNING, ER_UNKNOWN_ERROR, err_msg.str().c_str());
-    }
 
     uint reserved = (uint)value_size * ati.CharsetInfo()->mbmaxlen;
     char *buf = reinterpret_cast<char *>(buffer.Prepare(reserved));
@@ -690,10 +723,8 @@ void ParsingStrategy::GetValue(const char *value_ptr, size_t value_size, ushort
       if (ati.CharsetInfo()->mbmaxlen <= charset_info_->mbmaxlen)
         new_size = copy_and_convert(buf, reserved, ati.CharsetInfo(), buf, new_size, charset_info_, &errors);
       else {
-        if (new_size > temp_buf_.size())
-          temp_buf_.resize(new_size);
-        char *tmpbuf = &temp_buf_[0];
-        std::memcpy(tmpbuf, buf, new_size);
+        std::vector<char> temp_buf(buf, buf + new_size);
+        char *tmpbuf = temp_buf.data();
         new_size = copy_and_convert(buf, reserved, ati.CharsetInfo(), tmpbuf, new_size, charset_info_, &errors);
       }
     }
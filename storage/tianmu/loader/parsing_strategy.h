@@ -30,11 +30,24 @@ class ParsingStrategy final {
   using kmp_next_t = std::vector<int>;
   enum class ParseResult { OK, EOB, ERROR };
 
+  // a row split into its column values, nullptr for null; values not pointing into
+  // the parsed buffer are copied, as their strings are reused by the next row
+  struct RowFields {
+    std::vector<std::pair<const char *, size_t>> fields;
+    std::vector<std::string> copies;
+  };
+
  public:
   ParsingStrategy(const system::IOParameters &iop, std::vector<uchar> columns_collations);
   ~ParsingStrategy() {}
   ParseResult GetOneRow(const char *const buf, size_t size, std::vector<ValueCache> &values, uint &rowsize,
                         int &errorinfo, bool eof = false);
+  // like GetOneRow, but leaves the conversion of the values to GetValue
+  ParseResult GetOneRowFields(const char *const buf, size_t size, RowFields &row, uint &rowsize, int &errorinfo,
+                              bool eof = false);
+  // converts one text value of column col; does not touch THD or the table, so
+  // different columns may be converted in parallel
+  void GetValue(const char *const value_ptr, size_t value_size, ushort col, ValueCache &value);
   void ReadField(const char *&ptr, const char *&val_beg, Item *&item, uint &index_of_field,
                  std::vector<std::pair<const char *, size_t>> &vec_ptr_field, uint &field_index_in_field_list,
                  const CHARSET_INFO *char_info, bool completed_row = true);
@@ -65,7 +78,6 @@ class ParsingStrategy final {
   kmp_next_t kmp_next_enclose_terminator_;
 
   CHARSET_INFO *charset_info_;
-  std::vector<char> temp_buf_;
 
   bool first_row_prepared_{false};
   std::vector<String *> vec_field_Str_list_;  // table column index<---> String*, string will be delete by THD
@@ -82,7 +94,9 @@ class ParsingStrategy final {
                                            const std::string &line_termination, const std::vector<int> &kmp_next);
 
   void GetEOL(const char *const buf, const char *const buf_end);
-  void GetValue(const char *const value_ptr, size_t value_size, ushort col, ValueCache &value);
+  ParseResult ParseFields(const char *const buf, size_t size,
+                          std::vector<std::pair<const char *, size_t>> &vec_ptr_field, uint &rowsize, int &errorinfo,
+                          bool eof);
 };
 
 }  // namespace loader
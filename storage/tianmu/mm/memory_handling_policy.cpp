@@ -31,6 +31,7 @@
 #include "mm/numa_heap_policy.h"
 #include "mm/release2q.h"
 #include "mm/release_all.h"
+#include "mm/release_arc.h"
 #include "mm/release_fifo.h"
 #include "mm/release_lru.h"
 #include "mm/release_null.h"
@@ -139,6 +140,8 @@ MemoryHandling::MemoryHandling([[maybe_unused]] size_t comp_heap_size, size_t un
     _releasePolicy = new ReleaseLRU();
   else if (rpolicy == "2q")
     _releasePolicy = new Release2Q(1024, main_heap_MB * 4, 128);
+  else if (rpolicy == "arc")
+    _releasePolicy = new ReleaseARC(main_heap_MB * 4);
   else  // default
     _releasePolicy = new Release2Q(1024, main_heap_MB * 4, 128);
   //_releaseStrat = new ReleaseALL( this );
@@ -556,10 +559,25 @@ void MemoryHandling::AssertNoLeak(TraceableObject *o) {
   ASSERT(m_objs.find(o) == m_objs.end(), "MemoryLeakAssertion");
 }
 
-void MemoryHandling::TrackAccess(TraceableObject *o) {
+CacheSegment MemoryHandling::TrackAccess(TraceableObject *o, PackAccess access, uint64_t query) {
   MEASURE_FET("MemoryHandling::TrackAccess");
   std::scoped_lock guard(m_release_mutex);
-  _releasePolicy->Access(o);
+  AccessHint hint;
+  if (o->TraceableType() == TO_TYPE::TO_PACK) {
+    if (access == PackAccess::PREFETCH) {
+      // read ahead threads run without a transaction
+      hint.query = query;
+      hint.prefetch = true;
+    } else if (current_txn_ != nullptr) {
+      hint.query = current_txn_->QueryID();
+      int64_t admitted =
+          current_txn_->CountPackAccess(!o->IsTracked() || access == PackAccess::FIRST_USE_OF_PREFETCHED);
+      hint.scan = tianmu_sysvar_mm_scan_threshold > 0 && admitted > tianmu_sysvar_mm_scan_threshold;
+    }
+  }
+  CacheSegment found_in = o->GetCacheSegment();
+  _releasePolicy->HintedAccess(o, hint);
+  return (found_in != CacheSegment::NONE) ? found_in : o->GetCacheSegment();
 }
 
 void MemoryHandling::StopAccessTracking(TraceableObject *o) {
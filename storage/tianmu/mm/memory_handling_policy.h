@@ -32,6 +32,16 @@ namespace mm {
 class TraceableObject;
 class ReleaseStrategy;
 class HeapPolicy;
+
+// The part of the cache a release policy keeps an object in, reported by the
+// per-segment cache statistics. Policies without segments leave it NONE.
+enum class CacheSegment : unsigned char { NONE = 0, PROBATION, PROTECTED };
+
+// How a pack access reaches TrackAccess(). A pack read ahead is admitted on
+// behalf of the statement that asked for it, but counts as brought into the
+// cache by the statement only when it is first pinned.
+enum class PackAccess : unsigned char { USE, PREFETCH, FIRST_USE_OF_PREFETCHED };
+
 // Systemwide memory responsibilities
 //  -- alloc/dealloc on any heap by delegating
 //  -- track objects
@@ -70,7 +80,9 @@ class MemoryHandling {
                   TraceableObject *owner);  // returns size of a memory block
                                             // represented by [mh]
 
-  void TrackAccess(TraceableObject *);
+  // Returns the segment the object was found in, or if it was not tracked yet
+  // the one it was admitted to. `query` is used for PackAccess::PREFETCH only.
+  CacheSegment TrackAccess(TraceableObject *, PackAccess access = PackAccess::USE, uint64_t query = 0);
   void StopAccessTracking(TraceableObject *);
 
   void AssertNoLeak(TraceableObject *);
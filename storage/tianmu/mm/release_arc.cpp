@@ -0,0 +1,162 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#include "release_arc.h"
+
+#include <algorithm>
+
+#include "mm/reference_object.h"
+#include "mm/release_strategy.h"
+#include "mm/release_tracker.h"
+
+namespace Tianmu {
+namespace mm {
+
+ReleaseARC::~ReleaseARC() {
+  Forget(B1, B1Lookup, true);
+  Forget(B2, B2Lookup, true);
+}
+
+void ReleaseARC::HintedAccess(TraceableObject *o, const AccessHint &hint) {
+  switch (o->GetCacheSegment()) {
+    case CacheSegment::PROBATION:
+      // an object admitted without a known query is claimed by the first one
+      if (hint.query != 0 && !hint.scan && LastQuery(o) != 0 && LastQuery(o) != hint.query) {
+        UnTrack(o);
+        Admit(T2, o, hint);
+      } else {
+        Touch(o);
+        if (hint.query != 0)
+          LastQuery(o) = hint.query;
+      }
+      return;
+    case CacheSegment::PROTECTED:
+      Touch(o);
+      return;
+    case CacheSegment::NONE:
+      break;
+  }
+  DEBUG_ASSERT(!o->IsTracked());
+
+  auto it1 = B1Lookup.find(o->GetCoordinate());
+  auto it2 = (it1 == B1Lookup.end()) ? B2Lookup.find(o->GetCoordinate()) : B2Lookup.end();
+  if (it1 == B1Lookup.end() && it2 == B2Lookup.end()) {
+    Admit(T1, o, hint);
+    return;
+  }
+
+  // a read ahead is no reuse yet: the ghost is dropped without adapting p
+  bool reuse = !hint.scan && !hint.prefetch;
+  m_reloaded++;
+  unsigned b1 = B1.size(), b2 = B2.size();
+  ReferenceObject *d;
+  if (it1 != B1Lookup.end()) {
+    d = it1->second;
+    B1.remove(d);
+    B1Lookup.erase(it1);
+    // released from probation too early, give probation more room
+    if (reuse)
+      p = std::min(p + std::max(1u, b2 / b1), T1.size() + T2.size());
+  } else {
+    d = it2->second;
+    B2.remove(d);
+    B2Lookup.erase(it2);
+    // released from the protected segment too early, give it more room
+    if (reuse) {
+      unsigned delta = std::max(1u, b1 / b2);
+      p = (p > delta) ? p - delta : 0;
+    }
+  }
+  delete d;
+  Admit(reuse ? T2 : T1, o, hint);
+}
+
+void ReleaseARC::Remove(TraceableObject *o) {
+  UnTrack(o);
+  SetSegment(o, CacheSegment::NONE);
+}
+
+void ReleaseARC::Admit(LRUTracker &t, TraceableObject *o, const AccessHint &hint) {
+  t.insert(o);
+  SetSegment(o, (&t == &T1) ? CacheSegment::PROBATION : CacheSegment::PROTECTED);
+  LastQuery(o) = hint.query;
+}
+
+// `o` is already removed from `t`
+void ReleaseARC::Evict(LRUTracker &t, TraceableObject *o) {
+  ReferenceObject *ref = new ReferenceObject(o->GetCoordinate());
+  if (&t == &T1) {
+    B1.insert(ref);
+    B1Lookup.insert(std::make_pair(ref->GetCoordinate(), ref));
+    Forget(B1, B1Lookup);
+  } else {
+    B2.insert(ref);
+    B2Lookup.insert(std::make_pair(ref->GetCoordinate(), ref));
+    Forget(B2, B2Lookup);
+  }
+  SetSegment(o, CacheSegment::NONE);
+  o->Release();
+}
+
+void ReleaseARC::Forget(FIFOTracker &b,
+                        std::unordered_map<core::TOCoordinate, ReferenceObject *, core::TOCoordinate> &lookup,
+                        bool all) {
+  while (b.size() > (all ? 0 : Kghost)) {
+    TraceableObject *ao = b.removeTail();
+    lookup.erase(ao->GetCoordinate());
+    delete ao;
+  }
+}
+
+/*
+ * Release from probation while it is over its target size. Locked objects are
+ * in use and are moved to the head of their segment. Each object is tried at
+ * most once, so once all of one segment turned out to be locked the rest is
+ * released from the other one.
+ */
+void ReleaseARC::Release(unsigned num_objs) {
+  unsigned count = 0;
+  unsigned t1_left = T1.size(), t2_left = T2.size();
+  while ((t1_left > 0 || t2_left > 0) && (count < num_objs)) {
+    bool from_t1 = t1_left > 0 && (T1.size() > p || t2_left == 0);
+    LRUTracker &t = from_t1 ? T1 : T2;
+    (from_t1 ? t1_left : t2_left)--;
+    TraceableObject *o = t.removeMax();
+    if (o == nullptr)
+      break;
+    if (o->IsLocked()) {
+      t.insert(o);
+      continue;
+    }
+    Evict(t, o);
+    count++;
+  }
+}
+
+void ReleaseARC::ReleaseFull() {
+  for (LRUTracker *t : {&T1, &T2}) {
+    for (unsigned n = t->size(); n > 0; n--) {
+      TraceableObject *o = t->removeMax();
+      if (o->IsLocked())
+        t->insert(o);
+      else
+        Evict(*t, o);
+    }
+  }
+}
+
+}  // namespace mm
+}  // namespace Tianmu
@@ -0,0 +1,93 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_MM_RELEASE_ARC_H_
+#define TIANMU_MM_RELEASE_ARC_H_
+#pragma once
+
+#include <unordered_map>
+
+#include "mm/reference_object.h"
+#include "mm/release_strategy.h"
+#include "mm/release_tracker.h"
+
+namespace Tianmu {
+namespace mm {
+
+class TraceableObject;
+/*
+ * Adaptive Replacement Cache (Megiddo and Modha) with query aware admission.
+ *
+ * T1 (probation) holds objects seen by one query only, T2 (protected) the ones
+ * used again by another query. B1 and B2 remember the coordinates of objects
+ * released from T1 and T2. The target size p of T1 adapts to the workload:
+ * a reload of an object from B1 grows it, a reload from B2 shrinks it.
+ *
+ * On accessing X by query Q:
+ *  begin
+ *      if X is in T1 then
+ *          if Q is not the last query of X and Q is not a scan then
+ *              move X to the head of T2
+ *          else
+ *              move X to the head of T1
+ *      else if X is in T2 then
+ *          move X to the head of T2
+ *      else if X is in B1 or B2 and Q is not a scan and X is not read ahead then
+ *          adapt p, add X to the head of T2
+ *      else
+ *          add X to the head of T1
+ *  end
+ *
+ * Packs read ahead are admitted on behalf of the query that asked for them.
+ * An object admitted without a known query belongs to the first query using it.
+ *
+ * Objects are released on request only: from the tail of T1 while |T1| > p,
+ * otherwise from the tail of T2. So a large scan, whose packs stay in T1 and
+ * do not adapt p, can only push out other packs of probation and the
+ * protected working set survives it.
+ */
+class ReleaseARC : public ReleaseStrategy {
+  LRUTracker T1, T2;
+  FIFOTracker B1, B2;
+  unsigned Kghost;  // maximal size of B1 and B2 each
+  unsigned p = 0;   // target size of T1
+  std::unordered_map<core::TOCoordinate, ReferenceObject *, core::TOCoordinate> B1Lookup, B2Lookup;
+
+  void Admit(LRUTracker &t, TraceableObject *o, const AccessHint &hint);
+  void Evict(LRUTracker &t, TraceableObject *o);
+  void Forget(FIFOTracker &b, std::unordered_map<core::TOCoordinate, ReferenceObject *, core::TOCoordinate> &lookup,
+              bool all = false);
+
+ public:
+  ReleaseARC(unsigned kghost) : Kghost(kghost) {}
+  ~ReleaseARC();
+
+  void Access(TraceableObject *o) override { HintedAccess(o, AccessHint()); }
+  void HintedAccess(TraceableObject *o, const AccessHint &hint) override;
+  void Remove(TraceableObject *o) override;
+  void Release(unsigned) override;
+  void ReleaseFull() override;
+
+  unsigned long long getCount1() override { return T2.size(); }
+  unsigned long long getCount2() override { return T1.size(); }
+  unsigned long long getCount3() override { return B1.size(); }
+  unsigned long long getCount4() override { return B2.size(); }
+};
+
+}  // namespace mm
+}  // namespace Tianmu
+
+#endif  // TIANMU_MM_RELEASE_ARC_H_
@@ -24,17 +24,31 @@
 namespace Tianmu {
 namespace mm {
 
+// Who accesses an object: the id of the running query (0 if not known),
+// whether that query has brought more packs into the cache than
+// tianmu_mm_scan_threshold, i.e. is a large scan, and whether the object is
+// only read ahead for the query.
+struct AccessHint {
+  uint64_t query = 0;
+  bool scan = false;
+  bool prefetch = false;
+};
+
 class ReleaseStrategy {
  protected:
   uint64_t m_reloaded;
 
   void Touch(TraceableObject *o) { o->tracker->touch(o); }
   void UnTrack(TraceableObject *o) { o->tracker->remove(o); }
+  void SetSegment(TraceableObject *o, CacheSegment s) { o->segment = s; }
+  uint64_t &LastQuery(TraceableObject *o) { return o->last_query; }
 
  public:
   ReleaseStrategy() : m_reloaded(0) {}
   virtual ~ReleaseStrategy() {}
   virtual void Access(TraceableObject *) = 0;
+  // policies which are not query aware ignore the hint
+  virtual void HintedAccess(TraceableObject *o, [[maybe_unused]] const AccessHint &hint) { Access(o); }
   virtual void Remove(TraceableObject *) = 0;
 
   virtual void Release(unsigned) = 0;
@@ -101,6 +101,7 @@ class TraceableObject {
   // DataPacks can be prefetched but not used yet
   // this is a hint to memory release algorithm
   bool IsPrefetchUnused() { return m_preUnused; }
+  void setPrefetchUnused() { m_preUnused = true; }
   void clearPrefetchUnused() { m_preUnused = false; }
   static MemoryHandling *Instance() {
     if (!m_MemHandling) {
@@ -112,9 +113,13 @@ class TraceableObject {
       return m_MemHandling;
   }
 
-  void TrackAccess() { Instance()->TrackAccess(this); }
+  // see MemoryHandling::TrackAccess()
+  CacheSegment TrackAccess(PackAccess access = PackAccess::USE, uint64_t query = 0) {
+    return Instance()->TrackAccess(this, access, query);
+  }
   void StopAccessTracking() { Instance()->StopAccessTracking(this); }
   bool IsTracked() { return tracker != nullptr; }
+  CacheSegment GetCacheSegment() const { return segment; }
   virtual void Release() { TIANMU_ERROR("Release functionality not implemented for this object"); }
   core::TOCoordinate &GetCoordinate();
 
@@ -124,6 +129,8 @@ class TraceableObject {
   // For release tracking purposes, used by ReleaseTracker and ReleaseStrategy
   TraceableObject *next, *prev;
   ReleaseTracker *tracker;
+  CacheSegment segment = CacheSegment::NONE;
+  uint64_t last_query = 0;  // query id of the last access, if the policy needs it
 
   UniquePtr alloc_ptr(size_t size, BLOCK_TYPE type, bool nothrow = false);
 
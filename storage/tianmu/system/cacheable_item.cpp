@@ -160,8 +160,7 @@ void CacheableItem::CI_Put(int block, unsigned char *data, int size) {
       std::sprintf(str, "CacheableItem::CI_Put,write(%dKB)", (int)(file_size_[block] / 1_KB));
     FETOperator feto(str);
 #endif
-    cur_file_handle_.Seek(file_start_[block], SEEK_SET);
-    cur_file_handle_.WriteExact((char *)data, file_size_[block]);
+    cur_file_handle_.WriteExactAt((char *)data, file_size_[block], file_start_[block]);
   } catch (common::DatabaseException &e) {
     throw common::OutOfMemoryException(e.what());
   }
@@ -197,8 +196,7 @@ int CacheableItem::CI_Get(int block, uchar *data, int size, int off) {
     FETOperator feto(str);
 #endif
 
-    cur_file_handle_.Seek(file_start_[block] + off, SEEK_SET);
-    cur_file_handle_.Read((char *)data, size);
+    cur_file_handle_.ReadExactAt((char *)data, size, file_start_[block] + off);
   } catch (common::DatabaseException &e) {
     throw common::OutOfMemoryException(e.what());
   }
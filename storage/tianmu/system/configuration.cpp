@@ -41,20 +41,27 @@ unsigned int tianmu_sysvar_insert_max_buffered;
 unsigned int tianmu_sysvar_insert_numthreshold;
 unsigned int tianmu_sysvar_insert_wait_ms;
 unsigned int tianmu_sysvar_insert_wait_time;
+unsigned int tianmu_sysvar_io_threads;
 unsigned int tianmu_sysvar_knlevel;
 unsigned int tianmu_sysvar_load_threads;
 unsigned int tianmu_sysvar_max_execution_time;
 unsigned int tianmu_sysvar_mm_hardlimit;
 unsigned int tianmu_sysvar_mm_large_threshold;
 unsigned int tianmu_sysvar_mm_largetempratio;
+unsigned int tianmu_sysvar_mm_scan_threshold;
+unsigned int tianmu_sysvar_prefetch_buffer_size;
+unsigned int tianmu_sysvar_prefetch_depth;
+unsigned int tianmu_sysvar_prefetch_threads;
 unsigned int tianmu_sysvar_query_threads;
 unsigned int tianmu_sysvar_servermainheapsize;
 unsigned int tianmu_sysvar_sync_buffers;
 unsigned int tianmu_sysvar_threadpoolsize;
 unsigned int tianmu_sysvar_join_parallel;
+unsigned int tianmu_sysvar_join_radix_partitions;
 unsigned int tianmu_sysvar_join_splitrows;
 unsigned int tianmu_sysvar_delete_or_update_threads;
 unsigned int tianmu_sysvar_merge_rocks_expected_count;
+unsigned int tianmu_sysvar_merge_threads;
 unsigned int tianmu_sysvar_insert_write_batch_size;
 unsigned int tianmu_sysvar_log_loop_interval;
 my_bool tianmu_sysvar_compensation_start;
@@ -62,9 +69,11 @@ my_bool tianmu_sysvar_filterevaluation_speedup;
 my_bool tianmu_sysvar_groupby_speedup;
 unsigned int tianmu_sysvar_groupby_parallel_degree;
 unsigned long long tianmu_sysvar_groupby_parallel_rows_minimum;
+my_bool tianmu_sysvar_groupby_spill;
 unsigned int tianmu_sysvar_slow_query_record_interval;
 unsigned int tianmu_sysvar_index_cache_size;
 my_bool tianmu_sysvar_index_search;
+my_bool tianmu_sysvar_secondary_index;
 my_bool tianmu_sysvar_enable_rowstore;
 my_bool tianmu_sysvar_insert_delayed;
 my_bool tianmu_sysvar_minmax_speedup;
@@ -75,10 +84,14 @@ my_bool tianmu_sysvar_qps_log;
 my_bool tianmu_sysvar_large_prefix;
 unsigned int tianmu_sysvar_lookup_max_size;
 unsigned long tianmu_sysvar_dist_policy;
+unsigned long tianmu_sysvar_io_backend;
 char tianmu_sysvar_force_hashjoin;
 unsigned int tianmu_sysvar_start_async;
 char *tianmu_sysvar_async_join;
 char tianmu_sysvar_join_disable_switch_side;
+char tianmu_sysvar_join_runtime_filter;
+char tianmu_sysvar_lazy_column_init;
+char tianmu_sysvar_native_expression;
 char tianmu_sysvar_enable_histogram_cmap_bloom;
 unsigned int tianmu_sysvar_result_sender_rows;
 
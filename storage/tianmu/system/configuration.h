@@ -23,6 +23,8 @@ extern char tianmu_sysvar_filterevaluation_speedup;
 extern char tianmu_sysvar_groupby_speedup;
 extern unsigned int tianmu_sysvar_index_cache_size;
 extern char tianmu_sysvar_index_search;
+// Maintain non-unique secondary keys in rocksdb for tables created while enabled
+extern char tianmu_sysvar_secondary_index;
 extern char tianmu_sysvar_enable_rowstore;
 extern char tianmu_sysvar_insert_delayed;
 extern char tianmu_sysvar_minmax_speedup;
@@ -54,7 +56,9 @@ extern unsigned int tianmu_sysvar_insert_max_buffered;
 extern unsigned int tianmu_sysvar_insert_numthreshold;
 extern unsigned int tianmu_sysvar_insert_wait_ms;
 extern unsigned int tianmu_sysvar_insert_wait_time;
+extern unsigned int tianmu_sysvar_io_threads;
 extern unsigned int tianmu_sysvar_join_parallel;
+extern unsigned int tianmu_sysvar_join_radix_partitions;
 extern unsigned int tianmu_sysvar_join_splitrows;
 extern unsigned int tianmu_sysvar_knlevel;
 extern unsigned int tianmu_sysvar_load_threads;
@@ -63,11 +67,17 @@ extern unsigned int tianmu_sysvar_max_execution_time;
 extern unsigned int tianmu_sysvar_mm_hardlimit;
 extern unsigned int tianmu_sysvar_mm_large_threshold;
 extern unsigned int tianmu_sysvar_mm_largetempratio;
+extern unsigned int tianmu_sysvar_mm_scan_threshold;
+extern unsigned int tianmu_sysvar_prefetch_buffer_size;
+extern unsigned int tianmu_sysvar_prefetch_depth;
+extern unsigned int tianmu_sysvar_prefetch_threads;
 extern unsigned int tianmu_sysvar_query_threads;
 extern unsigned int tianmu_sysvar_servermainheapsize;
 extern unsigned int tianmu_sysvar_sync_buffers;
 extern unsigned int tianmu_sysvar_threadpoolsize;
 extern unsigned long tianmu_sysvar_dist_policy;
+// backend of pack reads, a system::IOEngine::Backend
+extern unsigned long tianmu_sysvar_io_backend;
 extern char tianmu_sysvar_force_hashjoin;
 extern unsigned int tianmu_sysvar_start_async;
 // Format: a;b;c;d
@@ -81,6 +91,9 @@ extern char *tianmu_sysvar_async_join;
 // tianmu_sysvar_join_disable_switch_side is the option to avoid this switching
 // process.
 extern char tianmu_sysvar_join_disable_switch_side;
+extern char tianmu_sysvar_join_runtime_filter;
+extern char tianmu_sysvar_lazy_column_init;
+extern char tianmu_sysvar_native_expression;
 // enable histogram/cmap/bloom filtering
 extern char tianmu_sysvar_enable_histogram_cmap_bloom;
 // The number of rows to load at a time when processing queries like select xxx
@@ -90,6 +103,8 @@ extern unsigned int tianmu_sysvar_result_sender_rows;
 extern unsigned int tianmu_sysvar_delete_or_update_threads;
 
 extern unsigned int tianmu_sysvar_merge_rocks_expected_count;
+// Number of tables whose delta store is merged concurrently, 0 - size of the background load pool
+extern unsigned int tianmu_sysvar_merge_threads;
 // Threshold to submit in insert request
 extern unsigned int tianmu_sysvar_insert_write_batch_size;
 
@@ -101,6 +116,8 @@ extern unsigned int tianmu_sysvar_groupby_parallel_degree;
 // Threshold for the minimum number of rows
 // that can start executing a multithreaded group by thread
 extern unsigned long long tianmu_sysvar_groupby_parallel_rows_minimum;
+// Spill groups not fitting in memory to disk partitions instead of rescanning
+extern char tianmu_sysvar_groupby_spill;
 // Slow Query Threshold of recording tianmu logs, in seconds
 extern unsigned int tianmu_sysvar_slow_query_record_interval;
 
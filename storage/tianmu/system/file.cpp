@@ -41,6 +41,40 @@ size_t TianmuFile::Read(void *buf, size_t count) {
   return read_bytes;
 }
 
+size_t TianmuFile::ReadAt(void *buf, size_t count, off_t pos) {
+  DEBUG_ASSERT(fd_ != -1);
+  auto read_bytes = pread(fd_, buf, count, pos);
+  if (read_bytes == -1)
+    ThrowError(errno);
+  return read_bytes;
+}
+
+void TianmuFile::ReadExactAt(void *buf, size_t count, off_t pos) {
+  size_t read_bytes = 0;
+  while (read_bytes < count) {
+    auto rb = ReadAt((char *)buf + read_bytes, count - read_bytes, pos + read_bytes);
+    if (rb == 0)
+      break;
+    read_bytes += rb;
+  }
+  if (read_bytes != count) {
+    ThrowError("Failed to read " + std::to_string(count) + " bytes at " + std::to_string(pos) + " from " + name_ +
+               ". returned " + std::to_string(read_bytes));
+  }
+}
+
+void TianmuFile::WriteExactAt(const void *buf, size_t count, off_t pos) {
+  DEBUG_ASSERT(fd_ != -1);
+  size_t total_writen_bytes = 0;
+  while (total_writen_bytes < count) {
+    auto writen_bytes =
+        pwrite(fd_, ((char *)buf) + total_writen_bytes, count - total_writen_bytes, pos + total_writen_bytes);
+    if (writen_bytes == -1)
+      ThrowError(errno);
+    total_writen_bytes += writen_bytes;
+  }
+}
+
 int TianmuFile::Flush() {
   int ret;
 #ifdef HAVE_FDATASYNC
@@ -0,0 +1,191 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "io_engine.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "common/exception.h"
+#include "util/log_ctl.h"
+
+namespace Tianmu {
+namespace system {
+
+std::unique_ptr<IOEngine> IOEngine::Create(Backend backend, size_t threads) {
+  switch (backend) {
+    case Backend::SYNC:
+      return std::unique_ptr<IOEngine>(new IOEngine(Backend::SYNC));
+    case Backend::IO_URING:
+#ifdef HAVE_LIBURING
+      if (UringIOEngine::Supported())
+        return std::make_unique<UringIOEngine>();
+      TIANMU_LOG(LogCtl_Level::WARN, "io_uring is not usable on this system, falling back to pread.");
+#else
+      TIANMU_LOG(LogCtl_Level::WARN, "Tianmu was built without liburing, falling back to pread.");
+#endif
+      [[fallthrough]];
+    case Backend::PREAD:
+    default:
+      return std::make_unique<PreadIOEngine>(threads);
+  }
+}
+
+const char *IOEngine::Name() const {
+  switch (backend_) {
+    case Backend::SYNC:
+      return "sync";
+    case Backend::PREAD:
+      return "pread";
+    case Backend::IO_URING:
+      return "io_uring";
+  }
+  return "unknown";
+}
+
+bool IOEngine::ReadBatch(ReadRequest *reqs, size_t n) {
+  if (n == 0)
+    return true;
+  if (n == 1)
+    ReadOne(reqs[0]);  // nothing to overlap with, don't hand it over
+  else
+    Submit(reqs, n);
+  return std::all_of(reqs, reqs + n, [](const ReadRequest &r) { return r.error == 0 && r.done == r.len; });
+}
+
+void IOEngine::Submit(ReadRequest *reqs, size_t n) {
+  for (size_t i = 0; i < n; i++) ReadOne(reqs[i]);
+}
+
+void IOEngine::ReadOne(ReadRequest &req) {
+  while (req.done < req.len) {
+    auto rb = pread(req.fd, static_cast<char *>(req.buf) + req.done, req.len - req.done, req.offset + req.done);
+    if (rb == -1) {
+      if (errno == EINTR)
+        continue;
+      req.error = errno;
+      return;
+    }
+    if (rb == 0)
+      return;  // end of file, done < len tells the caller
+    req.done += rb;
+  }
+}
+
+void PreadIOEngine::Submit(ReadRequest *reqs, size_t n) {
+  if (pool_.is_owner()) {
+    IOEngine::Submit(reqs, n);
+    return;
+  }
+
+  // split the batch into contiguous slices, one per I/O thread
+  size_t slices = std::min(n, pool_.size());
+  size_t step = (n + slices - 1) / slices;
+  utils::result_set<void> res;
+  for (size_t start = 0; start < n; start += step) {
+    size_t end = std::min(n, start + step);
+    res.insert(pool_.add_task([reqs, start, end]() {
+      for (size_t i = start; i < end; i++) ReadOne(reqs[i]);
+    }));
+  }
+  res.get_all();
+}
+
+#ifdef HAVE_LIBURING
+namespace {
+constexpr unsigned kRingDepth = 64;
+
+// Rings are not thread safe, so every thread submitting batches gets its own.
+struct Ring {
+  io_uring ring;
+  bool usable;
+  Ring() { usable = (io_uring_queue_init(kRingDepth, &ring, 0) == 0); }
+  ~Ring() {
+    if (usable)
+      io_uring_queue_exit(&ring);
+  }
+};
+
+Ring &ThreadRing() {
+  thread_local Ring r;
+  return r;
+}
+}  // namespace
+
+bool UringIOEngine::Supported() { return ThreadRing().usable; }
+
+void UringIOEngine::Submit(ReadRequest *reqs, size_t n) {
+  Ring &r = ThreadRing();
+  if (!r.usable) {
+    IOEngine::Submit(reqs, n);
+    return;
+  }
+
+  size_t next = 0;
+  unsigned in_flight = 0;
+  while (next < n || in_flight > 0) {
+    while (next < n && in_flight < kRingDepth) {
+      io_uring_sqe *sqe = io_uring_get_sqe(&r.ring);
+      if (sqe == nullptr)
+        break;
+      ReadRequest &req = reqs[next++];
+      io_uring_prep_read(sqe, req.fd, req.buf, req.len, req.offset);
+      io_uring_sqe_set_data(sqe, &req);
+      in_flight++;
+    }
+
+    int ret = io_uring_submit_and_wait(&r.ring, 1);
+    if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+      // the buffers belong to the caller, wait for what the kernel has before
+      // giving up on this ring
+      TIANMU_LOG(LogCtl_Level::ERROR, "io_uring submission failed: %s", std::strerror(-ret));
+      io_uring_cqe *cqe;
+      while (in_flight > 0 && io_uring_wait_cqe(&r.ring, &cqe) == 0) {
+        io_uring_cqe_seen(&r.ring, cqe);
+        in_flight--;
+      }
+      r.usable = false;
+      io_uring_queue_exit(&r.ring);
+      throw common::DatabaseException("io_uring submission failed: " + std::string(std::strerror(-ret)));
+    }
+
+    io_uring_cqe *cqe;
+    while (io_uring_peek_cqe(&r.ring, &cqe) == 0) {
+      auto req = static_cast<ReadRequest *>(io_uring_cqe_get_data(cqe));
+      int res = cqe->res;
+      io_uring_cqe_seen(&r.ring, cqe);
+      in_flight--;
+      if (res < 0) {
+        req->error = -res;
+      } else {
+        req->done = res;
+        if (res > 0 && req->done < req->len)
+          ReadOne(*req);  // short read, finish it synchronously
+      }
+    }
+  }
+}
+#endif
+
+}  // namespace system
+}  // namespace Tianmu
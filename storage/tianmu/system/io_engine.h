@@ -0,0 +1,96 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_SYSTEM_IO_ENGINE_H_
+#define TIANMU_SYSTEM_IO_ENGINE_H_
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <memory>
+
+#include "util/thread_pool.h"
+
+namespace Tianmu {
+namespace system {
+
+// One positional read of a batch. done and error are filled in by the engine.
+struct ReadRequest {
+  int fd;
+  off_t offset;
+  void *buf;
+  size_t len;
+  size_t done = 0;
+  int error = 0;  // errno of a failed read, 0 otherwise
+};
+
+// Backend for batched reads of column data, see tianmu_io_backend.
+//  SYNC     - the original code path: every pack is opened, seeked and read
+//             by the thread which needs it
+//  PREAD    - one pread() per pack through a cached descriptor, batches are
+//             spread over a pool of I/O threads
+//  IO_URING - batches are submitted to a per-thread io_uring; available only
+//             if the engine was built with liburing, otherwise PREAD is used
+class IOEngine {
+ public:
+  enum class Backend { SYNC, PREAD, IO_URING };
+
+  static std::unique_ptr<IOEngine> Create(Backend backend, size_t threads);
+  virtual ~IOEngine() = default;
+
+  Backend GetBackend() const { return backend_; }
+  const char *Name() const;
+
+  // Read all requests of the batch and return when every one of them has
+  // completed. Returns false if any request failed or hit end of file; the
+  // individual results are in the requests.
+  bool ReadBatch(ReadRequest *reqs, size_t n);
+
+ protected:
+  explicit IOEngine(Backend backend) : backend_(backend) {}
+  virtual void Submit(ReadRequest *reqs, size_t n);
+  static void ReadOne(ReadRequest &req);
+
+ private:
+  const Backend backend_;
+};
+
+class PreadIOEngine : public IOEngine {
+ public:
+  explicit PreadIOEngine(size_t threads) : IOEngine(Backend::PREAD), pool_("io", threads) {}
+
+ protected:
+  void Submit(ReadRequest *reqs, size_t n) override;
+
+ private:
+  utils::thread_pool pool_;
+};
+
+#ifdef HAVE_LIBURING
+class UringIOEngine : public IOEngine {
+ public:
+  UringIOEngine() : IOEngine(Backend::IO_URING) {}
+  static bool Supported();
+
+ protected:
+  void Submit(ReadRequest *reqs, size_t n) override;
+};
+#endif
+
+}  // namespace system
+}  // namespace Tianmu
+
+#endif  // TIANMU_SYSTEM_IO_ENGINE_H_
@@ -0,0 +1,74 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_SYSTEM_MEMORY_STREAM_H_
+#define TIANMU_SYSTEM_MEMORY_STREAM_H_
+#pragma once
+
+#include <cstring>
+
+#include "system/stream.h"
+
+namespace Tianmu {
+namespace system {
+
+// A read-only Stream over a memory buffer, e.g. a pack image which was read
+// from disk in a batch. The buffer is not owned.
+class MemoryStream : public Stream {
+ public:
+  MemoryStream(const void *buf, size_t size, std::string const &name)
+      : buf_(static_cast<const char *>(buf)), size_(size) {
+    name_ = name;
+  }
+  ~MemoryStream() = default;
+
+  bool IsOpen() const override { return buf_ != nullptr; }
+  int Close() override {
+    buf_ = nullptr;
+    return 0;
+  }
+  int OpenReadOnly([[maybe_unused]] std::string const &filename) override { return -1; }
+  int OpenReadWrite([[maybe_unused]] std::string const &filename) override { return -1; }
+  int OpenCreateEmpty([[maybe_unused]] std::string const &filename) override { return -1; }
+  void WriteExact([[maybe_unused]] const void *buf, [[maybe_unused]] size_t count) override {
+    ThrowError("write to a read-only memory stream");
+  }
+
+  size_t Read(void *buf, size_t count) override {
+    if (count > size_ - pos_)
+      count = size_ - pos_;
+    std::memcpy(buf, buf_ + pos_, count);
+    pos_ += count;
+    return count;
+  }
+
+  void ReadExact(void *buf, size_t count) override {
+    if (count > size_ - pos_)
+      ThrowError("Failed to read " + std::to_string(count) + " bytes, only " + std::to_string(size_ - pos_) +
+                 " left");
+    Read(buf, count);
+  }
+
+ private:
+  const char *buf_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // namespace system
+}  // namespace Tianmu
+
+#endif  // TIANMU_SYSTEM_MEMORY_STREAM_H_
@@ -59,6 +59,12 @@ class TianmuFile : public Stream {
   void ReadExact(void *buf, size_t count) override;
   void WriteExact(const void *buf, size_t count) override;
 
+  // positional I/O, the file offset is neither used nor changed
+  size_t ReadAt(void *buf, size_t count, off_t pos);
+  void ReadExactAt(void *buf, size_t count, off_t pos);
+  void WriteExactAt(const void *buf, size_t count, off_t pos);
+  int Handle() const { return fd_; }
+
   bool IsOpen() const override;
   int Close() override;
 };
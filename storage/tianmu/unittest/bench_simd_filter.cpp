@@ -0,0 +1,108 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+// Micro benchmark of the pack predicate kernels of util/simd_filter on every
+// level the CPU supports. Each kernel runs over a full pack of 65536 random
+// values; the masks of all levels are compared with the scalar ones.
+//
+//   benchsimdfilter [iterations]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/simd_filter.h"
+
+using namespace Tianmu::utils::simd;
+
+namespace {
+constexpr size_t kRows = 65536;
+
+struct Case {
+  std::string name;
+  std::function<void(uint32_t *)> run;
+};
+
+double NsPerRow(const Case &c, int iterations, uint32_t *mask) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) c.run(mask);
+  std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+  return ns.count() / (double(iterations) * kRows);
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+  std::mt19937_64 rng(42);
+  std::vector<uint8_t> v8(kRows);
+  std::vector<uint16_t> v16(kRows);
+  std::vector<uint32_t> v32(kRows);
+  std::vector<int64_t> v64(kRows), w64(kRows);
+  std::vector<double> d1(kRows), d2(kRows);
+  for (size_t i = 0; i < kRows; i++) {
+    uint64_t r = rng();
+    v8[i] = uint8_t(r);
+    v16[i] = uint16_t(r);
+    v32[i] = uint32_t(r);
+    v64[i] = int64_t(r % 1000000);
+    w64[i] = int64_t(rng() % 1000000);
+    d1[i] = double(r % 1000000) / 7;
+    d2[i] = double(rng() % 1000000) / 7;
+  }
+  std::vector<int64_t> in_vals = {3, 17, 42, 99, 128, 200, 250, 1000, 4096, 65535};
+
+  std::vector<Case> cases = {
+      {"between int8", [&](uint32_t *m) { BetweenMask(v8.data(), 1, kRows, 10, 100, m); }},
+      {"between int16", [&](uint32_t *m) { BetweenMask(v16.data(), 2, kRows, 1000, 30000, m); }},
+      {"between int32", [&](uint32_t *m) { BetweenMask(v32.data(), 4, kRows, 1 << 20, 1 << 30, m); }},
+      {"between int64", [&](uint32_t *m) { BetweenMask(v64.data(), 8, kRows, 1000, 500000, m); }},
+      {"between double", [&](uint32_t *m) { BetweenMaskDouble(d1.data(), kRows, 1000.5, 50000.25, m); }},
+      {"in(10) int16", [&](uint32_t *m) { InMask(v16.data(), 2, kRows, in_vals.data(), in_vals.size(), m); }},
+      {"in(10) int32", [&](uint32_t *m) { InMask(v32.data(), 4, kRows, in_vals.data(), in_vals.size(), m); }},
+      {"compare int64 <", [&](uint32_t *m) { CompareMask(v64.data(), w64.data(), kRows, 5, CmpOp::LT, m); }},
+      {"compare double <", [&](uint32_t *m) { CompareMaskDouble(d1.data(), d2.data(), kRows, CmpOp::LT, m); }},
+  };
+
+  std::vector<uint32_t> expected(MaskWords(kRows)), mask(MaskWords(kRows));
+  bool ok = true;
+  std::cout << "kernel";
+  for (int l = 0; l <= int(DetectedLevel()); l++) std::cout << "\t" << LevelName(Level(l)) << " ns/row";
+  std::cout << std::endl;
+  for (auto &c : cases) {
+    std::cout << c.name;
+    for (int l = 0; l <= int(DetectedLevel()); l++) {
+      SetLevel(Level(l));
+      c.run(l == 0 ? expected.data() : mask.data());
+      if (l > 0 && std::memcmp(expected.data(), mask.data(), expected.size() * sizeof(uint32_t)) != 0) {
+        std::cout << "\tMISMATCH";
+        ok = false;
+        continue;
+      }
+      std::cout << "\t" << NsPerRow(c, iterations, mask.data());
+    }
+    std::cout << std::endl;
+  }
+  SetLevel(DetectedLevel());
+  return ok ? 0 : 1;
+}
@@ -117,6 +117,17 @@ class Hash64 final {
 
   int capacity() { return capacity_; }
 
+  // all values of the set, in no particular order
+  std::vector<int64_t> Values() const {
+    std::vector<int64_t> values;
+    if (zero_inserted_)
+      values.push_back(0);
+    for (auto v : table_)
+      if (v != 0)
+        values.push_back(v);
+    return values;
+  }
+
  private:
   int capacity_;
   int64_t address_mask_;
@@ -0,0 +1,80 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_UTIL_PARKING_LOT_H_
+#define TIANMU_UTIL_PARKING_LOT_H_
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace Tianmu {
+namespace utils {
+
+// A fixed table of wait queues keyed by an address. Threads waiting for a
+// state change of some object park on the bucket the object address hashes
+// to, and the thread that changes the state wakes them up right away,
+// without the object having to carry its own mutex and condition variable.
+// The state itself must be published (e.g. by an atomic store) before
+// NotifyAll() is called for the same key.
+class ParkingLot final {
+ public:
+  ParkingLot() = default;
+  ~ParkingLot() = default;
+  ParkingLot(const ParkingLot &) = delete;
+  ParkingLot &operator=(const ParkingLot &) = delete;
+
+  // block until ready() returns true; returns false if no wait was needed
+  template <typename Pred>
+  bool Wait(const void *key, Pred ready) {
+    if (ready())
+      return false;
+    Bucket &b = bucket(key);
+    std::unique_lock<std::mutex> lock(b.mtx);
+    b.cv.wait(lock, ready);
+    return true;
+  }
+
+  void NotifyAll(const void *key) {
+    Bucket &b = bucket(key);
+    // acquiring the mutex orders the state change before any waiter that
+    // has checked ready() but is not yet blocked on the condition variable
+    { std::scoped_lock lock(b.mtx); }
+    b.cv.notify_all();
+  }
+
+ private:
+  static constexpr size_t kBucketBits = 8;
+
+  struct alignas(64) Bucket {
+    std::mutex mtx;
+    std::condition_variable cv;
+  };
+
+  Bucket &bucket(const void *key) {
+    uint64_t h = reinterpret_cast<uintptr_t>(key) * 0x9E3779B97F4A7C15ULL;
+    return buckets_[h >> (64 - kBucketBits)];
+  }
+
+  std::array<Bucket, 1 << kBucketBits> buckets_;
+};
+
+}  // namespace utils
+}  // namespace Tianmu
+
+#endif  // TIANMU_UTIL_PARKING_LOT_H_
@@ -0,0 +1,855 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+
+#include "util/simd_filter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define TIANMU_SIMD_X86 1
+#include <immintrin.h>
+#define TIANMU_TARGET_AVX2 __attribute__((target("avx2")))
+#define TIANMU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+
+namespace Tianmu {
+namespace utils {
+namespace simd {
+
+namespace {
+
+// The width specific entry points work on unsigned values and an unsigned
+// [lo, lo + range] window: (v - lo) <= range in modular arithmetic is the
+// same as lo <= v <= hi, for 8 byte signed values too, as long as lo <= hi.
+struct Kernels {
+  void (*between[4])(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask);
+  void (*in[4])(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask);
+  void (*widen[4])(const void *data, size_t n, int64_t *out);
+  void (*compare)(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask);
+  void (*between_double)(const double *v, size_t n, double lo, double hi, uint32_t *mask);
+  void (*compare_double)(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask);
+  const char *(*find)(const char *hay, size_t n, const char *needle, size_t m);
+};
+
+int WidthIndex(int width) {
+  switch (width) {
+    case 1:
+      return 0;
+    case 2:
+      return 1;
+    case 4:
+      return 2;
+    default:
+      return 3;
+  }
+}
+
+// scalar versions, also used for the tails of the vector ones; `begin` is a
+// multiple of 32
+
+template <typename U>
+void BetweenTail(const U *v, size_t begin, size_t n, U lo, U range, uint32_t *mask) {
+  for (size_t i = begin; i < n; i += 32) {
+    size_t rows = std::min<size_t>(32, n - i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < rows; j++) w |= uint32_t(U(v[i + j] - lo) <= range) << j;
+    mask[i >> 5] = w;
+  }
+}
+
+template <typename U>
+void InTail(const U *v, size_t begin, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  for (size_t i = begin; i < n; i += 32) {
+    size_t rows = std::min<size_t>(32, n - i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < rows; j++) {
+      U x = v[i + j];
+      bool hit = false;
+      for (size_t k = 0; k < nvals && !hit; k++) hit = (x == U(vals[k]));
+      w |= uint32_t(hit) << j;
+    }
+    mask[i >> 5] = w;
+  }
+}
+
+template <typename U>
+void WidenTail(const U *v, size_t begin, size_t n, int64_t *out) {
+  for (size_t i = begin; i < n; i++) out[i] = int64_t(v[i]);
+}
+
+template <CmpOp op, typename T>
+inline bool Cmp(T x, T y) {
+  switch (op) {
+    case CmpOp::EQ:
+      return x == y;
+    case CmpOp::NE:
+      return x != y;
+    case CmpOp::LT:
+      return x < y;
+    case CmpOp::LE:
+      return x <= y;
+    case CmpOp::GT:
+      return x > y;
+    default:
+      return x >= y;
+  }
+}
+
+template <CmpOp op>
+void CompareTail(const int64_t *a, const int64_t *b, size_t begin, size_t n, int64_t offset, uint32_t *mask) {
+  for (size_t i = begin; i < n; i += 32) {
+    size_t rows = std::min<size_t>(32, n - i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < rows; j++) {
+      int64_t x = int64_t(uint64_t(a[i + j]) + uint64_t(offset));
+      w |= uint32_t(Cmp<op>(x, b[i + j])) << j;
+    }
+    mask[i >> 5] = w;
+  }
+}
+
+void BetweenDoubleTail(const double *v, size_t begin, size_t n, double lo, double hi, uint32_t *mask) {
+  for (size_t i = begin; i < n; i += 32) {
+    size_t rows = std::min<size_t>(32, n - i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < rows; j++) w |= uint32_t(lo <= v[i + j] && v[i + j] <= hi) << j;
+    mask[i >> 5] = w;
+  }
+}
+
+template <CmpOp op>
+void CompareDoubleTail(const double *a, const double *b, size_t begin, size_t n, uint32_t *mask) {
+  for (size_t i = begin; i < n; i += 32) {
+    size_t rows = std::min<size_t>(32, n - i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < rows; j++) w |= uint32_t(Cmp<op>(a[i + j], b[i + j])) << j;
+    mask[i >> 5] = w;
+  }
+}
+
+// dispatches a CmpOp to a kernel templated on it
+#define TIANMU_CMP_DISPATCH(kernel, op, ...)  \
+  switch (op) {                               \
+    case CmpOp::EQ:                           \
+      return kernel<CmpOp::EQ>(__VA_ARGS__);  \
+    case CmpOp::NE:                           \
+      return kernel<CmpOp::NE>(__VA_ARGS__);  \
+    case CmpOp::LT:                           \
+      return kernel<CmpOp::LT>(__VA_ARGS__);  \
+    case CmpOp::LE:                           \
+      return kernel<CmpOp::LE>(__VA_ARGS__);  \
+    case CmpOp::GT:                           \
+      return kernel<CmpOp::GT>(__VA_ARGS__);  \
+    case CmpOp::GE:                           \
+      return kernel<CmpOp::GE>(__VA_ARGS__);  \
+  }
+
+template <typename U>
+void BetweenScalar(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  BetweenTail(static_cast<const U *>(data), 0, n, U(lo), U(range), mask);
+}
+
+template <typename U>
+void InScalar(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  InTail(static_cast<const U *>(data), 0, n, vals, nvals, mask);
+}
+
+template <typename U>
+void WidenScalar(const void *data, size_t n, int64_t *out) {
+  WidenTail(static_cast<const U *>(data), 0, n, out);
+}
+
+void CompareScalar(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask) {
+  switch (op) {
+    case CmpOp::EQ:
+      return CompareTail<CmpOp::EQ>(a, b, 0, n, offset, mask);
+    case CmpOp::NE:
+      return CompareTail<CmpOp::NE>(a, b, 0, n, offset, mask);
+    case CmpOp::LT:
+      return CompareTail<CmpOp::LT>(a, b, 0, n, offset, mask);
+    case CmpOp::LE:
+      return CompareTail<CmpOp::LE>(a, b, 0, n, offset, mask);
+    case CmpOp::GT:
+      return CompareTail<CmpOp::GT>(a, b, 0, n, offset, mask);
+    case CmpOp::GE:
+      return CompareTail<CmpOp::GE>(a, b, 0, n, offset, mask);
+  }
+}
+
+void BetweenDoubleScalar(const double *v, size_t n, double lo, double hi, uint32_t *mask) {
+  BetweenDoubleTail(v, 0, n, lo, hi, mask);
+}
+
+void CompareDoubleScalar(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask) {
+  TIANMU_CMP_DISPATCH(CompareDoubleTail, op, a, b, 0, n, mask)
+}
+
+const char *FindScalar(const char *hay, size_t n, const char *needle, size_t m) {
+  return static_cast<const char *>(memmem(hay, n, needle, m));
+}
+
+const Kernels kScalarKernels = {
+    {BetweenScalar<uint8_t>, BetweenScalar<uint16_t>, BetweenScalar<uint32_t>, BetweenScalar<uint64_t>},
+    {InScalar<uint8_t>, InScalar<uint16_t>, InScalar<uint32_t>, InScalar<uint64_t>},
+    {WidenScalar<uint8_t>, WidenScalar<uint16_t>, WidenScalar<uint32_t>, WidenScalar<uint64_t>},
+    CompareScalar,
+    BetweenDoubleScalar,
+    CompareDoubleScalar,
+    FindScalar,
+};
+
+#ifdef TIANMU_SIMD_X86
+
+// AVX2: each step turns 32 rows into one mask word
+
+TIANMU_TARGET_AVX2 inline __m256i Load256(const void *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+// 32-bit lane masks of 4 vectors -> one word
+TIANMU_TARGET_AVX2 inline uint32_t Bits32x4(__m256i m0, __m256i m1, __m256i m2, __m256i m3) {
+  return uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(m0))) |
+         uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(m1))) << 8 |
+         uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(m2))) << 16 |
+         uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(m3))) << 24;
+}
+
+// 16-bit lane masks of 2 vectors -> one word; packs works per 128-bit lane,
+// the permute restores row order
+TIANMU_TARGET_AVX2 inline uint32_t Bits16x2(__m256i m0, __m256i m1) {
+  return uint32_t(_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(m0, m1), 0xD8)));
+}
+
+// x <= range, unsigned
+TIANMU_TARGET_AVX2 inline __m256i Le8(__m256i x, __m256i range) {
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(x, range), x);
+}
+TIANMU_TARGET_AVX2 inline __m256i Le16(__m256i x, __m256i range) {
+  return _mm256_cmpeq_epi16(_mm256_min_epu16(x, range), x);
+}
+TIANMU_TARGET_AVX2 inline __m256i Le32(__m256i x, __m256i range) {
+  return _mm256_cmpeq_epi32(_mm256_min_epu32(x, range), x);
+}
+// there is no unsigned 64-bit compare: flip the sign bits, compare signed
+TIANMU_TARGET_AVX2 inline __m256i Le64(__m256i x, __m256i biased_range) {
+  const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+  return _mm256_xor_si256(_mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), biased_range), _mm256_set1_epi64x(-1));
+}
+
+TIANMU_TARGET_AVX2 void BetweenAvx2_8(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint8_t *>(data);
+  const __m256i vlo = _mm256_set1_epi8(char(lo)), vr = _mm256_set1_epi8(char(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32)
+    mask[i >> 5] = uint32_t(_mm256_movemask_epi8(Le8(_mm256_sub_epi8(Load256(v + i), vlo), vr)));
+  BetweenTail<uint8_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX2 void BetweenAvx2_16(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint16_t *>(data);
+  const __m256i vlo = _mm256_set1_epi16(short(lo)), vr = _mm256_set1_epi16(short(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32)
+    mask[i >> 5] = Bits16x2(Le16(_mm256_sub_epi16(Load256(v + i), vlo), vr),
+                            Le16(_mm256_sub_epi16(Load256(v + i + 16), vlo), vr));
+  BetweenTail<uint16_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX2 void BetweenAvx2_32(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint32_t *>(data);
+  const __m256i vlo = _mm256_set1_epi32(int(lo)), vr = _mm256_set1_epi32(int(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32)
+    mask[i >> 5] = Bits32x4(
+        Le32(_mm256_sub_epi32(Load256(v + i), vlo), vr), Le32(_mm256_sub_epi32(Load256(v + i + 8), vlo), vr),
+        Le32(_mm256_sub_epi32(Load256(v + i + 16), vlo), vr), Le32(_mm256_sub_epi32(Load256(v + i + 24), vlo), vr));
+  BetweenTail<uint32_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX2 void BetweenAvx2_64(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint64_t *>(data);
+  const __m256i vlo = _mm256_set1_epi64x(int64_t(lo));
+  const __m256i vr = _mm256_set1_epi64x(int64_t(range ^ (uint64_t(1) << 63)));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 8; k++) {
+      __m256i m = Le64(_mm256_sub_epi64(Load256(v + i + 4 * k), vlo), vr);
+      w |= uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(m))) << (4 * k);
+    }
+    mask[i >> 5] = w;
+  }
+  BetweenTail<uint64_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX2 void InAvx2_8(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint8_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    __m256i x = Load256(v + i), acc = _mm256_setzero_si256();
+    for (size_t k = 0; k < nvals; k++)
+      acc = _mm256_or_si256(acc, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(char(vals[k]))));
+    mask[i >> 5] = uint32_t(_mm256_movemask_epi8(acc));
+  }
+  InTail<uint8_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX2 void InAvx2_16(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint16_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    __m256i x0 = Load256(v + i), x1 = Load256(v + i + 16);
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    for (size_t k = 0; k < nvals; k++) {
+      __m256i c = _mm256_set1_epi16(short(vals[k]));
+      acc0 = _mm256_or_si256(acc0, _mm256_cmpeq_epi16(x0, c));
+      acc1 = _mm256_or_si256(acc1, _mm256_cmpeq_epi16(x1, c));
+    }
+    mask[i >> 5] = Bits16x2(acc0, acc1);
+  }
+  InTail<uint16_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX2 void InAvx2_32(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint32_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    __m256i x[4], acc[4];
+    for (int j = 0; j < 4; j++) {
+      x[j] = Load256(v + i + 8 * j);
+      acc[j] = _mm256_setzero_si256();
+    }
+    for (size_t k = 0; k < nvals; k++) {
+      __m256i c = _mm256_set1_epi32(int(vals[k]));
+      for (int j = 0; j < 4; j++) acc[j] = _mm256_or_si256(acc[j], _mm256_cmpeq_epi32(x[j], c));
+    }
+    mask[i >> 5] = Bits32x4(acc[0], acc[1], acc[2], acc[3]);
+  }
+  InTail<uint32_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX2 void InAvx2_64(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint64_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int j = 0; j < 8; j++) {
+      __m256i x = Load256(v + i + 4 * j), acc = _mm256_setzero_si256();
+      for (size_t k = 0; k < nvals; k++)
+        acc = _mm256_or_si256(acc, _mm256_cmpeq_epi64(x, _mm256_set1_epi64x(int64_t(vals[k]))));
+      w |= uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(acc))) << (4 * j);
+    }
+    mask[i >> 5] = w;
+  }
+  InTail<uint64_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX2 void WidenAvx2_8(const void *data, size_t n, int64_t *out) {
+  auto v = static_cast<const uint8_t *>(data);
+  size_t full = n / 4 * 4;
+  for (size_t i = 0; i < full; i += 4) {
+    int32_t four;
+    std::memcpy(&four, v + i, sizeof(four));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(four)));
+  }
+  WidenTail(v, full, n, out);
+}
+
+TIANMU_TARGET_AVX2 void WidenAvx2_16(const void *data, size_t n, int64_t *out) {
+  auto v = static_cast<const uint16_t *>(data);
+  size_t full = n / 4 * 4;
+  for (size_t i = 0; i < full; i += 4)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + i))));
+  WidenTail(v, full, n, out);
+}
+
+TIANMU_TARGET_AVX2 void WidenAvx2_32(const void *data, size_t n, int64_t *out) {
+  auto v = static_cast<const uint32_t *>(data);
+  size_t full = n / 4 * 4;
+  for (size_t i = 0; i < full; i += 4)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(v + i))));
+  WidenTail(v, full, n, out);
+}
+
+// x op y for 4 lanes, as a 4 bit mask
+template <CmpOp op>
+TIANMU_TARGET_AVX2 inline uint32_t Cmp4(__m256i x, __m256i y) {
+  switch (op) {
+    case CmpOp::EQ:
+      return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y)));
+    case CmpOp::NE:
+      return ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y))) & 0xF;
+    case CmpOp::LT:
+      return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(y, x)));
+    case CmpOp::LE:
+      return ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, y))) & 0xF;
+    case CmpOp::GT:
+      return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, y)));
+    default:
+      return ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(y, x))) & 0xF;
+  }
+}
+
+template <CmpOp op>
+TIANMU_TARGET_AVX2 void CompareAvx2Op(const int64_t *a, const int64_t *b, size_t n, int64_t offset, uint32_t *mask) {
+  const __m256i off = _mm256_set1_epi64x(offset);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 8; k++)
+      w |= Cmp4<op>(_mm256_add_epi64(Load256(a + i + 4 * k), off), Load256(b + i + 4 * k)) << (4 * k);
+    mask[i >> 5] = w;
+  }
+  CompareTail<op>(a, b, full, n, offset, mask);
+}
+
+void CompareAvx2(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask) {
+  switch (op) {
+    case CmpOp::EQ:
+      return CompareAvx2Op<CmpOp::EQ>(a, b, n, offset, mask);
+    case CmpOp::NE:
+      return CompareAvx2Op<CmpOp::NE>(a, b, n, offset, mask);
+    case CmpOp::LT:
+      return CompareAvx2Op<CmpOp::LT>(a, b, n, offset, mask);
+    case CmpOp::LE:
+      return CompareAvx2Op<CmpOp::LE>(a, b, n, offset, mask);
+    case CmpOp::GT:
+      return CompareAvx2Op<CmpOp::GT>(a, b, n, offset, mask);
+    case CmpOp::GE:
+      return CompareAvx2Op<CmpOp::GE>(a, b, n, offset, mask);
+  }
+}
+
+// _mm256_cmp_pd predicate of a CmpOp; ordered except NE, like the C++ operators
+template <CmpOp op>
+constexpr int PdPredicate() {
+  switch (op) {
+    case CmpOp::EQ:
+      return _CMP_EQ_OQ;
+    case CmpOp::NE:
+      return _CMP_NEQ_UQ;
+    case CmpOp::LT:
+      return _CMP_LT_OQ;
+    case CmpOp::LE:
+      return _CMP_LE_OQ;
+    case CmpOp::GT:
+      return _CMP_GT_OQ;
+    default:
+      return _CMP_GE_OQ;
+  }
+}
+
+TIANMU_TARGET_AVX2 void BetweenDoubleAvx2(const double *v, size_t n, double lo, double hi, uint32_t *mask) {
+  const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 8; k++) {
+      __m256d x = _mm256_loadu_pd(v + i + 4 * k);
+      __m256d m = _mm256_and_pd(_mm256_cmp_pd(x, vlo, _CMP_GE_OQ), _mm256_cmp_pd(x, vhi, _CMP_LE_OQ));
+      w |= uint32_t(_mm256_movemask_pd(m)) << (4 * k);
+    }
+    mask[i >> 5] = w;
+  }
+  BetweenDoubleTail(v, full, n, lo, hi, mask);
+}
+
+template <CmpOp op>
+TIANMU_TARGET_AVX2 void CompareDoubleAvx2Op(const double *a, const double *b, size_t n, uint32_t *mask) {
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 8; k++) {
+      __m256d m = _mm256_cmp_pd(_mm256_loadu_pd(a + i + 4 * k), _mm256_loadu_pd(b + i + 4 * k), PdPredicate<op>());
+      w |= uint32_t(_mm256_movemask_pd(m)) << (4 * k);
+    }
+    mask[i >> 5] = w;
+  }
+  CompareDoubleTail<op>(a, b, full, n, mask);
+}
+
+void CompareDoubleAvx2(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask) {
+  TIANMU_CMP_DISPATCH(CompareDoubleAvx2Op, op, a, b, n, mask)
+}
+
+// Substring search: 32 candidate positions are tested at once by comparing
+// the first and the last needle byte, only positions matching both are
+// verified with memcmp. Strong for the short needles of LIKE '%...%'.
+TIANMU_TARGET_AVX2 const char *FindAvx2(const char *hay, size_t n, const char *needle, size_t m) {
+  if (m < 2 || m > n)
+    return FindScalar(hay, n, needle, m);
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  size_t i = 0;
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    __m256i eq_first = _mm256_cmpeq_epi8(first, Load256(hay + i));
+    __m256i eq_last = _mm256_cmpeq_epi8(last, Load256(hay + i + m - 1));
+    uint32_t bits = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(eq_first, eq_last)));
+    while (bits != 0) {
+      int pos = __builtin_ctz(bits);
+      if (std::memcmp(hay + i + pos + 1, needle + 1, m - 2) == 0)
+        return hay + i + pos;
+      bits &= bits - 1;
+    }
+  }
+  return FindScalar(hay + i, n - i, needle, m);
+}
+
+const Kernels kAvx2Kernels = {
+    {BetweenAvx2_8, BetweenAvx2_16, BetweenAvx2_32, BetweenAvx2_64},
+    {InAvx2_8, InAvx2_16, InAvx2_32, InAvx2_64},
+    {WidenAvx2_8, WidenAvx2_16, WidenAvx2_32, WidenScalar<uint64_t>},
+    CompareAvx2,
+    BetweenDoubleAvx2,
+    CompareDoubleAvx2,
+    FindAvx2,
+};
+
+// AVX-512: compares produce bit masks directly; 8-bit data is done 64 rows
+// (two words) at a time, the rest 32 rows at a time
+
+TIANMU_TARGET_AVX512 inline __m512i Load512(const void *p) { return _mm512_loadu_si512(p); }
+
+TIANMU_TARGET_AVX512 void BetweenAvx512_8(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint8_t *>(data);
+  const __m512i vlo = _mm512_set1_epi8(char(lo)), vr = _mm512_set1_epi8(char(range));
+  size_t full = n / 64 * 64;
+  for (size_t i = 0; i < full; i += 64) {
+    uint64_t k = _mm512_cmple_epu8_mask(_mm512_sub_epi8(Load512(v + i), vlo), vr);
+    mask[i >> 5] = uint32_t(k);
+    mask[(i >> 5) + 1] = uint32_t(k >> 32);
+  }
+  BetweenTail<uint8_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX512 void BetweenAvx512_16(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint16_t *>(data);
+  const __m512i vlo = _mm512_set1_epi16(short(lo)), vr = _mm512_set1_epi16(short(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32)
+    mask[i >> 5] = _mm512_cmple_epu16_mask(_mm512_sub_epi16(Load512(v + i), vlo), vr);
+  BetweenTail<uint16_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX512 void BetweenAvx512_32(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint32_t *>(data);
+  const __m512i vlo = _mm512_set1_epi32(int(lo)), vr = _mm512_set1_epi32(int(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32)
+    mask[i >> 5] = uint32_t(_mm512_cmple_epu32_mask(_mm512_sub_epi32(Load512(v + i), vlo), vr)) |
+                   uint32_t(_mm512_cmple_epu32_mask(_mm512_sub_epi32(Load512(v + i + 16), vlo), vr)) << 16;
+  BetweenTail<uint32_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX512 void BetweenAvx512_64(const void *data, size_t n, uint64_t lo, uint64_t range, uint32_t *mask) {
+  auto v = static_cast<const uint64_t *>(data);
+  const __m512i vlo = _mm512_set1_epi64(int64_t(lo)), vr = _mm512_set1_epi64(int64_t(range));
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 4; k++)
+      w |= uint32_t(_mm512_cmple_epu64_mask(_mm512_sub_epi64(Load512(v + i + 8 * k), vlo), vr)) << (8 * k);
+    mask[i >> 5] = w;
+  }
+  BetweenTail<uint64_t>(v, full, n, lo, range, mask);
+}
+
+TIANMU_TARGET_AVX512 void InAvx512_8(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint8_t *>(data);
+  size_t full = n / 64 * 64;
+  for (size_t i = 0; i < full; i += 64) {
+    __m512i x = Load512(v + i);
+    uint64_t k = 0;
+    for (size_t j = 0; j < nvals; j++) k |= _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(char(vals[j])));
+    mask[i >> 5] = uint32_t(k);
+    mask[(i >> 5) + 1] = uint32_t(k >> 32);
+  }
+  InTail<uint8_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX512 void InAvx512_16(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint16_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    __m512i x = Load512(v + i);
+    uint32_t w = 0;
+    for (size_t j = 0; j < nvals; j++) w |= _mm512_cmpeq_epi16_mask(x, _mm512_set1_epi16(short(vals[j])));
+    mask[i >> 5] = w;
+  }
+  InTail<uint16_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX512 void InAvx512_32(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint32_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    __m512i x0 = Load512(v + i), x1 = Load512(v + i + 16);
+    uint32_t w0 = 0, w1 = 0;
+    for (size_t j = 0; j < nvals; j++) {
+      __m512i c = _mm512_set1_epi32(int(vals[j]));
+      w0 |= _mm512_cmpeq_epi32_mask(x0, c);
+      w1 |= _mm512_cmpeq_epi32_mask(x1, c);
+    }
+    mask[i >> 5] = w0 | w1 << 16;
+  }
+  InTail<uint32_t>(v, full, n, vals, nvals, mask);
+}
+
+TIANMU_TARGET_AVX512 void InAvx512_64(const void *data, size_t n, const uint64_t *vals, size_t nvals, uint32_t *mask) {
+  auto v = static_cast<const uint64_t *>(data);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 4; k++) {
+      __m512i x = Load512(v + i + 8 * k);
+      uint32_t b = 0;
+      for (size_t j = 0; j < nvals; j++) b |= _mm512_cmpeq_epi64_mask(x, _mm512_set1_epi64(int64_t(vals[j])));
+      w |= b << (8 * k);
+    }
+    mask[i >> 5] = w;
+  }
+  InTail<uint64_t>(v, full, n, vals, nvals, mask);
+}
+
+template <CmpOp op>
+TIANMU_TARGET_AVX512 inline uint32_t Cmp8(__m512i x, __m512i y) {
+  switch (op) {
+    case CmpOp::EQ:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_EQ);
+    case CmpOp::NE:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_NE);
+    case CmpOp::LT:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_LT);
+    case CmpOp::LE:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_LE);
+    case CmpOp::GT:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_NLE);
+    default:
+      return _mm512_cmp_epi64_mask(x, y, _MM_CMPINT_NLT);
+  }
+}
+
+template <CmpOp op>
+TIANMU_TARGET_AVX512 void CompareAvx512Op(const int64_t *a, const int64_t *b, size_t n, int64_t offset,
+                                          uint32_t *mask) {
+  const __m512i off = _mm512_set1_epi64(offset);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 4; k++)
+      w |= Cmp8<op>(_mm512_add_epi64(Load512(a + i + 8 * k), off), Load512(b + i + 8 * k)) << (8 * k);
+    mask[i >> 5] = w;
+  }
+  CompareTail<op>(a, b, full, n, offset, mask);
+}
+
+void CompareAvx512(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask) {
+  switch (op) {
+    case CmpOp::EQ:
+      return CompareAvx512Op<CmpOp::EQ>(a, b, n, offset, mask);
+    case CmpOp::NE:
+      return CompareAvx512Op<CmpOp::NE>(a, b, n, offset, mask);
+    case CmpOp::LT:
+      return CompareAvx512Op<CmpOp::LT>(a, b, n, offset, mask);
+    case CmpOp::LE:
+      return CompareAvx512Op<CmpOp::LE>(a, b, n, offset, mask);
+    case CmpOp::GT:
+      return CompareAvx512Op<CmpOp::GT>(a, b, n, offset, mask);
+    case CmpOp::GE:
+      return CompareAvx512Op<CmpOp::GE>(a, b, n, offset, mask);
+  }
+}
+
+TIANMU_TARGET_AVX512 void BetweenDoubleAvx512(const double *v, size_t n, double lo, double hi, uint32_t *mask) {
+  const __m512d vlo = _mm512_set1_pd(lo), vhi = _mm512_set1_pd(hi);
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 4; k++) {
+      __m512d x = _mm512_loadu_pd(v + i + 8 * k);
+      w |= uint32_t(_mm512_cmp_pd_mask(x, vlo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(x, vhi, _CMP_LE_OQ)) << (8 * k);
+    }
+    mask[i >> 5] = w;
+  }
+  BetweenDoubleTail(v, full, n, lo, hi, mask);
+}
+
+template <CmpOp op>
+TIANMU_TARGET_AVX512 void CompareDoubleAvx512Op(const double *a, const double *b, size_t n, uint32_t *mask) {
+  size_t full = n / 32 * 32;
+  for (size_t i = 0; i < full; i += 32) {
+    uint32_t w = 0;
+    for (int k = 0; k < 4; k++)
+      w |= uint32_t(_mm512_cmp_pd_mask(_mm512_loadu_pd(a + i + 8 * k), _mm512_loadu_pd(b + i + 8 * k),
+                                       PdPredicate<op>()))
+           << (8 * k);
+    mask[i >> 5] = w;
+  }
+  CompareDoubleTail<op>(a, b, full, n, mask);
+}
+
+void CompareDoubleAvx512(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask) {
+  TIANMU_CMP_DISPATCH(CompareDoubleAvx512Op, op, a, b, n, mask)
+}
+
+const Kernels kAvx512Kernels = {
+    {BetweenAvx512_8, BetweenAvx512_16, BetweenAvx512_32, BetweenAvx512_64},
+    {InAvx512_8, InAvx512_16, InAvx512_32, InAvx512_64},
+    {WidenAvx2_8, WidenAvx2_16, WidenAvx2_32, WidenScalar<uint64_t>},  // no gain from 512-bit widening
+    CompareAvx512,
+    BetweenDoubleAvx512,
+    CompareDoubleAvx512,
+    FindAvx2,  // candidate filtering is memory bound already at 256 bits
+};
+
+#endif  // TIANMU_SIMD_X86
+
+Level Probe() {
+#ifdef TIANMU_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    return Level::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return Level::AVX2;
+#endif
+  return Level::SCALAR;
+}
+
+const Kernels *KernelsFor(Level level) {
+#ifdef TIANMU_SIMD_X86
+  switch (level) {
+    case Level::AVX512:
+      return &kAvx512Kernels;
+    case Level::AVX2:
+      return &kAvx2Kernels;
+    default:
+      break;
+  }
+#endif
+  return &kScalarKernels;
+}
+
+std::atomic<Level> active_level{DetectedLevel()};
+std::atomic<const Kernels *> active_kernels{KernelsFor(active_level.load())};
+
+inline const Kernels &Active() { return *active_kernels.load(std::memory_order_relaxed); }
+
+}  // namespace
+
+Level DetectedLevel() {
+  static const Level detected = Probe();
+  return detected;
+}
+
+Level ActiveLevel() { return active_level.load(); }
+
+Level SetLevel(Level level) {
+  level = std::min(level, DetectedLevel());
+  active_kernels.store(KernelsFor(level));
+  active_level.store(level);
+  return level;
+}
+
+const char *LevelName(Level level) {
+  switch (level) {
+    case Level::AVX512:
+      return "avx512";
+    case Level::AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+void BetweenMask(const void *data, int width, size_t n, int64_t lo, int64_t hi, uint32_t *mask) {
+  if (width < 8) {
+    // narrow values are unsigned, clip the window to what they can hold
+    int64_t max_value = (int64_t(1) << (8 * width)) - 1;
+    lo = std::max<int64_t>(lo, 0);
+    hi = std::min(hi, max_value);
+  }
+  if (lo > hi) {
+    std::memset(mask, 0, MaskWords(n) * sizeof(uint32_t));
+    return;
+  }
+  Active().between[WidthIndex(width)](data, n, uint64_t(lo), uint64_t(hi) - uint64_t(lo), mask);
+}
+
+void InMask(const void *data, int width, size_t n, const int64_t *vals, size_t nvals, uint32_t *mask) {
+  std::vector<uint64_t> usable;
+  usable.reserve(nvals);
+  for (size_t i = 0; i < nvals; i++) {
+    if (width < 8 && (vals[i] < 0 || vals[i] > (int64_t(1) << (8 * width)) - 1))
+      continue;  // cannot be stored in this pack
+    usable.push_back(uint64_t(vals[i]));
+  }
+  if (usable.empty()) {
+    std::memset(mask, 0, MaskWords(n) * sizeof(uint32_t));
+    return;
+  }
+  Active().in[WidthIndex(width)](data, n, usable.data(), usable.size(), mask);
+}
+
+void CompareMask(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask) {
+  Active().compare(a, b, n, offset, op, mask);
+}
+
+void BetweenMaskDouble(const double *v, size_t n, double lo, double hi, uint32_t *mask) {
+  Active().between_double(v, n, lo, hi, mask);
+}
+
+void CompareMaskDouble(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask) {
+  Active().compare_double(a, b, n, op, mask);
+}
+
+void Widen(const void *data, int width, size_t n, int64_t *out) { Active().widen[WidthIndex(width)](data, n, out); }
+
+void MaskNot(uint32_t *mask, size_t n) {
+  size_t words = MaskWords(n);
+  for (size_t i = 0; i < words; i++) mask[i] = ~mask[i];
+  if (n % 32)
+    mask[words - 1] &= (uint32_t(1) << (n % 32)) - 1;
+}
+
+void MaskAndNot(uint32_t *mask, const uint32_t *other, size_t n) {
+  size_t words = MaskWords(n);
+  for (size_t i = 0; i < words; i++) mask[i] &= ~other[i];
+  if (n % 32)
+    mask[words - 1] &= (uint32_t(1) << (n % 32)) - 1;
+}
+
+size_t MaskCount(const uint32_t *mask, size_t n) {
+  size_t words = n / 32, count = 0;
+  for (size_t i = 0; i < words; i++) count += __builtin_popcount(mask[i]);
+  if (n % 32)
+    count += __builtin_popcount(mask[words] & ((uint32_t(1) << (n % 32)) - 1));
+  return count;
+}
+
+const char *FindSubstring(const char *hay, size_t n, const char *needle, size_t m) {
+  return Active().find(hay, n, needle, m);
+}
+
+}  // namespace simd
+}  // namespace utils
+}  // namespace Tianmu
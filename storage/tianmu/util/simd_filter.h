@@ -0,0 +1,80 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_UTIL_SIMD_FILTER_H_
+#define TIANMU_UTIL_SIMD_FILTER_H_
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Tianmu {
+namespace utils {
+namespace simd {
+
+// Predicate kernels over a pack of fixed width values. Every kernel writes a
+// row bitmap in the layout used by Filter::Block and the pack null bitmap:
+// row i is bit (i & 31) of word i >> 5. Bits of the last word at or past n
+// are cleared. The kernels do not depend on anything else in the engine so
+// they can be linked into a micro benchmark on their own.
+//
+// `width` is the byte size of one value (1, 2, 4 or 8). Values of 1-4 bytes
+// are compared as unsigned, 8 byte values as signed, which matches how
+// PackInt returns its 2-level encoded data from GetValInt().
+
+enum class Level { SCALAR = 0, AVX2 = 1, AVX512 = 2 };
+
+enum class CmpOp { EQ, NE, LT, LE, GT, GE };
+
+// best level supported by this CPU, probed once
+Level DetectedLevel();
+// level the kernels currently run on
+Level ActiveLevel();
+// for benchmarks and tests: run on `level` or the detected one, whichever is
+// lower; returns the level now in use
+Level SetLevel(Level level);
+const char *LevelName(Level level);
+
+inline size_t MaskWords(size_t n) { return (n + 31) / 32; }
+
+// mask[i] = lo <= v[i] <= hi
+void BetweenMask(const void *data, int width, size_t n, int64_t lo, int64_t hi, uint32_t *mask);
+// mask[i] = v[i] is one of vals[0 .. nvals)
+void InMask(const void *data, int width, size_t n, const int64_t *vals, size_t nvals, uint32_t *mask);
+// mask[i] = (a[i] + offset) op b[i], 64-bit signed with wrap-around addition
+void CompareMask(const int64_t *a, const int64_t *b, size_t n, int64_t offset, CmpOp op, uint32_t *mask);
+// the same for doubles; comparisons with NaN are false except NE, as in C++
+void BetweenMaskDouble(const double *v, size_t n, double lo, double hi, uint32_t *mask);
+void CompareMaskDouble(const double *a, const double *b, size_t n, CmpOp op, uint32_t *mask);
+// out[i] = v[i] widened to 64 bits
+void Widen(const void *data, int width, size_t n, int64_t *out);
+
+// mask = ~mask over n rows
+void MaskNot(uint32_t *mask, size_t n);
+// mask &= ~other over n rows, used to drop null rows
+void MaskAndNot(uint32_t *mask, const uint32_t *other, size_t n);
+// number of ones among the first n rows
+size_t MaskCount(const uint32_t *mask, size_t n);
+
+// first occurrence of needle[0 .. m) in hay[0 .. n), nullptr if none; an
+// empty needle is found at hay
+const char *FindSubstring(const char *hay, size_t n, const char *needle, size_t m);
+
+}  // namespace simd
+}  // namespace utils
+}  // namespace Tianmu
+
+#endif  // TIANMU_UTIL_SIMD_FILTER_H_
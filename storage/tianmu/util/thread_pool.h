@@ -121,6 +121,12 @@ class result_set final {
   void get_all() {
     for (auto &&result : results) result.get();
   }
+  // waits without collecting, so nothing still runs on the caller's data after a failure
+  void wait_all() {
+    for (auto &&result : results)
+      if (result.valid())
+        result.wait();
+  }
   void get_all_with_except() {
     bool no_except = true;
     for (auto &&result : results) try {
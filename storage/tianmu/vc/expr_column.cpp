@@ -16,9 +16,13 @@
 */
 
 #include "expr_column.h"
+
+#include <algorithm>
+
 #include "core/compiled_query.h"
 #include "core/mysql_expression.h"
 #include "core/tianmu_attr.h"
+#include "system/configuration.h"
 
 namespace Tianmu {
 namespace vcolumn {
@@ -73,6 +77,7 @@ ExpressionColumn::ExpressionColumn(core::MysqlExpression *expr, core::TempTable
     expr->SetBufsOrParams(&var_buf_);
     //		expr->SetBufsOrParams(&param_buf);
     dim_ = (only_dim_number >= 0 ? only_dim_number : -1);
+    BuildNative();
 
     // if (status == VC_EXPR && var_map_.size() == 0 )
     //	status = VC_CONST;
@@ -87,8 +92,36 @@ ExpressionColumn::ExpressionColumn(const ExpressionColumn &ec)
       vars_(ec.vars_),
       var_types_(ec.var_types_),
       var_buf_(ec.var_buf_),
+      native_expr_(ec.native_expr_),
+      native_cols_(ec.native_cols_),
       deterministic_(ec.deterministic_) {
   var_map_ = ec.var_map_;
+  if (native_expr_)
+    native_val_ = std::make_shared<core::ValueOrNull>();
+}
+
+void ExpressionColumn::BuildNative() {
+  if (!tianmu_sysvar_native_expression || !deterministic_ || !params_.empty() || dim_ < 0 || var_map_.empty())
+    return;
+  // all the variables come from one Tianmu table, as dim_ >= 0
+  std::map<core::VarID, core::ColumnType> columns;
+  for (auto &it : var_map_) {
+    auto table = it.GetTabPtr();
+    if (!table || table->TableType() != core::TType::TABLE)
+      return;
+    columns.emplace(it.var_id, table->GetColumnType(it.col_ndx));
+  }
+  std::shared_ptr<const core::NativeExpression> native = core::NativeExpression::Build(*expr_, columns, ct);
+  if (!native)
+    return;
+  for (auto &var : native->GetInputs()) {
+    auto it = std::find_if(var_map_.begin(), var_map_.end(), [&var](const VarMap &v) { return v.var_id == var; });
+    if (it == var_map_.end())
+      return;
+    native_cols_.push_back(it->col_ndx);
+  }
+  native_expr_ = native;
+  native_val_ = std::make_shared<core::ValueOrNull>();
 }
 
 void ExpressionColumn::SetParamTypes(core::MysqlExpression::TypOfVars *types) { expr_->EvalType(types); }
@@ -114,23 +147,65 @@ bool ExpressionColumn::FeedArguments(const core::MIIterator &mit) {
   return (diff || !deterministic_);
 }
 
-int64_t ExpressionColumn::GetValueInt64Impl(const core::MIIterator &mit) {
+bool ExpressionColumn::EvaluateNative(const core::MIIterator &mit) {
+  if (!native_expr_ || mit.Type() == core::MIIterator::MIIteratorType::MII_LOOKUP)
+    return false;
+  int64_t row = mit[dim_];
+  if (row == common::NULL_VALUE_64)
+    return false;
+
+  if (row < native_first_row_ || row >= native_first_row_ + int64_t(native_block_.size)) {
+    core::JustATable *table = var_map_[0].just_a_table_ptr;
+    // A sparse iterator would have a whole block converted for each row it
+    // visits, so the block is only evaluated if the iterator is going to visit
+    // at least half of the rest of the pack.
+    int64_t pack_rows = int64_t(1) << table->Getpackpower();
+    int64_t pack_rows_left = std::min((row | (pack_rows - 1)) + 1, table->NumOfObj()) - row;
+    int64_t mit_rows_left = mit.GetPackSizeLeft();
+    if (mit_rows_left != common::NULL_VALUE_64 && mit_rows_left * 2 < pack_rows_left)
+      return false;
+
+    // the block is aligned inside of the pack of the row, which is locked
+    int64_t block_rows = int64_t(1) << std::min(kNativeBlockPower, table->Getpackpower());
+    native_first_row_ = row & ~(block_rows - 1);
+    native_expr_->Reset(native_block_, std::min(block_rows, table->NumOfObj() - native_first_row_));
+    for (size_t i = 0; i < native_cols_.size(); i++) {
+      int64_t *values = native_expr_->Input(native_block_, i);
+      for (size_t r = 0; r < native_block_.size; r++)
+        values[r] = table->GetTable64(native_first_row_ + r, native_cols_[i]);
+    }
+    native_block_valid_ = native_expr_->Evaluate(native_block_);
+  }
+  if (!native_block_valid_)
+    return false;
+
+  native_expr_->GetValue(native_block_, row - native_first_row_, *native_val_);
+  last_val_ = native_val_;
+  first_eval_ = true;  // the arguments fed to expr_ are stale now
+  return true;
+}
+
+void ExpressionColumn::Evaluate(const core::MIIterator &mit) {
+  if (EvaluateNative(mit))
+    return;
   if (FeedArguments(mit))
     last_val_ = expr_->Evaluate();
+}
+
+int64_t ExpressionColumn::GetValueInt64Impl(const core::MIIterator &mit) {
+  Evaluate(mit);
   if (last_val_->IsNull())
     return common::NULL_VALUE_64;
   return last_val_->Get64();
 }
 
 bool ExpressionColumn::IsNullImpl(const core::MIIterator &mit) {
-  if (FeedArguments(mit))
-    last_val_ = expr_->Evaluate();
+  Evaluate(mit);
   return last_val_->IsNull();
 }
 
 void ExpressionColumn::GetValueStringImpl(types::BString &s, const core::MIIterator &mit) {
-  if (FeedArguments(mit))
-    last_val_ = expr_->Evaluate();
+  Evaluate(mit);
   if (core::ATI::IsDateTimeType(TypeName())) {
     int64_t tmp;
     types::TianmuDateTime vd(last_val_->Get64(), TypeName());
@@ -142,8 +217,7 @@ void ExpressionColumn::GetValueStringImpl(types::BString &s, const core::MIItera
 
 double ExpressionColumn::GetValueDoubleImpl(const core::MIIterator &mit) {
   double val = 0;
-  if (FeedArguments(mit))
-    last_val_ = expr_->Evaluate();
+  Evaluate(mit);
   if (last_val_->IsNull())
     val = NULL_VALUE_D;
 
@@ -21,6 +21,7 @@
 #include <mutex>
 
 #include "core/mi_updating_iterator.h"
+#include "core/native_expression.h"
 #include "core/pack_guardian.h"
 #include "vc/virtual_column.h"
 
@@ -127,12 +128,28 @@ class ExpressionColumn : public VirtualColumn {
    */
   bool FeedArguments(const core::MIIterator &mit);
 
+  // Sets last_val_ for the current row, natively if possible.
+  void Evaluate(const core::MIIterator &mit);
+  bool EvaluateNative(const core::MIIterator &mit);
+  void BuildNative();
+
+  // rows evaluated together by NativeExpression, at most a pack
+  static constexpr uint32_t kNativeBlockPower = 10;
+
   // if ExpressionColumn ExpressionColumn encapsulates an expression these sets
   // are used to interface with core::MysqlExpression
   core::MysqlExpression::SetOfVars vars_;
   core::MysqlExpression::TypOfVars var_types_;
   mutable core::MysqlExpression::var_buf_t var_buf_;
 
+  // nullptr if expr_ cannot be evaluated natively
+  std::shared_ptr<const core::NativeExpression> native_expr_;
+  std::vector<int> native_cols_;  // columns of the native inputs in the table of dim_
+  core::NativeExpression::Block native_block_;
+  int64_t native_first_row_ = 0;  // rows of native_block_ are native_first_row_...
+  bool native_block_valid_ = false;
+  std::shared_ptr<core::ValueOrNull> native_val_;
+
   //! value for a given row is always the same or not? e.g. currenttime() is not
   //! deterministic
   bool deterministic_;
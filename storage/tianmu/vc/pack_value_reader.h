@@ -0,0 +1,109 @@
+/* Copyright (c) 2022 StoneAtom, Inc. All rights reserved.
+   Use is subject to license terms
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1335 USA
+*/
+#ifndef TIANMU_VC_PACK_VALUE_READER_H_
+#define TIANMU_VC_PACK_VALUE_READER_H_
+#pragma once
+
+#include <vector>
+
+#include "core/mi_iterator.h"
+#include "vc/virtual_column.h"
+
+namespace Tianmu {
+namespace vcolumn {
+
+/*! \brief Per-thread replacement for vc->GetValueInt64(mit) in row loops.
+ *
+ * When the column maps directly onto a physical integer column, the whole
+ * current datapack is decoded at once (one width dispatch per pack, see
+ * PackInt::VisitValues) and subsequent rows of the pack are served from the
+ * buffer. Columns without such a path, and iterations jumping between packs
+ * too often (e.g. the inner side of a join), fall back to the row-by-row call.
+ * Copies start with an empty cache, so an owner may be copied per thread.
+ */
+class PackValueReader {
+ public:
+  PackValueReader() = default;
+  PackValueReader([[maybe_unused]] const PackValueReader &sec) {}
+  PackValueReader &operator=([[maybe_unused]] const PackValueReader &sec) {
+    Reset();
+    return *this;
+  }
+
+  int64_t GetValueInt64(VirtualColumn *vc, const core::MIIterator &mit) {
+    if (vc_ == nullptr)
+      Attach(vc);
+    if (vc != vc_ || dim_ < 0)  // only one column is cached
+      return vc->GetValueInt64(mit);
+    int64_t row = mit[dim_];
+    if (row == common::NULL_VALUE_64)
+      return common::NULL_VALUE_64;
+    int pack = int(row >> mit.GetPower());
+    if (pack != pack_)
+      Fill(pack, mit.GetPower());
+    rows_served_++;
+    if (!valid_)
+      return vc->GetValueInt64(mit);
+    return values_[row & ((int64_t(1) << mit.GetPower()) - 1)];
+  }
+
+  void Reset() {
+    vc_ = nullptr;
+    dim_ = -1;
+    pack_ = -1;
+    valid_ = false;
+    rows_served_ = 0;
+    short_fills_ = 0;
+  }
+
+ private:
+  // a decoded pack serving fewer rows than this is considered wasted work
+  static constexpr int64_t kMinRowsPerFill = 64;
+  static constexpr int kMaxShortFills = 8;
+
+  void Attach(VirtualColumn *vc) {
+    Reset();
+    vc_ = vc;
+    if (vc->IsSingleColumn() == VirtualColumn::single_col_t::SC_RCATTR)
+      dim_ = vc->GetDim();
+  }
+
+  void Fill(int pack, uint32_t power) {
+    if (pack_ != -1 && rows_served_ < kMinRowsPerFill && ++short_fills_ > kMaxShortFills) {
+      dim_ = -1;  // pack-hopping access, not worth decoding whole packs
+      valid_ = false;
+      return;
+    }
+    pack_ = pack;
+    rows_served_ = 0;
+    values_.resize(size_t(1) << power);
+    valid_ = vc_->GetPackValuesInt64(pack, values_.data());
+  }
+
+  VirtualColumn *vc_ = nullptr;
+  int dim_ = -1;
+  int pack_ = -1;
+  bool valid_ = false;
+  int64_t rows_served_ = 0;
+  int short_fills_ = 0;
+  std::vector<int64_t> values_;
+};
+
+}  // namespace vcolumn
+}  // namespace Tianmu
+
+#endif  // TIANMU_VC_PACK_VALUE_READER_H_
@@ -61,6 +61,7 @@ class SingleColumn : public VirtualColumn {
   }
 
   int64_t GetNotNullValueInt64(const core::MIIterator &mit) override { return col_->GetNotNullValueInt64(mit[dim_]); }
+  bool GetPackValuesInt64(int pack, int64_t *out) override { return col_->GetValuesInt64(pack, out); }
   bool IsDistinctInTable() override { return col_->IsDistinct(multi_index_->GetFilter(dim_)); }
   bool IsTempTableColumn() const { return col_->ColType() == core::PhysicalColumn::phys_col_t::ATTR; }
   void GetTextStat(types::TextStat &s) override { col_->GetTextStat(s, multi_index_->GetFilter(dim_)); }
@@ -382,6 +382,12 @@ class VirtualColumnBase : public core::Column {
   //! \brief Manually unlock all locked datapacks providing parameters for
   //! contained expression. Done also in destructor.
   virtual void UnlockSourcePacks() {}
+  /*! \brief GetValueInt64() of every row of one datapack of the only
+   * dimension of the column (see GetDim()), indexed by the row position in
+   * the pack. The pack must be locked. \return false if the column has no
+   * such one-pass path and values must be read row by row
+   */
+  virtual bool GetPackValuesInt64([[maybe_unused]] int pack, [[maybe_unused]] int64_t *out) { return false; }
   virtual void DisplayAttrStats() {}
   /*! \brief Returns true if access to column values does not depend on
    * MultiIndexIterator, false otherwise \return bool